@@ -0,0 +1,314 @@
+#include <charconv>
+#include <thread>
+#include "AccountStateCache.hpp"
+
+
+namespace bfcpp
+{
+  namespace
+  {
+    std::string_view field(const map<string, string>& values, const string& key)
+    {
+      auto it = values.find(key);
+      return it == values.cend() ? std::string_view{} : std::string_view{ it->second };
+    }
+
+
+    int64_t toInteger(std::string_view str)
+    {
+      int64_t value = 0;
+      std::from_chars(str.data(), str.data() + str.size(), value);
+      return value;
+    }
+
+
+    Decimal toDecimal(std::string_view str)
+    {
+      return str.empty() ? Decimal{ 0, StreamDecimalScale } : Decimal::fromString(str, StreamDecimalScale);
+    }
+
+
+    PositionSide toSide(std::string_view str)
+    {
+      if (str == "LONG")
+        return PositionSide::Long;
+      else if (str == "SHORT")
+        return PositionSide::Short;
+      else
+        return PositionSide::Both;
+    }
+
+
+    size_t hash(std::string_view name, const PositionSide side)
+    {
+      // FNV-1a
+      uint64_t h = 14695981039346656037ULL;
+
+      for (const char c : name)
+      {
+        h = (h ^ static_cast<uint8_t>(c)) * 1099511628211ULL;
+      }
+
+      return static_cast<size_t>((h ^ static_cast<uint8_t>(side)) * 1099511628211ULL);
+    }
+  }
+
+
+  template<size_t N>
+  AccountStateCache::SlotTable<N>::SlotTable(const size_t capacity) : m_capacity(capacity), m_count(0)
+  {
+    // at most half full
+    size_t size = 16;
+    while (size < capacity * 2)
+      size <<= 1;
+
+    m_mask = size - 1;
+    m_slots = std::make_unique<Slot<N>[]>(capacity);
+    m_table = std::make_unique<std::atomic<uint32_t>[]>(size);
+
+    for (size_t i = 0; i < size; ++i)
+      m_table[i].store(0, std::memory_order_relaxed);
+  }
+
+
+  template<size_t N>
+  AccountStateCache::Slot<N>* AccountStateCache::SlotTable<N>::get(std::string_view name, const PositionSide side)
+  {
+    auto index = hash(name, side) & m_mask;
+
+    for (; m_table[index].load(std::memory_order_relaxed); index = (index + 1) & m_mask)
+    {
+      if (auto& slot = m_slots[m_table[index].load(std::memory_order_relaxed) - 1]; slot.side == side && slot.name == name)
+      {
+        return &slot;
+      }
+    }
+
+    const auto count = m_count.load(std::memory_order_relaxed);
+
+    if (count == m_capacity || name.empty() || name.size() >= sizeof(SymbolString::data))
+    {
+      return nullptr;
+    }
+
+    auto& slot = m_slots[count];
+    slot.name.assign(name);
+    slot.side = side;
+
+    // publishes the name and side to readers
+    m_table[index].store(count + 1, std::memory_order_release);
+    m_count.store(count + 1, std::memory_order_relaxed);
+
+    return &slot;
+  }
+
+
+  template<size_t N>
+  const AccountStateCache::Slot<N>* AccountStateCache::SlotTable<N>::find(std::string_view name, const PositionSide side) const
+  {
+    auto index = hash(name, side) & m_mask;
+
+    for (uint32_t entry; (entry = m_table[index].load(std::memory_order_acquire)) != 0; index = (index + 1) & m_mask)
+    {
+      if (const auto& slot = m_slots[entry - 1]; slot.side == side && slot.name == name)
+      {
+        return &slot;
+      }
+    }
+
+    return nullptr;
+  }
+
+
+  template<size_t N>
+  bool AccountStateCache::SlotTable<N>::write(Slot<N>& slot, const std::array<Decimal, N>& values, const int64_t updateTime)
+  {
+    if (updateTime < slot.updateTime.load(std::memory_order_relaxed))
+    {
+      return false;
+    }
+
+    const auto sequence = slot.sequence.load(std::memory_order_relaxed);
+
+    slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    for (size_t i = 0; i < N; ++i)
+      slot.values[i].store(values[i].raw(), std::memory_order_relaxed);
+
+    slot.updateTime.store(updateTime, std::memory_order_relaxed);
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+
+    return true;
+  }
+
+
+  template<size_t N>
+  int64_t AccountStateCache::SlotTable<N>::read(const Slot<N>& slot, std::array<Decimal, N>& values)
+  {
+    std::array<int64_t, N> raw;
+    int64_t updateTime;
+
+    while (true)
+    {
+      const auto sequence = slot.sequence.load(std::memory_order_acquire);
+
+      if (sequence & 1)
+      {
+        std::this_thread::yield();
+        continue;
+      }
+
+      for (size_t i = 0; i < N; ++i)
+        raw[i] = slot.values[i].load(std::memory_order_relaxed);
+
+      updateTime = slot.updateTime.load(std::memory_order_relaxed);
+
+      std::atomic_thread_fence(std::memory_order_acquire);
+
+      if (slot.sequence.load(std::memory_order_relaxed) == sequence)
+        break;
+    }
+
+    for (size_t i = 0; i < N; ++i)
+      values[i] = Decimal{ raw[i], StreamDecimalScale };
+
+    return updateTime;
+  }
+
+
+
+  AccountStateCache::AccountStateCache(const size_t maxPositions, const size_t maxAssets) : m_seeded(false), m_positions(maxPositions), m_balances(maxAssets)
+  {
+  }
+
+
+  void AccountStateCache::seed(const AccountInformation& info)
+  {
+    if (!info.valid())
+    {
+      return;
+    }
+
+    const auto accountTime = toInteger(field(info.data, "updateTime"));
+
+    for (const auto& asset : info.assets)
+    {
+      const auto time = toInteger(field(asset, "updateTime"));
+
+      setBalance(field(asset, "asset"), { field(asset, "walletBalance"), field(asset, "crossWalletBalance") }, time ? time : accountTime);
+    }
+
+    for (const auto& position : info.positions)
+    {
+      const auto time = toInteger(field(position, "updateTime"));
+
+      setPosition(field(position, "symbol"), field(position, "positionSide"), { field(position, "positionAmt"), field(position, "entryPrice"), field(position, "unrealizedProfit") },
+                  time ? time : accountTime);
+    }
+
+    m_seeded.store(true, std::memory_order_release);
+  }
+
+
+  void AccountStateCache::onUserData(const UsdFutureUserData& userData)
+  {
+    if (userData.type != UsdFutureUserData::EventType::AccountUpdate)
+    {
+      return;
+    }
+
+    const auto time = toInteger(field(userData.au.data, "T"));
+
+    for (const auto& balance : userData.au.balances)
+    {
+      setBalance(field(balance, "a"), { field(balance, "wb"), field(balance, "cw") }, time);
+    }
+
+    for (const auto& position : userData.au.positions)
+    {
+      setPosition(field(position, "s"), field(position, "ps"), { field(position, "pa"), field(position, "ep"), field(position, "up") }, time);
+    }
+  }
+
+
+  std::optional<PositionState> AccountStateCache::position(std::string_view symbol, const PositionSide side) const
+  {
+    if (auto slot = m_positions.find(symbol, side); slot)
+    {
+      std::array<Decimal, 3> values;
+
+      PositionState state;
+      state.updateTime = SlotTable<3>::read(*slot, values);
+      state.amount = values[0];
+      state.entryPrice = values[1];
+      state.unrealizedProfit = values[2];
+      return state;
+    }
+
+    return std::nullopt;
+  }
+
+
+  std::optional<BalanceState> AccountStateCache::balance(std::string_view asset) const
+  {
+    if (auto slot = m_balances.find(asset, PositionSide::Both); slot)
+    {
+      std::array<Decimal, 2> values;
+
+      BalanceState state;
+      state.updateTime = SlotTable<2>::read(*slot, values);
+      state.walletBalance = values[0];
+      state.crossWalletBalance = values[1];
+      return state;
+    }
+
+    return std::nullopt;
+  }
+
+
+  void AccountStateCache::setPosition(std::string_view symbol, std::string_view side, const std::array<std::string_view, 3>& values, const int64_t updateTime)
+  {
+    std::array<Decimal, 3> decimals;
+
+    try
+    {
+      for (size_t i = 0; i < values.size(); ++i)
+        decimals[i] = toDecimal(values[i]);
+    }
+    catch (const std::exception&)
+    {
+      return;   // not a number or out of range, leave the last good state
+    }
+
+    std::scoped_lock lock(m_writeMux);
+
+    if (auto slot = m_positions.get(symbol, toSide(side)); slot)
+    {
+      SlotTable<3>::write(*slot, decimals, updateTime);
+    }
+  }
+
+
+  void AccountStateCache::setBalance(std::string_view asset, const std::array<std::string_view, 2>& values, const int64_t updateTime)
+  {
+    std::array<Decimal, 2> decimals;
+
+    try
+    {
+      for (size_t i = 0; i < values.size(); ++i)
+        decimals[i] = toDecimal(values[i]);
+    }
+    catch (const std::exception&)
+    {
+      return;
+    }
+
+    std::scoped_lock lock(m_writeMux);
+
+    if (auto slot = m_balances.get(asset, PositionSide::Both); slot)
+    {
+      SlotTable<2>::write(*slot, decimals, updateTime);
+    }
+  }
+}
@@ -0,0 +1,130 @@
+#ifndef __BINANCE_ACCOUNTSTATECACHE_HPP
+#define __BINANCE_ACCOUNTSTATECACHE_HPP
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include "bfcppCommon.hpp"
+#include "Decimal.hpp"
+#include "TypedStreams.hpp"
+
+
+namespace bfcpp
+{
+  enum class PositionSide : uint8_t { Both, Long, Short };
+
+
+  struct PositionState
+  {
+    Decimal amount;             // negative when short
+    Decimal entryPrice;
+    Decimal unrealizedProfit;
+    int64_t updateTime{ 0 };    // ms
+  };
+
+
+  struct BalanceState
+  {
+    Decimal walletBalance;
+    Decimal crossWalletBalance;
+    int64_t updateTime{ 0 };    // ms
+  };
+
+
+  /// <summary>
+  /// Positions and balances, seeded from accountInformation() then updated from ACCOUNT_UPDATE user data events,
+  /// so they can be read without polling REST. See UsdFuturesMarket::accountState().
+  ///
+  /// Reads don't lock: each position and balance is a slot guarded by a sequence count (a seqlock) which the reader
+  /// retries on if it was written whilst being read. Slots are allocated on first sight of a symbol/side or asset and never move,
+  /// so the capacity is fixed on construction. Updates older than the state held are ignored, so seeding can race the stream.
+  ///
+  /// Values are held with StreamDecimalScale decimal places.
+  /// </summary>
+  class AccountStateCache
+  {
+  public:
+    static const size_t DefaultMaxPositions = 2048;  // symbol and side pairs
+    static const size_t DefaultMaxAssets = 64;
+
+
+    explicit AccountStateCache(const size_t maxPositions = DefaultMaxPositions, const size_t maxAssets = DefaultMaxAssets);
+
+
+    /// <summary>
+    /// Sets every position and balance in the account information.
+    /// </summary>
+    void seed(const AccountInformation& info);
+
+    /// <summary>
+    /// Applies an AccountUpdate event's balances and positions, other events are ignored.
+    /// </summary>
+    void onUserData(const UsdFutureUserData& userData);
+
+
+    /// <summary>
+    /// nullopt if there's been no position for the symbol and side. Lock free.
+    /// </summary>
+    std::optional<PositionState> position(std::string_view symbol, const PositionSide side = PositionSide::Both) const;
+
+    /// <summary>
+    /// nullopt if the asset has not been seen. Lock free.
+    /// </summary>
+    std::optional<BalanceState> balance(std::string_view asset) const;
+
+    bool seeded() const { return m_seeded.load(std::memory_order_acquire); }
+
+
+  private:
+    // a seqlocked set of values, an odd sequence means a write is in progress
+    template<size_t N>
+    struct Slot
+    {
+      SymbolString name;      // symbol or asset, set before the slot is published, then constant
+      PositionSide side{ PositionSide::Both };
+      std::atomic<uint32_t> sequence{ 0 };
+      std::atomic<int64_t> values[N] = {};
+      std::atomic<int64_t> updateTime{ 0 };
+    };
+
+
+    // fixed capacity slots, indexed by name and side in an open addressing table which readers probe without locking
+    template<size_t N>
+    class SlotTable
+    {
+    public:
+      explicit SlotTable(const size_t capacity);
+
+      // the writer's slot, added if new. nullptr if full
+      Slot<N>* get(std::string_view name, const PositionSide side);
+
+      const Slot<N>* find(std::string_view name, const PositionSide side) const;
+
+      // false if the update is older than the slot's
+      static bool write(Slot<N>& slot, const std::array<Decimal, N>& values, const int64_t updateTime);
+
+      static int64_t read(const Slot<N>& slot, std::array<Decimal, N>& values);
+
+    private:
+      size_t m_capacity;
+      size_t m_mask;
+      std::unique_ptr<Slot<N>[]> m_slots;
+      std::unique_ptr<std::atomic<uint32_t>[]> m_table;    // slot index + 1, 0 if empty
+      std::atomic<uint32_t> m_count;
+    };
+
+
+    void setPosition(std::string_view symbol, std::string_view side, const std::array<std::string_view, 3>& values, const int64_t updateTime);
+    void setBalance(std::string_view asset, const std::array<std::string_view, 2>& values, const int64_t updateTime);
+
+
+    std::mutex m_writeMux;
+    std::atomic_bool m_seeded;
+    SlotTable<3> m_positions;   // amount, entryPrice, unrealizedProfit
+    SlotTable<2> m_balances;    // walletBalance, crossWalletBalance
+  };
+}
+
+#endif
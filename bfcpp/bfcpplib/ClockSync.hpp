@@ -0,0 +1,110 @@
+#ifndef __BINANCE_CLOCKSYNC_HPP
+#define __BINANCE_CLOCKSYNC_HPP
+
+#include <atomic>
+#include <limits>
+#include "bfcppCommon.hpp"
+
+
+namespace bfcpp
+{
+  /// <summary>
+  /// Estimates the offset between the local clock and the exchange's, so signed requests can be timestamped with the
+  /// exchange's time rather than the local system_clock. With the offset corrected, recvWindow only has to cover the one-way delay,
+  /// see UsdFuturesMarket::syncClock().
+  ///
+  /// Each sample is a server time request: sent and received are local times, the server time is assumed to be taken halfway between, as NTP does.
+  /// Of a round of samples only the one with the lowest round trip is used, as it had the least queuing so the least asymmetry.
+  ///
+  /// The offset is read without locking, so timestamp() can be called from any thread.
+  /// </summary>
+  class ClockSync
+  {
+  public:
+    struct Sample
+    {
+      int64_t sent;         // local, microseconds since epoch
+      int64_t serverTime;   // exchange, milliseconds since epoch
+      int64_t received;     // local, microseconds since epoch
+    };
+
+
+    ClockSync() : m_offset(0), m_delay(0), m_synced(false)
+    {
+    }
+
+
+    /// <summary>
+    /// Local system_clock time, microseconds since epoch.
+    /// </summary>
+    static int64_t localTime()
+    {
+      return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now().time_since_epoch()).count();
+    }
+
+
+    /// <summary>
+    /// Sets the offset and delay from the sample with the lowest round trip. Samples with a negative round trip are ignored.
+    /// Returns false, leaving the offset unchanged, if there are no usable samples.
+    /// </summary>
+    bool update(const vector<Sample>& samples)
+    {
+      const Sample* best = nullptr;
+      int64_t bestRoundTrip = std::numeric_limits<int64_t>::max();
+
+      for (const auto& sample : samples)
+      {
+        if (const auto roundTrip = sample.received - sample.sent; roundTrip >= 0 && roundTrip < bestRoundTrip)
+        {
+          best = &sample;
+          bestRoundTrip = roundTrip;
+        }
+      }
+
+      if (!best)
+      {
+        return false;
+      }
+
+      // the server time is truncated to the millisecond, so on average 500us behind
+      const auto server = best->serverTime * 1000 + 500;
+      const auto midpoint = best->sent + bestRoundTrip / 2;
+
+      m_offset.store(server - midpoint, std::memory_order_relaxed);
+      m_delay.store(bestRoundTrip / 2, std::memory_order_relaxed);
+      m_synced.store(true, std::memory_order_release);
+
+      return true;
+    }
+
+
+    /// <summary>
+    /// The exchange's time now, in milliseconds, for the timestamp param. The local time if not synced.
+    /// </summary>
+    int64_t timestamp() const
+    {
+      return (localTime() + m_offset.load(std::memory_order_relaxed)) / 1000;
+    }
+
+
+    /// <summary>
+    /// Exchange time minus local time. Positive if the local clock is behind.
+    /// </summary>
+    std::chrono::microseconds offset() const { return std::chrono::microseconds{ m_offset.load(std::memory_order_relaxed) }; }
+
+    /// <summary>
+    /// The one-way delay of the sample used, half its round trip.
+    /// </summary>
+    std::chrono::microseconds delay() const { return std::chrono::microseconds{ m_delay.load(std::memory_order_relaxed) }; }
+
+    bool synced() const { return m_synced.load(std::memory_order_acquire); }
+
+
+  private:
+    std::atomic<int64_t> m_offset;
+    std::atomic<int64_t> m_delay;
+    std::atomic_bool m_synced;
+  };
+}
+
+#endif
@@ -0,0 +1,454 @@
+#ifndef __BINANCE_DECIMAL_HPP
+#define __BINANCE_DECIMAL_HPP
+
+#include <ostream>
+#include <limits>
+#include "bfcppCommon.hpp"
+
+
+namespace bfcpp
+{
+  /// <summary>
+  /// A fixed point decimal, stored as a 64-bit integer scaled by 10^scale, i.e. "1234.56" with scale 2 is 123456.
+  ///
+  /// Parsing, formatting and arithmetic are exact and do not use floating point or allocate (except str()).
+  /// The scale is per value, usually the symbol's pricePrecision or quantityPrecision, see getDecimalScale().
+  /// Addition, subtraction and comparison work across scales, the result having the larger scale.
+  /// </summary>
+  class Decimal
+  {
+  public:
+    enum class Rounding
+    {
+      Down,   // towards zero, i.e. truncate
+      Up,     // away from zero
+      HalfUp  // to nearest, halves away from zero
+    };
+
+    static constexpr unsigned MaxScale = 18;
+    static constexpr size_t MaxChars = 24;  // sign, up to 19 digits and the point. See format().
+
+
+    constexpr Decimal() : m_value(0), m_scale(0)
+    {
+    }
+
+
+    /// <summary>
+    ///
+    /// </summary>
+    /// <param name="value">The scaled value, i.e. 123456 for 1234.56 with a scale of 2</param>
+    /// <param name="scale">The number of decimal places</param>
+    constexpr Decimal(const int64_t value, const unsigned scale) : m_value(value), m_scale(static_cast<uint8_t>(scale))
+    {
+    }
+
+
+    /// <summary>
+    /// Parses a decimal string, digits beyond 'scale' are truncated. Throws BfcppException if the string isn't a decimal or doesn't fit.
+    /// </summary>
+    static Decimal fromString(std::string_view str, const unsigned scale)
+    {
+      return Decimal{ toFixedPoint(str, scale), scale };
+    }
+
+
+    /// <summary>
+    /// Parses a decimal string, keeping all decimal places (up to MaxScale).
+    /// </summary>
+    static Decimal fromString(std::string_view str)
+    {
+      unsigned scale = 0;
+
+      if (auto point = str.find('.'); point != std::string_view::npos)
+      {
+        scale = static_cast<unsigned>(std::min<size_t>(str.size() - point - 1, MaxScale));
+      }
+
+      return fromString(str, scale);
+    }
+
+
+    int64_t raw() const { return m_value; }
+    unsigned scale() const { return m_scale; }
+    bool isZero() const { return m_value == 0; }
+
+
+    double toDouble() const
+    {
+      return static_cast<double>(m_value) / static_cast<double>(pow10(m_scale));
+    }
+
+
+    /// <summary>
+    /// Returns the value with a different scale. Reducing the scale rounds, increasing is exact.
+    /// </summary>
+    Decimal rescale(const unsigned scale, const Rounding rounding = Rounding::HalfUp) const
+    {
+      if (scale >= m_scale)
+      {
+        return Decimal{ checkedMultiply(m_value, pow10(scale - m_scale)), scale };
+      }
+
+      return Decimal{ divide(m_value, pow10(m_scale - scale), rounding), scale };
+    }
+
+
+    /// <summary>
+    /// Rounds to a multiple of 'step', which must be positive, otherwise BfcppException is thrown. Used for tickSize and stepSize filters.
+    /// </summary>
+    Decimal roundToStep(const Decimal& step, const Rounding rounding = Rounding::Down) const
+    {
+      const auto scale = std::max(m_scale, step.m_scale);
+      const auto value = rescale(scale).m_value;
+      const auto units = step.rescale(scale).m_value;
+
+      if (units <= 0)
+      {
+        throw BfcppException("Decimal: step must be positive");
+      }
+
+      return Decimal{ checkedMultiply(divide(value, units, rounding), units), scale };
+    }
+
+
+    /// <summary>
+    /// Multiplies exactly, the result rounded to 'scale'. Throws BfcppException if the result does not fit.
+    /// </summary>
+    Decimal multiply(const Decimal& other, const unsigned scale, const Rounding rounding = Rounding::HalfUp) const
+    {
+      const auto productScale = static_cast<unsigned>(m_scale) + other.m_scale;
+
+      if (productScale <= scale)
+      {
+        return Decimal{ checkedMultiply(checkedMultiply(m_value, other.m_value), pow10(scale - productScale)), scale };
+      }
+
+      return Decimal{ mulDiv(m_value, other.m_value, pow10(productScale - scale), rounding), scale };
+    }
+
+
+    /// <summary>
+    /// Writes the value with exactly scale() decimal places, i.e. "0.0100" for Decimal{100, 4}. No null terminator is written.
+    /// The buffer must be at least MaxChars. Returns the number of chars written.
+    /// </summary>
+    size_t format(char* buffer) const
+    {
+      char digits[MaxChars];
+      size_t n = 0;
+
+      // work with a negative value so that int64 min is handled
+      int64_t value = m_value < 0 ? m_value : -m_value;
+
+      do
+      {
+        digits[n++] = static_cast<char>('0' - value % 10);
+        value /= 10;
+      } while (value != 0 || n <= m_scale);
+
+      size_t size = 0;
+
+      if (m_value < 0)
+      {
+        buffer[size++] = '-';
+      }
+
+      while (n > 0)
+      {
+        if (n == m_scale)
+        {
+          buffer[size++] = '.';
+        }
+        buffer[size++] = digits[--n];
+      }
+
+      return size;
+    }
+
+
+    /// <summary>
+    /// Appends the formatted value to the string, see format().
+    /// </summary>
+    void appendTo(string& str) const
+    {
+      char buffer[MaxChars];
+      str.append(buffer, format(buffer));
+    }
+
+
+    string str() const
+    {
+      char buffer[MaxChars];
+      return string(buffer, format(buffer));
+    }
+
+
+    // arithmetic throws BfcppException if the result doesn't fit
+
+    Decimal operator-() const { return Decimal{ checkedSubtract(0, m_value), m_scale }; }
+
+    Decimal operator+(const Decimal& other) const
+    {
+      const auto scale = std::max(m_scale, other.m_scale);
+      return Decimal{ checkedAdd(rescale(scale).m_value, other.rescale(scale).m_value), scale };
+    }
+
+    Decimal operator-(const Decimal& other) const
+    {
+      const auto scale = std::max(m_scale, other.m_scale);
+      return Decimal{ checkedSubtract(rescale(scale).m_value, other.rescale(scale).m_value), scale };
+    }
+
+    Decimal operator*(const int64_t n) const { return Decimal{ checkedMultiply(m_value, n), m_scale }; }
+
+    Decimal& operator+=(const Decimal& other) { return *this = *this + other; }
+    Decimal& operator-=(const Decimal& other) { return *this = *this - other; }
+
+    bool operator==(const Decimal& other) const { return compare(other) == 0; }
+    bool operator!=(const Decimal& other) const { return compare(other) != 0; }
+    bool operator<(const Decimal& other) const { return compare(other) < 0; }
+    bool operator<=(const Decimal& other) const { return compare(other) <= 0; }
+    bool operator>(const Decimal& other) const { return compare(other) > 0; }
+    bool operator>=(const Decimal& other) const { return compare(other) >= 0; }
+
+
+    static int64_t pow10(const unsigned n)
+    {
+      static constexpr int64_t powers[MaxScale + 1] =
+      {
+        1LL, 10LL, 100LL, 1000LL, 10000LL, 100000LL, 1000000LL, 10000000LL, 100000000LL, 1000000000LL,
+        10000000000LL, 100000000000LL, 1000000000000LL, 10000000000000LL, 100000000000000LL,
+        1000000000000000LL, 10000000000000000LL, 100000000000000000LL, 1000000000000000000LL
+      };
+
+      if (n > MaxScale)
+      {
+        throw BfcppException("Decimal: scale exceeds MaxScale");
+      }
+
+      return powers[n];
+    }
+
+
+  private:
+    int compare(const Decimal& other) const
+    {
+      if (m_scale == other.m_scale)
+      {
+        return m_value < other.m_value ? -1 : (m_value > other.m_value ? 1 : 0);
+      }
+
+      // compare the integer parts first so that rescaling can't overflow
+      const auto intA = m_value / pow10(m_scale), intB = other.m_value / pow10(other.m_scale);
+
+      if (intA != intB)
+      {
+        return intA < intB ? -1 : 1;
+      }
+
+      const auto scale = std::max(m_scale, other.m_scale);
+      const auto fracA = (m_value % pow10(m_scale)) * pow10(scale - m_scale), fracB = (other.m_value % pow10(other.m_scale)) * pow10(scale - other.m_scale);
+      return fracA < fracB ? -1 : (fracA > fracB ? 1 : 0);
+    }
+
+
+    static int64_t divide(const int64_t value, const int64_t divisor, const Rounding rounding)
+    {
+      auto quotient = value / divisor;
+      const auto remainder = value % divisor;
+
+      if (remainder != 0)
+      {
+        const auto away = (value < 0) ? -1 : 1;
+        const auto absRemainder = remainder < 0 ? -remainder : remainder;
+
+        if (rounding == Rounding::Up || (rounding == Rounding::HalfUp && absRemainder >= divisor - absRemainder))
+        {
+          quotient += away;
+        }
+      }
+
+      return quotient;
+    }
+
+
+    static int64_t checkedMultiply(const int64_t a, const int64_t b)
+    {
+      if (a != 0 && b != 0)
+      {
+        const auto max = std::numeric_limits<int64_t>::max();
+        const uint64_t absA = a < 0 ? 0 - static_cast<uint64_t>(a) : a, absB = b < 0 ? 0 - static_cast<uint64_t>(b) : b;
+
+        if (absA > max / absB)
+        {
+          throw BfcppException("Decimal: overflow");
+        }
+      }
+
+      return a * b;
+    }
+
+
+    static int64_t checkedAdd(const int64_t a, const int64_t b)
+    {
+      if ((b > 0 && a > std::numeric_limits<int64_t>::max() - b) || (b < 0 && a < std::numeric_limits<int64_t>::min() - b))
+      {
+        throw BfcppException("Decimal: overflow");
+      }
+
+      return a + b;
+    }
+
+
+    static int64_t checkedSubtract(const int64_t a, const int64_t b)
+    {
+      if ((b < 0 && a > std::numeric_limits<int64_t>::max() + b) || (b > 0 && a < std::numeric_limits<int64_t>::min() + b))
+      {
+        throw BfcppException("Decimal: overflow");
+      }
+
+      return a - b;
+    }
+
+
+    // (a * b) / divisor with a 128-bit intermediate
+    static int64_t mulDiv(const int64_t a, const int64_t b, const int64_t divisor, const Rounding rounding)
+    {
+      const bool negative = (a < 0) != (b < 0);
+      const uint64_t absA = a < 0 ? 0 - static_cast<uint64_t>(a) : a, absB = b < 0 ? 0 - static_cast<uint64_t>(b) : b;
+      const auto d = static_cast<uint64_t>(divisor);
+
+      uint64_t quotient, remainder;
+
+#ifdef __SIZEOF_INT128__
+      const auto product = static_cast<unsigned __int128>(absA) * absB;
+
+      if ((product / d) > static_cast<uint64_t>(std::numeric_limits<int64_t>::max()))
+      {
+        throw BfcppException("Decimal: overflow");
+      }
+
+      quotient = static_cast<uint64_t>(product / d);
+      remainder = static_cast<uint64_t>(product % d);
+#else
+      // 64x64 multiply into hi:lo then shift-subtract division
+      const uint64_t aLo = absA & 0xFFFFFFFF, aHi = absA >> 32, bLo = absB & 0xFFFFFFFF, bHi = absB >> 32;
+      const uint64_t ll = aLo * bLo, lh = aLo * bHi, hl = aHi * bLo, hh = aHi * bHi;
+      const uint64_t mid = (ll >> 32) + (lh & 0xFFFFFFFF) + (hl & 0xFFFFFFFF);
+
+      uint64_t hi = hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+      uint64_t lo = (mid << 32) | (ll & 0xFFFFFFFF);
+
+      if (hi >= d)
+      {
+        throw BfcppException("Decimal: overflow");
+      }
+
+      quotient = 0;
+      remainder = hi;
+
+      for (int bit = 63; bit >= 0; --bit)
+      {
+        const bool carry = (remainder >> 63) != 0;
+        remainder = (remainder << 1) | ((lo >> bit) & 1);
+        quotient <<= 1;
+
+        if (carry || remainder >= d)
+        {
+          remainder -= d;
+          quotient |= 1;
+        }
+      }
+
+      if (quotient > static_cast<uint64_t>(std::numeric_limits<int64_t>::max()))
+      {
+        throw BfcppException("Decimal: overflow");
+      }
+#endif
+
+      if (remainder != 0 && (rounding == Rounding::Up || (rounding == Rounding::HalfUp && remainder >= d - remainder)))
+      {
+        ++quotient;
+      }
+
+      const auto result = static_cast<int64_t>(quotient);
+      return negative ? -result : result;
+    }
+
+
+  private:
+    int64_t m_value;
+    uint8_t m_scale;
+  };
+
+
+  inline std::ostream& operator<<(std::ostream& os, const Decimal& d)
+  {
+    char buffer[Decimal::MaxChars];
+    return os.write(buffer, d.format(buffer));
+  }
+
+
+  /// <summary>
+  /// The scales of a symbol's prices and quantities.
+  /// </summary>
+  struct DecimalScale
+  {
+    unsigned price{ 0 };
+    unsigned quantity{ 0 };
+  };
+
+
+  /// <summary>
+  /// Returns the symbol's pricePrecision and quantityPrecision from exchangeInfo().
+  /// </summary>
+  inline DecimalScale getDecimalScale(const ExchangeInfo::Symbol& symbol)
+  {
+    DecimalScale scale;
+
+    if (auto price = symbol.data.find("pricePrecision"); price != symbol.data.cend())
+    {
+      scale.price = std::stoul(price->second);
+    }
+
+    if (auto quantity = symbol.data.find("quantityPrecision"); quantity != symbol.data.cend())
+    {
+      scale.quantity = std::stoul(quantity->second);
+    }
+
+    return scale;
+  }
+
+
+  /// <summary>
+  /// Returns the symbol's pricePrecision and quantityPrecision from exchangeInfo(), throws BfcppException if the symbol is not found.
+  /// </summary>
+  inline DecimalScale getDecimalScale(const ExchangeInfo& info, const string& symbol)
+  {
+    for (const auto& sym : info.symbols)
+    {
+      if (auto name = sym.data.find("symbol"); name != sym.data.cend() && name->second == symbol)
+      {
+        return getDecimalScale(sym);
+      }
+    }
+
+    throw BfcppException{ BFCPP_FUNCTION_MSG(" symbol not found: " + symbol) };
+  }
+
+
+  /// <summary>
+  /// Ensure price is in a suitable format for the exchange, i.e. changing precision.
+  /// You can get the precision for a symbol from exchangeInfo, see getDecimalScale().
+  /// The price is rounded to the nearest, halves away from zero.
+  /// </summary>
+  /// <param name="price">The unformatted price</param>
+  /// <param name="precision">The precision</param>
+  /// <returns>The price in a suitable format</returns>
+  inline string priceTransform(const string& price, const std::streamsize precision = 2)
+  {
+    return Decimal::fromString(price).rescale(static_cast<unsigned>(precision)).str();
+  }
+}
+
+#endif
@@ -0,0 +1,396 @@
+#include <cstdio>
+#include <fstream>
+#include <thread>
+#include "ExchangeInfoCache.hpp"
+#include "Futures.hpp"
+
+#ifdef _WIN32
+  #ifndef NOMINMAX
+    #define NOMINMAX
+  #endif
+  #include <windows.h>
+#else
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+
+namespace bfcpp
+{
+  namespace
+  {
+    const char FileMagic[4] = { 'B', 'F', 'X', 'I' };
+    const uint32_t FileVersion = 1;
+
+
+    // followed by the SymbolInfo records, in id order, then the RateLimit records
+    struct FileHeader
+    {
+      char magic[4];
+      uint32_t version;
+      uint32_t symbolInfoSize;
+      uint32_t rateLimitSize;
+      uint32_t symbolCount;
+      uint32_t rateLimitCount;
+      int64_t updateTime;
+    };
+
+
+    /// <summary>
+    /// A read only mapping of a whole file, unmapped on destruction.
+    /// </summary>
+    class MappedFile
+    {
+    public:
+      explicit MappedFile(const string& path) : m_data(nullptr), m_size(0)
+      {
+#ifdef _WIN32
+        m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        m_mapping = nullptr;
+
+        LARGE_INTEGER size;
+        if (m_file == INVALID_HANDLE_VALUE || !GetFileSizeEx(m_file, &size) || size.QuadPart == 0)
+          return;
+
+        if (m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr); m_mapping)
+        {
+          m_data = static_cast<const char*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+          m_size = m_data ? static_cast<size_t>(size.QuadPart) : 0;
+        }
+#else
+        m_fd = ::open(path.c_str(), O_RDONLY);
+
+        struct stat st;
+        if (m_fd < 0 || ::fstat(m_fd, &st) != 0 || st.st_size == 0)
+          return;
+
+        if (auto data = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, m_fd, 0); data != MAP_FAILED)
+        {
+          m_data = static_cast<const char*>(data);
+          m_size = static_cast<size_t>(st.st_size);
+        }
+#endif
+      }
+
+
+      ~MappedFile()
+      {
+#ifdef _WIN32
+        if (m_data)
+          UnmapViewOfFile(m_data);
+        if (m_mapping)
+          CloseHandle(m_mapping);
+        if (m_file != INVALID_HANDLE_VALUE)
+          CloseHandle(m_file);
+#else
+        if (m_data)
+          ::munmap(const_cast<char*>(m_data), m_size);
+        if (m_fd >= 0)
+          ::close(m_fd);
+#endif
+      }
+
+
+      MappedFile(const MappedFile&) = delete;
+      MappedFile& operator=(const MappedFile&) = delete;
+
+
+      const char* data() const { return m_data; }
+      size_t size() const { return m_size; }
+
+
+    private:
+      const char* m_data;
+      size_t m_size;
+#ifdef _WIN32
+      HANDLE m_file;
+      HANDLE m_mapping;
+#else
+      int m_fd;
+#endif
+    };
+
+
+    Decimal toDecimal(const map<string, string>& values, const string& key)
+    {
+      if (auto it = values.find(key); it != values.cend() && !it->second.empty())
+        return Decimal::fromString(it->second);
+      else
+        return Decimal{};
+    }
+  }
+
+
+  uint32_t SymbolInfo::orderTypeBit(std::string_view type)
+  {
+    static const std::pair<std::string_view, uint32_t> Types[] =
+    {
+      {"LIMIT", Limit}, {"MARKET", Market}, {"STOP", Stop}, {"STOP_MARKET", StopMarket}, {"TAKE_PROFIT", TakeProfit},
+      {"TAKE_PROFIT_MARKET", TakeProfitMarket}, {"TRAILING_STOP_MARKET", TrailingStopMarket}
+    };
+
+    for (const auto& [name, bit] : Types)
+    {
+      if (name == type)
+        return bit;
+    }
+
+    return 0;
+  }
+
+
+  uint32_t SymbolInfo::timeInForceBit(std::string_view tif)
+  {
+    static const std::pair<std::string_view, uint32_t> Tifs[] = { {"GTC", GTC}, {"IOC", IOC}, {"FOK", FOK}, {"GTX", GTX} };
+
+    for (const auto& [name, bit] : Tifs)
+    {
+      if (name == tif)
+        return bit;
+    }
+
+    return 0;
+  }
+
+
+  bool SymbolInfo::fromExchangeInfo(const ExchangeInfo::Symbol& symbol, SymbolInfo& info)
+  {
+    // zero the padding as well, the record is written to disk as it is
+    std::memset(static_cast<void*>(&info), 0, sizeof(SymbolInfo));
+
+    auto field = [&symbol](const string& key) -> std::string_view
+    {
+      auto it = symbol.data.find(key);
+      return it == symbol.data.cend() ? std::string_view{} : std::string_view{ it->second };
+    };
+
+    const auto name = field("symbol");
+
+    if (name.empty() || name.size() > sizeof(info.m_symbol))
+    {
+      return false;
+    }
+
+    copy(name, info.m_symbol);
+    copy(field("pair"), info.m_pair);
+    copy(field("contractType"), info.m_contractType);
+    copy(field("status"), info.m_status);
+    copy(field("baseAsset"), info.m_baseAsset);
+    copy(field("quoteAsset"), info.m_quoteAsset);
+    copy(field("marginAsset"), info.m_marginAsset);
+
+    const auto scale = getDecimalScale(symbol);
+    info.pricePrecision = static_cast<uint8_t>(scale.price);
+    info.quantityPrecision = static_cast<uint8_t>(scale.quantity);
+
+    for (const auto& type : symbol.orderTypes)
+      info.orderTypes |= orderTypeBit(type);
+
+    for (const auto& tif : symbol.timeInForce)
+      info.timeInForce |= timeInForceBit(tif);
+
+    for (const auto& filter : symbol.filters)
+    {
+      auto type = filter.find("filterType");
+
+      if (type == filter.cend())
+        continue;
+
+      if (type->second == "PRICE_FILTER")
+      {
+        info.minPrice = toDecimal(filter, "minPrice");
+        info.maxPrice = toDecimal(filter, "maxPrice");
+        info.tickSize = toDecimal(filter, "tickSize");
+      }
+      else if (type->second == "LOT_SIZE")
+      {
+        info.minQty = toDecimal(filter, "minQty");
+        info.maxQty = toDecimal(filter, "maxQty");
+        info.stepSize = toDecimal(filter, "stepSize");
+      }
+      else if (type->second == "MARKET_LOT_SIZE")
+      {
+        info.marketMinQty = toDecimal(filter, "minQty");
+        info.marketMaxQty = toDecimal(filter, "maxQty");
+        info.marketStepSize = toDecimal(filter, "stepSize");
+      }
+      else if (type->second == "MIN_NOTIONAL")
+      {
+        info.minNotional = toDecimal(filter, "notional");
+      }
+      else if (type->second == "PERCENT_PRICE")
+      {
+        info.multiplierUp = toDecimal(filter, "multiplierUp");
+        info.multiplierDown = toDecimal(filter, "multiplierDown");
+      }
+    }
+
+    return true;
+  }
+
+
+
+  bool ExchangeInfoCache::load()
+  {
+    MappedFile file{ m_path };
+
+    if (file.size() < sizeof(FileHeader))
+    {
+      return false;
+    }
+
+    FileHeader header;
+    std::memcpy(&header, file.data(), sizeof(header));
+
+    if (std::memcmp(header.magic, FileMagic, sizeof(FileMagic)) != 0 || header.version != FileVersion ||
+        header.symbolInfoSize != sizeof(SymbolInfo) || header.rateLimitSize != sizeof(RateLimit) ||
+        file.size() != sizeof(FileHeader) + size_t{ header.symbolCount } * sizeof(SymbolInfo) + size_t{ header.rateLimitCount } * sizeof(RateLimit))
+    {
+      return false;
+    }
+
+    const auto symbolsStart = file.data() + sizeof(FileHeader);
+    const auto rateLimitsStart = symbolsStart + size_t{ header.symbolCount } * sizeof(SymbolInfo);
+
+    vector<SymbolInfo> symbols(header.symbolCount);
+    std::memcpy(static_cast<void*>(symbols.data()), symbolsStart, symbols.size() * sizeof(SymbolInfo));
+
+    vector<RateLimit> rateLimits(header.rateLimitCount);
+    std::memcpy(static_cast<void*>(rateLimits.data()), rateLimitsStart, rateLimits.size() * sizeof(RateLimit));
+
+    auto registry = std::make_shared<SymbolRegistry>();
+
+    for (const auto& symbol : symbols)
+    {
+      // the records are in id order, so a duplicate means the file is corrupt
+      if (const auto id = registry->size(); registry->add(symbol.symbol(), symbol.scale()) != id)
+      {
+        return false;
+      }
+    }
+
+    std::scoped_lock lock(m_updateMux);
+    std::atomic_store(&m_snapshot, std::make_shared<const ExchangeInfoSnapshot>(std::move(registry), std::move(symbols), std::move(rateLimits), header.updateTime));
+
+    return true;
+  }
+
+
+  bool ExchangeInfoCache::update(const ExchangeInfo& info)
+  {
+    std::scoped_lock lock(m_updateMux);
+
+    auto previous = snapshot();
+    auto registry = std::make_shared<SymbolRegistry>();
+    vector<SymbolInfo> symbols;
+
+    // existing symbols keep their ids, delisted ones keep their record without a status
+    if (previous)
+    {
+      symbols = previous->symbols();
+
+      for (auto& symbol : symbols)
+      {
+        registry->add(symbol.symbol(), symbol.scale());
+        SymbolInfo::copy({}, symbol.m_status);
+      }
+    }
+
+    for (const auto& symbol : info.symbols)
+    {
+      SymbolInfo record;
+
+      if (!SymbolInfo::fromExchangeInfo(symbol, record))
+        continue;
+
+      if (const auto id = registry->add(record.symbol(), record.scale()); id < symbols.size())
+        symbols[id] = record;
+      else
+        symbols.push_back(record);
+    }
+
+    auto rateLimits = RateLimitGovernor::readLimits(info);
+
+    const int64_t updateTime = info.serverTime.empty() ? getTimestamp() : std::stoll(info.serverTime);
+
+    auto next = std::make_shared<const ExchangeInfoSnapshot>(std::move(registry), std::move(symbols), std::move(rateLimits), updateTime);
+
+    // the snapshot is valid whether or not the file can be written
+    std::atomic_store(&m_snapshot, next);
+
+    return save(*next);
+  }
+
+
+  bool ExchangeInfoCache::save(const ExchangeInfoSnapshot& snapshot) const
+  {
+    FileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, FileMagic, sizeof(FileMagic));
+    header.version = FileVersion;
+    header.symbolInfoSize = sizeof(SymbolInfo);
+    header.rateLimitSize = sizeof(RateLimit);
+    header.symbolCount = static_cast<uint32_t>(snapshot.symbols().size());
+    header.rateLimitCount = static_cast<uint32_t>(snapshot.rateLimits().size());
+    header.updateTime = snapshot.updateTime();
+
+    // unique per process and thread, other processes may be writing the same file
+    const auto temp = m_path + ".tmp" + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id()) ^ static_cast<size_t>(Clock::now().time_since_epoch().count()));
+
+    {
+      std::ofstream out{ temp, std::ios::binary | std::ios::trunc };
+
+      out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+      out.write(reinterpret_cast<const char*>(snapshot.symbols().data()), snapshot.symbols().size() * sizeof(SymbolInfo));
+      out.write(reinterpret_cast<const char*>(snapshot.rateLimits().data()), snapshot.rateLimits().size() * sizeof(RateLimit));
+
+      if (!out.flush())
+      {
+        out.close();
+        std::remove(temp.c_str());
+        return false;
+      }
+    }
+
+#ifdef _WIN32
+    const bool renamed = MoveFileExA(temp.c_str(), m_path.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    const bool renamed = std::rename(temp.c_str(), m_path.c_str()) == 0;
+#endif
+
+    if (!renamed)
+    {
+      std::remove(temp.c_str());
+      return false;
+    }
+
+    return true;
+  }
+
+
+  pplx::task<bool> ExchangeInfoCache::refreshAsync(UsdFuturesMarket& market)
+  {
+    return pplx::create_task([this, &market]
+    {
+      auto info = market.exchangeInfo();
+
+      if (!info.valid())
+      {
+        throw BfcppException{ BFCPP_FUNCTION_MSG(" exchangeInfo failed: " + info.msg()) };
+      }
+
+      return update(info);
+    });
+  }
+
+
+  void ExchangeInfoCache::loadOrRefresh(UsdFuturesMarket& market)
+  {
+    if (!load())
+    {
+      refreshAsync(market).get();
+    }
+  }
+}
@@ -0,0 +1,257 @@
+#ifndef __BINANCE_EXCHANGEINFOCACHE_HPP
+#define __BINANCE_EXCHANGEINFOCACHE_HPP
+
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include "bfcppCommon.hpp"
+#include "Decimal.hpp"
+#include "SymbolRegistry.hpp"
+#include "RateLimitGovernor.hpp"
+
+
+namespace bfcpp
+{
+  class UsdFuturesMarket;
+
+
+  /// <summary>
+  /// A symbol's exchange info as a flat, fixed size record: the names, precisions and filters as typed values
+  /// rather than the strings in ExchangeInfo::Symbol. Records are copied to and from disk as they are, see ExchangeInfoCache.
+  /// </summary>
+  struct SymbolInfo
+  {
+    // bits in orderTypes
+    enum OrderType : uint32_t
+    {
+      Limit = 1 << 0,
+      Market = 1 << 1,
+      Stop = 1 << 2,
+      StopMarket = 1 << 3,
+      TakeProfit = 1 << 4,
+      TakeProfitMarket = 1 << 5,
+      TrailingStopMarket = 1 << 6
+    };
+
+    // bits in timeInForce
+    enum TimeInForce : uint32_t
+    {
+      GTC = 1 << 0,
+      IOC = 1 << 1,
+      FOK = 1 << 2,
+      GTX = 1 << 3
+    };
+
+
+    std::string_view symbol() const { return view(m_symbol); }
+    std::string_view pair() const { return view(m_pair); }
+    std::string_view contractType() const { return view(m_contractType); }
+    std::string_view status() const { return view(m_status); }
+    std::string_view baseAsset() const { return view(m_baseAsset); }
+    std::string_view quoteAsset() const { return view(m_quoteAsset); }
+    std::string_view marginAsset() const { return view(m_marginAsset); }
+
+    bool trading() const { return status() == "TRADING"; }
+
+    DecimalScale scale() const { return DecimalScale{ pricePrecision, quantityPrecision }; }
+
+    /// <summary>
+    /// The OrderType bit for the order's "type" param, i.e. "LIMIT", or 0 if unknown.
+    /// </summary>
+    static uint32_t orderTypeBit(std::string_view type);
+
+    /// <summary>
+    /// The TimeInForce bit for the order's "timeInForce" param, i.e. "GTC", or 0 if unknown.
+    /// </summary>
+    static uint32_t timeInForceBit(std::string_view tif);
+
+    bool allowsOrderType(std::string_view type) const { return (orderTypes & orderTypeBit(type)) != 0; }
+    bool allowsTimeInForce(std::string_view tif) const { return (timeInForce & timeInForceBit(tif)) != 0; }
+
+
+    /// <summary>
+    /// Creates the record from the exchange info. Returns false if the symbol name doesn't fit.
+    /// </summary>
+    static bool fromExchangeInfo(const ExchangeInfo::Symbol& symbol, SymbolInfo& info);
+
+
+    uint8_t pricePrecision;
+    uint8_t quantityPrecision;
+    uint32_t orderTypes;
+    uint32_t timeInForce;
+
+    // PRICE_FILTER
+    Decimal minPrice;
+    Decimal maxPrice;
+    Decimal tickSize;
+
+    // LOT_SIZE
+    Decimal minQty;
+    Decimal maxQty;
+    Decimal stepSize;
+
+    // MARKET_LOT_SIZE
+    Decimal marketMinQty;
+    Decimal marketMaxQty;
+    Decimal marketStepSize;
+
+    // MIN_NOTIONAL
+    Decimal minNotional;
+
+    // PERCENT_PRICE
+    Decimal multiplierUp;
+    Decimal multiplierDown;
+
+
+  private:
+    friend class ExchangeInfoCache;
+
+    template<size_t N>
+    static void copy(std::string_view str, char(&dest)[N])
+    {
+      std::memset(dest, 0, N);
+      str.copy(dest, N);
+    }
+
+    // nul padded
+    char m_symbol[32];
+    char m_pair[32];
+    char m_contractType[24];
+    char m_status[16];
+    char m_baseAsset[16];
+    char m_quoteAsset[16];
+    char m_marginAsset[16];
+
+
+    template<size_t N>
+    static std::string_view view(const char(&str)[N])
+    {
+      return std::string_view{ str, strnlen(str, N) };
+    }
+  };
+
+  static_assert(std::is_trivially_copyable_v<SymbolInfo>, "SymbolInfo is copied to and from disk");
+
+
+
+  /// <summary>
+  /// An immutable set of SymbolInfo, indexed by SymbolId. Shared by ExchangeInfoCache with its readers, so a refresh doesn't
+  /// invalidate records a reader is using.
+  /// </summary>
+  class ExchangeInfoSnapshot
+  {
+  public:
+    ExchangeInfoSnapshot(shared_ptr<const SymbolRegistry> registry, vector<SymbolInfo>&& symbols, vector<RateLimit>&& rateLimits, const int64_t updateTime) :
+      m_registry(std::move(registry)), m_symbols(std::move(symbols)), m_rateLimits(std::move(rateLimits)), m_updateTime(updateTime)
+    {
+    }
+
+
+    /// <summary>
+    /// The symbol's record or nullptr if unknown.
+    /// </summary>
+    const SymbolInfo* symbol(const SymbolId id) const
+    {
+      return id < m_symbols.size() ? &m_symbols[id] : nullptr;
+    }
+
+    const SymbolInfo* symbol(std::string_view name) const
+    {
+      return symbol(m_registry->id(name));
+    }
+
+
+    /// <summary>
+    /// Indexed by SymbolId. Ids are stable across refreshes, a delisted symbol keeps its id with an empty status.
+    /// </summary>
+    const vector<SymbolInfo>& symbols() const { return m_symbols; }
+
+    /// <summary>
+    /// Assigns the ids used by this snapshot. Pass to UsdFuturesMarket::setSymbolRegistry() so typed streams carry the same ids.
+    /// </summary>
+    const shared_ptr<const SymbolRegistry>& registry() const { return m_registry; }
+
+    /// <summary>
+    /// Pass to RateLimitGovernor::setLimits().
+    /// </summary>
+    const vector<RateLimit>& rateLimits() const { return m_rateLimits; }
+
+    /// <summary>
+    /// The exchange's serverTime when the exchange info was downloaded, milliseconds since epoch.
+    /// </summary>
+    int64_t updateTime() const { return m_updateTime; }
+
+
+  private:
+    shared_ptr<const SymbolRegistry> m_registry;
+    vector<SymbolInfo> m_symbols;
+    vector<RateLimit> m_rateLimits;
+    int64_t m_updateTime;
+  };
+
+
+
+  /// <summary>
+  /// Keeps exchangeInfo() as an ExchangeInfoSnapshot and a binary file, so a process can start from the file rather than
+  /// downloading and parsing the exchange info. The file is the records as they are in memory, so loading maps the file and copies them.
+  ///
+  /// The file is only valid for the build which wrote it (the record layout is checked), it is not a portable format.
+  /// Writes go to a temporary file which is then renamed, so processes sharing a file never see a partial write.
+  ///
+  /// Symbol ids are kept across refreshes and stored in the file, so processes loading the same file agree on ids.
+  ///
+  /// snapshot() can be called from any thread whilst refreshing.
+  /// </summary>
+  class ExchangeInfoCache
+  {
+  public:
+    explicit ExchangeInfoCache(const string& path) : m_path(path)
+    {
+    }
+
+
+    /// <summary>
+    /// Loads the file. Returns false, leaving the snapshot unchanged, if the file doesn't exist or was written by an incompatible build.
+    /// </summary>
+    bool load();
+
+    /// <summary>
+    /// Replaces the snapshot with the exchange info then writes the file. Symbols already known keep their id.
+    /// Returns false if the file couldn't be written, the snapshot is replaced regardless.
+    /// </summary>
+    bool update(const ExchangeInfo& info);
+
+    /// <summary>
+    /// Calls market.exchangeInfo() on a background task then update(), the task's result is update()'s. Throws if exchangeInfo() fails.
+    /// The market must outlive the task.
+    /// </summary>
+    pplx::task<bool> refreshAsync(UsdFuturesMarket& market);
+
+    /// <summary>
+    /// load(), or if that fails, a synchronous refresh. For startup.
+    /// </summary>
+    void loadOrRefresh(UsdFuturesMarket& market);
+
+    /// <summary>
+    /// The current snapshot, nullptr until loaded or updated.
+    /// </summary>
+    shared_ptr<const ExchangeInfoSnapshot> snapshot() const
+    {
+      return std::atomic_load(&m_snapshot);
+    }
+
+    const string& path() const { return m_path; }
+
+
+  private:
+    bool save(const ExchangeInfoSnapshot& snapshot) const;
+
+
+    string m_path;
+    std::mutex m_updateMux;
+    shared_ptr<const ExchangeInfoSnapshot> m_snapshot;
+  };
+}
+
+#endif
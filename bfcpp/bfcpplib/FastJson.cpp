@@ -0,0 +1,184 @@
+#include "FastJson.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BFCPP_FASTJSON_SSE2
+#include <emmintrin.h>
+#endif
+
+
+namespace bfcpp
+{
+  namespace fastjson
+  {
+    namespace
+    {
+      struct BlockMasks
+      {
+        uint64_t quote;
+        uint64_t backslash;
+        uint64_t structural;
+      };
+
+
+#ifdef BFCPP_FASTJSON_SSE2
+      inline uint64_t movemask(const __m128i a, const __m128i b, const __m128i c, const __m128i d)
+      {
+        return  static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(a))) |
+               (static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(b))) << 16) |
+               (static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(c))) << 32) |
+               (static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(d))) << 48);
+      }
+
+
+      inline uint64_t compare(const __m128i (&in)[4], const char c)
+      {
+        const auto v = _mm_set1_epi8(c);
+        return movemask(_mm_cmpeq_epi8(in[0], v), _mm_cmpeq_epi8(in[1], v), _mm_cmpeq_epi8(in[2], v), _mm_cmpeq_epi8(in[3], v));
+      }
+
+
+      inline BlockMasks classify(const char* block)
+      {
+        const __m128i in[4] = { _mm_loadu_si128(reinterpret_cast<const __m128i*>(block)),      _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + 16)),
+                                _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + 32)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + 48)) };
+
+        return BlockMasks{ compare(in, '"'), compare(in, '\\'),
+                           compare(in, '{') | compare(in, '}') | compare(in, '[') | compare(in, ']') | compare(in, ':') | compare(in, ',') };
+      }
+#else
+      inline BlockMasks classify(const char* block)
+      {
+        BlockMasks masks{ 0, 0, 0 };
+
+        for (uint64_t i = 0; i < 64; ++i)
+        {
+          switch (block[i])
+          {
+          case '"':  masks.quote |= 1ULL << i; break;
+          case '\\': masks.backslash |= 1ULL << i; break;
+          case '{': case '}': case '[': case ']': case ':': case ',': masks.structural |= 1ULL << i; break;
+          default: break;
+          }
+        }
+
+        return masks;
+      }
+#endif
+
+
+      // each bit is the xor of itself and all bits below it, so a bit is set from an opening quote up to (not including) its closing quote
+      inline uint64_t prefixXor(uint64_t x)
+      {
+        x ^= x << 1;
+        x ^= x << 2;
+        x ^= x << 4;
+        x ^= x << 8;
+        x ^= x << 16;
+        x ^= x << 32;
+        return x;
+      }
+
+
+      inline uint32_t trailingZeros(const uint64_t x)
+      {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward64(&index, x);
+        return static_cast<uint32_t>(index);
+#else
+        return static_cast<uint32_t>(__builtin_ctzll(x));
+#endif
+      }
+    }
+
+
+
+    bool Document::parse(std::string_view json)
+    {
+      m_json = json;
+      m_index.clear();
+
+      if (json.size() >= std::numeric_limits<uint32_t>::max())
+      {
+        return false;
+      }
+
+      uint64_t inStringCarry = 0;   // all ones if the previous block ended inside a string
+      bool escapeCarry = false;     // the previous block ended with an unescaped backslash
+      char tail[64];
+
+      for (size_t offset = 0; offset < json.size(); offset += 64)
+      {
+        const char* block = json.data() + offset;
+
+        if (json.size() - offset < 64)
+        {
+          std::memset(tail, ' ', sizeof(tail));
+          std::memcpy(tail, block, json.size() - offset);
+          block = tail;
+        }
+
+        auto masks = classify(block);
+
+        // backslashes are rare in stream data, so escaped chars are found with a scalar pass only when required
+        if (masks.backslash || escapeCarry)
+        {
+          uint64_t escaped = 0;
+
+          for (uint64_t i = 0; i < 64; ++i)
+          {
+            if (escapeCarry)
+            {
+              escaped |= 1ULL << i;
+              escapeCarry = false;
+            }
+            else if (masks.backslash & (1ULL << i))
+            {
+              escapeCarry = true;
+            }
+          }
+
+          masks.quote &= ~escaped;
+        }
+
+        const uint64_t inString = prefixXor(masks.quote) ^ inStringCarry;
+        inStringCarry = static_cast<uint64_t>(static_cast<int64_t>(inString) >> 63);
+
+        for (uint64_t bits = (masks.structural & ~inString) | masks.quote; bits; bits &= bits - 1)
+        {
+          m_index.push_back(static_cast<uint32_t>(offset) + trailingZeros(bits));
+        }
+      }
+
+      if (inStringCarry != 0)
+      {
+        return false; // unterminated string
+      }
+
+
+      // brackets must balance, the values are read on demand so this is the only validation up front
+      int64_t depth = 0;
+      for (const auto i : m_index)
+      {
+        switch (json[i])
+        {
+        case '{':
+        case '[':
+          ++depth;
+          break;
+
+        case '}':
+        case ']':
+          if (--depth < 0)
+            return false;
+          break;
+
+        default:
+          break;
+        }
+      }
+
+      return depth == 0 && !m_index.empty();
+    }
+  }
+}
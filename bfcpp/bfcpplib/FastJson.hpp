@@ -0,0 +1,418 @@
+#ifndef __BINANCE_FASTJSON_HPP
+#define __BINANCE_FASTJSON_HPP
+
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <algorithm>
+#include <initializer_list>
+#include "bfcppCommon.hpp"
+#include "Decimal.hpp"
+
+
+namespace bfcpp
+{
+  /// <summary>
+  /// Selects how the stream handlers parse websocket frames, see UsdFuturesMarket::setStreamParser().
+  /// </summary>
+  enum class StreamParser
+  {
+    Cpprest,  // web::json::value::parse(), builds a DOM
+    Fast      // fastjson::Document, a structural index read on demand. Falls back to Cpprest if a frame can't be read.
+  };
+
+
+  namespace fastjson
+  {
+    class Document;
+
+
+    /// <summary>
+    /// A value within a Document. Values are read on demand, nothing is converted or copied until requested.
+    /// Strings are returned as they appear in the frame, escape sequences are not decoded (Binance stream data does not use them).
+    /// </summary>
+    class Value
+    {
+    public:
+      enum class Type { Object, Array, String, Number, True, False, Null };
+
+      Value(const Document& doc, const uint32_t pos, const uint32_t idx) : m_doc(&doc), m_pos(pos), m_idx(idx)
+      {
+      }
+
+      Type type() const;
+
+      bool isObject() const { return type() == Type::Object; }
+      bool isArray() const { return type() == Type::Array; }
+
+      /// <summary>
+      /// The string without quotes, or the raw text of a number/true/false/null.
+      /// </summary>
+      std::string_view getString() const;
+
+      /// <summary>
+      /// The value's text as it appears in the frame, including the quotes or brackets.
+      /// </summary>
+      std::string_view raw() const;
+
+      int64_t getInt64() const;
+      bool getBool() const { return type() == Type::True; }
+
+      /// <summary>
+      /// As Decimal::fromString(), works with quoted and unquoted numbers.
+      /// </summary>
+      Decimal getDecimal(const unsigned scale) const { return Decimal::fromString(getString(), scale); }
+
+      /// <summary>
+      /// Calls f(std::string_view key, Value value) for each field of an object, in the order they appear.
+      /// </summary>
+      template<class F>
+      void forEachField(F f) const;
+
+      /// <summary>
+      /// Calls f(Value value) for each element of an array.
+      /// </summary>
+      template<class F>
+      void forEachElement(F f) const;
+
+      /// <summary>
+      /// Finds the field in an object, searching from the start. When reading several fields prefer forEachField(), which is a single pass.
+      /// </summary>
+      bool find(std::string_view key, Value& value) const;
+
+
+    private:
+      const Document* m_doc;
+      uint32_t m_pos;   // offset of the value's first char in the frame
+      uint32_t m_idx;   // index of the first structural char at or after m_pos
+    };
+
+
+
+    /// <summary>
+    /// Builds an index of the structural characters ({}[]:," outside of strings) in a frame, 64 bytes at a time using SSE2 where available.
+    /// Values are then read on demand by walking the index, without building a tree.
+    ///
+    /// A Document can be reused, the index memory is kept between frames.
+    /// The frame must outlive the Document's use.
+    /// </summary>
+    class Document
+    {
+    public:
+      /// <summary>
+      /// Indexes the frame. Returns false if the frame's quotes/brackets are unbalanced.
+      /// </summary>
+      bool parse(std::string_view json);
+
+      Value root() const;
+
+      std::string_view json() const { return m_json; }
+
+
+    private:
+      friend class Value;
+
+      char charAt(const uint32_t idx) const { return m_json[m_index[idx]]; }
+      uint32_t offsetAt(const uint32_t idx) const { return m_index[idx]; }
+      uint32_t skipWhitespace(uint32_t pos) const;
+      uint32_t skipValue(const uint32_t pos, const uint32_t idx) const;
+      void checkIndex(const uint32_t idx) const;
+
+      std::string_view m_json;
+      std::vector<uint32_t> m_index;
+    };
+
+
+
+    inline void Document::checkIndex(const uint32_t idx) const
+    {
+      if (idx >= m_index.size())
+      {
+        throw BfcppException("fastjson: unexpected end of frame");
+      }
+    }
+
+
+    inline uint32_t Document::skipWhitespace(uint32_t pos) const
+    {
+      while (pos < m_json.size() && (m_json[pos] == ' ' || m_json[pos] == '\n' || m_json[pos] == '\r' || m_json[pos] == '\t'))
+      {
+        ++pos;
+      }
+      return pos;
+    }
+
+
+    // returns the index of the first structural after the value
+    inline uint32_t Document::skipValue(const uint32_t pos, const uint32_t idx) const
+    {
+      checkIndex(idx);
+
+      if (offsetAt(idx) != pos)
+      {
+        return idx; // scalar, the structural is the ',' ']' or '}' which follows it
+      }
+
+      switch (charAt(idx))
+      {
+      case '"':
+        return idx + 2;
+
+      case '{':
+      case '[':
+      {
+        size_t depth = 0;
+        for (auto i = idx; i < m_index.size(); ++i)
+        {
+          switch (charAt(i))
+          {
+          case '{':
+          case '[':
+            ++depth;
+            break;
+
+          case '}':
+          case ']':
+            if (--depth == 0)
+              return i + 1;
+            break;
+
+          case '"':
+            ++i;  // skip the closing quote
+            break;
+
+          default:
+            break;
+          }
+        }
+
+        throw BfcppException("fastjson: unbalanced brackets");
+      }
+
+      default:
+        throw BfcppException("fastjson: unexpected structural");
+      }
+    }
+
+
+    inline Value Document::root() const
+    {
+      const auto pos = skipWhitespace(0);
+      return Value{ *this, pos, 0 };
+    }
+
+
+    inline Value::Type Value::type() const
+    {
+      switch (m_doc->m_json[m_pos])
+      {
+      case '{': return Type::Object;
+      case '[': return Type::Array;
+      case '"': return Type::String;
+      case 't': return Type::True;
+      case 'f': return Type::False;
+      case 'n': return Type::Null;
+      default:  return Type::Number;
+      }
+    }
+
+
+    inline std::string_view Value::getString() const
+    {
+      const auto& doc = *m_doc;
+
+      if (doc.m_json[m_pos] == '"')
+      {
+        doc.checkIndex(m_idx + 1);
+        const auto end = doc.offsetAt(m_idx + 1);
+        return doc.m_json.substr(m_pos + 1, end - m_pos - 1);
+      }
+      else
+      {
+        doc.checkIndex(m_idx);
+        auto end = doc.offsetAt(m_idx);
+        while (end > m_pos && (doc.m_json[end - 1] == ' ' || doc.m_json[end - 1] == '\n' || doc.m_json[end - 1] == '\r' || doc.m_json[end - 1] == '\t'))
+        {
+          --end;
+        }
+        return doc.m_json.substr(m_pos, end - m_pos);
+      }
+    }
+
+
+    inline std::string_view Value::raw() const
+    {
+      const auto& doc = *m_doc;
+
+      switch (doc.m_json[m_pos])
+      {
+      case '{':
+      case '[':
+      {
+        const auto end = doc.skipValue(m_pos, m_idx);
+        return doc.m_json.substr(m_pos, doc.offsetAt(end - 1) + 1 - m_pos);
+      }
+
+      case '"':
+        doc.checkIndex(m_idx + 1);
+        return doc.m_json.substr(m_pos, doc.offsetAt(m_idx + 1) + 1 - m_pos);
+
+      default:
+        return getString();
+      }
+    }
+
+
+    inline int64_t Value::getInt64() const
+    {
+      auto str = getString();
+
+      int64_t value = 0;
+      bool negative = false;
+      size_t i = 0;
+
+      if (!str.empty() && str[0] == '-')
+      {
+        negative = true;
+        ++i;
+      }
+
+      for (; i < str.size() && str[i] >= '0' && str[i] <= '9'; ++i)
+      {
+        value = value * 10 + (str[i] - '0');
+      }
+
+      return negative ? -value : value;
+    }
+
+
+    template<class F>
+    void Value::forEachField(F f) const
+    {
+      const auto& doc = *m_doc;
+
+      if (doc.m_json[m_pos] != '{')
+      {
+        throw BfcppException("fastjson: not an object");
+      }
+
+      auto i = m_idx + 1;
+      doc.checkIndex(i);
+
+      if (doc.charAt(i) == '}')
+        return;
+
+      while (true)
+      {
+        // "key" : value
+        doc.checkIndex(i + 2);
+
+        const auto keyStart = doc.offsetAt(i) + 1;
+        const auto key = doc.m_json.substr(keyStart, doc.offsetAt(i + 1) - keyStart);
+        const auto valuePos = doc.skipWhitespace(doc.offsetAt(i + 2) + 1);
+
+        Value value{ doc, valuePos, i + 3 };
+        f(key, value);
+
+        i = doc.skipValue(valuePos, i + 3);
+        doc.checkIndex(i);
+
+        if (doc.charAt(i) == '}')
+          return;
+
+        ++i; // ','
+      }
+    }
+
+
+    template<class F>
+    void Value::forEachElement(F f) const
+    {
+      const auto& doc = *m_doc;
+
+      if (doc.m_json[m_pos] != '[')
+      {
+        throw BfcppException("fastjson: not an array");
+      }
+
+      auto valuePos = doc.skipWhitespace(m_pos + 1);
+      auto i = m_idx + 1;
+
+      if (valuePos < doc.m_json.size() && doc.m_json[valuePos] == ']')
+        return;
+
+      while (true)
+      {
+        Value value{ doc, valuePos, i };
+        f(value);
+
+        i = doc.skipValue(valuePos, i);
+        doc.checkIndex(i);
+
+        if (doc.charAt(i) == ']')
+          return;
+
+        valuePos = doc.skipWhitespace(doc.offsetAt(i) + 1);
+        ++i; // ','
+      }
+    }
+
+
+    inline bool Value::find(std::string_view key, Value& value) const
+    {
+      bool found = false;
+
+      forEachField([&](std::string_view k, const Value& v)
+      {
+        if (!found && k == key)
+        {
+          value = v;
+          found = true;
+        }
+      });
+
+      return found;
+    }
+
+
+    /// <summary>
+    /// Indexes the frame then calls f(Value root). Returns false if the frame could not be indexed or read, in which case
+    /// the caller should fall back to cpprest.
+    /// </summary>
+    template<class F>
+    bool tryRead(Document& doc, std::string_view frame, F f)
+    {
+      try
+      {
+        if (!doc.parse(frame))
+          return false;
+
+        f(doc.root());
+        return true;
+      }
+      catch (const BfcppException&)
+      {
+        return false;
+      }
+    }
+
+
+    /// <summary>
+    /// As bfcpp::getJsonValues(), for a fastjson object.
+    /// </summary>
+    inline void getJsonValues(const Value& obj, map<string, string>& values, std::initializer_list<std::string_view> keys)
+    {
+      obj.forEachField([&values, &keys](std::string_view key, const Value& value)
+      {
+        if (std::find(keys.begin(), keys.end(), key) != keys.end())
+        {
+          values.emplace(string{ key }, string{ value.getString() });
+        }
+      });
+    }
+  }
+}
+
+#endif
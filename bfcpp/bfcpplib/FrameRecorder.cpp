@@ -0,0 +1,348 @@
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include "FrameRecorder.hpp"
+
+
+namespace bfcpp
+{
+  namespace
+  {
+    const char FileMagic[4] = { 'B', 'F', 'W', 'R' };
+    const uint32_t FileVersion = 1;
+
+
+    // the clocks when the file was opened, to convert the records' steady clock times to system time
+    struct FileHeader
+    {
+      char magic[4];
+      uint32_t version;
+      int64_t systemTime;   // nanoseconds since epoch
+      int64_t steadyTime;   // nanoseconds
+    };
+
+
+    template<class Clock>
+    int64_t nanoseconds(const typename Clock::time_point time)
+    {
+      return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+    }
+  }
+
+
+  FrameRecorder::FrameRecorder(const Options& options) : m_options(options), m_bufferCapacity(std::max<size_t>(options.maxBufferedBytes / 2, 1)), m_active(0), m_stop(false),
+    m_fileSize(0), m_fileSequence(0), m_recorded(0), m_dropped(0), m_failed(false)
+  {
+    for (auto& buffer : m_buffers)
+    {
+      buffer.data = std::make_unique<char[]>(m_bufferCapacity);
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(m_options.directory, ec);
+
+    if (ec)
+    {
+      throw BfcppException{ BFCPP_FUNCTION_MSG(" failed to create " + m_options.directory + ": " + ec.message()) };
+    }
+
+    open();
+
+    if (m_failed)
+    {
+      throw BfcppException{ BFCPP_FUNCTION_MSG(" failed to create " + currentFile()) };
+    }
+
+    m_writerThread = std::thread{ &FrameRecorder::writer, this };
+  }
+
+
+  FrameRecorder::~FrameRecorder()
+  {
+    stop();
+  }
+
+
+  void FrameRecorder::record(std::string_view uri, std::string_view frame, const Clock::time_point received)
+  {
+    const auto uriLength = static_cast<uint16_t>(std::min<size_t>(uri.size(), std::numeric_limits<uint16_t>::max()));
+    const auto frameLength = static_cast<uint32_t>(frame.size());
+    const auto time = nanoseconds<Clock>(received);
+    const uint64_t size = RecordHeaderSize + uriLength + frameLength;
+
+    if (m_stop.load(std::memory_order_relaxed) || m_failed || size > m_bufferCapacity)
+    {
+      m_dropped.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+
+    // the users count and the checks which follow are seq_cst, paired with the writer's switch and its wait for users to reach zero:
+    // either the writer waits for this record or this sees the switch (or the stop) and doesn't use the buffer
+    const auto index = m_active.load();
+    auto& buffer = m_buffers[index];
+
+    buffer.users.fetch_add(1);
+
+    if (m_stop.load())
+    {
+      buffer.users.fetch_sub(1, std::memory_order_release);
+      m_dropped.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+
+    if (m_active.load() != index)
+    {
+      // the writer switched buffers after this one was selected, use the new one
+      buffer.users.fetch_sub(1, std::memory_order_release);
+      record(uri, frame, received);
+      return;
+    }
+
+    const auto offset = buffer.reserved.fetch_add(size, std::memory_order_relaxed);
+
+    if (offset + size > m_bufferCapacity)
+    {
+      // the writer is behind. The space is reserved but not written, the writer stops at the first overflow
+      for (auto first = buffer.overflow.load(std::memory_order_relaxed); offset < first && !buffer.overflow.compare_exchange_weak(first, offset, std::memory_order_relaxed); )
+      {
+      }
+
+      buffer.users.fetch_sub(1, std::memory_order_release);
+      m_dropped.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+
+    auto out = buffer.data.get() + offset;
+    std::memcpy(out, &frameLength, sizeof(frameLength));
+    std::memcpy(out + sizeof(frameLength), &uriLength, sizeof(uriLength));
+    std::memcpy(out + sizeof(frameLength) + sizeof(uriLength), &time, sizeof(time));
+    std::copy_n(uri.data(), uriLength, out + RecordHeaderSize);
+    std::copy_n(frame.data(), frameLength, out + RecordHeaderSize + uriLength);
+
+    buffer.users.fetch_sub(1, std::memory_order_release);
+    m_recorded.fetch_add(1, std::memory_order_relaxed);
+  }
+
+
+  void FrameRecorder::stop()
+  {
+    {
+      std::scoped_lock lock(m_mux);
+      m_stop = true;
+    }
+
+    m_cv.notify_one();
+
+    if (m_writerThread.joinable())
+    {
+      m_writerThread.join();
+    }
+  }
+
+
+  string FrameRecorder::currentFile() const
+  {
+    std::scoped_lock lock(m_fileNameMux);
+    return m_fileName;
+  }
+
+
+  void FrameRecorder::writer()
+  {
+    for (bool stopping = false; !stopping; )
+    {
+      {
+        std::unique_lock lock(m_mux);
+        m_cv.wait_for(lock, m_options.flushInterval, [this] { return m_stop.load(); });
+        stopping = m_stop;
+      }
+
+      rotateIfDue(0);
+
+      // switch the receive threads to the other buffer then write this one
+      const auto previous = m_active.load(std::memory_order_relaxed);
+      m_active.store(previous ^ 1);
+
+      drain(m_buffers[previous]);
+
+      if (stopping)
+      {
+        // records made to the other buffer since the switch, m_stop keeps later records out of both
+        drain(m_buffers[previous ^ 1]);
+      }
+    }
+
+    m_file.close();
+  }
+
+
+  void FrameRecorder::drain(Buffer& buffer)
+  {
+    // records begun before the switch are being copied, later ones see the switch and use the other buffer
+    while (buffer.users.load() != 0)
+    {
+      std::this_thread::yield();
+    }
+
+    const auto end = buffer.reserved.load(std::memory_order_relaxed);
+
+    if (const auto size = std::min<uint64_t>({ end, buffer.overflow.load(std::memory_order_relaxed), m_bufferCapacity }); size)
+    {
+      write(buffer.data.get(), static_cast<size_t>(size));
+    }
+
+    // not used again until the writer switches back to it, which publishes these
+    buffer.overflow.store(NoOverflow, std::memory_order_relaxed);
+    buffer.reserved.store(0, std::memory_order_relaxed);
+  }
+
+
+  void FrameRecorder::write(const char* records, const size_t size)
+  {
+    // written in runs which fit in the current file, rotating between runs
+    size_t runStart = 0, runSize = 0;
+
+    auto flushRun = [&]
+    {
+      if (runSize && !m_failed)
+      {
+        m_failed = !m_file.write(records + runStart, runSize);
+        m_fileSize += runSize;
+      }
+
+      runStart += runSize;
+      runSize = 0;
+    };
+
+    for (size_t offset = 0; offset < size; )
+    {
+      uint32_t frameLength;
+      uint16_t uriLength;
+      std::memcpy(&frameLength, records + offset, sizeof(frameLength));
+      std::memcpy(&uriLength, records + offset + sizeof(frameLength), sizeof(uriLength));
+
+      const size_t recordSize = RecordHeaderSize + uriLength + frameLength;
+
+      if (m_fileSize + runSize + recordSize > m_options.maxFileSize)
+      {
+        flushRun();
+        rotateIfDue(recordSize);
+      }
+
+      if (m_failed)
+      {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        runStart += recordSize;
+      }
+      else
+      {
+        runSize += recordSize;
+      }
+
+      offset += recordSize;
+    }
+
+    flushRun();
+
+    if (!m_failed && !m_file.flush())
+    {
+      m_failed = true;
+    }
+  }
+
+
+  // starts a new file if the record won't fit in the current one or the file is older than the rotate interval. An empty file
+  // isn't replaced, so a record larger than maxFileSize is written to its own file
+  void FrameRecorder::rotateIfDue(const size_t nextRecordSize)
+  {
+    const bool hasRecords = m_fileSize > sizeof(FileHeader);
+    const bool full = m_fileSize + nextRecordSize > m_options.maxFileSize;
+    const bool old = Clock::now() - m_fileOpened >= m_options.rotateInterval;
+
+    if (hasRecords && (full || old) && !m_failed)
+    {
+      m_file.close();
+      open();
+    }
+  }
+
+
+  void FrameRecorder::open()
+  {
+    const auto system = std::chrono::system_clock::now();
+    const auto steady = Clock::now();
+
+    const auto name = m_options.prefix + "-" + std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>(system.time_since_epoch()).count()) +
+                      "-" + std::to_string(m_fileSequence++) + ".bfr";
+
+    const auto path = (std::filesystem::path{ m_options.directory } / name).string();
+
+    {
+      std::scoped_lock lock(m_fileNameMux);
+      m_fileName = path;
+    }
+
+    FileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, FileMagic, sizeof(FileMagic));
+    header.version = FileVersion;
+    header.systemTime = nanoseconds<std::chrono::system_clock>(system);
+    header.steadyTime = nanoseconds<Clock>(steady);
+
+    m_file = std::ofstream{ path, std::ios::binary | std::ios::trunc };
+    m_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    m_fileSize = sizeof(header);
+    m_fileOpened = steady;
+
+    if (!m_file.flush())
+    {
+      m_failed = true;
+    }
+  }
+
+
+  bool FrameRecorder::read(const string& path, std::function<void(const RecordedFrame&)> onFrame)
+  {
+    std::ifstream in{ path, std::ios::binary };
+
+    FileHeader header;
+
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)) || std::memcmp(header.magic, FileMagic, sizeof(FileMagic)) != 0 || header.version != FileVersion)
+    {
+      return false;
+    }
+
+    char recordHeader[RecordHeaderSize];
+    string data;
+
+    while (in.read(recordHeader, RecordHeaderSize))
+    {
+      uint32_t frameLength;
+      uint16_t uriLength;
+      int64_t time;
+      std::memcpy(&frameLength, recordHeader, sizeof(frameLength));
+      std::memcpy(&uriLength, recordHeader + sizeof(frameLength), sizeof(uriLength));
+      std::memcpy(&time, recordHeader + sizeof(frameLength) + sizeof(uriLength), sizeof(time));
+
+      data.resize(size_t{ uriLength } + frameLength);
+
+      if (!in.read(data.data(), data.size()))
+      {
+        return false;
+      }
+
+      RecordedFrame frame;
+      frame.received = std::chrono::nanoseconds{ time };
+      frame.systemTime = std::chrono::nanoseconds{ header.systemTime + (time - header.steadyTime) };
+      frame.uri = std::string_view{ data.data(), uriLength };
+      frame.frame = std::string_view{ data.data() + uriLength, frameLength };
+
+      onFrame(frame);
+    }
+
+    // a partial record header means the file was truncated
+    return in.gcount() == 0;
+  }
+}
@@ -0,0 +1,151 @@
+#ifndef __BINANCE_FRAMERECORDER_HPP
+#define __BINANCE_FRAMERECORDER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include "bfcppCommon.hpp"
+
+
+namespace bfcpp
+{
+  /// <summary>
+  /// A frame read from a recording, see FrameRecorder::read(). The views are valid only during the callback.
+  /// </summary>
+  struct RecordedFrame
+  {
+    std::chrono::nanoseconds received;    // steady clock, only comparable with other frames from the same process
+    std::chrono::nanoseconds systemTime;  // 'received' as system clock time since epoch, from the file's start times
+    std::string_view uri;
+    std::string_view frame;
+  };
+
+
+  /// <summary>
+  /// Records WebSocket frames as they're received, before they're parsed, so a session's streams can be replayed to reproduce
+  /// parser bugs or latency problems. See UsdFuturesMarket::startFrameRecording().
+  ///
+  /// record() copies the frame into one of two preallocated buffers, reserving its space with an atomic add, so the receive threads
+  /// don't lock, allocate or wait on the disk. Every Options::flushInterval a writer thread switches the receive threads to the other
+  /// buffer and writes the full one. If a buffer fills before the writer switches, frames are dropped and counted.
+  /// Each thread's frames are written in the order it recorded them.
+  ///
+  /// Files are named "<prefix>-<system clock milliseconds>-<sequence>.bfr". A file has a header then the records, each:
+  ///   uint32 frame length, uint16 uri length, int64 receive time (steady clock nanoseconds), the uri, the frame
+  /// in the host's byte order. A new file is started when the current one reaches Options::maxFileSize or is older than Options::rotateInterval.
+  /// </summary>
+  class FrameRecorder
+  {
+  public:
+    typedef std::chrono::steady_clock Clock;
+
+    static const size_t RecordHeaderSize = sizeof(uint32_t) + sizeof(uint16_t) + sizeof(int64_t);
+
+
+    struct Options
+    {
+      string directory{ "." };
+      string prefix{ "frames" };
+      size_t maxFileSize{ 256 * 1024 * 1024 };
+      std::chrono::seconds rotateInterval{ std::chrono::hours{ 1 } };
+      size_t maxBufferedBytes{ 64 * 1024 * 1024 };  // allocated on construction, split between the two buffers
+      std::chrono::milliseconds flushInterval{ 100 };
+    };
+
+
+    /// <summary>
+    /// Creates the directory if required and opens the first file. Throws BfcppException if either fails.
+    /// </summary>
+    explicit FrameRecorder(const Options& options);
+
+    ~FrameRecorder();
+
+    FrameRecorder(const FrameRecorder&) = delete;
+    FrameRecorder& operator=(const FrameRecorder&) = delete;
+
+
+    /// <summary>
+    /// Queues the frame to be written. Doesn't lock or allocate, called from the receive threads.
+    /// </summary>
+    void record(std::string_view uri, std::string_view frame, const Clock::time_point received);
+
+    /// <summary>
+    /// Writes the queued frames and closes the file. Frames recorded afterwards are dropped.
+    /// </summary>
+    void stop();
+
+
+    uint64_t recorded() const { return m_recorded.load(std::memory_order_relaxed); }
+    uint64_t dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+    /// <summary>
+    /// True if a file couldn't be written, after which frames are dropped.
+    /// </summary>
+    bool failed() const { return m_failed; }
+
+    string currentFile() const;
+
+
+    /// <summary>
+    /// Calls 'onFrame' with each record in the file, in the order received. Returns false if the file isn't a recording
+    /// or is truncated (i.e. still being written), the records before the truncation are passed.
+    /// </summary>
+    static bool read(const string& path, std::function<void(const RecordedFrame&)> onFrame);
+
+
+  private:
+    static constexpr uint64_t NoOverflow = std::numeric_limits<uint64_t>::max();
+
+    // receive threads add to 'users', check the buffer is still active, then reserve space by adding to 'reserved' and copy the record.
+    // The writer switches the active buffer then waits for 'users' to reach zero before writing, so no record is copied into a buffer
+    // after it's switched out, which would write it after the same thread's later records
+    struct Buffer
+    {
+      std::unique_ptr<char[]> data;
+      std::atomic<uint64_t> reserved{ 0 };
+      std::atomic<uint32_t> users{ 0 };
+      std::atomic<uint64_t> overflow{ NoOverflow };  // offset of the first record which didn't fit
+    };
+
+
+    void writer();
+    void drain(Buffer& buffer);
+    void write(const char* records, const size_t size);
+    void open();
+    void rotateIfDue(const size_t nextRecordSize);
+
+
+    Options m_options;
+
+    Buffer m_buffers[2];
+    size_t m_bufferCapacity;
+    std::atomic<unsigned> m_active;  // the buffer receive threads record to
+
+    std::mutex m_mux;
+    std::condition_variable m_cv;
+    std::atomic_bool m_stop;
+
+    // only used by the writer thread, and the constructor
+    std::ofstream m_file;
+    size_t m_fileSize;
+    Clock::time_point m_fileOpened;
+    uint64_t m_fileSequence;
+
+    mutable std::mutex m_fileNameMux;
+    string m_fileName;
+
+    std::atomic<uint64_t> m_recorded;
+    std::atomic<uint64_t> m_dropped;
+    std::atomic_bool m_failed;
+    std::thread m_writerThread;
+  };
+}
+
+#endif
@@ -1,3 +1,4 @@
+#include <random>
 #include "Futures.hpp"
 
 
@@ -12,32 +13,7 @@ namespace bfcpp
       throw BfcppException{ BFCPP_FUNCTION_MSG(" callback function null") };
     }
 
-    auto handler = [](ws::client::websocket_incoming_message websocketInMessage, shared_ptr<WebSocketSession> session)
-    {
-      auto json = web::json::value::parse(websocketInMessage.extract_string().get());
-
-      AllMarketMiniTickerStream mtt;
-
-      auto& data = json.as_array();
-      for (auto& entry : data)
-      {
-        map<string, string> values;
-        getJsonValues(entry, values, { "e", "E", "s", "c", "o", "h", "l", "v", "q" });
-
-        mtt.data.emplace_back(std::move(values));
-      }
-
-      session->callback(std::any{ std::move(mtt) });
-    };
-
-    auto tokenAndSession = createMonitor(m_exchangeBaseUri + "/ws/!miniTicker@arr", handler);
-
-    if (std::get<0>(tokenAndSession).isValid())
-    {
-      std::get<1>(tokenAndSession)->callback = onData;
-    }
-
-    return std::get<0>(tokenAndSession);
+    return createCallbackMonitor<AllMarketMiniTickerStream>("!miniTicker@arr", anyCallback<AllMarketMiniTickerStream>(onData));
   }
 
 
@@ -49,30 +25,7 @@ namespace bfcpp
       throw BfcppException{ BFCPP_FUNCTION_MSG(" callback function null")};
     }
 
-
-    auto handler = [](ws::client::websocket_incoming_message websocketInMessage, shared_ptr<WebSocketSession> session)
-    {
-      auto json = web::json::value::parse(websocketInMessage.extract_string().get());
-
-      CandleStream cs;
-
-      cs.eventTime = jsonValueToString(json[utility::conversions::to_string_t("E")]);
-      cs.symbol = jsonValueToString(json[utility::conversions::to_string_t("s")]);
-
-      auto& candleData = json[utility::conversions::to_string_t("k")].as_object();
-      getJsonValues(candleData, cs.candle, { "t", "T", "s", "i", "f", "L", "o", "c", "h", "l", "v", "n", "x", "q", "V", "Q", "B" });
-
-      session->callback( std::any{ std::move(cs) });
-    };
-        
-    auto tokenAndSession = createMonitor(m_exchangeBaseUri + "/ws/" + strToLower(symbol) + "@kline_" + interval, handler);
-
-    if (std::get<0>(tokenAndSession).isValid())
-    {
-      std::get<1>(tokenAndSession)->callback = onData;
-    }
-
-    return std::get<0>(tokenAndSession);
+    return createCallbackMonitor<CandleStream>(strToLower(symbol) + "@kline_" + interval, anyCallback<CandleStream>(onData));
   }
 
 
@@ -84,26 +37,7 @@ namespace bfcpp
       throw BfcppException{ BFCPP_FUNCTION_MSG(" callback function null") };
     }
 
-    auto handler = [](ws::client::websocket_incoming_message websocketInMessage, shared_ptr<WebSocketSession> session)
-    {
-      auto json = web::json::value::parse(websocketInMessage.extract_string().get());
-
-      SymbolMiniTickerStream symbol;
-     
-      getJsonValues(json, symbol.data, { "e", "E", "s", "c", "o", "h", "l", "v", "q" });
-
-      session->callback(std::any{ std::move(symbol) });
-    };
-
-
-    auto tokenAndSession = createMonitor(m_exchangeBaseUri + "/ws/" + strToLower(symbol) + "@miniTicker", handler);
-
-    if (std::get<0>(tokenAndSession).isValid())
-    {
-      std::get<1>(tokenAndSession)->callback = onData;
-    }
-
-    return std::get<0>(tokenAndSession);
+    return createCallbackMonitor<SymbolMiniTickerStream>(strToLower(symbol) + "@miniTicker", anyCallback<SymbolMiniTickerStream>(onData));
   }
   
 
@@ -115,93 +49,70 @@ namespace bfcpp
       throw BfcppException{ BFCPP_FUNCTION_MSG("callback function null") };
     }
 
-    auto handler = [](ws::client::websocket_incoming_message websocketInMessage, shared_ptr<WebSocketSession> session)
-    {
-      auto json = web::json::value::parse(websocketInMessage.extract_string().get());
-
-      SymbolBookTickerStream symbol;
-
-      getJsonValues(json, symbol.data, { "e", "u","E","T","s","b","B", "a", "A" });
+    return createCallbackMonitor<SymbolBookTickerStream>(strToLower(symbol) + "@bookTicker", anyCallback<SymbolBookTickerStream>(onData));
+  }
 
-      session->callback(std::any{ std::move(symbol) });
-    };
-    
 
-    auto tokenAndSession = createMonitor(m_exchangeBaseUri + "/ws/" + strToLower(symbol) + "@bookTicker", handler);
 
-    if (std::get<0>(tokenAndSession).isValid())
+  MonitorToken UsdFuturesMarket::monitorMarkPrice(std::function<void(std::any)> onData, const string& symbol)
+  {
+    if (onData == nullptr)
     {
-      std::get<1>(tokenAndSession)->callback = onData;
+      throw BfcppException{ BFCPP_FUNCTION_MSG(" callback function null") };
     }
 
-    return std::get<0>(tokenAndSession);
+    return createCallbackMonitor<MarkPriceStream>(symbol.empty() ? "!markPrice@arr@1s" : strToLower(symbol) + "@markPrice@1s", anyCallback<MarkPriceStream>(onData));
   }
 
 
 
-  MonitorToken UsdFuturesMarket::monitorMarkPrice(std::function<void(std::any)> onData, const string& symbol)
+  MonitorToken UsdFuturesMarket::monitorUserData(std::function<void(std::any)> onData)
   {
     if (onData == nullptr)
     {
-      throw BfcppException{ BFCPP_FUNCTION_MSG(" callback function null") };
+      throw BfcppException{ BFCPP_FUNCTION_MSG("callback function null")};
     }
 
-
-    auto handler = [](ws::client::websocket_incoming_message websocketInMessage, shared_ptr<WebSocketSession> session)
+    return doMonitorUserData([this, onData](std::string_view frame, shared_ptr<WebSocketSession> session)
     {
-      auto json = web::json::value::parse(websocketInMessage.extract_string().get());
-
-      MarkPriceStream mp;
-      
-      if (json.is_array())
+      if (auto userData = handleUserData(frame); userData)
       {
-        auto& prices = json.as_array();
-        for (auto& price : prices)
-        {
-          map<string, string> values;
-          getJsonValues(price, values, { "e", "E","s","p","i","P","r","T" });
-
-          mp.prices.emplace_back(std::move(values));
-        }
+        onData(std::any{ std::move(*userData) });
       }
-      else
-      {
-        // called with the symbol set, so not an array
-        map<string, string> values;
-        getJsonValues(json, values, { "e", "E","s","p","i","P","r","T" });
+    });
+  }
 
-        mp.prices.emplace_back(std::move(values));
-      }
-      
-      session->callback(std::any{ std::move(mp) });
-    };
 
-    string uri = "/ws/!markPrice@arr@1s";
 
-    if (!symbol.empty())
-      uri = "/ws/"+ strToLower(symbol)+"@markPrice@1s";
+  // shared by the std::any and typed monitorUserData(): reads the frame and updates the latency tracer and state caches before the caller's callback
+  std::optional<UsdFutureUserData> UsdFuturesMarket::handleUserData(std::string_view frame)
+  {
+    const auto received = m_orderLatencyTracing ? OrderLatencyTracer::Clock::now() : OrderLatencyTracer::Clock::time_point{};
 
-    auto tokenAndSession = createMonitor(m_exchangeBaseUri + uri, handler);
+    auto userData = readUserData(parseJson(frame));
 
-    if (std::get<0>(tokenAndSession).isValid())
+    if (userData.type == UsdFutureUserData::EventType::Unknown)
     {
-      std::get<1>(tokenAndSession)->callback = onData;
+      return std::nullopt;
     }
 
-    return std::get<0>(tokenAndSession);
+    StreamLatency::parsed();
+
+    if (m_orderLatencyTracing)
+      m_orderLatency.onUserData(userData, received);
+
+    m_orderStates.onUserData(userData);
+    m_accountState.onUserData(userData);
+
+    return userData;
   }
 
 
 
-  MonitorToken UsdFuturesMarket::monitorUserData(std::function<void(std::any)> onData)
+  MonitorToken UsdFuturesMarket::doMonitorUserData(StreamHandler handler)
   {
     using namespace std::chrono_literals;
 
-    if (onData == nullptr)
-    {
-      throw BfcppException{ BFCPP_FUNCTION_MSG("callback function null")};
-    }
-
     MonitorToken monitorToken;
 
     if (createListenKey(m_marketType))
@@ -210,31 +121,44 @@ namespace bfcpp
       {
         try
         {
-          monitorToken.id = m_monitorId++;
+          // the stream is quiet when there's no account activity, and the listen key is replaced when reconnecting
+          session->checkStale = false;
+          session->reconnectUri = [this]
+          {
+            return requestListenKey(m_marketType).then([this](const ListenKey& listenKey)
+            {
+              if (!listenKey.valid() || listenKey.listenKey.empty())
+              {
+                throw BfcppException("failed to create listen key");
+              }
+
+              return m_exchangeBaseUri + "/ws/" + listenKey.listenKey;
+            });
+          };
+
+          // when the listen key expires the exchange sends listenKeyExpired then stops sending. Closing the connection has the receive
+          // task reconnect, with a new listen key from reconnectUri, and report the gap
+          auto expiring = [handler](std::string_view frame, shared_ptr<WebSocketSession> session)
+          {
+            if (frame.find(R"("e":"listenKeyExpired")") != std::string_view::npos)
+            {
+              std::scoped_lock lock(session->clientMux);
+              session->client.close(ws::client::websocket_close_status::going_away);
+              return;
+            }
+
+            handler(frame, session);
+          };
+
+          shared_ptr<StreamLatency> latency;
+          monitorToken = createReceiveTask(session, trackStreamLatency("userData", expiring, latency));
+          addStreamLatency(monitorToken, latency);
 
           session->id = monitorToken.id;
-          session->callback = onData;
 
           m_idToSession[monitorToken.id] = session;
           m_sessions.push_back(session);
 
-          auto token = session->getCancelToken();
-          session->receiveTask = pplx::create_task([session, token, onData, this]
-          {
-            try
-            {
-              handleUserDataStream(session, onData);
-            }
-            catch (BfcppDisconnectException)
-            {
-              throw;
-            }
-            catch (std::exception ex)
-            {
-              pplx::cancel_current_task();
-            }            
-          }, token);
-
 
           auto timerFunc = std::bind(&UsdFuturesMarket::onUserDataTimer, this);
 
@@ -248,11 +172,11 @@ namespace bfcpp
             m_userDataStreamTimer.start(timerFunc, 60s * 45); // 45 mins
           }
         }
-        catch (BfcppDisconnectException)
+        catch (const BfcppException&)
         {
           throw;
         }
-        catch (std::exception ex)
+        catch (const std::exception& ex)
         {
           throw BfcppException(ex.what());
         }
@@ -271,7 +195,7 @@ namespace bfcpp
       throw BfcppException{ BFCPP_FUNCTION_MSG(" callback function null") };
     }
 
-    return doMonitorBookDepth(symbol, level, interval, onData);
+    return createCallbackMonitor<BookDepthStream>(strToLower(symbol) + "@depth" + level + "@" + interval, anyCallback<BookDepthStream>(onData));
   }
 
 
@@ -283,16 +207,100 @@ namespace bfcpp
       throw BfcppException{ BFCPP_FUNCTION_MSG(" callback function null") };
     }
 
-    return doMonitorBookDepth(symbol, "", interval, onData);
+    return createCallbackMonitor<BookDepthStream>(strToLower(symbol) + "@depth@" + interval, anyCallback<BookDepthStream>(onData));
+  }
+
+
+
+  MonitorToken UsdFuturesMarket::monitorLocalOrderBook(shared_ptr<LocalOrderBook> book, const string& interval, std::function<void(std::any)> onData)
+  {
+    return doMonitorLocalOrderBook(book, interval, [onData](LocalOrderBookStream& update)
+    {
+      if (onData)
+      {
+        onData(std::any{ std::move(update) });
+      }
+    });
+  }
+
+
+
+  MonitorToken UsdFuturesMarket::createLocalOrderBookMonitor(shared_ptr<LocalOrderBook> book, const string& interval, StreamHandler handler)
+  {
+    auto tokenAndSession = createMonitor(strToLower(book->symbol()) + "@depth@" + interval, handler);
+
+    if (std::get<0>(tokenAndSession).isValid())
+    {
+      auto& session = std::get<1>(tokenAndSession);
+
+      // diffs missed whilst disconnected can't be recovered, the book resyncs from a new snapshot when the stream resumes
+      session->onGap = [book, onGap = session->onGap](const StreamGap& gap)
+      {
+        if (gap.state == StreamGap::State::Disconnected)
+        {
+          book->reset();
+        }
+
+        if (onGap)
+        {
+          onGap(gap);
+        }
+      };
+    }
+
+    return std::get<0>(tokenAndSession);
   }
 
 
 
-  MonitorToken UsdFuturesMarket::doMonitorBookDepth(const string& symbol, const string& level, const string& interval, std::function<void(std::any)> onData)
+  bool UsdFuturesMarket::updateLocalOrderBook(shared_ptr<LocalOrderBook> book, BookDepthDiff& diff, fastjson::Document& doc, shared_ptr<std::atomic_bool> snapshotPending, std::string_view frame, LocalOrderBookStream& update)
   {
-    auto handler = [](ws::client::websocket_incoming_message websocketInMessage, shared_ptr<WebSocketSession> session)
+    // levels go straight from the frame into the book's ladder rather than a BookDepthStream. The diff and document are reused to avoid allocating per update.
+    auto readLevels = [&book](const fastjson::Value& levels, vector<pair<int64_t, int64_t>>& out)
+    {
+      levels.forEachElement([&book, &out](const fastjson::Value& level)
+      {
+        auto& entry = out.emplace_back(0, 0);
+        size_t i = 0;
+
+        level.forEachElement([&book, &entry, &i](const fastjson::Value& value)
+        {
+          if (i == 0)
+            entry.first = book->toTick(value.getString());
+          else if (i == 1)
+            entry.second = book->toQuantity(value.getString());
+
+          ++i;
+        });
+      });
+    };
+
+    auto readFast = [&](const fastjson::Value& root)
+    {
+      root.forEachField([&](std::string_view key, const fastjson::Value& value)
+      {
+        if (key == "U")
+          diff.firstUpdateId = static_cast<uint64_t>(value.getInt64());
+        else if (key == "u")
+          diff.finalUpdateId = static_cast<uint64_t>(value.getInt64());
+        else if (key == "pu")
+          diff.previousFinalUpdateId = static_cast<uint64_t>(value.getInt64());
+        else if (key == "E")
+          update.eventTime = value.getInt64();
+        else if (key == "T")
+          update.transactionTime = value.getInt64();
+        else if (key == "b")
+          readLevels(value, diff.bids);
+        else if (key == "a")
+          readLevels(value, diff.asks);
+      });
+    };
+
+    diff.clear();
+
+    if (!fastjson::tryRead(doc, frame, readFast))
     {
-      static const utility::string_t SymbolField = utility::conversions::to_string_t("s");
+      // the frame couldn't be indexed, read it with cpprest
       static const utility::string_t EventTimeField = utility::conversions::to_string_t("E");
       static const utility::string_t TransactionTimeField = utility::conversions::to_string_t("T");
       static const utility::string_t FirstUpdateIdField = utility::conversions::to_string_t("U");
@@ -301,484 +309,1673 @@ namespace bfcpp
       static const utility::string_t BidsField = utility::conversions::to_string_t("b");
       static const utility::string_t AsksField = utility::conversions::to_string_t("a");
 
+      auto json = parseJson(frame);
 
-      BookDepthStream result;
+      diff.clear();
 
-      auto json = web::json::value::parse(websocketInMessage.extract_string().get());
+      diff.firstUpdateId = json[FirstUpdateIdField].as_number().to_uint64();
+      diff.finalUpdateId = json[FinalUpdateIdField].as_number().to_uint64();
+      diff.previousFinalUpdateId = json[PreviousFinalUpdateIdField].as_number().to_uint64();
 
-      result.symbol = jsonValueToString(json[utility::conversions::to_string_t(SymbolField)]);
-      result.eventTime = jsonValueToString(json[utility::conversions::to_string_t(EventTimeField)]);
-      result.transactionTime = jsonValueToString(json[utility::conversions::to_string_t(TransactionTimeField)]);
-      result.firstUpdateId = jsonValueToString(json[utility::conversions::to_string_t(FirstUpdateIdField)]);
-      result.finalUpdateId = jsonValueToString(json[utility::conversions::to_string_t(FinalUpdateIdField)]);
-      result.previousFinalUpdateId = jsonValueToString(json[utility::conversions::to_string_t(PreviousFinalUpdateIdField)]);
-
-      // bids
-      auto& bidsArray = json[BidsField].as_array();
-
-      for (auto& bid : bidsArray)
+      for (auto& bid : json[BidsField].as_array())
       {
         auto& bidValue = bid.as_array();
-        result.bids.emplace_back(std::make_pair(jsonValueToString(bidValue[0]), jsonValueToString(bidValue[1])));
+        diff.bids.emplace_back(book->toTick(utility::conversions::to_utf8string(bidValue.at(0).as_string())), book->toQuantity(utility::conversions::to_utf8string(bidValue.at(1).as_string())));
       }
 
-      // asks 
-      auto& asksArray = json[AsksField].as_array();
-
-      for (auto& ask : asksArray)
+      for (auto& ask : json[AsksField].as_array())
       {
         auto& askValue = ask.as_array();
-        result.asks.emplace_back(std::make_pair(jsonValueToString(askValue[0]), jsonValueToString(askValue[1])));
+        diff.asks.emplace_back(book->toTick(utility::conversions::to_utf8string(askValue.at(0).as_string())), book->toQuantity(utility::conversions::to_utf8string(askValue.at(1).as_string())));
       }
 
-      session->callback(std::any{ std::move(result) });
-    };
+      update.eventTime = json[EventTimeField].as_number().to_int64();
+      update.transactionTime = json[TransactionTimeField].as_number().to_int64();
+    }
 
-    auto tokenAndSession = createMonitor(m_exchangeBaseUri + "/ws/" + strToLower(symbol) + "@depth" + level + "@" + interval, handler);
+    if (auto result = book->update(diff); result == LocalOrderBook::UpdateResult::Gap || book->needsSnapshot())
+    {
+      syncLocalOrderBook(book, snapshotPending);
+    }
 
-    if (std::get<0>(tokenAndSession).isValid())
+    if (!book->isSynced())
     {
-      std::get<1>(tokenAndSession)->callback = onData;
+      return false;
     }
 
-    return std::get<0>(tokenAndSession);
+    update.book = book;
+    return true;
   }
 
 
-  // -- REST Calls --
-
 
-  AccountInformation UsdFuturesMarket::accountInformation()
+  void UsdFuturesMarket::syncLocalOrderBook(shared_ptr<LocalOrderBook> book, shared_ptr<std::atomic_bool> snapshotPending)
   {
+    // one request at a time, the book buffers diffs until the snapshot is applied. Not waited on, so the receive task isn't blocked.
+    if (snapshotPending->exchange(true))
+    {
+      return;
+    }
+
     try
     {
-      auto handler = [](web::http::http_response response)
+      // started from a task because the request may wait on the rate limits, which would hold up the receive task
+      pplx::create_task([this, book]
       {
-        AccountInformation info;
-
-        auto json = response.extract_json().get();
-
-        const utility::string_t AssetField = utility::conversions::to_string_t("assets");
-        const utility::string_t PositionsField = utility::conversions::to_string_t("positions");
-
-
-        getJsonValues(json, info.data, vector<string> {  "feeTier", "canTrade", "canDeposit", "canWithdraw", "updateTime", "totalInitialMargin", "totalMaintMargin", "totalWalletBalance",
-                                                      "totalUnrealizedProfit", "totalMarginBalance", "totalPositionInitialMargin", "totalOpenOrderInitialMargin", "totalCrossWalletBalance",
-                                                      "totalCrossUnPnl", "availableBalance", "maxWithdrawAmount"});
-
-
-        auto& assetArray = json[AssetField].as_array();
-        for (const auto& entry : assetArray)
+        return doOrderBook({ {"symbol", book->symbol()}, {"limit", std::to_string(book->snapshotLimit())} });
+      })
+      .then([book, snapshotPending](pplx::task<OrderBook> snapshotTask)
+      {
+        try
         {
-          map<string, string> order;
-          getJsonValues(entry, order, vector<string> { "asset", "walletBalance", "unrealizedProfit", "marginBalance", "maintMargin", "initialMargin", "positionInitialMargin",
-                                                    "openOrderInitialMargin", "crossWalletBalance", "crossUnPnl", "availableBalance", "maxWithdrawAmount"});
-
-          info.assets.emplace_back(std::move(order));
+          if (auto snapshot = snapshotTask.get(); snapshot.valid())
+          {
+            book->applySnapshot(snapshot);
+          }
         }
-
-
-        auto& positionArray = json[PositionsField].as_array();
-        for (const auto& entry : positionArray)
+        catch (const std::exception&)
         {
-          map<string, string> position;
-          getJsonValues(entry, position, vector<string> {  "symbol", "initialMargin", "maintMargin", "unrealizedProfit", "positionInitialMargin", "openOrderInitialMargin",
-                                                        "leverage", "isolated", "entryPrice", "maxNotional", "positionSide", "positionAmt"});
-
-          info.positions.emplace_back(std::move(position));
+          // leave the book waiting for a snapshot, requested again on the next diff
         }
 
-        return info;
-      };
-
-      return sendRestRequest<AccountInformation>(RestCall::AccountInfo, web::http::methods::GET, true, m_marketType, handler, receiveWindow(RestCall::AccountInfo)).get();
-    }
-    catch (const pplx::task_canceled tc)
-    {
-      throw BfcppDisconnectException("accountInformation");
+        *snapshotPending = false;
+      });
     }
-    catch (const std::exception ex)
+    catch (const std::exception&)
     {
-      throw BfcppException(ex.what());
+      *snapshotPending = false;
     }
   }
 
 
+  // -- Stream readers, shared by the std::any and statically typed monitors --
 
-  AccountBalance UsdFuturesMarket::accountBalance()
+  void UsdFuturesMarket::readStream(const StreamParser parser, fastjson::Document& doc, std::string_view frame, AllMarketMiniTickerStream& mtt)
   {
-    try
+    auto readFast = [&mtt](const fastjson::Value& root)
     {
-      auto handler = [](web::http::http_response response)
+      root.forEachElement([&mtt](const fastjson::Value& entry)
       {
-        AccountBalance balance;
+        fastjson::getJsonValues(entry, mtt.data.emplace_back(), { "e", "E", "s", "c", "o", "h", "l", "v", "q" });
+      });
+    };
 
-        auto json = response.extract_json().get();
-        for (const auto& entry : json.as_array())
-        {
-          map<string, string> order;
-          getJsonValues(entry, order, { "accountAlias", "asset", "balance", "crossWalletBalance", "crossUnPnl", "availableBalance", "maxWithdrawAmount"});
+    if (parser == StreamParser::Fast && fastjson::tryRead(doc, frame, readFast))
+    {
+      return;
+    }
 
-          balance.balances.emplace_back(std::move(order));
-        }
+    mtt.data.clear();
 
-        return balance;
-      };
+    auto json = parseJson(frame);
 
-      return sendRestRequest<AccountBalance>(RestCall::AccountBalance, web::http::methods::GET, true, m_marketType, handler, receiveWindow(RestCall::AccountBalance)).get();
-    }
-    catch (const pplx::task_canceled tc)
-    {
-      throw BfcppDisconnectException("accountBalance");
-    }
-    catch (const std::exception ex)
+    for (auto& entry : json.as_array())
     {
-      throw BfcppException(ex.what());
+      map<string, string> values;
+      getJsonValues(entry, values, { "e", "E", "s", "c", "o", "h", "l", "v", "q" });
+
+      mtt.data.emplace_back(std::move(values));
     }
   }
 
 
 
-  TakerBuySellVolume UsdFuturesMarket::takerBuySellVolume(map<string, string>&& query)
+  void UsdFuturesMarket::readStream(const StreamParser, fastjson::Document&, std::string_view frame, CandleStream& cs)
   {
-    try
-    {
-      auto handler = [](web::http::http_response response)
-      {
-        TakerBuySellVolume result;
+    auto json = parseJson(frame);
 
-        auto json = response.extract_json().get();
+    cs.eventTime = jsonValueToString(json[utility::conversions::to_string_t("E")]);
+    cs.symbol = jsonValueToString(json[utility::conversions::to_string_t("s")]);
 
-        for (const auto& entry : json.as_array())
-        {
-          map<string, string> order;
-          getJsonValues(entry, order, { "buySellRatio", "buyVol", "sellVol", "timestamp"});
+    auto& candleData = json[utility::conversions::to_string_t("k")].as_object();
+    getJsonValues(candleData, cs.candle, { "t", "T", "s", "i", "f", "L", "o", "c", "h", "l", "v", "n", "x", "q", "V", "Q", "B" });
+  }
 
-          result.response.emplace_back(std::move(order));
-        }
 
-        return result;
-      };
 
-      return sendRestRequest<TakerBuySellVolume>(RestCall::TakerBuySellVolume, web::http::methods::GET, true, m_marketType, handler, receiveWindow(RestCall::TakerBuySellVolume), std::move(query)).get();
-    }
-    catch (const pplx::task_canceled tc)
-    {
-      throw BfcppDisconnectException("takerBuySellVolume");
-    }
-    catch (const std::exception ex)
-    {
-      throw BfcppException(ex.what());
-    }
+  void UsdFuturesMarket::readStream(const StreamParser, fastjson::Document&, std::string_view frame, SymbolMiniTickerStream& symbol)
+  {
+    getJsonValues(parseJson(frame), symbol.data, { "e", "E", "s", "c", "o", "h", "l", "v", "q" });
   }
 
 
 
-  KlineCandlestick UsdFuturesMarket::klines(map<string, string>&& query)
+  void UsdFuturesMarket::readStream(const StreamParser, fastjson::Document&, std::string_view frame, SymbolBookTickerStream& symbol)
   {
-    try
-    {
-      auto handler = [](web::http::http_response response)
-      {
-        KlineCandlestick result;
+    getJsonValues(parseJson(frame), symbol.data, { "e", "u","E","T","s","b","B", "a", "A" });
+  }
 
-        auto json = response.extract_json().get();
 
-        // kline does not return a key/value map, instead an array of arrays. 
+
+  void UsdFuturesMarket::readStream(const StreamParser parser, fastjson::Document& doc, std::string_view frame, MarkPriceStream& mp)
+  {
+    auto readFast = [&mp](const fastjson::Value& root)
+    {
+      auto readPrice = [&mp](const fastjson::Value& price)
+      {
+        fastjson::getJsonValues(price, mp.prices.emplace_back(), { "e", "E","s","p","i","P","r","T" });
+      };
+
+      if (root.isArray())
+        root.forEachElement(readPrice);
+      else
+        readPrice(root);
+    };
+
+    if (parser == StreamParser::Fast && fastjson::tryRead(doc, frame, readFast))
+    {
+      return;
+    }
+
+    mp.prices.clear();
+
+    auto json = parseJson(frame);
+
+    if (json.is_array())
+    {
+      auto& prices = json.as_array();
+      for (auto& price : prices)
+      {
+        map<string, string> values;
+        getJsonValues(price, values, { "e", "E","s","p","i","P","r","T" });
+
+        mp.prices.emplace_back(std::move(values));
+      }
+    }
+    else
+    {
+      // called with the symbol set, so not an array
+      map<string, string> values;
+      getJsonValues(json, values, { "e", "E","s","p","i","P","r","T" });
+
+      mp.prices.emplace_back(std::move(values));
+    }
+  }
+
+
+
+  void UsdFuturesMarket::readStream(const StreamParser, fastjson::Document&, std::string_view frame, BookDepthStream& result)
+  {
+    static const utility::string_t SymbolField = utility::conversions::to_string_t("s");
+    static const utility::string_t EventTimeField = utility::conversions::to_string_t("E");
+    static const utility::string_t TransactionTimeField = utility::conversions::to_string_t("T");
+    static const utility::string_t FirstUpdateIdField = utility::conversions::to_string_t("U");
+    static const utility::string_t FinalUpdateIdField = utility::conversions::to_string_t("u");
+    static const utility::string_t PreviousFinalUpdateIdField = utility::conversions::to_string_t("pu");
+    static const utility::string_t BidsField = utility::conversions::to_string_t("b");
+    static const utility::string_t AsksField = utility::conversions::to_string_t("a");
+
+    auto json = parseJson(frame);
+
+    result.symbol = jsonValueToString(json[SymbolField]);
+    result.eventTime = jsonValueToString(json[EventTimeField]);
+    result.transactionTime = jsonValueToString(json[TransactionTimeField]);
+    result.firstUpdateId = jsonValueToString(json[FirstUpdateIdField]);
+    result.finalUpdateId = jsonValueToString(json[FinalUpdateIdField]);
+    result.previousFinalUpdateId = jsonValueToString(json[PreviousFinalUpdateIdField]);
+
+    // bids
+    auto& bidsArray = json[BidsField].as_array();
+
+    for (auto& bid : bidsArray)
+    {
+      auto& bidValue = bid.as_array();
+      result.bids.emplace_back(std::make_pair(jsonValueToString(bidValue[0]), jsonValueToString(bidValue[1])));
+    }
+
+    // asks 
+    auto& asksArray = json[AsksField].as_array();
+
+    for (auto& ask : asksArray)
+    {
+      auto& askValue = ask.as_array();
+      result.asks.emplace_back(std::make_pair(jsonValueToString(askValue[0]), jsonValueToString(askValue[1])));
+    }
+  }
+
+
+
+  // -- Typed websocket monitors --
+
+  MonitorToken UsdFuturesMarket::monitorMarkPriceTyped(std::function<void(const vector<MarkPrice>&)> onData, const string& symbol)
+  {
+    if (onData == nullptr)
+    {
+      throw BfcppException{ BFCPP_FUNCTION_MSG(" callback function null") };
+    }
+
+    auto handler = [onData, registry = m_symbolRegistry, doc = std::make_shared<fastjson::Document>(), prices = std::make_shared<vector<MarkPrice>>()](std::string_view frame, shared_ptr<WebSocketSession> session)
+    {
+      typedjson::readFrame(*doc, frame, *prices, registry.get());
+      StreamLatency::parsed();
+
+      onData(*prices);
+    };
+
+    string stream = "!markPrice@arr@1s";
+
+    if (!symbol.empty())
+      stream = strToLower(symbol) + "@markPrice@1s";
+
+    return std::get<0>(createMonitor(stream, handler));
+  }
+
+
+
+  MonitorToken UsdFuturesMarket::monitorMiniTickerTyped(std::function<void(const vector<MiniTicker>&)> onData)
+  {
+    if (onData == nullptr)
+    {
+      throw BfcppException{ BFCPP_FUNCTION_MSG(" callback function null") };
+    }
+
+    auto handler = [onData, registry = m_symbolRegistry, doc = std::make_shared<fastjson::Document>(), tickers = std::make_shared<vector<MiniTicker>>()](std::string_view frame, shared_ptr<WebSocketSession> session)
+    {
+      typedjson::readFrame(*doc, frame, *tickers, registry.get());
+      StreamLatency::parsed();
+
+      onData(*tickers);
+    };
+
+    return std::get<0>(createMonitor("!miniTicker@arr", handler));
+  }
+
+
+
+  MonitorToken UsdFuturesMarket::monitorKlineCandlestickStreamTyped(const string& symbol, const string& interval, std::function<void(const Kline&)> onData)
+  {
+    if (onData == nullptr)
+    {
+      throw BfcppException{ BFCPP_FUNCTION_MSG(" callback function null") };
+    }
+
+    auto handler = [onData, registry = m_symbolRegistry, doc = std::make_shared<fastjson::Document>()](std::string_view frame, shared_ptr<WebSocketSession> session)
+    {
+      Kline kline{};
+      typedjson::readFrame(*doc, frame, kline, registry.get());
+      StreamLatency::parsed();
+
+      onData(kline);
+    };
+
+    return std::get<0>(createMonitor(strToLower(symbol) + "@kline_" + interval, handler));
+  }
+
+
+
+  MonitorToken UsdFuturesMarket::monitorSymbolTyped(const string& symbol, std::function<void(const MiniTicker&)> onData)
+  {
+    if (onData == nullptr)
+    {
+      throw BfcppException{ BFCPP_FUNCTION_MSG(" callback function null") };
+    }
+
+    auto handler = [onData, registry = m_symbolRegistry, doc = std::make_shared<fastjson::Document>()](std::string_view frame, shared_ptr<WebSocketSession> session)
+    {
+      MiniTicker ticker{};
+      typedjson::readFrame(*doc, frame, ticker, registry.get());
+      StreamLatency::parsed();
+
+      onData(ticker);
+    };
+
+    return std::get<0>(createMonitor(strToLower(symbol) + "@miniTicker", handler));
+  }
+
+
+
+  MonitorToken UsdFuturesMarket::monitorSymbolBookStreamTyped(const string& symbol, std::function<void(const BookTicker&)> onData)
+  {
+    if (onData == nullptr)
+    {
+      throw BfcppException{ BFCPP_FUNCTION_MSG(" callback function null") };
+    }
+
+    auto handler = [onData, registry = m_symbolRegistry, doc = std::make_shared<fastjson::Document>()](std::string_view frame, shared_ptr<WebSocketSession> session)
+    {
+      BookTicker ticker{};
+      typedjson::readFrame(*doc, frame, ticker, registry.get());
+      StreamLatency::parsed();
+
+      onData(ticker);
+    };
+
+    return std::get<0>(createMonitor(strToLower(symbol) + "@bookTicker", handler));
+  }
+
+
+
+  MonitorToken UsdFuturesMarket::monitorMarkPriceTyped(shared_ptr<SpscRing<vector<MarkPrice>>> ring, const string& symbol)
+  {
+    return createRingMonitor(symbol.empty() ? "!markPrice@arr@1s" : strToLower(symbol) + "@markPrice@1s", ring);
+  }
+
+
+
+  MonitorToken UsdFuturesMarket::monitorMiniTickerTyped(shared_ptr<SpscRing<vector<MiniTicker>>> ring)
+  {
+    return createRingMonitor("!miniTicker@arr", ring);
+  }
+
+
+
+  MonitorToken UsdFuturesMarket::monitorKlineCandlestickStreamTyped(const string& symbol, const string& interval, shared_ptr<SpscRing<Kline>> ring)
+  {
+    return createRingMonitor(strToLower(symbol) + "@kline_" + interval, ring);
+  }
+
+
+
+  MonitorToken UsdFuturesMarket::monitorSymbolTyped(const string& symbol, shared_ptr<SpscRing<MiniTicker>> ring)
+  {
+    return createRingMonitor(strToLower(symbol) + "@miniTicker", ring);
+  }
+
+
+
+  MonitorToken UsdFuturesMarket::monitorSymbolBookStreamTyped(const string& symbol, shared_ptr<SpscRing<BookTicker>> ring)
+  {
+    return createRingMonitor(strToLower(symbol) + "@bookTicker", ring);
+  }
+
+
+
+  // -- REST Calls --
+
+
+  AccountInformation UsdFuturesMarket::accountInformation()
+  {
+    try
+    {
+      auto handler = [](web::http::http_response response)
+      {
+        AccountInformation info;
+
+        auto json = response.extract_json().get();
+
+        const utility::string_t AssetField = utility::conversions::to_string_t("assets");
+        const utility::string_t PositionsField = utility::conversions::to_string_t("positions");
+
+
+        getJsonValues(json, info.data, vector<string> {  "feeTier", "canTrade", "canDeposit", "canWithdraw", "updateTime", "totalInitialMargin", "totalMaintMargin", "totalWalletBalance",
+                                                      "totalUnrealizedProfit", "totalMarginBalance", "totalPositionInitialMargin", "totalOpenOrderInitialMargin", "totalCrossWalletBalance",
+                                                      "totalCrossUnPnl", "availableBalance", "maxWithdrawAmount"});
+
+
+        auto& assetArray = json[AssetField].as_array();
+        for (const auto& entry : assetArray)
+        {
+          map<string, string> order;
+          getJsonValues(entry, order, vector<string> { "asset", "walletBalance", "unrealizedProfit", "marginBalance", "maintMargin", "initialMargin", "positionInitialMargin",
+                                                    "openOrderInitialMargin", "crossWalletBalance", "crossUnPnl", "availableBalance", "maxWithdrawAmount", "updateTime"});
+
+          info.assets.emplace_back(std::move(order));
+        }
+
+
+        auto& positionArray = json[PositionsField].as_array();
+        for (const auto& entry : positionArray)
+        {
+          map<string, string> position;
+          getJsonValues(entry, position, vector<string> {  "symbol", "initialMargin", "maintMargin", "unrealizedProfit", "positionInitialMargin", "openOrderInitialMargin",
+                                                        "leverage", "isolated", "entryPrice", "maxNotional", "positionSide", "positionAmt", "updateTime"});
+
+          info.positions.emplace_back(std::move(position));
+        }
+
+        return info;
+      };
+
+      return sendRestRequest<AccountInformation>(RestCall::AccountInfo, web::http::methods::GET, true, m_marketType, handler, receiveWindow(RestCall::AccountInfo)).get();
+    }
+    catch (const pplx::task_canceled& tc)
+    {
+      throw BfcppDisconnectException("accountInformation");
+    }
+    catch (const BfcppException&)
+    {
+      throw;
+    }
+    catch (const std::exception& ex)
+    {
+      throw BfcppException(ex.what());
+    }
+  }
+
+
+
+  AccountBalance UsdFuturesMarket::accountBalance()
+  {
+    try
+    {
+      auto handler = [](web::http::http_response response)
+      {
+        AccountBalance balance;
+
+        auto json = response.extract_json().get();
+        for (const auto& entry : json.as_array())
+        {
+          map<string, string> order;
+          getJsonValues(entry, order, { "accountAlias", "asset", "balance", "crossWalletBalance", "crossUnPnl", "availableBalance", "maxWithdrawAmount"});
+
+          balance.balances.emplace_back(std::move(order));
+        }
+
+        return balance;
+      };
+
+      return sendRestRequest<AccountBalance>(RestCall::AccountBalance, web::http::methods::GET, true, m_marketType, handler, receiveWindow(RestCall::AccountBalance)).get();
+    }
+    catch (const pplx::task_canceled& tc)
+    {
+      throw BfcppDisconnectException("accountBalance");
+    }
+    catch (const BfcppException&)
+    {
+      throw;
+    }
+    catch (const std::exception& ex)
+    {
+      throw BfcppException(ex.what());
+    }
+  }
+
+
+
+  TakerBuySellVolume UsdFuturesMarket::takerBuySellVolume(map<string, string>&& query)
+  {
+    try
+    {
+      auto handler = [](web::http::http_response response)
+      {
+        TakerBuySellVolume result;
+
+        auto json = response.extract_json().get();
+
+        for (const auto& entry : json.as_array())
+        {
+          map<string, string> order;
+          getJsonValues(entry, order, { "buySellRatio", "buyVol", "sellVol", "timestamp"});
+
+          result.response.emplace_back(std::move(order));
+        }
+
+        return result;
+      };
+
+      return sendRestRequest<TakerBuySellVolume>(RestCall::TakerBuySellVolume, web::http::methods::GET, true, m_marketType, handler, receiveWindow(RestCall::TakerBuySellVolume), std::move(query)).get();
+    }
+    catch (const pplx::task_canceled& tc)
+    {
+      throw BfcppDisconnectException("takerBuySellVolume");
+    }
+    catch (const BfcppException&)
+    {
+      throw;
+    }
+    catch (const std::exception& ex)
+    {
+      throw BfcppException(ex.what());
+    }
+  }
+
+
+
+  KlineCandlestick UsdFuturesMarket::klines(map<string, string>&& query)
+  {
+    try
+    {
+      auto handler = [](web::http::http_response response)
+      {
+        KlineCandlestick result;
+
+        auto json = response.extract_json().get();
+
+        // kline does not return a key/value map, instead an array of arrays. 
         // the outer array has an entry per interval, with each inner array containing 12 fields for that interval (i.e. open time, close time, open price, close price, etc)
 
-        auto& intervalPeriod = json.as_array();
-        for (auto& interval : intervalPeriod)
+        auto& intervalPeriod = json.as_array();
+        for (auto& interval : intervalPeriod)
+        {
+          vector<string> stickValues;
+          stickValues.reserve(12);
+
+          auto& sticksArray = interval.as_array();
+          for (auto& stick : sticksArray)
+          {
+            stickValues.emplace_back(jsonValueToString(stick));
+          }
+
+          result.response.emplace_back(std::move(stickValues));
+        }
+
+        return result;
+      };
+
+      return sendRestRequest<KlineCandlestick>(RestCall::KlineCandles, web::http::methods::GET, true, m_marketType, handler, receiveWindow(RestCall::KlineCandles), std::move(query)).get();
+    }
+    catch (const pplx::task_canceled& tc)
+    {
+      throw BfcppDisconnectException("klines");
+    }
+    catch (const BfcppException&)
+    {
+      throw;
+    }
+    catch (const std::exception& ex)
+    {
+      throw BfcppException(ex.what());
+    }
+  }
+
+  
+
+  AllOrdersResult UsdFuturesMarket::allOrders(map<string, string>&& query)
+  {
+    try
+    {
+      auto handler = [](web::http::http_response response)
+      {
+        AllOrdersResult result;
+
+        auto json = response.extract_json().get();
+        
+        for (const auto& entry : json.as_array())
+        {
+          map<string, string> order;
+          getJsonValues(entry, order, { "avgPrice", "clientOrderId", "cumQuote", "executedQty", "orderId", "origQty", "origType", "price", "reduceOnly", "side", "positionSide", "status",
+                                        "stopPrice", "closePosition", "symbol", "time", "timeInForce", "type", "activatePrice", "priceRate", "updateTime", "workingType", "priceProtect"});
+
+          result.response.emplace_back(std::move(order));
+        }
+
+        return result;
+      };
+
+      return sendRestRequest<AllOrdersResult>(RestCall::AllOrders, web::http::methods::GET, true, m_marketType, handler, receiveWindow(RestCall::AllOrders), std::move(query)).get();
+    }
+    catch (const pplx::task_canceled& tc)
+    {
+      throw BfcppDisconnectException("allOrders");
+    }
+    catch (const BfcppException&)
+    {
+      throw;
+    }
+    catch (const std::exception& ex)
+    {
+      throw BfcppException(ex.what());
+    }
+  }
+
+
+
+  ExchangeInfo UsdFuturesMarket::exchangeInfo()
+  {
+    try
+    {
+      auto handler = [](web::http::http_response response)
+      {
+        ExchangeInfo result;
+
+        auto json = response.extract_json().get();
+
+        result.timezone = jsonValueToString(json[utility::conversions::to_string_t("timezone")]);
+        result.serverTime = jsonValueToString(json[utility::conversions::to_string_t("serverTime")]);
+
+        // rate limits
+        auto& rateLimits = json[utility::conversions::to_string_t("rateLimits")].as_array();
+        for (auto& rate : rateLimits)
+        {
+          map<string, string> values;
+          getJsonValues(rate, values, { "rateLimitType", "interval", "intervalNum", "limit"});
+
+          result.rateLimits.emplace_back(std::move(values));
+        }
+        
+
+        // symbols
+        auto& symbols = json[utility::conversions::to_string_t("symbols")].as_array();
+        for (auto& symbol : symbols)
+        {
+          ExchangeInfo::Symbol sym;
+
+          getJsonValues(symbol, sym.data, { "symbol", "pair", "contractType", "deliveryDate", "onboardDate", "status", "maintMarginPercent", "requiredMarginPercent", "baseAsset",
+                                            "quoteAsset", "marginAsset", "pricePrecision", "quantityPrecision", "baseAssetPrecision", "quotePrecision", "underlyingType",
+                                            "settlePlan", "triggerProtect"});
+
+
+          auto& subType = symbol[utility::conversions::to_string_t("underlyingSubType")].as_array();
+          for (auto& st : subType)
+          {
+            sym.underlyingSubType.emplace_back(jsonValueToString(st));
+          }
+          
+
+          auto& filters = symbol[utility::conversions::to_string_t("filters")].as_array();
+          for (auto& filter : filters)
+          {
+            map<string, string> values;
+            getJsonValues(filter, values,  {"filterType", "maxPrice", "minPrice", "tickSize", "stepSize", "maxQty", "minQty", "notional", "multiplierDown", "multiplierUp", "multiplierDecimal"});
+
+            sym.filters.emplace_back(std::move(values));
+          }
+
+
+          auto& orderTypes = symbol[utility::conversions::to_string_t("orderTypes")].as_array();
+          for (auto& ot : orderTypes)
+          {
+            sym.orderTypes.emplace_back(jsonValueToString(ot));
+          }
+
+
+          auto& tif = symbol[utility::conversions::to_string_t("timeInForce")].as_array();
+          for (auto& t : tif)
+          {
+            sym.timeInForce.emplace_back(jsonValueToString(t));
+          }
+
+          result.symbols.emplace_back(sym);
+        }
+
+        return result;
+      };
+
+      auto info = sendRestRequest<ExchangeInfo>(RestCall::ExchangeInfo, web::http::methods::GET, true, m_marketType, handler, receiveWindow(RestCall::ExchangeInfo)).get();
+
+      if (info.valid())
+      {
+        m_rateLimits.setLimits(info);
+      }
+
+      return info;
+    }
+    catch (const pplx::task_canceled& tc)
+    {
+      throw BfcppDisconnectException("klines");
+    }
+    catch (const BfcppException&)
+    {
+      throw;
+    }
+    catch (const std::exception& ex)
+    {
+      throw BfcppException(ex.what());
+    }
+  }
+
+
+
+  bool UsdFuturesMarket::syncClock(const size_t samples)
+  {
+    try
+    {
+      const auto path = getApiPath(m_marketType, RestCall::ServerTime);
+      const auto ServerTimeField = utility::conversions::to_string_t("serverTime");
+
+      vector<ClockSync::Sample> results;
+      results.reserve(samples);
+
+      // sequential, concurrent requests would queue behind each other
+      for (size_t i = 0; i < samples; ++i)
+      {
+        auto request = createHttpRequest(web::http::methods::GET, path);
+
+        m_rateLimits.acquire(RestCall::ServerTime);
+
+        ClockSync::Sample sample{};
+        sample.sent = ClockSync::localTime();
+
+        auto response = restClient().request(std::move(request)).then([&sample](web::http::http_response response)
+        {
+          sample.received = ClockSync::localTime();
+          return response;
+        }).get();
+
+        m_rateLimits.onResponse(response.status_code(), response.headers());
+
+        if (response.status_code() == web::http::status_codes::OK)
+        {
+          auto json = response.extract_json().get();
+
+          if (json.has_field(ServerTimeField))
+          {
+            sample.serverTime = json[ServerTimeField].as_number().to_int64();
+            results.push_back(sample);
+          }
+        }
+      }
+
+      return m_clockSync.update(results);
+    }
+    catch (const pplx::task_canceled& tc)
+    {
+      throw BfcppDisconnectException("syncClock");
+    }
+    catch (const BfcppException&)
+    {
+      throw;
+    }
+    catch (const std::exception& ex)
+    {
+      throw BfcppException(ex.what());
+    }
+  }
+
+
+
+  OrderBook UsdFuturesMarket::orderBook(map<string, string>&& query)
+  {
+    try
+    {
+      return doOrderBook(std::move(query)).get();
+    }
+    catch (const pplx::task_canceled& tc)
+    {
+      throw BfcppDisconnectException("klines");
+    }
+    catch (const BfcppException&)
+    {
+      throw;
+    }
+    catch (const std::exception& ex)
+    {
+      throw BfcppException(ex.what());
+    }
+  }
+
+
+
+  pplx::task<OrderBook> UsdFuturesMarket::doOrderBook(map<string, string>&& query)
+  {
+    auto handler = [](web::http::http_response response)
+    {
+      OrderBook result;
+
+      auto json = response.extract_json().get();
+
+      static const utility::string_t BidsField = utility::conversions::to_string_t("bids");
+      static const utility::string_t AsksField = utility::conversions::to_string_t("asks");
+
+      result.messageOutputTime = jsonValueToString(json[utility::conversions::to_string_t("E")]);
+      result.transactionTime = jsonValueToString(json[utility::conversions::to_string_t("T")]);
+      result.lastUpdateId = jsonValueToString(json[utility::conversions::to_string_t("lastUpdateId")]);
+
+      // bids
+      auto& bidsArray = json[BidsField].as_array();
+
+      for (auto& bid : bidsArray)
+      {
+        auto& bidValue = bid.as_array();
+        result.bids.emplace_back(std::make_pair(jsonValueToString(bidValue[0]), jsonValueToString(bidValue[1])));
+      }
+
+      // asks 
+      auto& asksArray = json[AsksField].as_array();
+
+      for (auto& ask : asksArray)
+      {
+        auto& askValue = ask.as_array();
+        result.asks.emplace_back(std::make_pair(jsonValueToString(askValue[0]), jsonValueToString(askValue[1])));
+      }
+
+      return result;
+    };
+
+    return sendRestRequest<OrderBook>(RestCall::OrderBook , web::http::methods::GET, false, m_marketType, handler, receiveWindow(RestCall::OrderBook), std::move(query));
+  }
+
+
+  
+
+
+
+
+  // -- Order batching --
+
+
+  void UsdFuturesMarket::setOrderBatching(const bool enable, const std::chrono::microseconds window)
+  {
+    if (enable)
+    {
+      m_orderBatcher.start(window);
+      m_orderBatching = true;
+    }
+    else
+    {
+      m_orderBatching = false;  // new orders are sent directly, the batcher sends those already held
+      m_orderBatcher.stop();
+    }
+  }
+
+
+  pplx::task<NewOrderResult> UsdFuturesMarket::queueOrder(map<string, string>&& order)
+  {
+    // an invalid order would fail its whole batch
+    if (const auto check = validateOrder(order); check != OrderCheck::Valid)
+    {
+      return pplx::task_from_result(createInvalidRestResult<NewOrderResult>(validationFailure(check)));
+    }
+
+    return m_orderBatcher.add(std::move(order));
+  }
+
+
+
+
+
+
+  // -- connection/session ---
+
+  void UsdFuturesMarket::disconnect(const MonitorToken& mt, const bool deleteSession)
+  {
+    if (auto itIdToSession = m_idToSession.find(mt.id); itIdToSession != m_idToSession.end())
+    {
+      auto& session = itIdToSession->second;
+
+      session->cancel();
+
+      if (auto itConnection = m_idToConnection.find(mt.id); itConnection != m_idToConnection.end())
+      {
+        // a combined stream, the session isn't connected 
+        removeCombinedSubscription(itConnection->second, session);
+
+        if (deleteSession)
         {
-          vector<string> stickValues;
-          stickValues.reserve(12);
+          m_idToConnection.erase(itConnection);
+        }
+      }
+      else
+      {
+        {
+          std::scoped_lock lock(session->clientMux);
 
-          auto& sticksArray = interval.as_array();
-          for (auto& stick : sticksArray)
+          session->client.close(ws::client::websocket_close_status::going_away).then([&session]()
           {
-            stickValues.emplace_back(jsonValueToString(stick));
-          }
+            session->connected = false;
+          }).wait();
+        }
 
-          result.response.emplace_back(std::move(stickValues));
+        // calling wait() on a task that's already cancelled throws an exception
+        if (!session->receiveTask.is_done())
+        {
+          session->receiveTask.wait();
         }
+      }
+           
 
-        return result;
+      // when called from disconnect() this flag is false to avoid invalidating iterators in m_idToSession, 
+      // this is tidier than returning the new iterator from erase()
+      if (deleteSession)
+      {
+        if (auto storedSessionIt = std::find_if(m_sessions.cbegin(), m_sessions.cend(), [this, &mt](auto& sesh) { return sesh->id == mt.id; });  storedSessionIt != m_sessions.end())
+        {
+          m_sessions.erase(storedSessionIt);
+        }
+
+        m_idToSession.erase(itIdToSession);
+      }
+    }
+  }
+
+
+
+  void UsdFuturesMarket::disconnect()
+  {
+    // shared connections are closed once rather than unsubscribing each monitor's stream
+    vector<shared_ptr<CombinedStreamConnection>> connections;
+
+    {
+      std::scoped_lock lock(m_combinedMux);
+      connections.swap(m_combinedConnections);
+    }
+
+    vector<pplx::task<void>> disconnectTasks;
+
+    for (const auto& connection : connections)
+    {
+      disconnectTasks.emplace_back(pplx::create_task([connection, this]
+      {
+        closeCombinedConnection(*connection);
+      }));
+    }
+
+    for (const auto& idToSession : m_idToSession)
+    {
+      if (m_idToConnection.find(idToSession.first) != m_idToConnection.end())
+      {
+        idToSession.second->cancel();
+        idToSession.second->connected = false;
+        continue;
+      }
+
+      disconnectTasks.emplace_back(pplx::create_task([&idToSession, this]
+      {
+        disconnect(idToSession.first, false);
+      }));
+    }
+
+    pplx::when_all(disconnectTasks.begin(), disconnectTasks.end()).wait();
+
+    m_idToSession.clear();
+    m_sessions.clear();
+    m_idToConnection.clear();
+  }
+
+
+
+  std::tuple<MonitorToken, shared_ptr<WebSocketSession>> UsdFuturesMarket::createCombinedMonitor(const string& stream, StreamHandler handler)
+  {
+    auto session = std::make_shared<WebSocketSession>();
+    session->uri = stream;
+    session->id = m_monitorId++;
+    session->connected = true;
+    session->onGap = [this](const StreamGap& gap) { notifyStreamGap(gap); };
+
+    std::scoped_lock lock(m_combinedMux);
+
+    // prefer a connection which already has the stream, otherwise one with room for it
+    auto connectionIt = std::find_if(m_combinedConnections.begin(), m_combinedConnections.end(), [&stream](auto& c) { return c->hasStream(stream); });
+
+    if (connectionIt == m_combinedConnections.end())
+    {
+      connectionIt = std::find_if(m_combinedConnections.begin(), m_combinedConnections.end(), [this](auto& c) { return c->streamCount() < m_streamsPerConnection; });
+    }
+
+    if (connectionIt == m_combinedConnections.end())
+    {
+      // the first stream is in the uri so doesn't require a SUBSCRIBE
+      auto connection = std::make_shared<CombinedStreamConnection>();
+      connection->session = connect(m_exchangeBaseUri + "/stream?streams=" + stream);
+      connection->add(stream, { handler, session });
+
+      // the connection's streams change, so it's identified by the endpoint. Frames carry their stream's name, which the recorder keeps
+      connection->session->uri = m_exchangeBaseUri + "/stream";
+
+      auto route = [weakConnection = std::weak_ptr<CombinedStreamConnection>{ connection }, doc = std::make_shared<fastjson::Document>()](std::string_view frame, shared_ptr<WebSocketSession>)
+      {
+        if (auto connection = weakConnection.lock(); connection)
+        {
+          connection->route(frame, *doc);
+        }
       };
 
-      return sendRestRequest<KlineCandlestick>(RestCall::KlineCandles, web::http::methods::GET, true, m_marketType, handler, receiveWindow(RestCall::KlineCandles), std::move(query)).get();
+      // reconnect with the streams the connection has now, and pass gaps on to each subscription
+      connection->session->reconnectUri = [this, weakConnection = std::weak_ptr<CombinedStreamConnection>{ connection }]
+      {
+        auto connection = weakConnection.lock();
+        return pplx::task_from_result(connection ? m_exchangeBaseUri + "/stream?streams=" + connection->streamNames() : string{});
+      };
+
+      connection->session->onGap = [weakConnection = std::weak_ptr<CombinedStreamConnection>{ connection }](const StreamGap& gap)
+      {
+        if (auto connection = weakConnection.lock(); connection)
+        {
+          connection->forEachSubscription([&gap](const CombinedStreamConnection::Subscription& sub)
+          {
+            if (sub.session->onGap)
+            {
+              // a subscription's uri is its stream name, gaps report the stream's own uri on the combined endpoint
+              StreamGap subGap{ gap };
+              subGap.token = MonitorToken{ sub.session->id };
+              subGap.uri = gap.uri + "?streams=" + sub.session->uri;
+              sub.session->onGap(subGap);
+            }
+          });
+        }
+      };
+
+      connection->session->id = createReceiveTask(connection->session, route).id;
+
+      m_combinedConnections.push_back(connection);
+      m_idToConnection[session->id] = connection;
     }
-    catch (const pplx::task_canceled tc)
+    else
     {
-      throw BfcppDisconnectException("klines");
+      auto& connection = *connectionIt;
+
+      if (connection->add(stream, { handler, session }))
+      {
+        connection->queueRequest("SUBSCRIBE", stream);
+      }
+
+      m_idToConnection[session->id] = connection;
+    }
+
+    m_sessions.push_back(session);
+    m_idToSession[session->id] = session;
+
+    return std::make_tuple(MonitorToken{ session->id }, session);
+  }
+
+
+
+  void UsdFuturesMarket::removeCombinedSubscription(shared_ptr<CombinedStreamConnection> connection, shared_ptr<WebSocketSession> session)
+  {
+    session->connected = false;
+
+    {
+      std::scoped_lock lock(m_combinedMux);
+
+      if (!connection->remove(session->uri, session->id))
+      {
+        return; // other monitors still use the stream
+      }
+
+      if (connection->streamCount() > 0)
+      {
+        connection->queueRequest("UNSUBSCRIBE", session->uri);
+        return;
+      }
+
+      // no longer found by createCombinedMonitor(), so can be closed without the lock
+      m_combinedConnections.erase(std::remove(m_combinedConnections.begin(), m_combinedConnections.end(), connection), m_combinedConnections.end());
+    }
+
+    closeCombinedConnection(*connection);
+  }
+
+
+
+  void UsdFuturesMarket::closeCombinedConnection(CombinedStreamConnection& connection)
+  {
+    connection.close();
+
+    auto& connectionSession = connection.session;
+
+    connectionSession->cancel();
+
+    {
+      std::scoped_lock clientLock(connectionSession->clientMux);
+
+      connectionSession->client.close(ws::client::websocket_close_status::going_away).then([&connectionSession]()
+      {
+        connectionSession->connected = false;
+      }).wait();
+    }
+
+    if (!connectionSession->receiveTask.is_done())
+    {
+      connectionSession->receiveTask.wait();
+    }
+  }
+
+
+
+  void UsdFuturesMarket::notifyStreamGap(const StreamGap& gap)
+  {
+    if (m_onStreamGap)
+    {
+      try
+      {
+        m_onStreamGap(gap);
+      }
+      catch (...)
+      {
+        // ignore callers' issues
+      }
+    }
+  }
+
+
+
+  void UsdFuturesMarket::supervise(shared_ptr<WebSocketSession> session)
+  {
+    using namespace std::chrono_literals;
+
+    if (!session->onGap)
+    {
+      session->onGap = [this](const StreamGap& gap) { notifyStreamGap(gap); };
+    }
+
+    session->lastReceive = Clock::now().time_since_epoch().count();
+    session->connected = true;
+
+    std::scoped_lock lock(m_supervisorMux);
+
+    m_supervised.erase(std::remove_if(m_supervised.begin(), m_supervised.end(), [](auto& weakSession) { return weakSession.expired(); }), m_supervised.end());
+    m_supervised.emplace_back(session);
+
+    if (!m_supervising)
+    {
+      m_supervising = true;
+      m_supervisorTimer.start(std::bind(&UsdFuturesMarket::onSupervisorTimer, this), 100ms);
+    }
+  }
+
+
+
+  void UsdFuturesMarket::onSupervisorTimer()
+  {
+    vector<shared_ptr<WebSocketSession>> stale;
+    vector<PendingReconnect> due;
+
+    {
+      std::scoped_lock lock(m_supervisorMux);
+
+      if (m_reconnectPolicy.enabled && m_reconnectPolicy.staleTimeout.count() > 0)
+      {
+        const auto staleBefore = (Clock::now() - m_reconnectPolicy.staleTimeout).time_since_epoch().count();
+
+        for (const auto& weakSession : m_supervised)
+        {
+          if (auto session = weakSession.lock(); session && session->checkStale && session->connected && session->lastReceive < staleBefore && !session->getCancelToken().is_canceled())
+          {
+            stale.push_back(session);
+          }
+        }
+      }
+
+      // cancelled sessions are due immediately so disconnect() isn't held up by the backoff
+      const auto now = std::chrono::steady_clock::now();
+
+      auto notDue = std::partition(m_pendingReconnects.begin(), m_pendingReconnects.end(), [now](const PendingReconnect& pending)
+      {
+        return pending.due <= now || pending.session->getCancelToken().is_canceled();
+      });
+
+      std::move(m_pendingReconnects.begin(), notDue, std::back_inserter(due));
+      m_pendingReconnects.erase(m_pendingReconnects.begin(), notDue);
+    }
+
+    // closing ends the session's receive chain, which then reconnects
+    for (auto& session : stale)
+    {
+      std::scoped_lock lock(session->clientMux);
+      session->connected = false;
+      session->client.close(ws::client::websocket_close_status::going_away);
+    }
+
+    for (auto& pending : due)
+    {
+      reconnect(std::move(pending));
+    }
+
+    // combined connections' SUBSCRIBE/UNSUBSCRIBE requests
+    vector<shared_ptr<CombinedStreamConnection>> connections;
+
+    {
+      std::scoped_lock lock(m_combinedMux);
+      connections = m_combinedConnections;
+    }
+
+    for (auto& connection : connections)
+    {
+      connection->sendRequests(std::chrono::steady_clock::now());
+    }
+  }
+
+
+
+  void UsdFuturesMarket::receive(shared_ptr<WebSocketSession> session, StreamHandler extractFunc, pplx::task_completion_event<void> receiveEnded)
+  {
+    if (session->getCancelToken().is_canceled())
+    {
+      receiveEnded.set();
+      return;
+    }
+
+    session->client.receive().then([this, session, extractFunc, receiveEnded](pplx::task<ws::client::websocket_incoming_message> received)
+    {
+      try
+      {
+        // the task has completed, get() doesn't block
+        auto msg = received.get();
+
+        // system clock to compare with the exchange's event times, steady clock for intervals measured in this process
+        const auto arrived = Clock::now();
+        const auto arrivedSteady = std::chrono::steady_clock::now();
+        session->lastReceive = arrived.time_since_epoch().count();
+
+        if (msg.message_type() == ws::client::websocket_message_type::text_message)
+        {
+          const auto recorder = m_frameRecording ? std::atomic_load(&m_frameRecorder) : shared_ptr<FrameRecorder>{};
+
+          msg.extract_string().then([this, session, extractFunc, receiveEnded, arrived, arrivedSteady, recorder](pplx::task<std::string> frame)
+          {
+            try
+            {
+              if (!session->getCancelToken().is_canceled())
+              {
+                const auto data = frame.get();
+
+                if (recorder)
+                {
+                  // before the handler, so a frame it can't process is recorded
+                  recorder->record(session->uri, data, arrivedSteady);
+                }
+
+                StreamLatency::received(arrived, arrivedSteady);
+                extractFunc(data, session);
+              }
+            }
+            catch (const std::exception&)
+            {
+              // a frame the handler can't process is dropped, the monitor continues
+            }
+
+            receive(session, extractFunc, receiveEnded);
+          });
+
+          return;
+        }
+        else if (msg.message_type() != ws::client::websocket_message_type::close)
+        {
+          receive(session, extractFunc, receiveEnded);
+          return;
+        }
+      }
+      catch (const std::exception&)
+      {
+        // the connection failed, was closed by the exchange or closed by the supervisor as stale
+      }
+
+      connectionLost(session, extractFunc, receiveEnded);
+    });
+  }
+
+
+
+  void UsdFuturesMarket::connectionLost(shared_ptr<WebSocketSession> session, StreamHandler extractFunc, pplx::task_completion_event<void> receiveEnded)
+  {
+    session->connected = false;
+
+    if (session->getCancelToken().is_canceled())
+    {
+      receiveEnded.set();
+      return;
     }
-    catch (const std::exception ex)
+
+    PendingReconnect pending;
+    pending.session = session;
+    pending.extractFunc = extractFunc;
+    pending.receiveEnded = receiveEnded;
+    pending.gap.state = StreamGap::State::Disconnected;
+    pending.gap.token = MonitorToken{ session->id };
+    pending.gap.uri = session->uri;
+    pending.gap.disconnected = Clock::now();
+    pending.delay = reconnectPolicy().initialDelay;
+
+    if (session->onGap)
     {
-      throw BfcppException(ex.what());
+      session->onGap(pending.gap);
     }
+
+    scheduleReconnect(std::move(pending));
   }
 
-  
 
-  AllOrdersResult UsdFuturesMarket::allOrders(map<string, string>&& query)
+
+  void UsdFuturesMarket::scheduleReconnect(PendingReconnect&& pending)
   {
-    try
+    thread_local std::mt19937 random{ std::random_device{}() };
+
+    const auto policy = reconnectPolicy();
+
+    if (!policy.enabled || (policy.maxAttempts > 0 && pending.gap.attempts >= policy.maxAttempts))
     {
-      auto handler = [](web::http::http_response response)
+      pending.gap.state = StreamGap::State::Failed;
+
+      if (pending.session->onGap)
       {
-        AllOrdersResult result;
+        pending.session->onGap(pending.gap);
+      }
 
-        auto json = response.extract_json().get();
-        
-        for (const auto& entry : json.as_array())
-        {
-          map<string, string> order;
-          getJsonValues(entry, order, { "avgPrice", "clientOrderId", "cumQuote", "executedQty", "orderId", "origQty", "origType", "price", "reduceOnly", "side", "positionSide", "status",
-                                        "stopPrice", "closePosition", "symbol", "time", "timeInForce", "type", "activatePrice", "priceRate", "updateTime", "workingType", "priceProtect"});
+      pending.receiveEnded.set();
+      return;
+    }
 
-          result.response.emplace_back(std::move(order));
-        }
+    std::uniform_real_distribution<double> jitter{ 1.0 - policy.jitter, 1.0 + policy.jitter };
 
-        return result;
-      };
+    pending.due = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::milliseconds>(pending.delay * jitter(random));
 
-      return sendRestRequest<AllOrdersResult>(RestCall::AllOrders, web::http::methods::GET, true, m_marketType, handler, receiveWindow(RestCall::AllOrders), std::move(query)).get();
-    }
-    catch (const pplx::task_canceled tc)
-    {
-      throw BfcppDisconnectException("allOrders");
-    }
-    catch (const std::exception ex)
-    {
-      throw BfcppException(ex.what());
-    }
+    std::scoped_lock lock(m_supervisorMux);
+    m_pendingReconnects.emplace_back(std::move(pending));
   }
 
 
 
-  ExchangeInfo UsdFuturesMarket::exchangeInfo()
+  void UsdFuturesMarket::reconnect(PendingReconnect pending)
   {
-    try
+    auto session = pending.session;
+
+    if (session->getCancelToken().is_canceled())
     {
-      auto handler = [](web::http::http_response response)
-      {
-        ExchangeInfo result;
+      pending.receiveEnded.set();
+      return;
+    }
 
-        auto json = response.extract_json().get();
+    ++pending.gap.attempts;
 
-        result.timezone = jsonValueToString(json[utility::conversions::to_string_t("timezone")]);
-        result.serverTime = jsonValueToString(json[utility::conversions::to_string_t("serverTime")]);
+    auto client = std::make_shared<ws::client::websocket_client>();
 
-        // rate limits
-        auto& rateLimits = json[utility::conversions::to_string_t("rateLimits")].as_array();
-        for (auto& rate : rateLimits)
-        {
-          map<string, string> values;
-          getJsonValues(rate, values, { "rateLimitType", "interval", "intervalNum", "limit"});
+    // the uri may require a REST call (the user data's listen key), which may wait on the rate limits, so it's started off the supervisor's thread
+    pplx::create_task([session]
+    {
+      return session->reconnectUri ? session->reconnectUri() : pplx::task_from_result(session->uri);
+    })
+    .then([client](const string& uri)
+    {
+      return client->connect(web::uri{ utility::conversions::to_string_t(uri) });
+    })
+    .then([this, attempt = std::move(pending), client](pplx::task<void> connected)
+    {
+      auto pending = attempt;
+      auto& session = pending.session;
 
-          result.rateLimits.emplace_back(std::move(values));
-        }
-        
+      try
+      {
+        connected.get();
+      }
+      catch (const std::exception&)
+      {
+        const auto policy = reconnectPolicy();
+        pending.delay = std::min<std::chrono::duration<double, std::milli>>(pending.delay * policy.multiplier, policy.maxDelay);
+        scheduleReconnect(std::move(pending));
+        return;
+      }
 
-        // symbols
-        auto& symbols = json[utility::conversions::to_string_t("symbols")].as_array();
-        for (auto& symbol : symbols)
+      {
+        std::scoped_lock lock(session->clientMux);
+
+        if (session->getCancelToken().is_canceled())
         {
-          ExchangeInfo::Symbol sym;
+          client->close(ws::client::websocket_close_status::going_away);
+          pending.receiveEnded.set();
+          return;
+        }
 
-          getJsonValues(symbol, sym.data, { "symbol", "pair", "contractType", "deliveryDate", "onboardDate", "status", "maintMarginPercent", "requiredMarginPercent", "baseAsset",
-                                            "quoteAsset", "marginAsset", "pricePrecision", "quantityPrecision", "baseAssetPrecision", "quotePrecision", "underlyingType",
-                                            "settlePlan", "triggerProtect"});
+        session->client = std::move(*client);
+        session->lastReceive = Clock::now().time_since_epoch().count();
+        session->connected = true;
+      }
 
+      pending.gap.state = StreamGap::State::Reconnected;
 
-          auto& subType = symbol[utility::conversions::to_string_t("underlyingSubType")].as_array();
-          for (auto& st : subType)
-          {
-            sym.underlyingSubType.emplace_back(jsonValueToString(st));
-          }
-          
+      if (session->onGap)
+      {
+        session->onGap(pending.gap);
+      }
 
-          auto& filters = symbol[utility::conversions::to_string_t("filters")].as_array();
-          for (auto& filter : filters)
-          {
-            map<string, string> values;
-            getJsonValues(filter, values,  {"filterType", "maxPrice", "minPrice", "tickSize", "stepSize", "maxQty", "minQty", "notional", "multiplierDown", "multiplierUp", "multiplierDecimal"});
+      receive(session, pending.extractFunc, pending.receiveEnded);
+    });
+  }
 
-            sym.filters.emplace_back(std::move(values));
-          }
 
 
-          auto& orderTypes = symbol[utility::conversions::to_string_t("orderTypes")].as_array();
-          for (auto& ot : orderTypes)
-          {
-            sym.orderTypes.emplace_back(jsonValueToString(ot));
-          }
+  bool CombinedStreamConnection::add(const string& stream, Subscription&& subscription)
+  {
+    std::scoped_lock lock(m_mux);
 
+    auto& subscriptions = m_streams[stream];
+    const bool first = subscriptions == nullptr;
 
-          auto& tif = symbol[utility::conversions::to_string_t("timeInForce")].as_array();
-          for (auto& t : tif)
-          {
-            sym.timeInForce.emplace_back(jsonValueToString(t));
-          }
+    auto updated = first ? std::make_shared<Subscriptions>() : std::make_shared<Subscriptions>(*subscriptions);
+    updated->emplace_back(std::move(subscription));
+    subscriptions = std::move(updated);
 
-          result.symbols.emplace_back(sym);
-        }
+    return first;
+  }
 
-        return result;
-      };
 
-      return sendRestRequest<ExchangeInfo>(RestCall::ExchangeInfo, web::http::methods::GET, true, m_marketType, handler, receiveWindow(RestCall::ExchangeInfo)).get();
-    }
-    catch (const pplx::task_canceled tc)
-    {
-      throw BfcppDisconnectException("klines");
-    }
-    catch (const std::exception ex)
+
+  bool CombinedStreamConnection::remove(const string& stream, const MonitorTokenId id)
+  {
+    std::scoped_lock lock(m_mux);
+
+    if (auto it = m_streams.find(stream); it != m_streams.end())
     {
-      throw BfcppException(ex.what());
+      auto updated = std::make_shared<Subscriptions>(*it->second);
+      updated->erase(std::remove_if(updated->begin(), updated->end(), [id](auto& sub) { return sub.session->id == id; }), updated->end());
+
+      if (updated->empty())
+      {
+        m_streams.erase(it);
+        return true;
+      }
+
+      it->second = std::move(updated);
     }
+
+    return false;
   }
 
 
 
-  OrderBook UsdFuturesMarket::orderBook(map<string, string>&& query)
+  string CombinedStreamConnection::streamNames() const
   {
-    try
-    {
-      auto handler = [](web::http::http_response response)
-      {
-        OrderBook result;
+    std::scoped_lock lock(m_mux);
 
-        auto json = response.extract_json().get();
+    string names;
 
-        static const utility::string_t BidsField = utility::conversions::to_string_t("bids");
-        static const utility::string_t AsksField = utility::conversions::to_string_t("asks");
+    for (const auto& stream : m_streams)
+    {
+      if (!names.empty())
+        names += '/';
 
-        result.messageOutputTime = jsonValueToString(json[utility::conversions::to_string_t("E")]);
-        result.transactionTime = jsonValueToString(json[utility::conversions::to_string_t("T")]);
-        result.lastUpdateId = jsonValueToString(json[utility::conversions::to_string_t("lastUpdateId")]);
+      names += stream.first;
+    }
 
-        // bids
-        auto& bidsArray = json[BidsField].as_array();
+    return names;
+  }
 
-        for (auto& bid : bidsArray)
-        {
-          auto& bidValue = bid.as_array();
-          result.bids.emplace_back(std::make_pair(jsonValueToString(bidValue[0]), jsonValueToString(bidValue[1])));
-        }
 
-        // asks 
-        auto& asksArray = json[AsksField].as_array();
 
-        for (auto& ask : asksArray)
-        {
-          auto& askValue = ask.as_array();
-          result.asks.emplace_back(std::make_pair(jsonValueToString(askValue[0]), jsonValueToString(askValue[1])));
-        }
+  void CombinedStreamConnection::forEachSubscription(std::function<void(const Subscription&)> f) const
+  {
+    vector<shared_ptr<const Subscriptions>> all;
 
-        return result;
-      };
+    {
+      std::scoped_lock lock(m_mux);
 
-      return sendRestRequest<OrderBook>(RestCall::OrderBook , web::http::methods::GET, false, m_marketType, handler, receiveWindow(RestCall::OrderBook), std::move(query)).get();
+      for (const auto& stream : m_streams)
+      {
+        all.push_back(stream.second);
+      }
     }
-    catch (const pplx::task_canceled tc)
+
+    for (const auto& subscriptions : all)
     {
-      throw BfcppDisconnectException("klines");
+      for (const auto& sub : *subscriptions)
+      {
+        f(sub);
+      }
     }
-    catch (const std::exception ex)
+  }
+
+
+
+  void CombinedStreamConnection::queueRequest(const string& method, const string& stream)
+  {
+    std::scoped_lock lock(m_requestMux);
+
+    if (m_closed)
     {
-      throw BfcppException(ex.what());
+      return;
     }
+
+    m_requests.emplace_back(R"({"method":")" + method + R"(","params":[")" + stream + R"("],"id":)" + std::to_string(++m_requestId) + "}");
   }
 
-  
 
 
+  void CombinedStreamConnection::close()
+  {
+    std::scoped_lock lock(m_requestMux);
+    m_closed = true;
+    m_requests.clear();
+  }
 
 
-  // -- connection/session ---
 
-  void UsdFuturesMarket::disconnect(const MonitorToken& mt, const bool deleteSession)
+  void CombinedStreamConnection::sendRequests(const std::chrono::steady_clock::time_point now)
   {
-    if (auto itIdToSession = m_idToSession.find(mt.id); itIdToSession != m_idToSession.end())
+    using namespace std::chrono_literals;
+
+    vector<string> requests;
+
     {
-      auto& session = itIdToSession->second;
+      std::scoped_lock lock(m_requestMux);
 
-      session->cancel();
+      while (!m_sent.empty() && now - m_sent.front() >= 1s)
+      {
+        m_sent.pop_front();
+      }
 
-      session->client.close(ws::client::websocket_close_status::going_away).then([&session]()
+      // waiting for the previous sends keeps the requests spaced as they're sent, not only as they're queued
+      if (m_closed || m_inFlight > 0)
       {
-        session->connected = false;
-      }).wait();
+        return;
+      }
 
-      // calling wait() on a task that's already cancelled throws an exception
-      if (!session->receiveTask.is_done())
+      while (!m_requests.empty() && m_sent.size() < MaxRequestsPerSecond)
       {
-        session->receiveTask.wait();
+        requests.emplace_back(std::move(m_requests.front()));
+        m_requests.pop_front();
+        m_sent.push_back(now);
       }
-           
 
-      // when called from disconnect() this flag is false to avoid invalidating iterators in m_idToSession, 
-      // this is tidier than returning the new iterator from erase()
-      if (deleteSession)
+      m_inFlight = requests.size();
+    }
+
+    // send() queues the message in the client, so the lock isn't held whilst the message is sent
+    std::scoped_lock lock(session->clientMux);
+
+    for (const auto& request : requests)
+    {
+      ws::client::websocket_outgoing_message msg;
+      msg.set_utf8_message(request);
+
+      pplx::task<void> sent;
+
+      try
       {
-        if (auto storedSessionIt = std::find_if(m_sessions.cbegin(), m_sessions.cend(), [this, &mt](auto& sesh) { return sesh->id == mt.id; });  storedSessionIt != m_sessions.end())
+        sent = session->client.send(msg);
+      }
+      catch (const std::exception&)
+      {
+        sent = pplx::task_from_result();
+      }
+
+      sent.then([connection = shared_from_this()](pplx::task<void> sent)
+      {
+        try
         {
-          m_sessions.erase(storedSessionIt);
+          sent.get();
+        }
+        catch (const std::exception&)
+        {
+          // the connection is down, reconnecting subscribes to the connection's current streams
         }
 
-        m_idToSession.erase(itIdToSession);
-      }
+        std::scoped_lock lock(connection->m_requestMux);
+        --connection->m_inFlight;
+      });
     }
   }
 
 
 
-  void UsdFuturesMarket::disconnect()
+  bool CombinedStreamConnection::hasStream(const string& stream) const
   {
-    vector<pplx::task<void>> disconnectTasks;
+    std::scoped_lock lock(m_mux);
+    return m_streams.find(stream) != m_streams.cend();
+  }
 
-    for (const auto& idToSession : m_idToSession)
-    {
-      disconnectTasks.emplace_back(pplx::create_task([&idToSession, this]
-      {
-        disconnect(idToSession.first, false);
-      }));
-    }
 
-    pplx::when_all(disconnectTasks.begin(), disconnectTasks.end()).wait();
 
-    m_idToSession.clear();
-    m_sessions.clear();
+  size_t CombinedStreamConnection::streamCount() const
+  {
+    std::scoped_lock lock(m_mux);
+    return m_streams.size();
   }
 
 
 
-  bool UsdFuturesMarket::createListenKey(const MarketType marketType)
+  void CombinedStreamConnection::route(std::string_view frame, fastjson::Document& doc) const
   {
-    try
+    std::string_view stream, data;
+
+    auto readFast = [&stream, &data](const fastjson::Value& root)
     {
-      auto handler = [](web::http::http_response response)
+      root.forEachField([&stream, &data](std::string_view key, const fastjson::Value& value)
       {
-        ListenKey result;
+        if (key == "stream")
+          stream = value.getString();
+        else if (key == "data")
+          data = value.raw();
+      });
+    };
 
-        auto json = response.extract_json().get();
+    string fallbackStream, fallbackData;
 
-        result.listenKey = utility::conversions::to_utf8string(json[utility::conversions::to_string_t(ListenKeyName)].as_string());
+    if (!fastjson::tryRead(doc, frame, readFast))
+    {
+      auto json = parseJson(frame);
 
-        return result;
-      };
+      if (json.has_field(utility::conversions::to_string_t("stream")) && json.has_field(utility::conversions::to_string_t("data")))
+      {
+        fallbackStream = utility::conversions::to_utf8string(json.at(utility::conversions::to_string_t("stream")).as_string());
+        fallbackData = utility::conversions::to_utf8string(json.at(utility::conversions::to_string_t("data")).serialize());
 
-      auto lk = sendRestRequest<ListenKey>(RestCall::ListenKey, web::http::methods::POST, true, marketType, handler, receiveWindow(RestCall::ListenKey)).get();
-      
-      m_listenKey = lk.listenKey;
+        stream = fallbackStream;
+        data = fallbackData;
+      }
+    }
+
+    if (stream.empty() || data.empty())
+    {
+      return;
+    }
+
+    shared_ptr<const Subscriptions> subscriptions;
+
+    {
+      std::scoped_lock lock(m_mux);
+
+      if (auto it = m_streams.find(stream); it != m_streams.cend())
+      {
+        subscriptions = it->second;
+      }
+    }
+
+    if (subscriptions)
+    {
+      for (const auto& sub : *subscriptions)
+      {
+        if (!sub.session->getCancelToken().is_canceled())
+        {
+          try
+          {
+            sub.handler(data, sub.session);
+          }
+          catch (const std::exception&)
+          {
+            // a frame which a handler can't process doesn't stop the other streams on the connection
+          }
+        }
+      }
+    }
+  }
 
-      return lk.valid() && !m_listenKey.empty();
+
+
+  bool UsdFuturesMarket::createListenKey(const MarketType marketType)
+  {
+    try
+    {
+      auto lk = requestListenKey(marketType).get();
+      return lk.valid() && !lk.listenKey.empty();
     }
-    catch (const pplx::task_canceled tc)
+    catch (const pplx::task_canceled& tc)
     {
       throw BfcppDisconnectException("createListenKey");
     }
-    catch (const std::exception ex)
+    catch (const BfcppException&)
+    {
+      throw;
+    }
+    catch (const std::exception& ex)
     {
       throw BfcppException(ex.what());
     }
@@ -786,10 +1983,32 @@ namespace bfcpp
 
 
 
+  pplx::task<ListenKey> UsdFuturesMarket::requestListenKey(const MarketType marketType)
+  {
+    auto handler = [](web::http::http_response response)
+    {
+      ListenKey result;
+
+      auto json = response.extract_json().get();
+
+      result.listenKey = utility::conversions::to_utf8string(json[utility::conversions::to_string_t(ListenKeyName)].as_string());
+
+      return result;
+    };
+
+    return sendRestRequest<ListenKey>(RestCall::ListenKey, web::http::methods::POST, true, marketType, handler, receiveWindow(RestCall::ListenKey)).then([this](ListenKey lk)
+    {
+      m_listenKey = lk.listenKey;
+      return lk;
+    });
+  }
+
+
+
 
   // -- data/util --
 
-  void UsdFuturesMarket::extractUsdFuturesUserData(shared_ptr<WebSocketSession> session, web::json::value&& jsonVal)
+  UsdFutureUserData UsdFuturesMarket::readUserData(web::json::value&& jsonVal)
   {
     const utility::string_t CodeField = utility::conversions::to_string_t("code");
     const utility::string_t MsgField = utility::conversions::to_string_t("msg");
@@ -913,10 +2132,9 @@ namespace bfcpp
           // handled above
           break;
         }
-
-
-        session->callback(std::any{ std::move(userData) });
       }
+
+      return userData;
     }
   }
 
@@ -7,17 +7,120 @@
 #include <functional>
 #include <map>
 #include <any>
+#include <optional>
 #include <set>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
 #include <cpprest/ws_client.h>
 #include <cpprest/json.h>
 #include <cpprest/http_client.h>
 #include <openssl/hmac.h>
 #include "IntervalTimer.hpp"
 #include "bfcppCommon.hpp"
+#include "LocalOrderBook.hpp"
+#include "TypedStreams.hpp"
+#include "HttpClientPool.hpp"
+#include "SpscRing.hpp"
+#include "SymbolRegistry.hpp"
+#include "OrderTemplate.hpp"
+#include "Signer.hpp"
+#include "RateLimitGovernor.hpp"
+#include "ClockSync.hpp"
+#include "OrderValidator.hpp"
+#include "OrderStateCache.hpp"
+#include "AccountStateCache.hpp"
+#include "OrderLatencyTracer.hpp"
+#include "StreamLatency.hpp"
+#include "RestCallStatistics.hpp"
+#include "FrameRecorder.hpp"
+#include "OrderBatcher.hpp"
 
 
 namespace bfcpp
 {
+  /// <summary>
+  /// A connection to the combined stream endpoint (/stream) which carries the streams of many monitors, see UsdFuturesMarket::setCombinedStreams().
+  /// Each frame is {"stream":"<name>","data":<payload>}, the payload is passed to the handlers of the monitors subscribed to that stream.
+  /// </summary>
+  struct CombinedStreamConnection : public std::enable_shared_from_this<CombinedStreamConnection>
+  {
+    inline const static size_t MaxRequestsPerSecond = 9; // Binance allows 10 incoming messages per second
+
+
+    struct Subscription
+    {
+      StreamHandler handler;
+      shared_ptr<WebSocketSession> session; // not connected, holds the monitor's id
+    };
+
+    typedef vector<Subscription> Subscriptions;
+
+
+    /// <summary>
+    /// Adds the subscription, returns true if this is the first for the stream (so a SUBSCRIBE is required).
+    /// </summary>
+    bool add(const string& stream, Subscription&& subscription);
+
+    /// <summary>
+    /// Removes the monitor's subscription, returns true if this was the last for the stream (so an UNSUBSCRIBE is required).
+    /// </summary>
+    bool remove(const string& stream, const MonitorTokenId id);
+
+    bool hasStream(const string& stream) const;
+    string streamNames() const;  // '/' separated, as used in the /stream uri
+    void forEachSubscription(std::function<void(const Subscription&)> f) const;
+    size_t streamCount() const;
+
+    /// <summary>
+    /// Passes the frame's payload to the stream's subscriptions. Frames without a "stream", i.e. SUBSCRIBE responses, are ignored.
+    /// </summary>
+    void route(std::string_view frame, fastjson::Document& doc) const;
+
+    /// <summary>
+    /// Queues a SUBSCRIBE or UNSUBSCRIBE, sent by sendRequests() so the caller doesn't wait.
+    /// </summary>
+    void queueRequest(const string& method, const string& stream);
+
+    /// <summary>
+    /// Sends queued requests in order, up to MaxRequestsPerSecond, once the previous sends have completed. Called by the
+    /// market's supervisor, doesn't wait for the sends.
+    /// </summary>
+    void sendRequests(const std::chrono::steady_clock::time_point now);
+
+    /// <summary>
+    /// Drops queued requests, call before closing the session.
+    /// </summary>
+    void close();
+
+
+    shared_ptr<WebSocketSession> session;
+
+  private:
+    std::mutex m_requestMux;
+    std::deque<string> m_requests;
+    std::deque<std::chrono::steady_clock::time_point> m_sent;  // in the last second
+    size_t m_inFlight{ 0 };
+    bool m_closed{ false };
+    size_t m_requestId{ 0 };
+
+    mutable std::mutex m_mux;
+    // subscriptions are replaced rather than modified so route() can call the handlers without holding the lock
+    map<string, shared_ptr<const Subscriptions>, std::less<>> m_streams;
+  };
+
+
+
+  /// <summary>
+  /// True if F can be passed to the statically typed monitor overloads, i.e. monitorSymbolBookStream(symbol, F&&), for Stream.
+  /// Callables which can take a std::any are excluded so they select the std::function<void(std::any)> overloads.
+  /// </summary>
+  template<class F, class Stream>
+  inline constexpr bool IsStreamCallback = std::is_invocable_v<std::decay_t<F>&, const Stream&> && !std::is_invocable_v<std::decay_t<F>&, std::any>;
+
+
+
   /// <summary>
   /// Access the USD-M Future's market. You must have a Futures account.
   /// The APis keys must be enabled for Futures in the API Management settings. 
@@ -26,10 +129,19 @@ namespace bfcpp
   class UsdFuturesMarket
   {
     inline const static string DefaultReceiveWindow = "5000";
+    inline const static size_t MaxStreamsPerConnection = 200;
+    inline const static std::chrono::microseconds DefaultOrderBatchWindow = std::chrono::microseconds{ 500 };
+    inline const static size_t DefaultClockSyncSamples = 5;
+    inline const static std::chrono::seconds DefaultClockSyncInterval = std::chrono::seconds{ 60 };
 
 
   protected:
-    UsdFuturesMarket(MarketType mt, const string& exchangeUri, const ApiAccess& access) : m_marketType(mt), m_exchangeBaseUri(exchangeUri), m_apiAccess(access)
+    UsdFuturesMarket(MarketType mt, const string& exchangeUri, const ApiAccess& access) : m_marketType(mt), m_exchangeBaseUri(exchangeUri), m_apiAccess(access), m_signer(access.secretKey), m_orderLatencyTracing(false), m_roundOrders(false), m_streamParser(StreamParser::Cpprest),
+      m_combinedStreams(false), m_streamsPerConnection(MaxStreamsPerConnection), m_streamLatencyTracking(false), m_restPool(std::make_unique<HttpClientPool>(getApiUri(mt))),
+      m_restTiming(false), m_restStatistics(std::make_unique<RestCallStatistics>()), m_frameRecording(false),
+      m_orderBatching(false), m_orderBatcher([this](map<string, string>&& order) { return doNewOrder(std::move(order)); },
+                                             [this](vector<map<string, string>>&& orders) { return doNewOrderBatch(std::move(orders)); }),
+      m_supervising(false)
     {
       m_monitorId = 1;
     }
@@ -44,7 +156,10 @@ namespace bfcpp
 
     virtual ~UsdFuturesMarket()
     {
+      stopClockSync();
+      setOrderBatching(false);
       disconnect();
+      stopFrameRecording();
     }
 
     /// <summary>
@@ -72,26 +187,99 @@ namespace bfcpp
     {
       try
       {
-        web::http::client::http_client client{ web::uri { utility::conversions::to_string_t(getApiUri(m_marketType)) } };
-
         auto request = createHttpRequest(web::http::methods::POST, getApiPath(m_marketType, RestCall::Ping) + "?" + createQueryString({}, RestCall::Ping, false, receiveWindow(RestCall::Ping)));
 
         auto send = Clock::now();
-        auto rcv = client.request(std::move(request)).then([](web::http::http_response response) { return Clock::now(); }).get();
+        auto rcv = restClient().request(std::move(request)).then([](web::http::http_response response) { return Clock::now(); }).get();
 
         return std::chrono::duration_cast<std::chrono::milliseconds>(rcv - send);
       }
-      catch (const pplx::task_canceled tc)
+      catch (const pplx::task_canceled& tc)
       {
         throw BfcppDisconnectException("ping");
       }
-      catch (const std::exception ex)
+      catch (const BfcppException&)
+      {
+        throw;
+      }
+      catch (const std::exception& ex)
       {
         throw BfcppException(ex.what());
       }
     }
 
 
+    /// <summary>
+    /// Estimates the offset between the local clock and the exchange's from 'samples' server time requests, sent one after another.
+    /// Signed requests are then timestamped with the exchange's time, see ClockSync.
+    /// 
+    /// Without this the receive window must cover the local clock's skew. Once synced, setReceiveWindow() can be set to a few hundred milliseconds.
+    /// </summary>
+    /// <param name="samples">The sample with the lowest round trip is used</param>
+    /// <returns>true if the offset was updated, false if no sample succeeded</returns>
+    bool syncClock(const size_t samples = DefaultClockSyncSamples);
+
+
+    /// <summary>
+    /// Calls syncClock() now, then every 'interval' on a background thread as the local clock drifts.
+    /// </summary>
+    void startClockSync(const std::chrono::seconds interval = DefaultClockSyncInterval, const size_t samples = DefaultClockSyncSamples)
+    {
+      stopClockSync();
+      syncClock(samples);
+      m_clockSyncTimer.start([this, samples] { syncClock(samples); }, interval);
+    }
+
+
+    void stopClockSync()
+    {
+      m_clockSyncTimer.stop();
+    }
+
+
+    const ClockSync& clockSync() const
+    {
+      return m_clockSync;
+    }
+
+
+
+
+    /// <summary>
+    /// Replaces the pool of REST clients. REST calls reuse these clients, and their open connections, rather than creating a client per call.
+    /// Call this before making REST calls, not whilst calls are in progress.
+    /// </summary>
+    /// <param name="size">The number of clients, each has its own connection</param>
+    /// <param name="warm">If true, calls warmRestClients()</param>
+    void setRestClientPool(const size_t size, const bool warm = true)
+    {
+      m_restPool = std::make_unique<HttpClientPool>(getApiUri(m_marketType), size);
+
+      if (warm)
+      {
+        warmRestClients();
+      }
+    }
+
+
+    /// <summary>
+    /// Sends a ping from each pooled REST client so its connection is open, avoiding the TCP connect and TLS handshake on the first orders.
+    /// Call at startup.
+    /// </summary>
+    void warmRestClients()
+    {
+      m_restPool->warm([this]
+      {
+        return createHttpRequest(web::http::methods::GET, getApiPath(m_marketType, RestCall::Ping));
+      });
+    }
+
+
+    size_t restClientPoolSize() const
+    {
+      return m_restPool->size();
+    }
+
 
 
     // --- monitor functions
@@ -178,6 +366,137 @@ namespace bfcpp
     MonitorToken monitorDiffBookDepth(const string& symbol, const string& interval, std::function<void(std::any)> onData);
 
 
+    /// <summary>
+    /// Maintains a LocalOrderBook from the Diff. Book Depth Stream. 
+    /// The orderBook() snapshot is requested when the first diff arrives and again whenever a gap in the diff sequence is detected,
+    /// so the book resyncs without intervention. The snapshot request is asynchronous, diffs which arrive whilst it is in flight
+    /// are buffered by the book.
+    /// Levels are converted from the stream straight into the book's PriceLadder, no BookDepthStream is created.
+    /// </summary>
+    /// <param name="book">The book to maintain, the symbol is taken from the book</param>
+    /// <param name="interval">See monitorDiffBookDepth()</param>
+    /// <param name="onData">Optional callback, called after each diff is applied. The any holds a LocalOrderBookStream</param>
+    /// <returns></returns>
+    MonitorToken monitorLocalOrderBook(shared_ptr<LocalOrderBook> book, const string& interval = "100ms", std::function<void(std::any)> onData = nullptr);
+
+
+
+    // --- statically typed callback overloads
+    // As the functions above but onData is any callable taking the struct by const reference, i.e. [](const MarkPriceStream& mp){}.
+    // The struct is passed directly, there is no std::any and onData is called without a std::function.
+    // Callables which take a std::any select the std::function<void(std::any)> overloads.
+
+    template<class F, class = std::enable_if_t<IsStreamCallback<F, MarkPriceStream>>>
+    MonitorToken monitorMarkPrice(F&& onData, const string& symbol = "")
+    {
+      return createCallbackMonitor<MarkPriceStream>(symbol.empty() ? "!markPrice@arr@1s" : strToLower(symbol) + "@markPrice@1s", std::forward<F>(onData));
+    }
+
+    template<class F, class = std::enable_if_t<IsStreamCallback<F, UsdFutureUserData>>>
+    MonitorToken monitorUserData(F&& onData)
+    {
+      return doMonitorUserData([this, onData = std::forward<F>(onData)](std::string_view frame, shared_ptr<WebSocketSession> session) mutable
+      {
+        if (const auto userData = handleUserData(frame); userData)
+        {
+          onData(*userData);
+        }
+      });
+    }
+
+    template<class F, class = std::enable_if_t<IsStreamCallback<F, AllMarketMiniTickerStream>>>
+    MonitorToken monitorMiniTicker(F&& onData)
+    {
+      return createCallbackMonitor<AllMarketMiniTickerStream>("!miniTicker@arr", std::forward<F>(onData));
+    }
+
+    template<class F, class = std::enable_if_t<IsStreamCallback<F, CandleStream>>>
+    MonitorToken monitorKlineCandlestickStream(const string& symbol, const string& interval, F&& onData)
+    {
+      return createCallbackMonitor<CandleStream>(strToLower(symbol) + "@kline_" + interval, std::forward<F>(onData));
+    }
+
+    template<class F, class = std::enable_if_t<IsStreamCallback<F, SymbolMiniTickerStream>>>
+    MonitorToken monitorSymbol(const string& symbol, F&& onData)
+    {
+      return createCallbackMonitor<SymbolMiniTickerStream>(strToLower(symbol) + "@miniTicker", std::forward<F>(onData));
+    }
+
+    template<class F, class = std::enable_if_t<IsStreamCallback<F, SymbolBookTickerStream>>>
+    MonitorToken monitorSymbolBookStream(const string& symbol, F&& onData)
+    {
+      return createCallbackMonitor<SymbolBookTickerStream>(strToLower(symbol) + "@bookTicker", std::forward<F>(onData));
+    }
+
+    template<class F, class = std::enable_if_t<IsStreamCallback<F, BookDepthStream>>>
+    MonitorToken monitorPartialBookDepth(const string& symbol, const string& level, const string& interval, F&& onData)
+    {
+      return createCallbackMonitor<BookDepthStream>(strToLower(symbol) + "@depth" + level + "@" + interval, std::forward<F>(onData));
+    }
+
+    template<class F, class = std::enable_if_t<IsStreamCallback<F, BookDepthStream>>>
+    MonitorToken monitorDiffBookDepth(const string& symbol, const string& interval, F&& onData)
+    {
+      return createCallbackMonitor<BookDepthStream>(strToLower(symbol) + "@depth@" + interval, std::forward<F>(onData));
+    }
+
+    template<class F, class = std::enable_if_t<IsStreamCallback<F, LocalOrderBookStream>>>
+    MonitorToken monitorLocalOrderBook(shared_ptr<LocalOrderBook> book, const string& interval, F&& onData)
+    {
+      return doMonitorLocalOrderBook(book, interval, std::forward<F>(onData));
+    }
+
+
+
+    // --- typed monitor functions
+    // As the functions above but the data is passed to the callback in typed structs (see TypedStreams.hpp) rather than in a std::any holding maps of strings.
+    // The data is only valid for the duration of the callback, copy what you need to keep.
+
+
+    /// <summary>
+    /// As monitorMarkPrice(). If symbol is set the vector has a single entry.
+    /// </summary>
+    MonitorToken monitorMarkPriceTyped(std::function<void(const vector<MarkPrice>&)> onData, const string& symbol = "");
+
+
+    /// <summary>
+    /// As monitorMiniTicker().
+    /// </summary>
+    MonitorToken monitorMiniTickerTyped(std::function<void(const vector<MiniTicker>&)> onData);
+
+
+    /// <summary>
+    /// As monitorKlineCandlestickStream().
+    /// </summary>
+    MonitorToken monitorKlineCandlestickStreamTyped(const string& symbol, const string& interval, std::function<void(const Kline&)> onData);
+
+
+    /// <summary>
+    /// As monitorSymbol().
+    /// </summary>
+    MonitorToken monitorSymbolTyped(const string& symbol, std::function<void(const MiniTicker&)> onData);
+
+
+    /// <summary>
+    /// As monitorSymbolBookStream().
+    /// </summary>
+    MonitorToken monitorSymbolBookStreamTyped(const string& symbol, std::function<void(const BookTicker&)> onData);
+
+
+
+    // --- typed monitor functions with ring delivery
+    // As the typed functions above but rather than calling a function on the receive thread, each event is written into the ring
+    // for a consumer to poll()/drain() on its own thread. A slow consumer can't stall the socket (with RingOverflow::Drop)
+    // and the receive thread doesn't call through std::function. A ring must only be used by one monitor.
+
+    MonitorToken monitorMarkPriceTyped(shared_ptr<SpscRing<vector<MarkPrice>>> ring, const string& symbol = "");
+    MonitorToken monitorMiniTickerTyped(shared_ptr<SpscRing<vector<MiniTicker>>> ring);
+    MonitorToken monitorKlineCandlestickStreamTyped(const string& symbol, const string& interval, shared_ptr<SpscRing<Kline>> ring);
+    MonitorToken monitorSymbolTyped(const string& symbol, shared_ptr<SpscRing<MiniTicker>> ring);
+    MonitorToken monitorSymbolBookStreamTyped(const string& symbol, shared_ptr<SpscRing<BookTicker>> ring);
+
+
+
     /// <summary>
     /// See See https://binance-docs.github.io/apidocs/futures/en/#long-short-ratio
     /// </summary>
@@ -240,7 +559,7 @@ namespace bfcpp
     /// 
     /// If the order is successful, the User Data Stream will be updated.
     /// 
-    /// Use the priceTransform() function to make the price value suitable.
+    /// Use the priceTransform() function or Decimal::str() to make the price value suitable.
     /// </summary>
     /// <param name="order">Order params, see link above.</param>
     /// <returns>See NewOrderResult.</returns>
@@ -257,7 +576,31 @@ namespace bfcpp
     /// <returns>The NewOrderResult in a task.</returns>
     pplx::task<NewOrderResult> newOrderAsync(map<string, string>&& order)
     {
-      return doNewOrder(std::move(order));
+      return m_orderBatching ? queueOrder(std::move(order)) : doNewOrder(std::move(order));
+    }
+
+
+    /// <summary>
+    /// As newOrder() but the query is built from the template, which only writes the params that change per order rather than
+    /// serialising every param. The template must only be used by one thread at a time, see OrderTemplate.
+    /// </summary>
+    /// <param name="order">The order's fixed params</param>
+    /// <param name="price">Omitted if zero, i.e. for MARKET orders</param>
+    /// <param name="quantity">Omitted if zero, i.e. with closePosition</param>
+    /// <param name="clientOrderId">Optional newClientOrderId</param>
+    /// <returns>See NewOrderResult.</returns>
+    NewOrderResult newOrder(OrderTemplate& order, const Decimal& price, const Decimal& quantity, std::string_view clientOrderId = {})
+    {
+      return doNewOrder(order, price, quantity, clientOrderId).get();
+    }
+
+
+    /// <summary>
+    /// As newOrder(OrderTemplate&, ...) but async. The template can be reused as soon as this returns.
+    /// </summary>
+    pplx::task<NewOrderResult> newOrderAsync(OrderTemplate& order, const Decimal& price, const Decimal& quantity, std::string_view clientOrderId = {})
+    {
+      return doNewOrder(order, price, quantity, clientOrderId);
     }
 
 
@@ -324,6 +667,9 @@ namespace bfcpp
       {
         disconnect(mt, true);
       }
+
+      std::scoped_lock lock(m_streamLatencyMux);
+      m_streamLatencies.erase(mt.id);
     }
 
 
@@ -333,6 +679,9 @@ namespace bfcpp
     void cancelMonitors()
     {
       disconnect();
+
+      std::scoped_lock lock(m_streamLatencyMux);
+      m_streamLatencies.clear();
     }
 
 
@@ -345,6 +694,7 @@ namespace bfcpp
     void setApiKeys(const ApiAccess access = {})
     {
       m_apiAccess = access;
+      m_signer = Signer{ access.secretKey };
     }
 
 
@@ -366,155 +716,696 @@ namespace bfcpp
     }
 
 
-  private:
+    /// <summary>
+    /// Sets the parser used by the stream handlers of monitors created after this call. 
+    /// StreamParser::Fast reads fields in a single pass over the frame rather than building a cpprest DOM, which matters for
+    /// the all market streams (monitorMarkPrice(), monitorMiniTicker()) where a frame has hundreds of symbols.
+    /// It is used by the monitor functions which pass maps, i.e. monitorMarkPrice() and monitorMiniTicker(). The 'Typed' monitors and
+    /// monitorLocalOrderBook() always read the frame directly. Defaults to StreamParser::Cpprest.
+    /// </summary>
+    void setStreamParser(const StreamParser parser)
+    {
+      m_streamParser = parser;
+    }
 
-    constexpr bool mustConvertStringT()
+    StreamParser streamParser() const
     {
-      return std::is_same_v<utility::string_t, MarketStringType> == false;
+      return m_streamParser;
     }
 
 
-    pplx::task<NewOrderResult> doNewOrder(map<string, string>&& order)
+    /// <summary>
+    /// Orders sent with newOrder(), newOrderAsync() and newOrderBatch() are checked by the validator before they're sent.
+    /// An order which fails isn't sent, its result is invalid with the OrderCheck in the msg. A batch fails if any of its orders fail.
+    /// Set before sending orders, nullptr to stop validating.
+    /// </summary>
+    /// <param name="validator">Keep a pointer to call setReferencePrice()</param>
+    /// <param name="round">Round prices to the tick and quantities to the step rather than failing, see OrderValidator::check()</param>
+    void setOrderValidator(shared_ptr<OrderValidator> validator, const bool round = false)
     {
-      try
-      {
-        auto handler = [](web::http::http_response response)
-        {
-          NewOrderResult result;
-
-          auto json = response.extract_json().get();
+      m_orderValidator = std::move(validator);
+      m_roundOrders = round;
+    }
 
-          getJsonValues(json, result.response, vector<string> {  "clientOrderId", "cumQty", "cumQuote", "executedQty", "orderId", "avgPrice", "origQty", "price", "reduceOnly", "side", "positionSide", "status",
-                                                              "stopPrice", "closePosition", "symbol", "timeInForce", "type", "origType", "activatePrice", "priceRate", "updateTime", "workingType", "priceProtect"});
+    shared_ptr<OrderValidator> orderValidator() const
+    {
+      return m_orderValidator;
+    }
 
-          return result;
-        };
 
-        return sendRestRequest<NewOrderResult>(RestCall::NewOrder, web::http::methods::POST, true, m_marketType, handler, receiveWindow(RestCall::NewOrder), std::move(order));
-      }
-      catch (const pplx::task_canceled tc)
-      {
-        throw BfcppDisconnectException("newOrder");
-      }
-      catch (const std::exception ex)
-      {
-        throw BfcppException(ex.what());
-      }
+    /// <summary>
+    /// This account's orders, updated from newOrder(), newOrderBatch() and cancelOrder() responses, and from the
+    /// user data stream when monitorUserData() is running. Query order status here rather than with allOrders().
+    /// </summary>
+    OrderStateCache& orderStates()
+    {
+      return m_orderStates;
     }
 
 
-    pplx::task<CancelOrderResult> doCancelOrder(map<string, string>&& order)
+    /// <summary>
+    /// This account's positions and balances, updated from the user data stream when monitorUserData() is running.
+    /// Call seedAccountState() once to load the state before the first ACCOUNT_UPDATE. Reads don't lock.
+    /// </summary>
+    AccountStateCache& accountState()
     {
-      try
-      {
-        auto handler = [](web::http::http_response response)
-        {
-          CancelOrderResult result;
+      return m_accountState;
+    }
 
-          auto json = response.extract_json().get();
-          getJsonValues(json, result.response, vector<string> {"clientOrderId", "cumQty", "cumQuote", "executedQty", "orderId", "origQty", "origType", "price", "reduceOnly", "side", "positionSide",
-                                                            "status", "stopPrice", "closePosition", "symbol", "timeInForce", "type", "activatePrice", "priceRate", "updateTime", "workingType", "priceProtect"});
 
-          return result;
-        };
+    /// <summary>
+    /// Seeds accountState() from accountInformation(). Call after monitorUserData() so no update is missed,
+    /// updates received before the response are kept if newer. Returns the account information.
+    /// </summary>
+    AccountInformation seedAccountState()
+    {
+      auto info = accountInformation();
+      m_accountState.seed(info);
+      return info;
+    }
 
-        return sendRestRequest<CancelOrderResult>(RestCall::CancelOrder, web::http::methods::DEL, true, m_marketType, handler, receiveWindow(RestCall::CancelOrder), std::move(order));
-      }
-      catch (const pplx::task_canceled tc)
-      {
-        throw BfcppDisconnectException("cancelOrder");
-      }
-      catch (const std::exception ex)
-      {
-        throw BfcppException(ex.what());
-      }
+
+    /// <summary>
+    /// Traces each order from the newOrder(), newOrderAsync() or newOrderBatch() call to its ORDER_TRADE_UPDATE events on the user data stream,
+    /// recording the latency of each stage in orderLatency(). An order sent without a newClientOrderId is given one.
+    /// monitorUserData() must be running for the stream stages.
+    /// </summary>
+    void setOrderLatencyTracing(const bool trace)
+    {
+      m_orderLatencyTracing = trace;
     }
 
+    bool orderLatencyTracing() const
+    {
+      return m_orderLatencyTracing;
+    }
 
-    pplx::task<NewOrderBatchResult> doNewOrderBatch(vector<map<string, string>>&& orders)
+    OrderLatencyTracer& orderLatency()
     {
-      try
-      {
-        auto handler = [](web::http::http_response response)
-        {
-          NewOrderBatchResult result;
+      return m_orderLatency;
+    }
 
-          auto json = response.extract_json().get();
 
-          for (auto& order : json.as_array())
-          {
-            map<string, string> orderValues;
-            getJsonValues(order, orderValues, vector<string> {  "clientOrderId", "cumQty", "cumQuote", "executedQty", "orderId", "avgPrice", "origQty", "price", "reduceOnly", "side", "positionSide", "status",
-                                                              "stopPrice", "closePosition", "symbol", "timeInForce", "type", "origType", "activatePrice", "priceRate", "updateTime", "workingType", "priceProtect"});
+    /// <summary>
+    /// Times each part of every REST call (see RestCallTimings) and records them per RestCall in restStatistics().
+    /// The clock sync's server time requests are not included.
+    /// </summary>
+    void setRestTiming(const bool timed)
+    {
+      m_restTiming = timed;
+    }
 
-            result.response.emplace_back(std::move(orderValues));
-          }
+    bool restTiming() const
+    {
+      return m_restTiming;
+    }
 
-          return result;
-        };
+    RestCallStatistics& restStatistics()
+    {
+      return *m_restStatistics;
+    }
 
 
-        // convert the vector of orders to single JSON string and create the query string from that
-        const static map<string, web::json::value::value_type> NonStringTypes = { {"orderId", web::json::value::Number}, {"reduceOnly", web::json::value::Boolean},
-                                                                                  {"updateTime", web::json::value::Number}, {"priceProtect", web::json::value::Boolean}
-                                                                                };
+    /// <summary>
+    /// Records every frame received on the WebSocket streams, including the user data stream, with its stream's URI and receive time,
+    /// to files in options.directory. See FrameRecorder, FrameRecorder::read() reads the files.
+    /// Replaces a recording already running. Throws BfcppException if the directory or file can't be created.
+    /// </summary>
+    void startFrameRecording(const FrameRecorder::Options& options = {})
+    {
+      auto recorder = std::make_shared<FrameRecorder>(options);
 
-        web::json::value list = web::json::value::array();
-        size_t i = 0;
+      if (auto previous = std::atomic_exchange(&m_frameRecorder, std::move(recorder)); previous)
+      {
+        previous->stop();
+      }
 
-        for (auto& order : orders)
-        {
-          auto entry = list.object();
-          
-          for (auto& pair : order)
-          {
-            auto key = utility::conversions::to_string_t(pair.first);
+      m_frameRecording = true;
+    }
 
-            if (auto typeEntry = NonStringTypes.find(pair.first); typeEntry == NonStringTypes.end())
-            {
-              entry[key] = web::json::value::string(utility::conversions::to_string_t(pair.second));
-            }
-            else
-            {
-              if (typeEntry->second == web::json::value::Number)
-              {
-                entry[key] = web::json::value::number(static_cast<int64_t>(std::stoll(utility::conversions::to_string_t(pair.second)))); // TODO confirm long long correct
-              }
-              else if (typeEntry->second == web::json::value::Boolean)
-              {
-                entry[key] = web::json::value::boolean(pair.second == "true" || pair.second == "TRUE");
-              }
-            }
-          }
+    /// <summary>
+    /// Writes the frames not yet written and closes the file.
+    /// </summary>
+    void stopFrameRecording()
+    {
+      m_frameRecording = false;
+
+      if (auto recorder = std::atomic_exchange(&m_frameRecorder, shared_ptr<FrameRecorder>{}); recorder)
+      {
+        recorder->stop();
+      }
+    }
+
+    /// <summary>
+    /// The current recording, or null if not recording.
+    /// </summary>
+    shared_ptr<FrameRecorder> frameRecorder() const
+    {
+      return std::atomic_load(&m_frameRecorder);
+    }
+
+
+    /// <summary>
+    /// Sets the registry used by the 'Typed' monitor functions created after this call to set each event's symbolId,
+    /// so per symbol data can be looked up by index rather than by name. Create with SymbolRegistry(exchangeInfo()).
+    /// </summary>
+    void setSymbolRegistry(shared_ptr<const SymbolRegistry> registry)
+    {
+      m_symbolRegistry = registry;
+    }
+
+    shared_ptr<const SymbolRegistry> symbolRegistry() const
+    {
+      return m_symbolRegistry;
+    }
+
+
+    /// <summary>
+    /// Tracks REST request weight and order counts against the exchange's limits, see RateLimitGovernor. 
+    /// Limits are updated when exchangeInfo() is called. By default usage is only tracked, use setMode() to queue requests
+    /// or throw BfcppRateLimitException when a request would breach a limit.
+    /// </summary>
+    RateLimitGovernor& rateLimits()
+    {
+      return m_rateLimits;
+    }
+
+
+    /// <summary>
+    /// When enabled, orders sent with newOrderAsync(map) are held for up to 'window' after the first arrives, or until OrderBatcher::MaxBatchOrders
+    /// are held, then sent in one batchOrders request. Each order's task gets its own entry from the batch response, so callers are unchanged.
+    /// A lone order is sent with newOrder, so batching only adds the window's latency when orders aren't concurrent.
+    /// 
+    /// A batch costs 5 request weight and one order count per order, rather than one order count per order and a request each.
+    /// Disabled by default. Disabling sends any held orders before returning.
+    /// </summary>
+    /// <param name="enable">true to batch orders</param>
+    /// <param name="window">How long the first order in a batch waits for others</param>
+    void setOrderBatching(const bool enable, const std::chrono::microseconds window = DefaultOrderBatchWindow);
+
+
+    bool orderBatching() const
+    {
+      return m_orderBatching;
+    }
+
+
+    /// <summary>
+    /// When enabled, monitors created after this call share connections to the combined stream endpoint (/stream) rather than
+    /// each opening a connection. Streams are added and removed with SUBSCRIBE/UNSUBSCRIBE, each frame is routed to its monitors by the "stream" field.
+    /// A connection carries up to 'streamsPerConnection' streams, after which another connection is opened.
+    /// 
+    /// Monitors still return a MonitorToken each, cancelMonitor() unsubscribes the stream and closes the connection when it has no streams.
+    /// monitorUserData() always has its own connection.
+    /// </summary>
+    /// <param name="combined">true to use combined streams</param>
+    /// <param name="streamsPerConnection">Binance allows 200 streams per connection</param>
+    void setCombinedStreams(const bool combined, const size_t streamsPerConnection = MaxStreamsPerConnection)
+    {
+      if (streamsPerConnection == 0 || streamsPerConnection > MaxStreamsPerConnection)
+      {
+        throw BfcppException{ BFCPP_FUNCTION_MSG(" streamsPerConnection must be 1 to " + std::to_string(MaxStreamsPerConnection)) };
+      }
+
+      m_combinedStreams = combined;
+      m_streamsPerConnection = streamsPerConnection;
+    }
+
+
+    bool combinedStreams() const
+    {
+      return m_combinedStreams;
+    }
+
+
+    /// <summary>
+    /// When enabled, monitors created after this call record the latency of each frame, from the exchange's event time to the callback returning,
+    /// see StreamLatency. Read with streamLatencySnapshot().
+    /// </summary>
+    void setStreamLatencyTracking(const bool track)
+    {
+      m_streamLatencyTracking = track;
+    }
+
+
+    bool streamLatencyTracking() const
+    {
+      return m_streamLatencyTracking;
+    }
+
+
+    /// <summary>
+    /// The latencies of each monitor created whilst tracking was enabled. If 'reset' is true the histograms are cleared as they're read,
+    /// so each snapshot covers the time since the previous.
+    /// </summary>
+    vector<StreamLatencySummary> streamLatencySnapshot(const bool reset = false)
+    {
+      std::scoped_lock lock(m_streamLatencyMux);
+
+      vector<StreamLatencySummary> summaries;
+      summaries.reserve(m_streamLatencies.size());
+
+      for (auto& [id, latency] : m_streamLatencies)
+      {
+        summaries.emplace_back(latency->summary(id));
+
+        if (reset)
+          latency->reset();
+      }
+
+      return summaries;
+    }
+
+
+    /// <summary>
+    /// The monitor's histograms, for other percentiles. nullptr if the monitor isn't tracked.
+    /// </summary>
+    shared_ptr<const StreamLatency> streamLatency(const MonitorToken& mt) const
+    {
+      std::scoped_lock lock(m_streamLatencyMux);
+
+      auto it = m_streamLatencies.find(mt.id);
+      return it == m_streamLatencies.cend() ? nullptr : it->second;
+    }
+
+
+    void resetStreamLatency()
+    {
+      std::scoped_lock lock(m_streamLatencyMux);
+
+      for (auto& [id, latency] : m_streamLatencies)
+        latency->reset();
+    }
+
+
+    /// <summary>
+    /// Sets how monitors reconnect when their connection is closed or stale. A reconnected monitor keeps its MonitorToken.
+    /// The user data stream creates a new listen key when reconnecting.
+    /// Reconnecting is enabled by default, see ReconnectPolicy.
+    /// </summary>
+    void setReconnectPolicy(const ReconnectPolicy& policy)
+    {
+      std::scoped_lock lock(m_supervisorMux);
+      m_reconnectPolicy = policy;
+    }
+
+
+    ReconnectPolicy reconnectPolicy() const
+    {
+      std::scoped_lock lock(m_supervisorMux);
+      return m_reconnectPolicy;
+    }
+
+
+    /// <summary>
+    /// Called when a monitor's connection is lost, when it reconnects, and if reconnecting is abandoned. See StreamGap.
+    /// Called from the monitor's receive thread. Set before creating monitors.
+    /// monitorLocalOrderBook() resets its book when disconnected, it is resynced from a new snapshot after reconnecting.
+    /// </summary>
+    void setStreamGapHandler(std::function<void(const StreamGap&)> onGap)
+    {
+      m_onStreamGap = onGap;
+    }
+
+
+  private:
+
+    constexpr bool mustConvertStringT()
+    {
+      return std::is_same_v<utility::string_t, MarketStringType> == false;
+    }
+
+
+    // updates m_orderStates from a newOrder or cancelOrder response
+    template<class ResultT>
+    std::function<ResultT(ResultT)> trackOrder()
+    {
+      return [this](ResultT result)
+      {
+        if (result.valid())
+        {
+          m_orderStates.onOrderResponse(result.response);
+        }
+
+        return result;
+      };
+    }
+
+
+    OrderCheck validateOrder(map<string, string>& order) const
+    {
+      return m_orderValidator ? m_orderValidator->check(order, m_roundOrders) : OrderCheck::Valid;
+    }
+
+
+    static string validationFailure(const OrderCheck check)
+    {
+      return string{ "order failed validation: " } + toString(check);
+    }
+
+
+    // the order's newClientOrderId, set to a generated id if not set, so the order can be traced on the user data stream
+    string tracedClientOrderId(map<string, string>& order)
+    {
+      auto& clientOrderId = order["newClientOrderId"];
+
+      if (clientOrderId.empty())
+      {
+        clientOrderId = m_orderLatency.nextClientOrderId();
+      }
+
+      return clientOrderId;
+    }
+
+
+    // records the orders as sent, then their REST acknowledgements
+    template<class ResultT>
+    pplx::task<ResultT> traceOrders(vector<string>&& clientOrderIds, pplx::task<ResultT>&& sent)
+    {
+      const auto sentAt = OrderLatencyTracer::Clock::now();
+
+      for (const auto& clientOrderId : clientOrderIds)
+        m_orderLatency.onSent(clientOrderId, sentAt);
+
+      return sent.then([this, clientOrderIds = std::move(clientOrderIds)](pplx::task<ResultT> response)
+      {
+        ResultT result;
+
+        try
+        {
+          result = response.get();
+        }
+        catch (const std::exception&)
+        {
+          // the request failed without a response
+          for (const auto& clientOrderId : clientOrderIds)
+            m_orderLatency.abandon(clientOrderId);
+
+          throw;
+        }
+
+        const auto received = OrderLatencyTracer::Clock::now();
+
+        if constexpr (std::is_same_v<ResultT, NewOrderBatchResult>)
+        {
+          // a batch's entries are in order, a rejected entry has a code rather than an orderId
+          for (size_t i = 0; i < clientOrderIds.size(); ++i)
+            m_orderLatency.onRestAck(clientOrderIds[i], result.valid() && i < result.response.size() && result.response[i].count("orderId"), received);
+        }
+        else
+        {
+          m_orderLatency.onRestAck(clientOrderIds[0], result.valid(), received);
+        }
+
+        return result;
+      });
+    }
+
+
+    pplx::task<NewOrderResult> doNewOrder(map<string, string>&& order)
+    {
+      const bool trace = m_orderLatencyTracing;
+      const auto start = trace || m_restTiming ? OrderLatencyTracer::Clock::now() : OrderLatencyTracer::Clock::time_point{};
+
+      if (const auto check = validateOrder(order); check != OrderCheck::Valid)
+      {
+        return pplx::task_from_result(createInvalidRestResult<NewOrderResult>(validationFailure(check)));
+      }
+
+      try
+      {
+        if (trace)
+        {
+          vector<string> clientOrderIds{ tracedClientOrderId(order) };
+
+          auto query = buildQueryString(std::move(order), true, receiveWindow(RestCall::NewOrder));
+          const auto built = OrderLatencyTracer::Clock::now();
+          signQueryString(query);
+
+          m_orderLatency.begin(clientOrderIds[0], start, built, OrderLatencyTracer::Clock::now());
+          OrderLatencyTracer::TraceGuard guard{ m_orderLatency, clientOrderIds };
+
+          auto sent = sendRestQuery<NewOrderResult>(RestCall::NewOrder, web::http::methods::POST, m_marketType, readNewOrderResult<NewOrderResult>, query, start);
+          guard.release();
 
-          list[i++] = std::move(entry);
+          return traceOrders(std::move(clientOrderIds), std::move(sent)).then(trackOrder<NewOrderResult>());
         }
 
-        map<string, string> query;
-        query["batchOrders"] = utility::conversions::to_utf8string(web::http::uri::encode_data_string(list.serialize()));
+        return sendRestRequest<NewOrderResult>(RestCall::NewOrder, web::http::methods::POST, true, m_marketType, readNewOrderResult<NewOrderResult>, receiveWindow(RestCall::NewOrder), std::move(order)).then(trackOrder<NewOrderResult>());
+      }
+      catch (const pplx::task_canceled& tc)
+      {
+        throw BfcppDisconnectException("newOrder");
+      }
+      catch (const BfcppException&)
+      {
+        throw;
+      }
+      catch (const std::exception& ex)
+      {
+        throw BfcppException(ex.what());
+      }
+    }
+
+
+    pplx::task<NewOrderResult> doNewOrder(OrderTemplate& order, const Decimal& price, const Decimal& quantity, std::string_view clientOrderId)
+    {
+      const bool trace = m_orderLatencyTracing;
+      const auto start = trace || m_restTiming ? OrderLatencyTracer::Clock::now() : OrderLatencyTracer::Clock::time_point{};
+
+      Decimal orderPrice = price, orderQuantity = quantity;
 
-        return sendRestRequest<NewOrderBatchResult>(RestCall::NewBatchOrder, web::http::methods::POST, true, m_marketType, handler, receiveWindow(RestCall::NewBatchOrder), std::move(query));
+      if (m_orderValidator)
+      {
+        if (const auto check = m_orderValidator->check(order.symbol(), order.buy(), order.market(), order.reduceOnly(), orderPrice, orderQuantity, m_roundOrders); check != OrderCheck::Valid)
+        {
+          return pplx::task_from_result(createInvalidRestResult<NewOrderResult>(validationFailure(check)));
+        }
       }
-      catch (const pplx::task_canceled tc)
+
+      try
+      {
+        if (trace)
+        {
+          vector<string> clientOrderIds{ clientOrderId.empty() ? m_orderLatency.nextClientOrderId() : string{ clientOrderId } };
+
+          order.build(orderPrice, orderQuantity, clientOrderIds[0], receiveWindow(RestCall::NewOrder), m_clockSync.timestamp());
+          const auto built = OrderLatencyTracer::Clock::now();
+          auto query = order.sign(m_signer);
+
+          m_orderLatency.begin(clientOrderIds[0], start, built, OrderLatencyTracer::Clock::now());
+          OrderLatencyTracer::TraceGuard guard{ m_orderLatency, clientOrderIds };
+
+          auto sent = sendRestQuery<NewOrderResult>(RestCall::NewOrder, web::http::methods::POST, m_marketType, readNewOrderResult<NewOrderResult>, query, start);
+          guard.release();
+
+          return traceOrders(std::move(clientOrderIds), std::move(sent)).then(trackOrder<NewOrderResult>());
+        }
+
+        auto query = order.build(orderPrice, orderQuantity, clientOrderId, receiveWindow(RestCall::NewOrder), m_clockSync.timestamp(), m_signer);
+
+        return sendRestQuery<NewOrderResult>(RestCall::NewOrder, web::http::methods::POST, m_marketType, readNewOrderResult<NewOrderResult>, query, start).then(trackOrder<NewOrderResult>());
+      }
+      catch (const pplx::task_canceled& tc)
+      {
+        throw BfcppDisconnectException("newOrder");
+      }
+      catch (const BfcppException&)
+      {
+        throw;
+      }
+      catch (const std::exception& ex)
+      {
+        throw BfcppException(ex.what());
+      }
+    }
+
+
+    pplx::task<CancelOrderResult> doCancelOrder(map<string, string>&& order)
+    {
+      try
+      {
+        auto handler = [](web::http::http_response response)
+        {
+          CancelOrderResult result;
+
+          auto json = response.extract_json().get();
+          getJsonValues(json, result.response, vector<string> {"clientOrderId", "cumQty", "cumQuote", "executedQty", "orderId", "origQty", "origType", "price", "reduceOnly", "side", "positionSide",
+                                                            "status", "stopPrice", "closePosition", "symbol", "timeInForce", "type", "activatePrice", "priceRate", "updateTime", "workingType", "priceProtect"});
+
+          return result;
+        };
+
+        return sendRestRequest<CancelOrderResult>(RestCall::CancelOrder, web::http::methods::DEL, true, m_marketType, handler, receiveWindow(RestCall::CancelOrder), std::move(order)).then(trackOrder<CancelOrderResult>());
+      }
+      catch (const pplx::task_canceled& tc)
+      {
+        throw BfcppDisconnectException("cancelOrder");
+      }
+      catch (const BfcppException&)
+      {
+        throw;
+      }
+      catch (const std::exception& ex)
+      {
+        throw BfcppException(ex.what());
+      }
+    }
+
+
+    pplx::task<NewOrderResult> queueOrder(map<string, string>&& order);
+
+
+    pplx::task<NewOrderBatchResult> doNewOrderBatch(vector<map<string, string>>&& orders)
+    {
+      const bool trace = m_orderLatencyTracing;
+      const auto start = trace || m_restTiming ? OrderLatencyTracer::Clock::now() : OrderLatencyTracer::Clock::time_point{};
+
+      for (size_t i = 0; i < orders.size(); ++i)
+      {
+        if (const auto check = validateOrder(orders[i]); check != OrderCheck::Valid)
+        {
+          return pplx::task_from_result(createInvalidRestResult<NewOrderBatchResult>(validationFailure(check) + " (order " + std::to_string(i) + ")"));
+        }
+      }
+
+      try
+      {
+        vector<string> clientOrderIds;
+
+        if (trace)
+        {
+          for (auto& order : orders)
+            clientOrderIds.emplace_back(tracedClientOrderId(order));
+        }
+
+
+        auto queryString = buildQueryString(createBatchOrdersQuery(orders), true, receiveWindow(RestCall::NewBatchOrder));
+        const auto built = trace ? OrderLatencyTracer::Clock::now() : OrderLatencyTracer::Clock::time_point{};
+        signQueryString(queryString);
+
+        if (trace)
+        {
+          const auto signedAt = OrderLatencyTracer::Clock::now();
+
+          for (const auto& clientOrderId : clientOrderIds)
+            m_orderLatency.begin(clientOrderId, start, built, signedAt);
+        }
+
+        // holds no ids when not tracing
+        OrderLatencyTracer::TraceGuard guard{ m_orderLatency, clientOrderIds };
+
+        auto sent = sendRestQuery<NewOrderBatchResult>(RestCall::NewBatchOrder, web::http::methods::POST, m_marketType, readNewOrderBatchResult<NewOrderBatchResult>, queryString, start);
+        guard.release();
+
+        if (trace)
+        {
+          sent = traceOrders(std::move(clientOrderIds), std::move(sent));
+        }
+
+        return sent.then([this](NewOrderBatchResult result)
+        {
+          if (result.valid())
+          {
+            for (const auto& order : result.response)
+              m_orderStates.onOrderResponse(order);
+          }
+
+          return result;
+        });
+      }
+      catch (const pplx::task_canceled& tc)
+      {
+        throw BfcppDisconnectException("doNewOrderBatch");
+      }
+      catch (const BfcppException&)
+      {
+        throw;
+      }
+      catch (const std::exception& ex)
+      {
+        throw BfcppException(ex.what());
+      }
+    }
+
+
+    // read a frame into the struct passed to the monitor's callback
+    static void readStream(const StreamParser parser, fastjson::Document& doc, std::string_view frame, AllMarketMiniTickerStream& mtt);
+    static void readStream(const StreamParser parser, fastjson::Document& doc, std::string_view frame, CandleStream& cs);
+    static void readStream(const StreamParser parser, fastjson::Document& doc, std::string_view frame, SymbolMiniTickerStream& symbol);
+    static void readStream(const StreamParser parser, fastjson::Document& doc, std::string_view frame, SymbolBookTickerStream& symbol);
+    static void readStream(const StreamParser parser, fastjson::Document& doc, std::string_view frame, MarkPriceStream& mp);
+    static void readStream(const StreamParser parser, fastjson::Document& doc, std::string_view frame, BookDepthStream& result);
+    static UsdFutureUserData readUserData(web::json::value&& jsonVal);
+
+
+    /// <summary>
+    /// Creates a monitor which reads each frame into a Stream then calls onData(Stream&). onData is held by the handler
+    /// as its own type, so the call is direct.
+    /// </summary>
+    template<class Stream, class F>
+    MonitorToken createCallbackMonitor(const string& stream, F&& onData)
+    {
+      auto handler = [onData = std::forward<F>(onData), parser = m_streamParser, doc = std::make_shared<fastjson::Document>()](std::string_view frame, shared_ptr<WebSocketSession> session) mutable
+      {
+        Stream data;
+        readStream(parser, *doc, frame, data);
+        StreamLatency::parsed();
+
+        onData(data);
+      };
+
+      return std::get<0>(createMonitor(stream, handler));
+    }
+
+
+    // adapts a std::any callback for createCallbackMonitor(), the Stream is moved into the any
+    template<class Stream>
+    static auto anyCallback(std::function<void(std::any)> onData)
+    {
+      return [onData = std::move(onData)](Stream& data) { onData(std::any{ std::move(data) }); };
+    }
+
+
+    MonitorToken doMonitorUserData(StreamHandler handler);
+
+
+    template<class F>
+    MonitorToken doMonitorLocalOrderBook(shared_ptr<LocalOrderBook> book, const string& interval, F&& onData)
+    {
+      if (book == nullptr)
       {
-        throw BfcppDisconnectException("doNewOrderBatch");
+        throw BfcppException{ BFCPP_FUNCTION_MSG(" book is null") };
       }
-      catch (const std::exception ex)
+
+      auto handler = [this, book, onData = std::forward<F>(onData), diff = std::make_shared<BookDepthDiff>(), doc = std::make_shared<fastjson::Document>(),
+                      snapshotPending = std::make_shared<std::atomic_bool>(false)](std::string_view frame, shared_ptr<WebSocketSession> session) mutable
       {
-        throw BfcppException(ex.what());
-      }
+        LocalOrderBookStream update;
+
+        if (updateLocalOrderBook(book, *diff, *doc, snapshotPending, frame, update))
+        {
+          StreamLatency::parsed();
+
+          onData(update);
+        }
+      };
+
+      return createLocalOrderBookMonitor(book, interval, handler);
     }
 
 
-    MonitorToken doMonitorBookDepth(const string& symbol, const string& level, const string& interval, std::function<void(std::any)> onData);
+    MonitorToken createLocalOrderBookMonitor(shared_ptr<LocalOrderBook> book, const string& interval, StreamHandler handler);
+    bool updateLocalOrderBook(shared_ptr<LocalOrderBook> book, BookDepthDiff& diff, fastjson::Document& doc, shared_ptr<std::atomic_bool> snapshotPending, std::string_view frame, LocalOrderBookStream& update);
+    void syncLocalOrderBook(shared_ptr<LocalOrderBook> book, shared_ptr<std::atomic_bool> snapshotPending);
+    pplx::task<OrderBook> doOrderBook(map<string, string>&& query);
 
 
     void onUserDataTimer()
     {
       auto request = createHttpRequest(web::http::methods::PUT, getApiPath(m_marketType, RestCall::ListenKey));
 
-      web::http::client::http_client client{ web::uri{utility::conversions::to_string_t(getApiUri(m_marketType))} };
-      client.request(std::move(request)).then([this](web::http::http_response response)
+      restClient().request(std::move(request)).then([this](web::http::http_response response)
       {
         if (response.status_code() != web::http::status_codes::OK)
         {
@@ -524,57 +1415,13 @@ namespace bfcpp
     }
 
 
-    void handleUserDataStream(shared_ptr<WebSocketSession> session, std::function<void(UsdFutureUserData)> onData)
-    {
-      try
-      {
-        while (!session->getCancelToken().is_canceled())
-        {
-          session->client.receive().then([=, token = session->getCancelToken()](pplx::task<ws::client::websocket_incoming_message> websocketInMessage)
-          {
-            if (!token.is_canceled())
-            {
-              std::string strMsg;
-              websocketInMessage.get().extract_string().then([=, &strMsg, cancelToken = session->getCancelToken()](pplx::task<std::string> str_tsk)
-              {
-                if (!cancelToken.is_canceled())
-                {
-                  strMsg = str_tsk.get();
-                }
-              }, token).wait();
-
-
-              if (!strMsg.empty())
-              {
-                std::error_code errCode;
-                if (auto json = web::json::value::parse(strMsg, errCode); errCode.value() == 0)
-                {
-                  extractUsdFuturesUserData(session, std::move(json));
-                }
-              }
-            }
-          }, session->getCancelToken()).wait();
-        }
-      }
-      catch (pplx::task_canceled)
-      {
-        throw BfcppDisconnectException(session->uri);
-      }
-      catch (std::exception ex)
-      {
-        throw;
-      }
-    }
-
-
-    void extractUsdFuturesUserData(shared_ptr<WebSocketSession> session, web::json::value&& jsonVal);
-  
-
     void disconnect(const MonitorToken& mt, const bool deleteSession);
     void disconnect();
 
 
     bool createListenKey(const MarketType marketType);
+    std::optional<UsdFutureUserData> handleUserData(std::string_view frame);
+    pplx::task<ListenKey> requestListenKey(const MarketType marketType);
 
 
     shared_ptr<WebSocketSession> connect(const string& uri)
@@ -590,7 +1437,11 @@ namespace bfcpp
           session->connected = true;
         }).wait();
       }
-      catch (const std::exception ex)
+      catch (const BfcppException&)
+      {
+        throw;
+      }
+      catch (const std::exception& ex)
       {
         throw BfcppException(ex.what());
       }
@@ -599,11 +1450,48 @@ namespace bfcpp
     }
 
 
-    std::tuple<MonitorToken, shared_ptr<WebSocketSession>> createMonitor(const string& uri, std::function<void(ws::client::websocket_incoming_message, shared_ptr<WebSocketSession>)> handler)
+    // wraps the handler to record its frames' latencies when tracking is enabled, 'latency' is set to the monitor's histograms
+    StreamHandler trackStreamLatency(const string& stream, StreamHandler handler, shared_ptr<StreamLatency>& latency)
+    {
+      if (!m_streamLatencyTracking)
+      {
+        return handler;
+      }
+
+      latency = std::make_shared<StreamLatency>(stream);
+
+      return [this, latency, handler](std::string_view frame, shared_ptr<WebSocketSession> session)
+      {
+        latency->handle(handler, frame, session, m_clockSync.offset());
+      };
+    }
+
+
+    void addStreamLatency(const MonitorToken& mt, shared_ptr<StreamLatency> latency)
     {
+      if (latency && mt.isValid())
+      {
+        std::scoped_lock lock(m_streamLatencyMux);
+        m_streamLatencies[mt.id] = std::move(latency);
+      }
+    }
+
+
+    std::tuple<MonitorToken, shared_ptr<WebSocketSession>> createMonitor(const string& stream, StreamHandler handler)
+    {
+      shared_ptr<StreamLatency> latency;
+      handler = trackStreamLatency(stream, std::move(handler), latency);
+
+      if (m_combinedStreams)
+      {
+        auto tokenAndSession = createCombinedMonitor(stream, handler);
+        addStreamLatency(std::get<0>(tokenAndSession), latency);
+        return tokenAndSession;
+      }
+
       std::tuple<MonitorToken, shared_ptr<WebSocketSession>> tokenAndSession;
 
-      if (shared_ptr<WebSocketSession> session = connect(uri); session)
+      if (shared_ptr<WebSocketSession> session = connect(m_exchangeBaseUri + "/ws/" + stream); session)
       {
         if (MonitorToken monitor = createReceiveTask(session, handler);  monitor.isValid())
         {
@@ -616,59 +1504,106 @@ namespace bfcpp
         }
       }
 
+      addStreamLatency(std::get<0>(tokenAndSession), latency);
       return tokenAndSession;
     }
 
 
-    MonitorToken createReceiveTask(shared_ptr<WebSocketSession> session, std::function<void(ws::client::websocket_incoming_message, shared_ptr<WebSocketSession>)> extractFunc)
+    /// <summary>
+    /// Creates a monitor which reads each frame directly into the ring's next slot.
+    /// </summary>
+    template<class T>
+    MonitorToken createRingMonitor(const string& stream, shared_ptr<SpscRing<T>> ring)
     {
-      MonitorToken monitorToken;
-
-      auto token = session->getCancelToken();
-      monitorToken.id = m_monitorId++;
+      if (ring == nullptr)
+      {
+        throw BfcppException{ BFCPP_FUNCTION_MSG(" ring null") };
+      }
 
-      session->receiveTask = pplx::create_task([session, token, extractFunc, mt = monitorToken.id, this]
+      auto handler = [ring, registry = m_symbolRegistry, doc = std::make_shared<fastjson::Document>()](std::string_view frame, shared_ptr<WebSocketSession> session)
       {
-        try
+        ring->publish([&](T& event)
         {
-          while (!token.is_canceled())
+          if constexpr (std::is_trivially_copyable_v<T>)
           {
-            session->client.receive().then([=](pplx::task<ws::client::websocket_incoming_message> websocketInMessage)
-            {
-              if (!token.is_canceled())
-              {
-                try
-                {                  
-                  if (auto msg = websocketInMessage.get(); msg.message_type() == ws::client::websocket_message_type::text_message)
-                  {
-                    extractFunc(msg, session);
-                  }
-                }
-                catch (const std::exception ex)
-                {
-                  throw BfcppException(ex.what());
-                }                
-              }
-            }, token).wait();
+            event = T{};  // vectors are cleared by readFrame(), keeping their capacity
           }
-        }
-        catch (pplx::task_canceled)
-        {
-          throw BfcppDisconnectException(session->uri);
-        }
-        catch (const std::exception ex)
-        {
-          pplx::cancel_current_task();
-        }
-      }, token);
+
+          typedjson::readFrame(*doc, frame, event, registry.get());
+          StreamLatency::parsed();
+        },
+        session->getCancelToken());
+      };
+
+      return std::get<0>(createMonitor(stream, handler));
+    }
+
+
+    std::tuple<MonitorToken, shared_ptr<WebSocketSession>> createCombinedMonitor(const string& stream, StreamHandler handler);
+    void removeCombinedSubscription(shared_ptr<CombinedStreamConnection> connection, shared_ptr<WebSocketSession> session);
+    void closeCombinedConnection(CombinedStreamConnection& connection);
+
+
+    /// <summary>
+    /// Starts receiving on the session. Receiving is a chain of continuations, each receive() schedules the next, so sessions
+    /// don't hold a thread whilst waiting for data. The session's receiveTask completes when the chain ends.
+    /// </summary>
+    MonitorToken createReceiveTask(shared_ptr<WebSocketSession> session, StreamHandler extractFunc)
+    {
+      MonitorToken monitorToken;
+      monitorToken.id = m_monitorId++;
+
+      pplx::task_completion_event<void> receiveEnded;
+      session->receiveTask = pplx::create_task(receiveEnded);
+
+      supervise(session);
+      receive(session, extractFunc, receiveEnded);
 
       return monitorToken;
     }
 
 
+    void receive(shared_ptr<WebSocketSession> session, StreamHandler extractFunc, pplx::task_completion_event<void> receiveEnded);
+    void connectionLost(shared_ptr<WebSocketSession> session, StreamHandler extractFunc, pplx::task_completion_event<void> receiveEnded);
+
+
+    // a reconnect waiting for its backoff delay, run by the supervisor
+    struct PendingReconnect
+    {
+      shared_ptr<WebSocketSession> session;
+      StreamHandler extractFunc;
+      pplx::task_completion_event<void> receiveEnded;
+      StreamGap gap;
+      std::chrono::duration<double, std::milli> delay;
+      std::chrono::steady_clock::time_point due;
+    };
+
+    void scheduleReconnect(PendingReconnect&& pending);
+    void reconnect(PendingReconnect pending);
+    void supervise(shared_ptr<WebSocketSession> session);
+    void onSupervisorTimer();
+    void notifyStreamGap(const StreamGap& gap);
+
+
 protected:
 
     string createQueryString(map<string, string>&& queryValues, const RestCall call, const bool sign, const string& rcvWindow)
+    {
+      auto qs = buildQueryString(std::move(queryValues), sign, rcvWindow);
+
+      if (sign)
+      {
+        signQueryString(qs);
+      }
+
+      return qs;
+    }
+
+
+    /// <summary>
+    /// As createQueryString() but not signed, so with 'sign' true signQueryString() must be called.
+    /// </summary>
+    string buildQueryString(map<string, string>&& queryValues, const bool sign, const string& rcvWindow)
     {
       stringstream ss;
 
@@ -680,15 +1615,25 @@ protected:
 
       if (sign)
       {
-        ss << "recvWindow=" << rcvWindow << "&timestamp=" << getTimestamp();
-
-        string qs = ss.str();
-        return qs + "&signature=" + (createSignature(m_apiAccess.secretKey, qs));
-      }
-      else
-      {
-        return ss.str();
+        ss << "recvWindow=" << rcvWindow << "&timestamp=" << m_clockSync.timestamp();
       }
+
+      return ss.str();
+    }
+
+
+    void signQueryString(string& qs)
+    {
+      char signature[Signer::SignatureLength];
+      m_signer.sign(qs, signature);
+
+      qs.append("&signature=").append(signature, Signer::SignatureLength);
+    }
+
+
+    web::http::client::http_client& restClient()
+    {
+      return m_restPool->client();
     }
 
 
@@ -705,38 +1650,191 @@ protected:
 
     template<class RestResultT>
     pplx::task<RestResultT> sendRestRequest(const RestCall call, const web::http::method method, const bool sign, const MarketType mt, std::function<RestResultT(web::http::http_response)> handler, const string& rcvWindow, map<string, string>&& query = {})
+    {
+      const auto start = isRestTimed<RestResultT>() ? RestCallStatistics::Clock::now() : RestCallStatistics::Clock::time_point{};
+
+      return sendRestQuery<RestResultT>(call, method, mt, handler, createQueryString(std::move(query), call, true, rcvWindow), start);
+    }
+
+
+    /// <summary>
+    /// As sendRestRequest() with the query string already built (and signed, if required).
+    /// If timed, 'start' is when building the query string began, otherwise the query's build time is not included.
+    /// </summary>
+    template<class RestResultT>
+    pplx::task<RestResultT> sendRestQuery(const RestCall call, const web::http::method method, const MarketType mt, std::function<RestResultT(web::http::http_response)> handler, std::string_view queryString,
+                                          RestCallStatistics::Clock::time_point start = {})
     {
       try
       {
-        string queryString{ createQueryString(std::move(query), call, true, rcvWindow) };
+        const bool timed = isRestTimed<RestResultT>();
+
+        if (timed && start == RestCallStatistics::Clock::time_point{})
+        {
+          start = RestCallStatistics::Clock::now();
+        }
 
-        auto request = createHttpRequest(method, getApiPath(mt, call) + "?" + queryString);
+        const auto& path = getApiPath(mt, call);
 
-        web::http::client::http_client client{ web::uri { utility::conversions::to_string_t(getApiUri(mt)) } };
+        string uri;
+        uri.reserve(path.size() + 1 + queryString.size());
+        uri.append(path).append("?").append(queryString);
 
-        return client.request(std::move(request)).then([handler, this](web::http::http_response response)
+        auto request = createHttpRequest(method, std::move(uri));
+
+        const auto built = timed ? RestCallStatistics::Clock::now() : RestCallStatistics::Clock::time_point{};
+
+        m_rateLimits.acquire(call);
+
+        const auto sent = timed ? RestCallStatistics::Clock::now() : RestCallStatistics::Clock::time_point{};
+
+        return restClient().request(std::move(request)).then([handler, this, call, timed, start, built, sent](web::http::http_response response)
         {
-          if (response.status_code() == web::http::status_codes::OK)
-          {
-            return handler(response);
-          }
-          else
+          const auto received = timed ? RestCallStatistics::Clock::now() : RestCallStatistics::Clock::time_point{};
+
+          m_rateLimits.onResponse(response.status_code(), response.headers());
+
+          auto result = response.status_code() == web::http::status_codes::OK ? handler(response) : createInvalidRestResult<RestResultT>(handleRestCallError(response));
+
+          if (timed)
           {
-            return createInvalidRestResult<RestResultT>(handleRestCallError(response));
+            recordRestTimings(call, result, start, built, sent, received);
           }
+
+          return result;
         });
       }
-      catch (const pplx::task_canceled tc)
+      catch (const pplx::task_canceled& tc)
       {
         throw;
       }
-      catch (const std::exception ex)
+      catch (const std::exception& ex)
       {
         throw;
       }
     }
 
 
+    // results which hold RestCallTimings are always timed
+    template<class RestResultT>
+    bool isRestTimed() const
+    {
+      return std::is_base_of_v<RestCallTimings, RestResultT> || m_restTiming;
+    }
+
+
+    template<class RestResultT>
+    void recordRestTimings(const RestCall call, RestResultT& result, const RestCallStatistics::Clock::time_point start, const RestCallStatistics::Clock::time_point built,
+                           const RestCallStatistics::Clock::time_point sent, const RestCallStatistics::Clock::time_point received)
+    {
+      using std::chrono::duration_cast;
+      using Duration = std::chrono::high_resolution_clock::duration;
+
+      const auto handled = RestCallStatistics::Clock::now();
+
+      RestCallTimings timings;
+      timings.restQueryBuild = duration_cast<Duration>(built - start);
+      timings.restApiCall = duration_cast<Duration>(received - sent);
+      timings.restResponseHandler = duration_cast<Duration>(handled - received);
+      timings.bfcppTotalProcess = timings.restQueryBuild + timings.restResponseHandler;
+
+      if (m_restTiming)
+      {
+        m_restStatistics->record(call, timings, duration_cast<std::chrono::nanoseconds>(handled - start));
+      }
+
+      if constexpr (std::is_base_of_v<RestCallTimings, RestResultT>)
+      {
+        // 'total' is left for the caller
+        result.restQueryBuild = timings.restQueryBuild;
+        result.restApiCall = timings.restApiCall;
+        result.restResponseHandler = timings.restResponseHandler;
+        result.bfcppTotalProcess = timings.bfcppTotalProcess;
+      }
+    }
+
+
+    template<class ResultT>
+    static ResultT readNewOrderResult(web::http::http_response response)
+    {
+      ResultT result;
+
+      auto json = response.extract_json().get();
+
+      getJsonValues(json, result.response, vector<string> {  "clientOrderId", "cumQty", "cumQuote", "executedQty", "orderId", "avgPrice", "origQty", "price", "reduceOnly", "side", "positionSide", "status",
+                                                          "stopPrice", "closePosition", "symbol", "timeInForce", "type", "origType", "activatePrice", "priceRate", "updateTime", "workingType", "priceProtect"});
+
+      return result;
+    }
+
+
+    template<class ResultT>
+    static ResultT readNewOrderBatchResult(web::http::http_response response)
+    {
+      ResultT result;
+
+      auto json = response.extract_json().get();
+
+      for (auto& order : json.as_array())
+      {
+        map<string, string> orderValues;
+        getJsonValues(order, orderValues, vector<string> {  "clientOrderId", "cumQty", "cumQuote", "executedQty", "orderId", "avgPrice", "origQty", "price", "reduceOnly", "side", "positionSide", "status",
+                                                          "stopPrice", "closePosition", "symbol", "timeInForce", "type", "origType", "activatePrice", "priceRate", "updateTime", "workingType", "priceProtect",
+                                                          "code", "msg"}); // a rejected order's entry is an error
+
+        result.response.emplace_back(std::move(orderValues));
+      }
+
+      return result;
+    }
+
+
+    /// <summary>
+    /// Converts the orders to the batchOrders JSON list, returned as the query, unsigned.
+    /// </summary>
+    static map<string, string> createBatchOrdersQuery(const vector<map<string, string>>& orders)
+    {
+      const static map<string, web::json::value::value_type> NonStringTypes = { {"orderId", web::json::value::Number}, {"reduceOnly", web::json::value::Boolean},
+                                                                                {"updateTime", web::json::value::Number}, {"priceProtect", web::json::value::Boolean}
+                                                                              };
+
+      web::json::value list = web::json::value::array();
+      size_t i = 0;
+
+      for (auto& order : orders)
+      {
+        auto entry = list.object();
+        
+        for (auto& pair : order)
+        {
+          auto key = utility::conversions::to_string_t(pair.first);
+
+          if (auto typeEntry = NonStringTypes.find(pair.first); typeEntry == NonStringTypes.end())
+          {
+            entry[key] = web::json::value::string(utility::conversions::to_string_t(pair.second));
+          }
+          else
+          {
+            if (typeEntry->second == web::json::value::Number)
+            {
+              entry[key] = web::json::value::number(static_cast<int64_t>(std::stoll(utility::conversions::to_string_t(pair.second)))); // TODO confirm long long correct
+            }
+            else if (typeEntry->second == web::json::value::Boolean)
+            {
+              entry[key] = web::json::value::boolean(pair.second == "true" || pair.second == "TRUE");
+            }
+          }
+        }
+
+        list[i++] = std::move(entry);
+      }
+
+      map<string, string> query;
+      query["batchOrders"] = utility::conversions::to_utf8string(web::http::uri::encode_data_string(list.serialize()));
+      return query;
+    }
+
+
     string handleRestCallError(web::http::http_response& response)
     {
       auto isJson = response.headers()[utility::conversions::to_string_t("content-type")].find(utility::conversions::to_string_t("json")) != utility::string_t::npos;
@@ -757,9 +1855,48 @@ private:
     std::atomic_bool m_running;
     string m_listenKey;
     ApiAccess m_apiAccess;
+    Signer m_signer;  // holds the secret key's HMAC pads, replaced in setApiKeys()
+    RateLimitGovernor m_rateLimits;
+    ClockSync m_clockSync;
+    shared_ptr<OrderValidator> m_orderValidator;
+    OrderStateCache m_orderStates;
+    AccountStateCache m_accountState;
+    OrderLatencyTracer m_orderLatency;
+    std::atomic_bool m_orderLatencyTracing;
+    bool m_roundOrders;
 
     IntervalTimer m_userDataStreamTimer;
     map<RestCall, string> m_receiveWindowMap;
+    StreamParser m_streamParser;
+    shared_ptr<const SymbolRegistry> m_symbolRegistry;
+
+    bool m_combinedStreams;
+    size_t m_streamsPerConnection;
+    bool m_streamLatencyTracking;
+    mutable std::mutex m_streamLatencyMux;
+    map<MonitorTokenId, shared_ptr<StreamLatency>> m_streamLatencies;
+    std::mutex m_combinedMux;
+    vector<shared_ptr<CombinedStreamConnection>> m_combinedConnections;
+    map<MonitorTokenId, shared_ptr<CombinedStreamConnection>> m_idToConnection;
+
+    std::unique_ptr<HttpClientPool> m_restPool;
+    std::atomic_bool m_restTiming;
+    std::unique_ptr<RestCallStatistics> m_restStatistics;   // on the heap, the histograms are large
+    std::atomic_bool m_frameRecording;
+    shared_ptr<FrameRecorder> m_frameRecorder;   // atomic_load()/atomic_exchange(), read by the receive threads
+
+    std::atomic_bool m_orderBatching;
+    OrderBatcher m_orderBatcher;
+
+    IntervalTimer m_clockSyncTimer;
+
+    std::function<void(const StreamGap&)> m_onStreamGap;
+    mutable std::mutex m_supervisorMux;
+    ReconnectPolicy m_reconnectPolicy;
+    vector<std::weak_ptr<WebSocketSession>> m_supervised;
+    vector<PendingReconnect> m_pendingReconnects;
+    bool m_supervising;
+    IntervalTimer m_supervisorTimer; // last so it's stopped before the members it uses are destroyed
 };
 
 
@@ -830,91 +1967,21 @@ private:
 
 
   private:
-    template<typename ResultT>
-    pplx::task<ResultT> sendRestRequestPerformanceCheck(const RestCall call, const web::http::method method, const bool sign, const MarketType mt, std::function<ResultT(web::http::http_response)> handler, const string& rcvWindow, map<string, string>&& query = {})
-    {
-      try
-      {
-        auto start = std::chrono::high_resolution_clock::now();
-
-        string queryString{ createQueryString(std::move(query), call, true, rcvWindow) };
-
-        auto request = createHttpRequest(method, getApiPath(mt, call) + "?" + queryString);
-
-        web::http::client::http_client client{ web::uri { utility::conversions::to_string_t(getApiUri(mt)) } };
-
-        auto requestSent = std::chrono::high_resolution_clock::now();
-        return client.request(std::move(request)).then([handler, start, requestSent, this](web::http::http_response response)
-        {
-          try
-          {
-            auto restCallTime = std::chrono::high_resolution_clock::now() - requestSent;
-
-            if (response.status_code() == web::http::status_codes::OK)
-            {
-              auto handlerCalled = std::chrono::high_resolution_clock::now();
-              auto result = handler(response);
-              auto handlerDone = std::chrono::high_resolution_clock::now();
-
-              result.restQueryBuild = requestSent - start;
-              result.restResponseHandler = handlerDone - handlerCalled;
-              result.bfcppTotalProcess = result.restQueryBuild + result.restResponseHandler;
-              result.restApiCall = restCallTime;
-              return result;
-            }
-            else
-            {
-              ResultT result{};
-              result.bfcppTotalProcess = std::chrono::high_resolution_clock::now() - start;
-              result.restApiCall = restCallTime;
-              result.valid(false, handleRestCallError(response));
-              return result;
-            }         
-          }
-          catch (const std::exception ex)
-          {
-            throw BfcppException(ex.what());
-          }          
-        });
-      }
-      catch (const pplx::task_canceled tc)
-      {
-        throw BfcppException("Receive task cancelled: " + string{ tc.what() });
-      }
-      catch (const std::exception ex)
-      {
-        throw BfcppException(ex.what());
-      }
-    }
-
-
     pplx::task<NewOrderPerformanceResult> doNewOrderPerfomanceCheck(map<string, string>&& order)
     {
       try
       {
-        Clock::time_point handlerStart, handlerStop;
-
-        auto handler = [&handlerStart, &handlerStop](web::http::http_response response)
-        {
-          handlerStart = Clock::now();
-
-          NewOrderPerformanceResult result;
-
-          auto json = response.extract_json().get();
-
-          getJsonValues(json, result.response, vector<string> {  "clientOrderId", "cumQty", "cumQuote", "executedQty", "orderId", "avgPrice", "origQty", "price", "reduceOnly", "side", "positionSide", "status",
-                                                              "stopPrice", "closePosition", "symbol", "timeInForce", "type", "origType", "activatePrice", "priceRate", "updateTime", "workingType", "priceProtect"});
-
-          return result;
-        };
-
-        return sendRestRequestPerformanceCheck<NewOrderPerformanceResult>(RestCall::NewOrder, web::http::methods::POST, true, marketType(), handler, receiveWindow(RestCall::NewOrder), std::move(order));
+        return sendRestRequest<NewOrderPerformanceResult>(RestCall::NewOrder, web::http::methods::POST, true, marketType(), readNewOrderResult<NewOrderPerformanceResult>, receiveWindow(RestCall::NewOrder), std::move(order));
       }
-      catch (const pplx::task_canceled tc)
+      catch (const pplx::task_canceled& tc)
       {
         throw BfcppDisconnectException("newOrder");
       }
-      catch (const std::exception ex)
+      catch (const BfcppException&)
+      {
+        throw;
+      }
+      catch (const std::exception& ex)
       {
         throw BfcppException(ex.what());
       }
@@ -926,74 +1993,18 @@ private:
     {
       try
       {
-        Clock::time_point handlerStart, handlerStop;
-
-        auto handler = [&handlerStart, &handlerStop](web::http::http_response response)
-        {
-          handlerStart = Clock::now();
-
-          NewOrderBatchPerformanceResult result;
-          
-          auto json = response.extract_json().get();
-          
-          auto& jsonArray = json.as_array();
-          for (auto& order : jsonArray)
-          {
-            map<string, string> orderValues;
-            getJsonValues(order, orderValues, vector<string> {  "clientOrderId", "cumQty", "cumQuote", "executedQty", "orderId", "avgPrice", "origQty", "price", "reduceOnly", "side", "positionSide", "status",
-                                                              "stopPrice", "closePosition", "symbol", "timeInForce", "type", "origType", "activatePrice", "priceRate", "updateTime", "workingType", "priceProtect"});
-
-            result.response.emplace_back(std::move(orderValues));
-          }
-          
-          return result;          
-        };
-
-        // convert the vector of orders to single JSON string and create the query string from that
-        const static map<string, web::json::value::value_type> NonStringTypes = { {"orderId", web::json::value::Number}, {"reduceOnly", web::json::value::Boolean},
-                                                                                  {"updateTime", web::json::value::Number}, {"priceProtect", web::json::value::Boolean}};
-
-        web::json::value list = web::json::value::array();
-        size_t i = 0;
-
-        for (auto& order : orders)
-        {
-          auto entry = list.object();
-
-          for (auto& pair : order)
-          {
-            auto key = utility::conversions::to_string_t(pair.first);
-
-            if (auto typeEntry = NonStringTypes.find(pair.first); typeEntry == NonStringTypes.end())
-            {
-              entry[key] = web::json::value::string(utility::conversions::to_string_t(pair.second));
-            }
-            else
-            {
-              if (typeEntry->second == web::json::value::Number)
-              {
-                entry[key] = web::json::value::number(static_cast<int64_t>(std::stoll(utility::conversions::to_string_t(pair.second)))); // TODO confirm long long correct
-              }
-              else if (typeEntry->second == web::json::value::Boolean)
-              {
-                entry[key] = web::json::value::boolean(pair.second == "true" || pair.second == "TRUE");
-              }
-            }
-          }
-
-          list[i++] = std::move(entry);
-        }
-
-        map<string, string> query;
-        query["batchOrders"] = utility::conversions::to_utf8string(web::http::uri::encode_data_string(list.serialize()));
-
-        return sendRestRequestPerformanceCheck<NewOrderBatchPerformanceResult>(RestCall::NewBatchOrder, web::http::methods::POST, true, marketType(), handler, receiveWindow(RestCall::NewBatchOrder), std::move(query));
+        return sendRestRequest<NewOrderBatchPerformanceResult>(RestCall::NewBatchOrder, web::http::methods::POST, true, marketType(), readNewOrderBatchResult<NewOrderBatchPerformanceResult>,
+                                                               receiveWindow(RestCall::NewBatchOrder), createBatchOrdersQuery(orders));
       }
-      catch (const pplx::task_canceled tc)
+      catch (const pplx::task_canceled& tc)
       {
         throw BfcppDisconnectException("newOrder");
       }
-      catch (const std::exception ex)
+      catch (const BfcppException&)
+      {
+        throw;
+      }
+      catch (const std::exception& ex)
       {
         throw BfcppException(ex.what());
       }
@@ -0,0 +1,94 @@
+#ifndef __BINANCE_HTTPCLIENTPOOL_HPP
+#define __BINANCE_HTTPCLIENTPOOL_HPP
+
+#include <atomic>
+#include <memory>
+#include "bfcppCommon.hpp"
+
+
+namespace bfcpp
+{
+  /// <summary>
+  /// A fixed set of http_clients for one host, reused for every REST call rather than creating a client per call.
+  ///
+  /// Each http_client keeps its connections open (keep-alive) between requests, so once warm a request doesn't
+  /// need a TCP connect or TLS handshake. Clients are handed out round robin so concurrent requests spread across connections.
+  ///
+  /// Clients are created on construction, but don't connect until the first request or warm().
+  /// </summary>
+  class HttpClientPool
+  {
+  public:
+    static const size_t DefaultSize = 4;
+
+
+    /// <summary>
+    ///
+    /// </summary>
+    /// <param name="baseUri">The REST host, i.e. getApiUri()</param>
+    /// <param name="size">The number of clients</param>
+    HttpClientPool(const string& baseUri, const size_t size = DefaultSize) : m_baseUri(baseUri), m_next(0)
+    {
+      if (size == 0)
+      {
+        throw BfcppException{ BFCPP_FUNCTION_MSG(" pool size must be greater than 0") };
+      }
+
+      const web::uri uri{ utility::conversions::to_string_t(baseUri) };
+
+      for (size_t i = 0; i < size; ++i)
+      {
+        m_clients.emplace_back(std::make_unique<web::http::client::http_client>(uri));
+      }
+    }
+
+
+    /// <summary>
+    /// The next client, round robin. http_client is thread safe.
+    /// </summary>
+    web::http::client::http_client& client()
+    {
+      return *m_clients[m_next++ % m_clients.size()];
+    }
+
+
+    /// <summary>
+    /// Sends the request from every client and waits for the responses, which opens each client's connection.
+    /// Failed requests are ignored, the client connects on its next request instead.
+    /// </summary>
+    /// <param name="createRequest">Creates the request, called for each client</param>
+    void warm(std::function<web::http::http_request()> createRequest)
+    {
+      vector<pplx::task<void>> requests;
+
+      for (auto& client : m_clients)
+      {
+        requests.emplace_back(client->request(createRequest()).then([](pplx::task<web::http::http_response> response)
+        {
+          try
+          {
+            response.get();
+          }
+          catch (const std::exception&)
+          {
+
+          }
+        }));
+      }
+
+      pplx::when_all(requests.begin(), requests.end()).wait();
+    }
+
+
+    const string& baseUri() const { return m_baseUri; }
+    size_t size() const { return m_clients.size(); }
+
+
+  private:
+    string m_baseUri;
+    vector<std::unique_ptr<web::http::client::http_client>> m_clients;
+    std::atomic_size_t m_next;
+  };
+}
+
+#endif
@@ -0,0 +1,206 @@
+#ifndef __BINANCE_LATENCYHISTOGRAM_HPP
+#define __BINANCE_LATENCYHISTOGRAM_HPP
+
+#include <atomic>
+#include <array>
+#include <chrono>
+#include <limits>
+#include "bfcppCommon.hpp"
+
+
+namespace bfcpp
+{
+  /// <summary>
+  /// A histogram's values at a point in time, see LatencyHistogram::summary().
+  /// </summary>
+  struct LatencySummary
+  {
+    uint64_t count{ 0 };
+    std::chrono::nanoseconds min{ 0 };
+    std::chrono::nanoseconds mean{ 0 };
+    std::chrono::nanoseconds p50{ 0 };
+    std::chrono::nanoseconds p90{ 0 };
+    std::chrono::nanoseconds p99{ 0 };
+    std::chrono::nanoseconds p999{ 0 };
+    std::chrono::nanoseconds max{ 0 };
+  };
+
+
+  /// <summary>
+  /// Records latencies in nanoseconds into log-linear buckets, as HdrHistogram does: each power of two is split into
+  /// 2^(SubBucketBits - 1) buckets, so a percentile is within 1/2^(SubBucketBits - 1) (under 1.6%) of the recorded value,
+  /// from 1ns to MaxValue (about 18 minutes, larger values are recorded as MaxValue).
+  ///
+  /// record() is lock free and doesn't allocate, so it can be called from receive and request threads.
+  /// Queries read the buckets whilst they may be recorded to, so are approximate whilst recording.
+  /// </summary>
+  class LatencyHistogram
+  {
+  public:
+    static constexpr unsigned SubBucketBits = 7;
+    static constexpr int64_t MaxValue = (int64_t{ 1 } << 40) - 1;
+
+
+    LatencyHistogram()
+    {
+      reset();
+    }
+
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+
+    /// <summary>
+    /// Negative values (i.e. from clocks which differ) are recorded as 0.
+    /// </summary>
+    void record(const int64_t nanoseconds)
+    {
+      const auto value = nanoseconds < 0 ? 0 : (nanoseconds > MaxValue ? MaxValue : nanoseconds);
+
+      m_counts[index(value)].fetch_add(1, std::memory_order_relaxed);
+      m_count.fetch_add(1, std::memory_order_relaxed);
+      m_sum.fetch_add(value, std::memory_order_relaxed);
+
+      for (auto min = m_min.load(std::memory_order_relaxed); value < min && !m_min.compare_exchange_weak(min, value, std::memory_order_relaxed);)
+        ;
+
+      for (auto max = m_max.load(std::memory_order_relaxed); value > max && !m_max.compare_exchange_weak(max, value, std::memory_order_relaxed);)
+        ;
+    }
+
+    void record(const std::chrono::nanoseconds latency)
+    {
+      record(latency.count());
+    }
+
+
+    uint64_t count() const { return m_count.load(std::memory_order_relaxed); }
+
+    std::chrono::nanoseconds min() const
+    {
+      return std::chrono::nanoseconds{ count() ? m_min.load(std::memory_order_relaxed) : 0 };
+    }
+
+    std::chrono::nanoseconds max() const
+    {
+      return std::chrono::nanoseconds{ m_max.load(std::memory_order_relaxed) };
+    }
+
+    std::chrono::nanoseconds mean() const
+    {
+      const auto n = count();
+      return std::chrono::nanoseconds{ n ? static_cast<int64_t>(m_sum.load(std::memory_order_relaxed) / n) : 0 };
+    }
+
+
+    /// <summary>
+    /// The value at or below which 'percentile' (0 to 100) percent of the values are. This is the upper bound of the value's bucket,
+    /// capped at max(). 0 if nothing has been recorded.
+    /// </summary>
+    std::chrono::nanoseconds percentile(const double percentile) const
+    {
+      const auto n = count();
+
+      if (n == 0)
+      {
+        return std::chrono::nanoseconds{ 0 };
+      }
+
+      const auto clamped = percentile < 0.0 ? 0.0 : (percentile > 100.0 ? 100.0 : percentile);
+      const auto target = std::max<uint64_t>(1, static_cast<uint64_t>(clamped / 100.0 * n + 0.5));
+
+      uint64_t seen = 0;
+
+      for (size_t i = 0; i < BucketCount; ++i)
+      {
+        if (seen += m_counts[i].load(std::memory_order_relaxed); seen >= target)
+        {
+          return std::chrono::nanoseconds{ std::min(upperBound(i), m_max.load(std::memory_order_relaxed)) };
+        }
+      }
+
+      return max();
+    }
+
+
+    LatencySummary summary() const
+    {
+      LatencySummary summary;
+      summary.count = count();
+      summary.min = min();
+      summary.mean = mean();
+      summary.p50 = percentile(50.0);
+      summary.p90 = percentile(90.0);
+      summary.p99 = percentile(99.0);
+      summary.p999 = percentile(99.9);
+      summary.max = max();
+      return summary;
+    }
+
+
+    /// <summary>
+    /// Clears the values. Values recorded whilst resetting may be partly lost.
+    /// </summary>
+    void reset()
+    {
+      for (auto& count : m_counts)
+        count.store(0, std::memory_order_relaxed);
+
+      m_count.store(0, std::memory_order_relaxed);
+      m_sum.store(0, std::memory_order_relaxed);
+      m_min.store(std::numeric_limits<int64_t>::max(), std::memory_order_relaxed);
+      m_max.store(0, std::memory_order_relaxed);
+    }
+
+
+  private:
+    static constexpr size_t HalfBucket = size_t{ 1 } << (SubBucketBits - 1);
+    static constexpr size_t BucketCount = (40 - SubBucketBits + 2) * HalfBucket;   // index(MaxValue) + 1
+
+
+    static unsigned highestBit(uint64_t value)
+    {
+      unsigned bit = 0;
+      while (value >>= 1)
+        ++bit;
+      return bit;
+    }
+
+
+    // values below 2^SubBucketBits have a bucket each, above that each power of two has HalfBucket buckets
+    static size_t index(const int64_t value)
+    {
+      const auto v = static_cast<uint64_t>(value);
+
+      if (v < (uint64_t{ 1 } << SubBucketBits))
+      {
+        return static_cast<size_t>(v);
+      }
+
+      const auto shift = highestBit(v) - SubBucketBits + 1;
+      return static_cast<size_t>(shift * HalfBucket + (v >> shift));
+    }
+
+
+    static int64_t upperBound(const size_t index)
+    {
+      if (index < (size_t{ 1 } << SubBucketBits))
+      {
+        return static_cast<int64_t>(index);
+      }
+
+      const auto shift = index / HalfBucket - 1;
+      const auto sub = index - shift * HalfBucket;
+      return static_cast<int64_t>(((sub + 1) << shift) - 1);
+    }
+
+
+    std::array<std::atomic<uint64_t>, BucketCount> m_counts;
+    std::atomic<uint64_t> m_count;
+    std::atomic<int64_t> m_sum;
+    std::atomic<int64_t> m_min;
+    std::atomic<int64_t> m_max;
+  };
+}
+
+#endif
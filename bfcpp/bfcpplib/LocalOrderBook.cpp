@@ -0,0 +1,244 @@
+#include "LocalOrderBook.hpp"
+
+
+namespace bfcpp
+{
+  LocalOrderBook::LocalOrderBook(const string& symbol, const string& tickSize, const size_t snapshotLimit, const size_t bufferLimit, const size_t ladderCapacity) :
+    m_symbol(symbol), m_snapshotLimit(snapshotLimit), m_bufferLimit(bufferLimit), m_ladder(tickSize, ladderCapacity),
+    m_haveSnapshot(false), m_synced(false), m_snapshotUpdateId(0), m_lastUpdateId(0)
+  {
+
+  }
+
+
+  LocalOrderBook::UpdateResult LocalOrderBook::update(const BookDepthDiff& diff)
+  {
+    std::scoped_lock lock(m_mux);
+    return doUpdate(diff);
+  }
+
+
+  LocalOrderBook::UpdateResult LocalOrderBook::update(const BookDepthStream& stream)
+  {
+    BookDepthDiff diff;
+    diff.firstUpdateId = std::stoull(stream.firstUpdateId);
+    diff.finalUpdateId = std::stoull(stream.finalUpdateId);
+    diff.previousFinalUpdateId = std::stoull(stream.previousFinalUpdateId);
+
+    for (const auto& bid : stream.bids)
+      diff.bids.emplace_back(toTick(bid.first), toQuantity(bid.second));
+
+    for (const auto& ask : stream.asks)
+      diff.asks.emplace_back(toTick(ask.first), toQuantity(ask.second));
+
+    return update(diff);
+  }
+
+
+  LocalOrderBook::UpdateResult LocalOrderBook::applySnapshot(const OrderBook& snapshot)
+  {
+    std::scoped_lock lock(m_mux);
+
+    m_ladder.clear();
+
+    for (const auto& bid : snapshot.bids)
+      m_ladder.set(PriceLadder::Side::Bid, toTick(bid.first), toQuantity(bid.second));
+
+    for (const auto& ask : snapshot.asks)
+      m_ladder.set(PriceLadder::Side::Ask, toTick(ask.first), toQuantity(ask.second));
+
+    m_snapshotUpdateId = std::stoull(snapshot.lastUpdateId);
+    m_lastUpdateId = m_snapshotUpdateId;
+    m_haveSnapshot = true;
+    m_synced = false;
+
+    // replay the diffs received whilst waiting for the snapshot
+    std::deque<BookDepthDiff> buffered;
+    buffered.swap(m_buffer);
+
+    auto result = UpdateResult::Buffered;
+
+    while (!buffered.empty())
+    {
+      result = doUpdate(buffered.front());
+      buffered.pop_front();
+
+      if (result == UpdateResult::Gap)
+      {
+        // the snapshot is too old, keep the remaining diffs for the next snapshot
+        std::move(buffered.begin(), buffered.end(), std::back_inserter(m_buffer));
+        break;
+      }
+    }
+
+    return result;
+  }
+
+
+  void LocalOrderBook::reset()
+  {
+    std::scoped_lock lock(m_mux);
+    doReset();
+    m_buffer.clear();
+  }
+
+
+  bool LocalOrderBook::isSynced() const
+  {
+    std::scoped_lock lock(m_mux);
+    return m_synced;
+  }
+
+
+  bool LocalOrderBook::isTruncated() const
+  {
+    std::scoped_lock lock(m_mux);
+    return m_ladder.truncated();
+  }
+
+
+  uint64_t LocalOrderBook::truncatedLevels() const
+  {
+    std::scoped_lock lock(m_mux);
+    return m_ladder.truncatedLevels();
+  }
+
+
+  bool LocalOrderBook::needsSnapshot() const
+  {
+    std::scoped_lock lock(m_mux);
+    return !m_haveSnapshot;
+  }
+
+
+  uint64_t LocalOrderBook::lastUpdateId() const
+  {
+    std::scoped_lock lock(m_mux);
+    return m_lastUpdateId;
+  }
+
+
+  std::optional<BookLevel> LocalOrderBook::bestBid() const
+  {
+    std::scoped_lock lock(m_mux);
+    return best(PriceLadder::Side::Bid);
+  }
+
+
+  std::optional<BookLevel> LocalOrderBook::bestAsk() const
+  {
+    std::scoped_lock lock(m_mux);
+    return best(PriceLadder::Side::Ask);
+  }
+
+
+  vector<BookLevel> LocalOrderBook::bids(const size_t depth) const
+  {
+    std::scoped_lock lock(m_mux);
+    return topLevels(PriceLadder::Side::Bid, depth);
+  }
+
+
+  vector<BookLevel> LocalOrderBook::asks(const size_t depth) const
+  {
+    std::scoped_lock lock(m_mux);
+    return topLevels(PriceLadder::Side::Ask, depth);
+  }
+
+
+  LocalOrderBook::UpdateResult LocalOrderBook::doUpdate(const BookDepthDiff& diff)
+  {
+    if (!m_haveSnapshot)
+    {
+      buffer(diff);
+      return UpdateResult::Buffered;
+    }
+
+    if (m_synced)
+    {
+      if (diff.previousFinalUpdateId != m_lastUpdateId)
+      {
+        doReset();
+        buffer(diff);
+        return UpdateResult::Gap;
+      }
+    }
+    else if (diff.finalUpdateId < m_snapshotUpdateId)
+    {
+      return UpdateResult::Dropped;
+    }
+    else if (diff.firstUpdateId > m_snapshotUpdateId)
+    {
+      // missed the diffs that follow the snapshot
+      doReset();
+      buffer(diff);
+      return UpdateResult::Gap;
+    }
+
+    applyDiff(diff);
+
+    m_lastUpdateId = diff.finalUpdateId;
+    m_synced = true;
+
+    return UpdateResult::Applied;
+  }
+
+
+  void LocalOrderBook::doReset()
+  {
+    m_ladder.clear();
+    m_haveSnapshot = false;
+    m_synced = false;
+    m_snapshotUpdateId = 0;
+    m_lastUpdateId = 0;
+  }
+
+
+  void LocalOrderBook::buffer(const BookDepthDiff& diff)
+  {
+    if (m_buffer.size() == m_bufferLimit)
+    {
+      m_buffer.pop_front();
+    }
+
+    m_buffer.emplace_back(diff);
+  }
+
+
+  void LocalOrderBook::applyDiff(const BookDepthDiff& diff)
+  {
+    // quantities are absolute, zero removes the level
+    for (const auto& bid : diff.bids)
+      m_ladder.set(PriceLadder::Side::Bid, bid.first, bid.second);
+
+    for (const auto& ask : diff.asks)
+      m_ladder.set(PriceLadder::Side::Ask, ask.first, ask.second);
+  }
+
+
+  std::optional<BookLevel> LocalOrderBook::best(const PriceLadder::Side side) const
+  {
+    const auto tick = side == PriceLadder::Side::Bid ? m_ladder.bestBid() : m_ladder.bestAsk();
+
+    if (!m_synced || tick == PriceLadder::NoTick)
+      return std::nullopt;
+
+    return BookLevel{ m_ladder.tickToPrice(tick), m_ladder.toDecimalQuantity(m_ladder.quantity(side, tick)) };
+  }
+
+
+  vector<BookLevel> LocalOrderBook::topLevels(const PriceLadder::Side side, const size_t depth) const
+  {
+    vector<BookLevel> result;
+
+    if (m_synced)
+    {
+      m_ladder.forEachLevel(side, depth, [this, &result](const int64_t tick, const int64_t quantity)
+      {
+        result.emplace_back(BookLevel{ m_ladder.tickToPrice(tick), m_ladder.toDecimalQuantity(quantity) });
+      });
+    }
+
+    return result;
+  }
+}
@@ -0,0 +1,194 @@
+#ifndef __BINANCE_LOCALORDERBOOK_HPP
+#define __BINANCE_LOCALORDERBOOK_HPP
+
+#include <deque>
+#include <mutex>
+#include <optional>
+#include "bfcppCommon.hpp"
+#include "PriceLadder.hpp"
+
+
+namespace bfcpp
+{
+  /// <summary>
+  /// A price level in a LocalOrderBook.
+  /// </summary>
+  struct BookLevel
+  {
+    Decimal price;
+    Decimal quantity;
+  };
+
+
+  /// <summary>
+  /// A diff. book depth event with the levels converted to ticks and scaled quantities, see PriceLadder.
+  /// This is what monitorLocalOrderBook() creates from the stream, rather than a BookDepthStream.
+  /// </summary>
+  struct BookDepthDiff
+  {
+    uint64_t firstUpdateId{ 0 };
+    uint64_t finalUpdateId{ 0 };
+    uint64_t previousFinalUpdateId{ 0 };
+    vector<pair<int64_t, int64_t>> bids;  // tick, quantity
+    vector<pair<int64_t, int64_t>> asks;  // tick, quantity
+
+    // clears without releasing memory, so the diff can be reused
+    void clear()
+    {
+      firstUpdateId = finalUpdateId = previousFinalUpdateId = 0;
+      bids.clear();
+      asks.clear();
+    }
+  };
+
+
+  /// <summary>
+  /// An order book for a single symbol, maintained locally from an orderBook() snapshot and the diff. book depth stream.
+  ///
+  /// This follows "How to manage a local order book correctly" from https://binance-docs.github.io/apidocs/futures/en/#diff-book-depth-streams:
+  ///   1) diffs are buffered until a snapshot is applied
+  ///   2) diffs where 'u' is less than the snapshot's lastUpdateId are dropped
+  ///   3) the first diff applied must have 'U' <= lastUpdateId and 'u' >= lastUpdateId
+  ///   4) each diff after that must have 'pu' equal to the previous diff's 'u', otherwise the book is reset and requires a new snapshot
+  ///
+  /// Levels are stored in a PriceLadder, so the symbol's tickSize is required. See getTickSize().
+  ///
+  /// Usually you don't call update()/applySnapshot() yourself, instead pass the book to UsdFuturesMarket::monitorLocalOrderBook().
+  /// All functions are thread safe.
+  /// </summary>
+  class LocalOrderBook
+  {
+  public:
+    enum class UpdateResult
+    {
+      Applied,  // the diff was applied, the book is synced
+      Buffered, // waiting for a snapshot
+      Dropped,  // the diff is older than the snapshot
+      Gap       // a gap in the sequence was found, the book has been reset and requires a new snapshot
+    };
+
+
+    /// <summary>
+    ///
+    /// </summary>
+    /// <param name="symbol">The symbol, i.e. "BTCUSDT"</param>
+    /// <param name="tickSize">The symbol's PRICE_FILTER tickSize, see getTickSize()</param>
+    /// <param name="snapshotLimit">The 'limit' used when requesting the orderBook() snapshot. See https://binance-docs.github.io/apidocs/futures/en/#order-book</param>
+    /// <param name="bufferLimit">The max number of diffs buffered whilst waiting for a snapshot. Oldest diffs are dropped first.</param>
+    /// <param name="ladderCapacity">The number of ticks held by the PriceLadder</param>
+    LocalOrderBook(const string& symbol, const string& tickSize, const size_t snapshotLimit = 1000, const size_t bufferLimit = 1000, const size_t ladderCapacity = 8192);
+
+
+    /// <summary>
+    /// Apply or buffer a diff.
+    /// </summary>
+    UpdateResult update(const BookDepthDiff& diff);
+
+
+    /// <summary>
+    /// Apply or buffer a diff from monitorDiffBookDepth().
+    /// </summary>
+    UpdateResult update(const BookDepthStream& diff);
+
+
+    /// <summary>
+    /// Replaces the book with the snapshot then applies any buffered diffs.
+    /// Returns UpdateResult::Gap if the snapshot is too old for the buffered diffs, in which case a newer snapshot is required.
+    /// </summary>
+    UpdateResult applySnapshot(const OrderBook& snapshot);
+
+
+    /// <summary>
+    /// Clears the book and buffered diffs. A new snapshot is required.
+    /// </summary>
+    void reset();
+
+
+    /// <summary>
+    /// True when a snapshot and a diff which continues from it have been applied. Prices are only valid whilst synced.
+    /// </summary>
+    bool isSynced() const;
+
+
+    /// <summary>
+    /// True if levels have been dropped since the last snapshot because they were outside the PriceLadder's window, see PriceLadder::truncated().
+    /// The best prices are still valid, but bids() and asks() may have holes further from the mid. reset() and request a new snapshot, or use a larger ladderCapacity.
+    /// </summary>
+    bool isTruncated() const;
+
+
+    /// <summary>
+    /// The number of levels dropped because they were outside the PriceLadder's window, since construction.
+    /// </summary>
+    uint64_t truncatedLevels() const;
+
+
+    /// <summary>
+    /// True when waiting for a snapshot, i.e. on creation or after a gap.
+    /// </summary>
+    bool needsSnapshot() const;
+
+
+    const string& symbol() const { return m_symbol; }
+    size_t snapshotLimit() const { return m_snapshotLimit; }
+
+
+    /// <summary>
+    /// Converts a price string to the ladder's tick index. Does not lock.
+    /// </summary>
+    int64_t toTick(std::string_view price) const { return m_ladder.toTick(price); }
+
+
+    /// <summary>
+    /// Converts a quantity string to the ladder's scaled quantity. Does not lock.
+    /// </summary>
+    int64_t toQuantity(std::string_view quantity) const { return m_ladder.toQuantity(quantity); }
+
+
+    /// <summary>
+    /// The 'u' of the most recent diff applied, or the snapshot's lastUpdateId if no diff has been applied since.
+    /// </summary>
+    uint64_t lastUpdateId() const;
+
+
+    std::optional<BookLevel> bestBid() const;
+    std::optional<BookLevel> bestAsk() const;
+
+
+    /// <summary>
+    /// Returns up to 'depth' bid levels, best price first.
+    /// </summary>
+    vector<BookLevel> bids(const size_t depth) const;
+
+
+    /// <summary>
+    /// Returns up to 'depth' ask levels, best price first.
+    /// </summary>
+    vector<BookLevel> asks(const size_t depth) const;
+
+
+  private:
+    UpdateResult doUpdate(const BookDepthDiff& diff);
+    void doReset();
+    void buffer(const BookDepthDiff& diff);
+    void applyDiff(const BookDepthDiff& diff);
+    std::optional<BookLevel> best(const PriceLadder::Side side) const;
+    vector<BookLevel> topLevels(const PriceLadder::Side side, const size_t depth) const;
+
+
+  private:
+    string m_symbol;
+    size_t m_snapshotLimit;
+    size_t m_bufferLimit;
+
+    mutable std::mutex m_mux;
+    PriceLadder m_ladder;
+    std::deque<BookDepthDiff> m_buffer;
+    bool m_haveSnapshot;
+    bool m_synced;
+    uint64_t m_snapshotUpdateId;
+    uint64_t m_lastUpdateId;
+  };
+}
+
+#endif
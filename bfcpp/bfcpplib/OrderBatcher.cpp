@@ -0,0 +1,197 @@
+#include "OrderBatcher.hpp"
+
+
+namespace bfcpp
+{
+  OrderBatcher::OrderBatcher(SendOrder sendOrder, SendBatch sendBatch) : m_sendOrder(std::move(sendOrder)), m_sendBatch(std::move(sendBatch)),
+    m_window(0), m_stopping(true)
+  {
+  }
+
+
+  OrderBatcher::~OrderBatcher()
+  {
+    stop();
+  }
+
+
+  void OrderBatcher::start(const std::chrono::microseconds window)
+  {
+    std::scoped_lock lock(m_mux);
+
+    m_window = window;
+
+    if (!m_thread.joinable())
+    {
+      m_stopping = false;
+      m_thread = std::thread{ &OrderBatcher::run, this };
+    }
+  }
+
+
+  void OrderBatcher::stop()
+  {
+    std::unique_lock lock(m_mux);
+
+    if (!m_thread.joinable())
+    {
+      return;
+    }
+
+    m_stopping = true;
+    m_cv.notify_one();
+
+    auto thread = std::move(m_thread);
+
+    lock.unlock();
+    thread.join();
+  }
+
+
+  pplx::task<NewOrderResult> OrderBatcher::add(map<string, string>&& order)
+  {
+    pplx::task_completion_event<NewOrderResult> result;
+
+    {
+      std::scoped_lock lock(m_mux);
+
+      if (m_stopping)
+      {
+        return m_sendOrder(std::move(order));
+      }
+
+      m_pending.push_back(PendingOrder{ std::move(order), result });
+    }
+
+    m_cv.notify_one();
+
+    return pplx::create_task(result);
+  }
+
+
+  void OrderBatcher::run()
+  {
+    std::unique_lock lock(m_mux);
+
+    while (true)
+    {
+      m_cv.wait(lock, [this] { return m_stopping || !m_pending.empty(); });
+
+      if (m_pending.empty())
+      {
+        break;  // stopped
+      }
+
+      // the window starts with the first order, held orders are sent immediately when stopping
+      const auto due = std::chrono::steady_clock::now() + m_window;
+      m_cv.wait_until(lock, due, [this] { return m_stopping || m_pending.size() >= MaxBatchOrders; });
+
+      while (!m_pending.empty())
+      {
+        const auto size = std::min(m_pending.size(), MaxBatchOrders);
+
+        vector<PendingOrder> batch{ std::make_move_iterator(m_pending.begin()), std::make_move_iterator(m_pending.begin() + size) };
+        m_pending.erase(m_pending.begin(), m_pending.begin() + size);
+
+        lock.unlock();
+        send(std::move(batch));
+        lock.lock();
+
+        // a partial batch left behind waits for its own window, unless stopping
+        if (!m_stopping && m_pending.size() < MaxBatchOrders)
+        {
+          break;
+        }
+      }
+    }
+  }
+
+
+  void OrderBatcher::send(vector<PendingOrder>&& batch)
+  {
+    try
+    {
+      if (batch.size() == 1)
+      {
+        m_sendOrder(std::move(batch[0].order)).then([result = batch[0].result](pplx::task<NewOrderResult> task)
+        {
+          try
+          {
+            result.set(task.get());
+          }
+          catch (...)
+          {
+            result.set_exception(std::current_exception());
+          }
+        });
+      }
+      else
+      {
+        vector<map<string, string>> orders;
+        vector<pplx::task_completion_event<NewOrderResult>> results;
+
+        for (auto& pending : batch)
+        {
+          orders.emplace_back(std::move(pending.order));
+          results.emplace_back(pending.result);
+        }
+
+        m_sendBatch(std::move(orders)).then([results = std::move(results)](pplx::task<NewOrderBatchResult> task)
+        {
+          try
+          {
+            auto orderResults = splitBatchResult(task.get(), results.size());
+
+            for (size_t i = 0; i < results.size(); ++i)
+            {
+              results[i].set(std::move(orderResults[i]));
+            }
+          }
+          catch (...)
+          {
+            for (auto& result : results)
+            {
+              result.set_exception(std::current_exception());
+            }
+          }
+        });
+      }
+    }
+    catch (...)
+    {
+      for (auto& pending : batch)
+      {
+        pending.result.set_exception(std::current_exception());
+      }
+    }
+  }
+
+
+  vector<NewOrderResult> OrderBatcher::splitBatchResult(NewOrderBatchResult&& batch, const size_t count)
+  {
+    vector<NewOrderResult> results;
+    results.reserve(count);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+      if (!batch.valid())
+      {
+        results.emplace_back(createInvalidRestResult<NewOrderResult>(string{ batch.msg() }));
+      }
+      else if (i >= batch.response.size())
+      {
+        results.emplace_back(createInvalidRestResult<NewOrderResult>("order missing from batch response"));
+      }
+      else if (auto& entry = batch.response[i]; entry.find("code") != entry.cend())
+      {
+        results.emplace_back(createInvalidRestResult<NewOrderResult>(entry["code"] + ": " + entry["msg"]));
+      }
+      else
+      {
+        results.emplace_back(std::move(entry));
+      }
+    }
+
+    return results;
+  }
+}
@@ -0,0 +1,83 @@
+#ifndef __BINANCE_ORDERBATCHER_HPP
+#define __BINANCE_ORDERBATCHER_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include "bfcppCommon.hpp"
+
+
+namespace bfcpp
+{
+  /// <summary>
+  /// Holds orders for a window after the first arrives, or until MaxBatchOrders are held, then sends them in one batchOrders request.
+  /// Each order's task gets its own entry from the batch response, see splitBatchResult(). A lone order is sent as a normal order.
+  /// See UsdFuturesMarket::setOrderBatching().
+  ///
+  /// The requests are made with the functions passed on construction, held orders are sent from the batcher's thread.
+  /// </summary>
+  class OrderBatcher
+  {
+  public:
+    inline const static size_t MaxBatchOrders = 5;  // per batchOrders request
+
+    typedef std::function<pplx::task<NewOrderResult>(map<string, string>&&)> SendOrder;
+    typedef std::function<pplx::task<NewOrderBatchResult>(vector<map<string, string>>&&)> SendBatch;
+
+
+    OrderBatcher(SendOrder sendOrder, SendBatch sendBatch);
+    ~OrderBatcher();
+
+    OrderBatcher(const OrderBatcher&) = delete;
+    OrderBatcher& operator=(const OrderBatcher&) = delete;
+
+
+    /// <summary>
+    /// Starts holding orders, or sets the window if started.
+    /// </summary>
+    void start(const std::chrono::microseconds window);
+
+    /// <summary>
+    /// Sends the held orders then stops, orders added whilst stopping are sent immediately. Returns once the held orders are sent.
+    /// </summary>
+    void stop();
+
+    /// <summary>
+    /// Holds the order until its batch is sent, or sends it immediately if not started.
+    /// </summary>
+    pplx::task<NewOrderResult> add(map<string, string>&& order);
+
+
+    /// <summary>
+    /// The result for each of 'count' orders sent in the batch. The batch's entries are in the order sent: an entry with a code
+    /// is the exchange's rejection of that order. If the batch failed, each order has its failure.
+    /// </summary>
+    static vector<NewOrderResult> splitBatchResult(NewOrderBatchResult&& batch, const size_t count);
+
+
+  private:
+    struct PendingOrder
+    {
+      map<string, string> order;
+      pplx::task_completion_event<NewOrderResult> result;
+    };
+
+
+    void run();
+    void send(vector<PendingOrder>&& batch);
+
+
+    SendOrder m_sendOrder;
+    SendBatch m_sendBatch;
+    std::chrono::microseconds m_window;
+    std::mutex m_mux;
+    std::condition_variable m_cv;
+    vector<PendingOrder> m_pending;
+    bool m_stopping;
+    std::thread m_thread;
+  };
+}
+
+#endif
@@ -0,0 +1,170 @@
+#include <charconv>
+#include "OrderLatencyTracer.hpp"
+
+
+namespace bfcpp
+{
+  OrderLatencyTracer::OrderLatencyTracer(const size_t capacity) : m_capacity(capacity), m_nextId(0)
+  {
+    // the session's start time, so ids differ from a previous run's. Binance allows [.A-Z:/a-z0-9_-]{1,36}
+    char buffer[16];
+    const auto now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    auto [end, ec] = std::to_chars(buffer, buffer + sizeof(buffer), now, 36);
+
+    m_idPrefix.assign("bft").append(buffer, end - buffer).append("-");
+  }
+
+
+  string OrderLatencyTracer::nextClientOrderId()
+  {
+    char buffer[16];
+    auto [end, ec] = std::to_chars(buffer, buffer + sizeof(buffer), m_nextId.fetch_add(1, std::memory_order_relaxed), 36);
+
+    return string{ m_idPrefix }.append(buffer, end - buffer);
+  }
+
+
+  void OrderLatencyTracer::begin(std::string_view clientOrderId, const Clock::time_point start, const Clock::time_point built, const Clock::time_point signedAt)
+  {
+    record(OrderLatencyStage::Build, built - start);
+    record(OrderLatencyStage::Sign, signedAt - built);
+
+    std::scoped_lock lock(m_mux);
+
+    string id{ clientOrderId };
+
+    m_traces.insert_or_assign(id, Trace{ start, signedAt });   // the caller may reuse an id
+    m_order.emplace_back(std::move(id), start);
+
+    while (m_traces.size() > m_capacity || m_order.size() > m_capacity * 2)
+    {
+      // the oldest may have ended, or its id been reused for a later trace
+      if (auto it = m_traces.find(m_order.front().first); it != m_traces.end() && it->second.start == m_order.front().second)
+      {
+        m_traces.erase(it);
+      }
+
+      m_order.pop_front();
+    }
+  }
+
+
+  void OrderLatencyTracer::onSent(std::string_view clientOrderId, const Clock::time_point sent)
+  {
+    std::scoped_lock lock(m_mux);
+
+    if (auto it = m_traces.find(string{ clientOrderId }); it != m_traces.end())
+    {
+      record(OrderLatencyStage::Send, sent - it->second.sent);
+      it->second.sent = sent;
+    }
+  }
+
+
+  void OrderLatencyTracer::onRestAck(std::string_view clientOrderId, const bool valid, const Clock::time_point received)
+  {
+    std::scoped_lock lock(m_mux);
+
+    if (auto it = m_traces.find(string{ clientOrderId }); it != m_traces.end())
+    {
+      record(OrderLatencyStage::RestAck, received - it->second.sent);
+      it->second.restAcked = true;
+
+      if (!valid || it->second.closed)
+      {
+        m_traces.erase(it);   // the id is left in m_order, removed when it reaches the front
+      }
+    }
+  }
+
+
+  void OrderLatencyTracer::abandon(std::string_view clientOrderId)
+  {
+    std::scoped_lock lock(m_mux);
+    m_traces.erase(string{ clientOrderId });   // the id is left in m_order, removed when it reaches the front
+  }
+
+
+  void OrderLatencyTracer::onUserData(const UsdFutureUserData& userData, const Clock::time_point received)
+  {
+    if (userData.type != UsdFutureUserData::EventType::OrderUpdate)
+    {
+      return;
+    }
+
+    std::scoped_lock lock(m_mux);
+
+    for (const auto& [symbol, values] : userData.ou.orders)
+    {
+      auto clientOrderId = values.find("c");
+      auto status = values.find("X");
+
+      if (clientOrderId == values.cend() || status == values.cend())
+      {
+        continue;
+      }
+
+      auto it = m_traces.find(clientOrderId->second);
+
+      if (it == m_traces.end())
+      {
+        continue;
+      }
+
+      auto& trace = it->second;
+
+      if (trace.closed)
+      {
+        continue;
+      }
+
+      if (!trace.acknowledged)
+      {
+        // a fill may be the first update, i.e. for a MARKET order
+        record(OrderLatencyStage::StreamAck, received - trace.sent);
+        record(OrderLatencyStage::TickToAck, received - trace.start);
+        trace.acknowledged = true;
+      }
+
+      const auto& state = status->second;
+
+      if ((state == "PARTIALLY_FILLED" || state == "FILLED") && !trace.filled)
+      {
+        record(OrderLatencyStage::FirstFill, received - trace.sent);
+        trace.filled = true;
+      }
+
+      if (state == "FILLED")
+      {
+        record(OrderLatencyStage::FinalFill, received - trace.sent);
+        trace.closed = true;
+      }
+      else if (state == "CANCELED" || state == "EXPIRED" || state == "REJECTED")
+      {
+        trace.closed = true;
+      }
+
+      // kept until the REST response, which often arrives after the fill
+      if (trace.closed && trace.restAcked)
+      {
+        m_traces.erase(it);
+      }
+    }
+  }
+
+
+  size_t OrderLatencyTracer::inFlight() const
+  {
+    std::scoped_lock lock(m_mux);
+    return m_traces.size();
+  }
+
+
+  void OrderLatencyTracer::reset()
+  {
+    for (auto& histogram : m_histograms)
+    {
+      histogram.reset();
+    }
+  }
+}
@@ -0,0 +1,176 @@
+#ifndef __BINANCE_ORDERLATENCYTRACER_HPP
+#define __BINANCE_ORDERLATENCYTRACER_HPP
+
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+#include "bfcppCommon.hpp"
+#include "LatencyHistogram.hpp"
+
+
+namespace bfcpp
+{
+  /// <summary>
+  /// The stages of an order's latency recorded by OrderLatencyTracer.
+  /// </summary>
+  enum class OrderLatencyStage : uint8_t
+  {
+    Build,      // newOrder() called to query built
+    Sign,       // query signed
+    Send,       // signed to request handed to the HTTP client
+    RestAck,    // sent to REST response
+    StreamAck,  // sent to ORDER_TRADE_UPDATE with NEW
+    FirstFill,  // sent to the first PARTIALLY_FILLED or FILLED update
+    FinalFill,  // sent to the FILLED update
+    TickToAck,  // newOrder() called to ORDER_TRADE_UPDATE with NEW
+    Count
+  };
+
+
+  inline const char* toString(const OrderLatencyStage stage)
+  {
+    static const char* Names[] = { "Build", "Sign", "Send", "RestAck", "StreamAck", "FirstFill", "FinalFill", "TickToAck" };
+
+    return Names[static_cast<size_t>(stage)];
+  }
+
+
+  /// <summary>
+  /// Measures each order from the newOrder() call to its acknowledgement and fills on the user data stream.
+  /// See UsdFuturesMarket::setOrderLatencyTracing().
+  ///
+  /// An order is traced by its clientOrderId, so an order sent without one is given one by nextClientOrderId().
+  /// Times are from a monotonic clock, taken when the frame is received rather than when the user data callback runs.
+  /// An order's trace ends once it is filled, cancelled, expired or rejected and its REST response has been received (the fill of a MARKET
+  /// or IOC order usually arrives first), or when more than 'capacity' orders are traced, the oldest first.
+  ///
+  /// Each stage is recorded in a LatencyHistogram which can be read whilst orders are traced.
+  /// </summary>
+  class OrderLatencyTracer
+  {
+  public:
+    typedef std::chrono::steady_clock Clock;
+
+    static const size_t DefaultCapacity = 4096;
+
+
+    explicit OrderLatencyTracer(const size_t capacity = DefaultCapacity);
+
+
+    /// <summary>
+    /// A clientOrderId unique to this tracer (and very likely to this process), for orders sent without one.
+    /// </summary>
+    string nextClientOrderId();
+
+
+    /// <summary>
+    /// Starts tracing the order, records Build and Sign.
+    /// </summary>
+    void begin(std::string_view clientOrderId, const Clock::time_point start, const Clock::time_point built, const Clock::time_point signedAt);
+
+    /// <summary>
+    /// Records Send, call after the request is handed to the HTTP client.
+    /// </summary>
+    void onSent(std::string_view clientOrderId, const Clock::time_point sent);
+
+    /// <summary>
+    /// Records RestAck. If the order failed, or has already closed, the trace ends.
+    /// </summary>
+    void onRestAck(std::string_view clientOrderId, const bool valid, const Clock::time_point received);
+
+    /// <summary>
+    /// Records StreamAck, TickToAck, FirstFill and FinalFill from an OrderUpdate event, other events are ignored.
+    /// </summary>
+    void onUserData(const UsdFutureUserData& userData, const Clock::time_point received);
+
+    /// <summary>
+    /// Ends the trace without recording, for an order which wasn't sent or whose request failed.
+    /// </summary>
+    void abandon(std::string_view clientOrderId);
+
+
+    /// <summary>
+    /// Abandons the traces begun for the orders when destroyed, unless released. Created after begin() so the traces
+    /// end if sending throws, i.e. BfcppRateLimitException.
+    /// </summary>
+    class TraceGuard
+    {
+    public:
+      TraceGuard(OrderLatencyTracer& tracer, const vector<string>& clientOrderIds) : m_tracer(&tracer), m_clientOrderIds(&clientOrderIds)
+      {
+      }
+
+      ~TraceGuard()
+      {
+        if (m_tracer)
+        {
+          for (const auto& clientOrderId : *m_clientOrderIds)
+            m_tracer->abandon(clientOrderId);
+        }
+      }
+
+      TraceGuard(const TraceGuard&) = delete;
+      TraceGuard& operator=(const TraceGuard&) = delete;
+
+      /// <summary>
+      /// The request was sent, the traces continue.
+      /// </summary>
+      void release() { m_tracer = nullptr; }
+
+    private:
+      OrderLatencyTracer* m_tracer;
+      const vector<string>* m_clientOrderIds;
+    };
+
+
+    const LatencyHistogram& histogram(const OrderLatencyStage stage) const
+    {
+      return m_histograms[static_cast<size_t>(stage)];
+    }
+
+    LatencySummary summary(const OrderLatencyStage stage) const
+    {
+      return histogram(stage).summary();
+    }
+
+    /// <summary>
+    /// Orders sent but not yet closed, or closed but without their REST response.
+    /// </summary>
+    size_t inFlight() const;
+
+    /// <summary>
+    /// Clears the histograms, orders in flight are still traced.
+    /// </summary>
+    void reset();
+
+
+  private:
+    struct Trace
+    {
+      Clock::time_point start;
+      Clock::time_point sent;
+      bool acknowledged{ false };
+      bool filled{ false };
+      bool restAcked{ false };
+      bool closed{ false };   // filled, cancelled, expired or rejected
+    };
+
+
+    void record(const OrderLatencyStage stage, const Clock::duration latency)
+    {
+      m_histograms[static_cast<size_t>(stage)].record(std::chrono::duration_cast<std::chrono::nanoseconds>(latency));
+    }
+
+
+    mutable std::mutex m_mux;
+    size_t m_capacity;
+    std::unordered_map<string, Trace> m_traces;
+    std::deque<std::pair<string, Clock::time_point>> m_order;   // id and start, oldest first, may hold ended traces
+    string m_idPrefix;
+    std::atomic<uint64_t> m_nextId;
+    LatencyHistogram m_histograms[static_cast<size_t>(OrderLatencyStage::Count)];
+  };
+}
+
+#endif
@@ -0,0 +1,362 @@
+#include <charconv>
+#include "OrderStateCache.hpp"
+
+
+namespace bfcpp
+{
+  namespace
+  {
+    std::string_view field(const map<string, string>& values, const string& key)
+    {
+      auto it = values.find(key);
+      return it == values.cend() ? std::string_view{} : std::string_view{ it->second };
+    }
+
+
+    int64_t toInteger(std::string_view str)
+    {
+      int64_t value = 0;
+      std::from_chars(str.data(), str.data() + str.size(), value);
+      return value;
+    }
+
+
+    Decimal toDecimal(std::string_view str)
+    {
+      return str.empty() ? Decimal{} : Decimal::fromString(str);
+    }
+
+
+    OrderStatus toStatus(std::string_view str)
+    {
+      auto it = OrderStatusMap.find(string{ str });
+      return it == OrderStatusMap.cend() ? OrderStatus::None : it->second;
+    }
+
+
+    bool isClosed(const OrderState& order)
+    {
+      return order.status != OrderStatus::None && !order.isOpen();
+    }
+  }
+
+
+  OrderStateCache::OrderStateCache(const size_t capacity) : m_capacity(capacity), m_mask(0)
+  {
+  }
+
+
+  void OrderStateCache::onUserData(const UsdFutureUserData& userData)
+  {
+    if (userData.type != UsdFutureUserData::EventType::OrderUpdate)
+    {
+      return;
+    }
+
+    for (const auto& [symbol, values] : userData.ou.orders)
+    {
+      OrderState update;
+      update.orderId = toInteger(field(values, "i"));
+      update.clientOrderId.assign(field(values, "c"));
+      update.symbol.assign(field(values, "s"));
+      update.status = toStatus(field(values, "X"));
+      update.buy = field(values, "S") == "BUY";
+      update.price = toDecimal(field(values, "p"));
+      update.quantity = toDecimal(field(values, "q"));
+      update.filledQuantity = toDecimal(field(values, "z"));
+      update.averagePrice = toDecimal(field(values, "ap"));
+      update.updateTime = toInteger(field(values, "T"));
+
+      apply(update);
+    }
+  }
+
+
+  void OrderStateCache::onOrderResponse(const map<string, string>& response)
+  {
+    OrderState update;
+    update.orderId = toInteger(field(response, "orderId"));
+    update.clientOrderId.assign(field(response, "clientOrderId"));
+    update.symbol.assign(field(response, "symbol"));
+    update.status = toStatus(field(response, "status"));
+    update.buy = field(response, "side") == "BUY";
+    update.price = toDecimal(field(response, "price"));
+    update.quantity = toDecimal(field(response, "origQty"));
+    update.filledQuantity = toDecimal(field(response, "executedQty"));
+    update.averagePrice = toDecimal(field(response, "avgPrice"));
+    update.updateTime = toInteger(field(response, "updateTime"));
+
+    apply(update);
+  }
+
+
+  void OrderStateCache::apply(const OrderState& update)
+  {
+    if (update.orderId == 0)
+    {
+      return;  // a failed request
+    }
+
+    std::scoped_lock lock(m_mux);
+
+    if (auto index = findById(update.orderId); index != Empty)
+    {
+      auto& existing = m_orders[index];
+
+      // stale: the REST response and stream event for a change race
+      if (update.updateTime < existing.updateTime || update.filledQuantity < existing.filledQuantity || (isClosed(existing) && !isClosed(update)))
+      {
+        return;
+      }
+
+      const bool wasClosed = isClosed(existing);
+      const auto clientOrderId = existing.clientOrderId;   // indexed, doesn't change
+
+      existing = update;
+      existing.clientOrderId = clientOrderId;
+
+      if (!wasClosed && isClosed(existing))
+      {
+        m_closed.push_back(index);
+        evict();
+      }
+
+      return;
+    }
+
+    uint32_t index;
+
+    if (!m_free.empty())
+    {
+      index = m_free.back();
+      m_free.pop_back();
+      m_orders[index] = update;
+    }
+    else
+    {
+      index = static_cast<uint32_t>(m_orders.size());
+      m_orders.push_back(update);
+    }
+
+    insert(index);
+
+    if (isClosed(update))
+    {
+      m_closed.push_back(index);
+    }
+
+    evict();
+  }
+
+
+  std::optional<OrderState> OrderStateCache::find(const int64_t orderId) const
+  {
+    std::scoped_lock lock(m_mux);
+
+    if (auto index = findById(orderId); index != Empty)
+      return m_orders[index];
+    else
+      return std::nullopt;
+  }
+
+
+  std::optional<OrderState> OrderStateCache::find(std::string_view clientOrderId) const
+  {
+    std::scoped_lock lock(m_mux);
+
+    if (auto index = findByClientId(clientOrderId); index != Empty)
+      return m_orders[index];
+    else
+      return std::nullopt;
+  }
+
+
+  vector<OrderState> OrderStateCache::openOrders(std::string_view symbol) const
+  {
+    std::scoped_lock lock(m_mux);
+
+    vector<OrderState> open;
+
+    for (const auto index : m_idTable)
+    {
+      if (index != Empty && m_orders[index].isOpen() && (symbol.empty() || m_orders[index].symbol == symbol))
+      {
+        open.push_back(m_orders[index]);
+      }
+    }
+
+    return open;
+  }
+
+
+  size_t OrderStateCache::size() const
+  {
+    std::scoped_lock lock(m_mux);
+    return m_orders.size() - m_free.size();
+  }
+
+
+  void OrderStateCache::clear()
+  {
+    std::scoped_lock lock(m_mux);
+
+    m_orders.clear();
+    m_free.clear();
+    m_idTable.clear();
+    m_clientIdTable.clear();
+    m_closed.clear();
+    m_mask = 0;
+  }
+
+
+  size_t OrderStateCache::hash(const int64_t orderId)
+  {
+    // order ids are sequential, so mix the bits (splitmix64's finaliser)
+    auto h = static_cast<uint64_t>(orderId);
+    h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+    return static_cast<size_t>(h ^ (h >> 31));
+  }
+
+
+  size_t OrderStateCache::hash(std::string_view clientOrderId)
+  {
+    // FNV-1a
+    uint64_t h = 14695981039346656037ULL;
+
+    for (const char c : clientOrderId)
+    {
+      h = (h ^ static_cast<uint8_t>(c)) * 1099511628211ULL;
+    }
+
+    return static_cast<size_t>(h);
+  }
+
+
+  template<class Matches>
+  uint32_t OrderStateCache::probe(const vector<uint32_t>& table, size_t slot, Matches&& matches)
+  {
+    if (table.empty())
+    {
+      return Empty;
+    }
+
+    for (; table[slot] != Empty; slot = (slot + 1) & (table.size() - 1))
+    {
+      if (matches(table[slot]))
+      {
+        return table[slot];
+      }
+    }
+
+    return Empty;
+  }
+
+
+  uint32_t OrderStateCache::findById(const int64_t orderId) const
+  {
+    return probe(m_idTable, hash(orderId) & m_mask, [this, orderId](const uint32_t index) { return m_orders[index].orderId == orderId; });
+  }
+
+
+  uint32_t OrderStateCache::findByClientId(std::string_view clientOrderId) const
+  {
+    return probe(m_clientIdTable, hash(clientOrderId) & m_mask, [this, clientOrderId](const uint32_t index) { return m_orders[index].clientOrderId == clientOrderId; });
+  }
+
+
+  void OrderStateCache::insert(const uint32_t index)
+  {
+    // keep the tables at most half full
+    if ((m_orders.size() - m_free.size()) * 2 > m_idTable.size())
+    {
+      size_t size = 16;
+      while (size < (m_orders.size() - m_free.size()) * 2)
+        size <<= 1;
+
+      m_idTable.assign(size, Empty);
+      m_clientIdTable.assign(size, Empty);
+      m_mask = size - 1;
+
+      // the free indexes are reset, so skipped
+      for (uint32_t i = 0; i < m_orders.size(); ++i)
+      {
+        if (m_orders[i].orderId != 0)
+          insert(i);
+      }
+
+      return;
+    }
+
+    auto slot = hash(m_orders[index].orderId) & m_mask;
+    while (m_idTable[slot] != Empty)
+      slot = (slot + 1) & m_mask;
+
+    m_idTable[slot] = index;
+
+    if (const auto clientOrderId = m_orders[index].clientOrderId.view(); !clientOrderId.empty())
+    {
+      slot = hash(clientOrderId) & m_mask;
+      while (m_clientIdTable[slot] != Empty)
+        slot = (slot + 1) & m_mask;
+
+      m_clientIdTable[slot] = index;
+    }
+  }
+
+
+  template<class HashOf>
+  void OrderStateCache::eraseSlot(vector<uint32_t>& table, size_t slot, HashOf&& hashOf)
+  {
+    const auto mask = table.size() - 1;
+
+    table[slot] = Empty;
+
+    // shift back the entries after it which would no longer be found
+    for (auto next = (slot + 1) & mask; table[next] != Empty; next = (next + 1) & mask)
+    {
+      const auto home = hashOf(table[next]) & mask;
+
+      if (((next - home) & mask) >= ((next - slot) & mask))
+      {
+        table[slot] = table[next];
+        table[next] = Empty;
+        slot = next;
+      }
+    }
+  }
+
+
+  void OrderStateCache::erase(const uint32_t index)
+  {
+    auto& order = m_orders[index];
+
+    auto slot = hash(order.orderId) & m_mask;
+    while (m_idTable[slot] != index)
+      slot = (slot + 1) & m_mask;
+
+    eraseSlot(m_idTable, slot, [this](const uint32_t i) { return hash(m_orders[i].orderId); });
+
+    if (const auto clientOrderId = order.clientOrderId.view(); !clientOrderId.empty())
+    {
+      slot = hash(clientOrderId) & m_mask;
+      while (m_clientIdTable[slot] != index)
+        slot = (slot + 1) & m_mask;
+
+      eraseSlot(m_clientIdTable, slot, [this](const uint32_t i) { return hash(m_orders[i].clientOrderId.view()); });
+    }
+
+    order = OrderState{};
+    m_free.push_back(index);
+  }
+
+
+  void OrderStateCache::evict()
+  {
+    while (!m_closed.empty() && m_orders.size() - m_free.size() > m_capacity)
+    {
+      erase(m_closed.front());
+      m_closed.pop_front();
+    }
+  }
+}
@@ -0,0 +1,111 @@
+#ifndef __BINANCE_ORDERSTATECACHE_HPP
+#define __BINANCE_ORDERSTATECACHE_HPP
+
+#include <deque>
+#include <mutex>
+#include <optional>
+#include "bfcppCommon.hpp"
+#include "Decimal.hpp"
+#include "TypedStreams.hpp"
+
+
+namespace bfcpp
+{
+  /// <summary>
+  /// An order's latest known state, see OrderStateCache.
+  /// </summary>
+  struct OrderState
+  {
+    int64_t orderId{ 0 };
+    FixedString<40> clientOrderId;  // Binance allows 36 chars
+    SymbolString symbol;
+    OrderStatus status{ OrderStatus::None };
+    bool buy{ false };
+    Decimal price;
+    Decimal quantity;
+    Decimal filledQuantity;
+    Decimal averagePrice;
+    int64_t updateTime{ 0 };        // ms, of the event or response which set this state
+
+    bool isOpen() const { return status == OrderStatus::New || status == OrderStatus::PartiallyFilled; }
+  };
+
+
+  /// <summary>
+  /// The state of this account's orders, from ORDER_TRADE_UPDATE user data events and the newOrder/cancelOrder responses,
+  /// so order status can be queried without a REST call. UsdFuturesMarket feeds its cache, see UsdFuturesMarket::orderStates().
+  ///
+  /// Orders are indexed by orderId and by clientOrderId in open addressing tables, so lookups and updates are O(1).
+  /// A REST response and the stream event for the same change can arrive in either order: an update older than the state held,
+  /// with less filled, or which would reopen a closed order, is ignored.
+  ///
+  /// Open orders are kept until they close. Closed orders are kept up to 'capacity' orders in total, the oldest closed are removed first.
+  /// All functions are thread safe.
+  /// </summary>
+  class OrderStateCache
+  {
+  public:
+    static const size_t DefaultCapacity = 4096;
+
+
+    explicit OrderStateCache(const size_t capacity = DefaultCapacity);
+
+
+    /// <summary>
+    /// Applies an OrderUpdate event, other events are ignored.
+    /// </summary>
+    void onUserData(const UsdFutureUserData& userData);
+
+    /// <summary>
+    /// Applies a newOrder(), cancelOrder() or newOrderBatch() entry response. Invalid or empty responses are ignored.
+    /// </summary>
+    void onOrderResponse(const map<string, string>& response);
+
+
+    std::optional<OrderState> find(const int64_t orderId) const;
+    std::optional<OrderState> find(std::string_view clientOrderId) const;
+
+    /// <summary>
+    /// NEW and PARTIALLY_FILLED orders, for all symbols if 'symbol' is empty. Iterates all orders held.
+    /// </summary>
+    vector<OrderState> openOrders(std::string_view symbol = {}) const;
+
+    size_t size() const;
+    void clear();
+
+
+  private:
+    static constexpr uint32_t Empty = std::numeric_limits<uint32_t>::max();
+
+    void apply(const OrderState& update);
+
+    uint32_t findById(const int64_t orderId) const;
+    uint32_t findByClientId(std::string_view clientOrderId) const;
+
+    void insert(const uint32_t index);
+    void erase(const uint32_t index);
+    void evict();
+
+    // the tables hold indexes into m_orders, linear probing. Removal shifts entries back rather than leaving tombstones
+    static size_t hash(const int64_t orderId);
+    static size_t hash(std::string_view clientOrderId);
+
+    template<class Matches>
+    static uint32_t probe(const vector<uint32_t>& table, size_t slot, Matches&& matches);
+
+    template<class HashOf>
+    static void eraseSlot(vector<uint32_t>& table, size_t slot, HashOf&& hashOf);
+
+
+    mutable std::mutex m_mux;
+    size_t m_capacity;
+    vector<OrderState> m_orders;
+    vector<uint32_t> m_free;          // unused indexes in m_orders
+    vector<uint32_t> m_idTable;
+    vector<uint32_t> m_clientIdTable;
+    size_t m_mask;
+    std::deque<uint32_t> m_closed;    // oldest first
+  };
+}
+
+#endif
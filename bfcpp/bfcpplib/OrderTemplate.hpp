@@ -0,0 +1,196 @@
+#ifndef __BINANCE_ORDERTEMPLATE_HPP
+#define __BINANCE_ORDERTEMPLATE_HPP
+
+#include <charconv>
+#include <string_view>
+#include "bfcppCommon.hpp"
+#include "Decimal.hpp"
+#include "Signer.hpp"
+
+
+namespace bfcpp
+{
+  /// <summary>
+  /// An order's query string with the fixed params (symbol, side, type, timeInForce, etc) serialised once, on construction.
+  /// Each send only writes price, quantity, newClientOrderId, recvWindow, timestamp and the signature between them, into
+  /// a buffer allocated on construction. See UsdFuturesMarket::newOrder(OrderTemplate&, ...).
+  ///
+  /// The params are in the same order as createQueryString() writes them, so the query is byte for byte the one newOrder(map) sends for the same order.
+  ///
+  /// The buffer is reused, so a template must only be sent by one thread at a time. Use a template per thread or strategy.
+  /// </summary>
+  class OrderTemplate
+  {
+  public:
+    static const size_t MaxClientOrderIdLength = 36;   // Binance's limit for newClientOrderId
+
+  private:
+    // the variable params, with their keys, at their longest
+    static const size_t MaxVariableLength = (7 + Decimal::MaxChars) + (10 + Decimal::MaxChars) + (18 + MaxClientOrderIdLength) + (12 + 20) + (11 + 20) + (11 + Signer::SignatureLength);
+
+  public:
+    /// <summary>
+    ///
+    /// </summary>
+    /// <param name="fixed">The params which don't change between orders. Must include "symbol", and must not include the params set per send</param>
+    explicit OrderTemplate(map<string, string>&& fixed) : m_buy(false), m_market(false), m_reduceOnly(false)
+    {
+      static const std::string_view Variable[] = { "newClientOrderId", "price", "quantity", "recvWindow", "timestamp", "signature" };
+
+      if (auto it = fixed.find("symbol"); it == fixed.cend())
+      {
+        throw BfcppException{ BFCPP_FUNCTION_MSG(" symbol not set") };
+      }
+      else
+      {
+        m_symbol = it->second;
+      }
+
+      // the map is in key order, newClientOrderId, price and quantity go where they'd sort among the fixed params
+      size_t split = 0;
+
+      for (auto& [key, value] : fixed)
+      {
+        if (std::find(std::begin(Variable), std::end(Variable), key) != std::end(Variable))
+        {
+          throw BfcppException{ BFCPP_FUNCTION_MSG(" " + key + " is set per order") };
+        }
+
+        for (; split < 3 && key > Variable[split]; ++split)
+        {
+          m_split[split] = m_fixed.size();
+        }
+
+        m_fixed.append(key).append("=").append(value).append("&");
+      }
+
+      for (; split < 3; ++split)
+      {
+        m_split[split] = m_fixed.size();
+      }
+
+      // for OrderValidator
+      if (auto side = fixed.find("side"); side != fixed.cend())
+        m_buy = side->second == "BUY";
+
+      if (auto type = fixed.find("type"); type != fixed.cend())
+        m_market = type->second.size() >= 6 && type->second.compare(type->second.size() - 6, 6, "MARKET") == 0;
+
+      if (auto reduceOnly = fixed.find("reduceOnly"); reduceOnly != fixed.cend())
+        m_reduceOnly = reduceOnly->second == "true";
+
+      m_query.reserve(m_fixed.size() + MaxVariableLength);
+    }
+
+
+    /// <summary>
+    /// Writes the variable params after the fixed params and signs the query. The returned view is valid until the next build().
+    /// Does not allocate.
+    /// </summary>
+    /// <param name="price">Omitted if zero, i.e. for MARKET orders</param>
+    /// <param name="quantity">Omitted if zero, i.e. with closePosition</param>
+    /// <param name="clientOrderId">Omitted if empty, the exchange then assigns one</param>
+    /// <param name="recvWindow">See UsdFuturesMarket::receiveWindow()</param>
+    /// <param name="timestamp">See getTimestamp() and ClockSync::timestamp()</param>
+    /// <param name="signer">Holds the API secret key</param>
+    std::string_view build(const Decimal& price, const Decimal& quantity, std::string_view clientOrderId, std::string_view recvWindow, const int64_t timestamp, const Signer& signer)
+    {
+      build(price, quantity, clientOrderId, recvWindow, timestamp);
+      return sign(signer);
+    }
+
+
+    /// <summary>
+    /// As build() but the query isn't signed, call sign() before sending it.
+    /// </summary>
+    std::string_view build(const Decimal& price, const Decimal& quantity, std::string_view clientOrderId, std::string_view recvWindow, const int64_t timestamp)
+    {
+      if (clientOrderId.size() > MaxClientOrderIdLength)
+      {
+        throw BfcppException{ BFCPP_FUNCTION_MSG(" clientOrderId too long") };
+      }
+
+      if (recvWindow.size() > 20)
+      {
+        throw BfcppException{ BFCPP_FUNCTION_MSG(" invalid recvWindow") };
+      }
+
+      const std::string_view fixed{ m_fixed };
+
+      m_query.assign(fixed.substr(0, m_split[0]));
+
+      if (!clientOrderId.empty())
+      {
+        m_query.append("newClientOrderId=").append(clientOrderId).append("&");
+      }
+
+      m_query.append(fixed.substr(m_split[0], m_split[1] - m_split[0]));
+
+      char buffer[Decimal::MaxChars];
+
+      if (!price.isZero())
+      {
+        m_query.append("price=").append(buffer, price.format(buffer)).append("&");
+      }
+
+      m_query.append(fixed.substr(m_split[1], m_split[2] - m_split[1]));
+
+      if (!quantity.isZero())
+      {
+        m_query.append("quantity=").append(buffer, quantity.format(buffer)).append("&");
+      }
+
+      m_query.append(fixed.substr(m_split[2]));
+
+      m_query.append("recvWindow=").append(recvWindow);
+
+      auto [end, ec] = std::to_chars(buffer, buffer + sizeof(buffer), timestamp);
+      m_query.append("&timestamp=").append(buffer, end - buffer);
+
+      return m_query;
+    }
+
+
+    /// <summary>
+    /// Signs the query written by build(), then appends the signature.
+    /// </summary>
+    std::string_view sign(const Signer& signer)
+    {
+      char signature[Signer::SignatureLength];
+      signer.sign(m_query, signature);
+
+      m_query.append("&signature=").append(signature, Signer::SignatureLength);
+
+      return m_query;
+    }
+
+
+    const string& symbol() const { return m_symbol; }
+
+    bool buy() const { return m_buy; }
+
+    /// <summary>
+    /// True for MARKET, STOP_MARKET, etc, which don't have a price.
+    /// </summary>
+    bool market() const { return m_market; }
+
+    bool reduceOnly() const { return m_reduceOnly; }
+
+    /// <summary>
+    /// The fixed params, as serialised on construction.
+    /// </summary>
+    std::string_view fixedParams() const { return m_fixed; }
+
+
+  private:
+    string m_symbol;
+    string m_fixed;     // the fixed params, in key order
+    size_t m_split[3];  // where newClientOrderId, price and quantity go in m_fixed
+    string m_query;
+    bool m_buy;
+    bool m_market;
+    bool m_reduceOnly;
+  };
+}
+
+#endif
@@ -0,0 +1,259 @@
+#include "OrderValidator.hpp"
+
+
+namespace bfcpp
+{
+  namespace
+  {
+    // the value as an integer at 'scale', false if it has non-zero digits beyond the scale
+    bool toUnits(const Decimal& value, const unsigned scale, int64_t& units)
+    {
+      if (value.scale() <= scale)
+      {
+        units = value.rescale(scale).raw();
+        return true;
+      }
+
+      const auto divisor = Decimal::pow10(value.scale() - scale);
+      units = value.raw() / divisor;
+      return value.raw() % divisor == 0;
+    }
+
+
+    int64_t roundToUnits(const Decimal& value, const unsigned scale, const int64_t step, const Decimal::Rounding rounding)
+    {
+      return value.roundToStep(Decimal{ step ? step : 1, scale }, rounding).rescale(scale).raw();
+    }
+
+
+    unsigned maxScale(std::initializer_list<Decimal> values, const unsigned precision)
+    {
+      auto scale = precision;
+
+      for (const auto& value : values)
+        scale = std::max(scale, value.scale());
+
+      return scale;
+    }
+  }
+
+
+  OrderValidator::OrderValidator(const ExchangeInfoSnapshot& snapshot) : m_registry(snapshot.registry())
+  {
+    for (const auto& symbol : snapshot.symbols())
+    {
+      addRules(symbol);
+    }
+
+    m_references = std::make_unique<Reference[]>(m_rules.size());
+  }
+
+
+  OrderValidator::OrderValidator(const ExchangeInfo& info)
+  {
+    auto registry = std::make_shared<SymbolRegistry>();
+
+    for (const auto& symbol : info.symbols)
+    {
+      if (SymbolInfo record; SymbolInfo::fromExchangeInfo(symbol, record) && !registry->contains(record.symbol()))
+      {
+        registry->add(record.symbol(), record.scale());
+        addRules(record);
+      }
+    }
+
+    m_registry = std::move(registry);
+    m_references = std::make_unique<Reference[]>(m_rules.size());
+  }
+
+
+  void OrderValidator::addRules(const SymbolInfo& info)
+  {
+    Rules rules;
+
+    rules.priceScale = maxScale({ info.tickSize, info.minPrice, info.maxPrice }, info.pricePrecision);
+    rules.quantityScale = maxScale({ info.stepSize, info.minQty, info.maxQty, info.marketStepSize, info.marketMinQty, info.marketMaxQty }, info.quantityPrecision);
+
+    rules.minPrice = info.minPrice.rescale(rules.priceScale).raw();
+    rules.maxPrice = info.maxPrice.rescale(rules.priceScale).raw();
+    rules.tickSize = info.tickSize.rescale(rules.priceScale).raw();
+
+    rules.minQty = info.minQty.rescale(rules.quantityScale).raw();
+    rules.maxQty = info.maxQty.rescale(rules.quantityScale).raw();
+    rules.stepSize = info.stepSize.rescale(rules.quantityScale).raw();
+
+    // without a MARKET_LOT_SIZE filter market orders use LOT_SIZE
+    const bool marketLot = !info.marketStepSize.isZero() || !info.marketMinQty.isZero() || !info.marketMaxQty.isZero();
+    rules.marketMinQty = marketLot ? info.marketMinQty.rescale(rules.quantityScale).raw() : rules.minQty;
+    rules.marketMaxQty = marketLot ? info.marketMaxQty.rescale(rules.quantityScale).raw() : rules.maxQty;
+    rules.marketStepSize = marketLot ? info.marketStepSize.rescale(rules.quantityScale).raw() : rules.stepSize;
+
+    rules.minNotional = info.minNotional.rescale(rules.priceScale + rules.quantityScale, Decimal::Rounding::Up).raw();
+
+    rules.multiplierUp = info.multiplierUp;
+    rules.multiplierDown = info.multiplierDown;
+
+    m_rules.push_back(rules);
+  }
+
+
+  OrderCheck OrderValidator::check(const SymbolId id, const bool buy, const bool market, const bool reduceOnly, Decimal& price, Decimal& quantity, const bool round) const
+  {
+    if (id >= m_rules.size())
+    {
+      return OrderCheck::UnknownSymbol;
+    }
+
+    const auto& rules = m_rules[id];
+    const auto& reference = m_references[id];
+
+    if (price.raw() < 0 || quantity.raw() < 0 || (!market && price.isZero()))
+    {
+      return OrderCheck::InvalidValue;
+    }
+
+    try
+    {
+      int64_t priceUnits = 0;
+      int64_t quantityUnits = 0;
+      bool priceRounded = false, quantityRounded = false;
+
+      if (!market)
+      {
+        if (!toUnits(price, rules.priceScale, priceUnits) || (rules.tickSize && priceUnits % rules.tickSize))
+        {
+          if (!round)
+            return OrderCheck::PriceTick;
+
+          priceUnits = roundToUnits(price, rules.priceScale, rules.tickSize, buy ? Decimal::Rounding::Down : Decimal::Rounding::Up);
+          priceRounded = true;
+        }
+
+        if (rules.minPrice && priceUnits < rules.minPrice)
+          return OrderCheck::PriceTooLow;
+
+        if (rules.maxPrice && priceUnits > rules.maxPrice)
+          return OrderCheck::PriceTooHigh;
+
+        // the exchange only limits how far a buy is above, or a sell below, the mark price
+        if (const auto highest = reference.highest.load(std::memory_order_relaxed); buy && highest && priceUnits > highest)
+          return OrderCheck::PercentPrice;
+
+        if (const auto lowest = reference.lowest.load(std::memory_order_relaxed); !buy && lowest && priceUnits < lowest)
+          return OrderCheck::PercentPrice;
+      }
+
+      if (!quantity.isZero())
+      {
+        const auto minQty = market ? rules.marketMinQty : rules.minQty;
+        const auto maxQty = market ? rules.marketMaxQty : rules.maxQty;
+        const auto stepSize = market ? rules.marketStepSize : rules.stepSize;
+
+        if (!toUnits(quantity, rules.quantityScale, quantityUnits) || (stepSize && quantityUnits % stepSize))
+        {
+          if (!round)
+            return OrderCheck::QuantityStep;
+
+          quantityUnits = roundToUnits(quantity, rules.quantityScale, stepSize, Decimal::Rounding::Down);
+          quantityRounded = true;
+        }
+
+        if (minQty && quantityUnits < minQty)
+          return OrderCheck::QuantityTooLow;
+
+        if (maxQty && quantityUnits > maxQty)
+          return OrderCheck::QuantityTooHigh;
+
+        // market orders are valued at the mark price, if known
+        const auto notionalPrice = market ? reference.price.load(std::memory_order_relaxed) : priceUnits;
+
+        if (!reduceOnly && rules.minNotional && notionalPrice)
+        {
+          const auto notional = Decimal{ notionalPrice, rules.priceScale }.multiply(Decimal{ quantityUnits, rules.quantityScale }, rules.priceScale + rules.quantityScale);
+
+          if (notional.raw() < rules.minNotional)
+            return OrderCheck::MinNotional;
+        }
+      }
+
+      if (priceRounded)
+        price = Decimal{ priceUnits, rules.priceScale };
+
+      if (quantityRounded)
+        quantity = Decimal{ quantityUnits, rules.quantityScale };
+
+      return OrderCheck::Valid;
+    }
+    catch (const BfcppException&)
+    {
+      // overflow, so far beyond any limit
+      return OrderCheck::InvalidValue;
+    }
+  }
+
+
+  OrderCheck OrderValidator::check(map<string, string>& order, const bool round) const
+  {
+    auto symbol = order.find("symbol");
+
+    if (symbol == order.cend())
+    {
+      return OrderCheck::UnknownSymbol;
+    }
+
+    auto find = [&order](const string& key) -> std::string_view
+    {
+      auto it = order.find(key);
+      return it == order.cend() ? std::string_view{} : std::string_view{ it->second };
+    };
+
+    const auto type = find("type");
+    const bool market = type.size() >= 6 && type.substr(type.size() - 6) == "MARKET";  // MARKET, STOP_MARKET, etc don't have a price
+
+    Decimal price, quantity;
+
+    try
+    {
+      if (auto p = find("price"); !market && !p.empty())
+        price = Decimal::fromString(p);
+
+      if (auto q = find("quantity"); !q.empty())
+        quantity = Decimal::fromString(q);
+    }
+    catch (const std::exception&)
+    {
+      return OrderCheck::InvalidValue;
+    }
+
+    const auto result = check(symbol->second, find("side") == "BUY", market, find("reduceOnly") == "true", price, quantity, round);
+
+    if (result == OrderCheck::Valid && round)
+    {
+      if (auto p = find("price"); !market && !p.empty() && price != Decimal::fromString(p))
+        order["price"] = price.str();
+
+      if (auto q = find("quantity"); !q.empty() && quantity != Decimal::fromString(q))
+        order["quantity"] = quantity.str();
+    }
+
+    return result;
+  }
+
+
+  void OrderValidator::setReferencePrice(const SymbolId id, const Decimal& price)
+  {
+    if (id >= m_rules.size())
+    {
+      return;
+    }
+
+    const auto& rules = m_rules[id];
+    auto& reference = m_references[id];
+
+    const auto mark = price.rescale(rules.priceScale);
+
+    reference.lowest.store(rules.multiplierDown.isZero() ? 0 : mark.multiply(rules.multiplierDown, rules.priceScale, Decimal::Rounding::Up).raw(), std::memory_order_relaxed);
+    reference.highest.store(rules.multiplierUp.isZero() ? 0 : mark.multiply(rules.multiplierUp, rules.priceScale, Decimal::Rounding::Down).raw(), std::memory_order_relaxed);
+    reference.price.store(mark.raw(), std::memory_order_relaxed);
+  }
+}
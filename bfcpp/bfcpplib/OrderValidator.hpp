@@ -0,0 +1,134 @@
+#ifndef __BINANCE_ORDERVALIDATOR_HPP
+#define __BINANCE_ORDERVALIDATOR_HPP
+
+#include <atomic>
+#include <memory>
+#include <string_view>
+#include "bfcppCommon.hpp"
+#include "Decimal.hpp"
+#include "SymbolRegistry.hpp"
+#include "ExchangeInfoCache.hpp"
+
+
+namespace bfcpp
+{
+  /// <summary>
+  /// The result of OrderValidator::check(). Each is the filter the exchange would reject the order with.
+  /// </summary>
+  enum class OrderCheck : uint8_t
+  {
+    Valid,
+    UnknownSymbol,
+    InvalidValue,     // price or quantity missing, negative or not a number
+    PriceTooLow,      // PRICE_FILTER minPrice
+    PriceTooHigh,     // PRICE_FILTER maxPrice
+    PriceTick,        // PRICE_FILTER tickSize
+    QuantityTooLow,   // LOT_SIZE/MARKET_LOT_SIZE minQty
+    QuantityTooHigh,  // LOT_SIZE/MARKET_LOT_SIZE maxQty
+    QuantityStep,     // LOT_SIZE/MARKET_LOT_SIZE stepSize
+    MinNotional,      // MIN_NOTIONAL
+    PercentPrice      // PERCENT_PRICE
+  };
+
+
+  inline const char* toString(const OrderCheck check)
+  {
+    static const char* Names[] = { "Valid", "UnknownSymbol", "InvalidValue", "PriceTooLow", "PriceTooHigh", "PriceTick", "QuantityTooLow",
+                                   "QuantityTooHigh", "QuantityStep", "MinNotional", "PercentPrice" };
+
+    return Names[static_cast<size_t>(check)];
+  }
+
+
+  /// <summary>
+  /// Checks orders against their symbol's filters before they're sent, so an order the exchange would reject
+  /// doesn't cost a round trip and rate limit weight. See UsdFuturesMarket::setOrderValidator().
+  ///
+  /// Each symbol's filters are converted on construction to integers at the scale of the symbol's tickSize and stepSize,
+  /// so a check is a rescale, compares and a modulo per filter, with no allocation.
+  ///
+  /// PERCENT_PRICE, and MIN_NOTIONAL for MARKET orders, need the mark price, set with setReferencePrice(), i.e. from monitorMarkPrice().
+  /// Until set, those checks pass. reduceOnly orders are exempt from MIN_NOTIONAL, as on the exchange.
+  ///
+  /// check() is const and setReferencePrice() is lock free, so a validator can be shared between threads.
+  /// </summary>
+  class OrderValidator
+  {
+  public:
+    /// <summary>
+    /// Checks use the snapshot's symbol ids.
+    /// </summary>
+    explicit OrderValidator(const ExchangeInfoSnapshot& snapshot);
+
+    explicit OrderValidator(const ExchangeInfo& info);
+
+
+    /// <summary>
+    /// Checks the order's price and quantity. If 'round' is true, a price off tick is rounded to the tick (down for a BUY, up for a SELL,
+    /// so never to a worse price) and a quantity off step is rounded down, rather than failing.
+    /// </summary>
+    /// <param name="price">The limit price, zero for MARKET orders</param>
+    /// <param name="quantity">Zero with closePosition</param>
+    OrderCheck check(const SymbolId id, const bool buy, const bool market, const bool reduceOnly, Decimal& price, Decimal& quantity, const bool round = false) const;
+
+    OrderCheck check(std::string_view symbol, const bool buy, const bool market, const bool reduceOnly, Decimal& price, Decimal& quantity, const bool round = false) const
+    {
+      return check(m_registry->id(symbol), buy, market, reduceOnly, price, quantity, round);
+    }
+
+    /// <summary>
+    /// Checks an order as passed to newOrder(). If 'round' is true and the price or quantity are rounded, they are replaced in the order.
+    /// </summary>
+    OrderCheck check(map<string, string>& order, const bool round = false) const;
+
+
+    /// <summary>
+    /// The mark price PERCENT_PRICE is relative to. Ignored for an unknown symbol.
+    /// </summary>
+    void setReferencePrice(const SymbolId id, const Decimal& price);
+
+    void setReferencePrice(std::string_view symbol, const Decimal& price)
+    {
+      setReferencePrice(m_registry->id(symbol), price);
+    }
+
+
+    const shared_ptr<const SymbolRegistry>& registry() const { return m_registry; }
+
+
+  private:
+    // a symbol's filters as integers, 0 if the filter is absent
+    struct Rules
+    {
+      unsigned priceScale;
+      unsigned quantityScale;
+
+      int64_t minPrice, maxPrice, tickSize;             // at priceScale
+      int64_t minQty, maxQty, stepSize;                 // at quantityScale
+      int64_t marketMinQty, marketMaxQty, marketStepSize;
+      int64_t minNotional;                              // at priceScale + quantityScale
+
+      Decimal multiplierUp;
+      Decimal multiplierDown;
+    };
+
+    // the mark price and the PERCENT_PRICE band from it, at priceScale: a buy can't be above highest, a sell below lowest.
+    // Each is atomic, a check may see a band from the previous price
+    struct Reference
+    {
+      std::atomic<int64_t> price{ 0 };
+      std::atomic<int64_t> lowest{ 0 };
+      std::atomic<int64_t> highest{ 0 };
+    };
+
+
+    void addRules(const SymbolInfo& info);
+
+
+    shared_ptr<const SymbolRegistry> m_registry;
+    vector<Rules> m_rules;  // indexed by SymbolId
+    std::unique_ptr<Reference[]> m_references;
+  };
+}
+
+#endif
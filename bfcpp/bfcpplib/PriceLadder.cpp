@@ -0,0 +1,172 @@
+#include <algorithm>
+#include "PriceLadder.hpp"
+
+
+namespace bfcpp
+{
+  PriceLadder::PriceLadder(const string& tickSize, const size_t capacity, const unsigned quantityDecimals) :
+    m_priceDecimals(decimalPlaces(tickSize)), m_quantityDecimals(quantityDecimals), m_low(NoTick), m_bestBid(NoTick), m_bestAsk(NoTick),
+    m_truncated(false), m_truncatedLevels(0)
+  {
+    m_tickUnits = toFixedPoint(tickSize, m_priceDecimals);
+
+    if (m_tickUnits <= 0)
+    {
+      throw BfcppException{ BFCPP_FUNCTION_MSG(" invalid tick size: " + tickSize) };
+    }
+
+    size_t size = 2;
+    while (size < capacity)
+    {
+      size <<= 1;
+    }
+
+    m_mask = size - 1;
+    m_bids.resize(size, 0);
+    m_asks.resize(size, 0);
+  }
+
+
+  void PriceLadder::set(const Side side, const int64_t tick, const int64_t quantity)
+  {
+    if (!inWindow(tick) && !moveWindow(tick))
+    {
+      // too far from the mid, removing a level which isn't held loses nothing
+      if (quantity != 0)
+      {
+        truncate(1);
+      }
+
+      return;
+    }
+
+    levels(side)[slot(tick)] = quantity;
+
+    if (side == Side::Bid)
+    {
+      if (quantity != 0)
+      {
+        if (m_bestBid == NoTick || tick > m_bestBid)
+          m_bestBid = tick;
+      }
+      else if (tick == m_bestBid)
+      {
+        m_bestBid = scan(Side::Bid, tick - 1);
+      }
+    }
+    else
+    {
+      if (quantity != 0)
+      {
+        if (m_bestAsk == NoTick || tick < m_bestAsk)
+          m_bestAsk = tick;
+      }
+      else if (tick == m_bestAsk)
+      {
+        m_bestAsk = scan(Side::Ask, tick + 1);
+      }
+    }
+  }
+
+
+  void PriceLadder::clear()
+  {
+    std::fill(m_bids.begin(), m_bids.end(), 0);
+    std::fill(m_asks.begin(), m_asks.end(), 0);
+
+    m_low = NoTick;
+    m_bestBid = NoTick;
+    m_bestAsk = NoTick;
+    m_truncated = false;
+  }
+
+
+  bool PriceLadder::moveWindow(const int64_t tick)
+  {
+    const auto size = static_cast<int64_t>(m_bids.size());
+    const auto half = size / 2;
+
+    if (m_low == NoTick)
+    {
+      m_low = tick - half;
+      return true;
+    }
+
+
+    // centre on the mid, or between the only best price and the new tick
+    int64_t centre = tick;
+
+    if (m_bestBid != NoTick && m_bestAsk != NoTick)
+      centre = m_bestBid + (m_bestAsk - m_bestBid) / 2;
+    else if (m_bestBid != NoTick)
+      centre = m_bestBid + (tick - m_bestBid) / 2;
+    else if (m_bestAsk != NoTick)
+      centre = m_bestAsk + (tick - m_bestAsk) / 2;
+
+    const int64_t low = centre - half;
+
+    if (tick < low || tick >= low + size || low == m_low)
+    {
+      return false;
+    }
+
+
+    // clear the slots for ticks leaving the window, these are reused for ticks entering
+    uint64_t dropped = 0;
+
+    if (const auto delta = low - m_low; delta >= size || delta <= -size)
+    {
+      dropped = std::count_if(m_bids.cbegin(), m_bids.cend(), [](const int64_t q) { return q != 0; }) +
+                std::count_if(m_asks.cbegin(), m_asks.cend(), [](const int64_t q) { return q != 0; });
+
+      std::fill(m_bids.begin(), m_bids.end(), 0);
+      std::fill(m_asks.begin(), m_asks.end(), 0);
+    }
+    else
+    {
+      const int64_t from = delta > 0 ? m_low : low + size;
+      const int64_t to = delta > 0 ? low : m_low + size;
+
+      for (int64_t t = from; t < to; ++t)
+      {
+        dropped += (m_bids[slot(t)] != 0) + (m_asks[slot(t)] != 0);
+        m_bids[slot(t)] = 0;
+        m_asks[slot(t)] = 0;
+      }
+    }
+
+    if (dropped)
+    {
+      truncate(dropped);
+    }
+
+    m_low = low;
+
+    if (m_bestBid != NoTick && !inWindow(m_bestBid))
+    {
+      m_bestBid = m_bestBid < m_low ? NoTick : scan(Side::Bid, m_low + size - 1);
+    }
+
+    if (m_bestAsk != NoTick && !inWindow(m_bestAsk))
+    {
+      m_bestAsk = m_bestAsk >= m_low + size ? NoTick : scan(Side::Ask, m_low);
+    }
+
+    return true;
+  }
+
+
+  int64_t PriceLadder::scan(const Side side, int64_t from) const
+  {
+    const auto& qty = levels(side);
+    const int64_t step = side == Side::Bid ? -1 : 1;
+
+    for (; inWindow(from); from += step)
+    {
+      if (qty[slot(from)] != 0)
+        return from;
+    }
+
+    return NoTick;
+  }
+}
@@ -0,0 +1,235 @@
+#ifndef __BINANCE_PRICELADDER_HPP
+#define __BINANCE_PRICELADDER_HPP
+
+#include <limits>
+#include "bfcppCommon.hpp"
+#include "Decimal.hpp"
+
+
+namespace bfcpp
+{
+  /// <summary>
+  /// A flat, integer indexed order book for a single symbol.
+  ///
+  /// Prices are converted to a tick index (price / tickSize) and quantities to integers scaled by 10^quantityDecimals, so an update
+  /// is a single write to a contiguous int64 array with no string compares or allocations.
+  ///
+  /// The arrays hold a window of 'capacity' ticks, indexed circularly. The window is centred on the first price set and moves
+  /// with the mid price. Levels which are further than capacity/2 ticks from the mid are not kept, so choose a capacity
+  /// which covers the depth you need. Dropping a level is counted, see truncated(): levels beyond the window aren't restored
+  /// if the window moves back over them, so the book has holes until it is rebuilt from a snapshot.
+  ///
+  /// Finding the next best price after the best level is removed is a linear scan over the array.
+  ///
+  /// Not thread safe, see LocalOrderBook.
+  /// </summary>
+  class PriceLadder
+  {
+  public:
+    enum class Side { Bid, Ask };
+
+    static constexpr int64_t NoTick = std::numeric_limits<int64_t>::min();
+    static constexpr unsigned DefaultQuantityDecimals = 8;
+
+
+    /// <summary>
+    ///
+    /// </summary>
+    /// <param name="tickSize">The PRICE_FILTER tickSize for the symbol from exchangeInfo(), i.e. "0.10". See getTickSize().</param>
+    /// <param name="capacity">The number of ticks held, rounded up to a power of two</param>
+    /// <param name="quantityDecimals">Quantities are stored as integers scaled by 10^quantityDecimals</param>
+    PriceLadder(const string& tickSize, const size_t capacity = 8192, const unsigned quantityDecimals = DefaultQuantityDecimals);
+
+
+    /// <summary>
+    /// Converts a price string to a tick index, rounding to the nearest tick (halves away from zero) if the price isn't a multiple of the tick size.
+    /// </summary>
+    int64_t toTick(std::string_view price) const
+    {
+      // parse with the price's own decimal places so digits finer than the tick size take part in the rounding
+      unsigned decimals = m_priceDecimals;
+      int64_t units = m_tickUnits;
+
+      for (const auto places = std::min(decimalPlaces(price), Decimal::MaxScale); decimals < places; ++decimals)
+      {
+        units *= 10;
+      }
+
+      const auto value = toFixedPoint(price, decimals);
+      const auto remainder = value % units;
+      auto tick = value / units;
+
+      if (const auto magnitude = remainder < 0 ? -remainder : remainder; magnitude * 2 >= units)
+      {
+        tick += value < 0 ? -1 : 1;
+      }
+
+      return tick;
+    }
+
+
+    /// <summary>
+    /// Converts a quantity string to a scaled integer.
+    /// </summary>
+    int64_t toQuantity(std::string_view quantity) const
+    {
+      return toFixedPoint(quantity, m_quantityDecimals);
+    }
+
+
+    Decimal tickToPrice(const int64_t tick) const
+    {
+      return Decimal{ tick * m_tickUnits, m_priceDecimals };
+    }
+
+
+    Decimal toDecimalQuantity(const int64_t quantity) const
+    {
+      return Decimal{ quantity, m_quantityDecimals };
+    }
+
+
+    /// <summary>
+    /// Sets the absolute quantity at the tick, a zero quantity removes the level.
+    /// </summary>
+    void set(const Side side, const int64_t tick, const int64_t quantity);
+
+
+    /// <summary>
+    /// The quantity at the tick, zero if there is no level or the tick is outside the window.
+    /// </summary>
+    int64_t quantity(const Side side, const int64_t tick) const
+    {
+      return inWindow(tick) ? levels(side)[slot(tick)] : 0;
+    }
+
+
+    /// <summary>
+    /// The best bid tick or NoTick.
+    /// </summary>
+    int64_t bestBid() const { return m_bestBid; }
+
+
+    /// <summary>
+    /// The best ask tick or NoTick.
+    /// </summary>
+    int64_t bestAsk() const { return m_bestAsk; }
+
+
+    /// <summary>
+    /// Calls f(tick, quantity) for up to 'depth' levels, best price first.
+    /// </summary>
+    template<class F>
+    void forEachLevel(const Side side, const size_t depth, F f) const
+    {
+      const auto& qty = levels(side);
+      const int64_t best = side == Side::Bid ? m_bestBid : m_bestAsk;
+      const int64_t step = side == Side::Bid ? -1 : 1;
+
+      size_t count = 0;
+      for (int64_t tick = best; best != NoTick && count < depth && inWindow(tick); tick += step)
+      {
+        if (auto q = qty[slot(tick)]; q != 0)
+        {
+          f(tick, q);
+          ++count;
+        }
+      }
+    }
+
+
+    /// <summary>
+    /// Removes all levels and clears truncated().
+    /// </summary>
+    void clear();
+
+
+    size_t capacity() const { return m_bids.size(); }
+
+
+    /// <summary>
+    /// True if a level has been dropped, because it was outside the window or the window moved away from it, since the last clear().
+    /// The best prices are still correct but levels further from the mid may be missing.
+    /// </summary>
+    bool truncated() const { return m_truncated; }
+
+
+    /// <summary>
+    /// The number of levels dropped since construction.
+    /// </summary>
+    uint64_t truncatedLevels() const { return m_truncatedLevels; }
+
+
+  private:
+    bool inWindow(const int64_t tick) const
+    {
+      return m_low != NoTick && tick >= m_low && tick < m_low + static_cast<int64_t>(m_bids.size());
+    }
+
+    size_t slot(const int64_t tick) const
+    {
+      return static_cast<size_t>(tick) & m_mask;
+    }
+
+    vector<int64_t>& levels(const Side side) { return side == Side::Bid ? m_bids : m_asks; }
+    const vector<int64_t>& levels(const Side side) const { return side == Side::Bid ? m_bids : m_asks; }
+
+    bool moveWindow(const int64_t tick);
+    void truncate(const uint64_t levels) { m_truncated = true; m_truncatedLevels += levels; }
+    int64_t scan(const Side side, int64_t from) const;
+
+
+  private:
+    unsigned m_priceDecimals;
+    unsigned m_quantityDecimals;
+    int64_t m_tickUnits;
+
+    size_t m_mask;
+    int64_t m_low;
+    int64_t m_bestBid;
+    int64_t m_bestAsk;
+    vector<int64_t> m_bids;
+    vector<int64_t> m_asks;
+    bool m_truncated;
+    uint64_t m_truncatedLevels;
+  };
+
+
+  /// <summary>
+  /// Returns the PRICE_FILTER tickSize for the symbol, or an empty string if not found.
+  /// </summary>
+  inline string getTickSize(const ExchangeInfo::Symbol& symbol)
+  {
+    for (const auto& filter : symbol.filters)
+    {
+      if (auto type = filter.find("filterType"); type != filter.cend() && type->second == "PRICE_FILTER")
+      {
+        if (auto tickSize = filter.find("tickSize"); tickSize != filter.cend())
+        {
+          return tickSize->second;
+        }
+      }
+    }
+
+    return {};
+  }
+
+
+  /// <summary>
+  /// Returns the PRICE_FILTER tickSize for the symbol, or an empty string if not found.
+  /// </summary>
+  inline string getTickSize(const ExchangeInfo& info, const string& symbol)
+  {
+    for (const auto& sym : info.symbols)
+    {
+      if (auto name = sym.data.find("symbol"); name != sym.data.cend() && name->second == symbol)
+      {
+        return getTickSize(sym);
+      }
+    }
+
+    return {};
+  }
+}
+
+#endif
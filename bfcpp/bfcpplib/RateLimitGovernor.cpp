@@ -0,0 +1,406 @@
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include "RateLimitGovernor.hpp"
+
+
+namespace bfcpp
+{
+  namespace
+  {
+    int64_t nowMs()
+    {
+      return std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now().time_since_epoch()).count();
+    }
+
+
+    // "1M", "10S", etc, as in the header names and ExchangeInfo intervals
+    std::chrono::seconds toInterval(const uint32_t count, const char unit)
+    {
+      switch (unit)
+      {
+      case 's': case 'S': return std::chrono::seconds{ count };
+      case 'm': case 'M': return std::chrono::seconds{ count * 60 };
+      case 'h': case 'H': return std::chrono::seconds{ count * 3600 };
+      case 'd': case 'D': return std::chrono::seconds{ count * 86400 };
+      default: return std::chrono::seconds{ 0 };
+      }
+    }
+
+
+    bool startsWithNoCase(std::string_view str, std::string_view prefix)
+    {
+      return str.size() >= prefix.size() && std::equal(prefix.cbegin(), prefix.cend(), str.cbegin(), [](const char a, const char b) { return std::tolower(a) == std::tolower(b); });
+    }
+  }
+
+
+  RateLimitGovernor::RateLimitGovernor() : m_mode(Mode::Off), m_maxWait(std::chrono::seconds{ 10 }), m_dataShare(0.8), m_retryAfter(0), m_ordersWaiting(0)
+  {
+    using namespace std::chrono_literals;
+
+    setLimits({ {RateLimit::Type::RequestWeight, 60s, 2400}, {RateLimit::Type::Orders, 60s, 1200}, {RateLimit::Type::Orders, 10s, 300} });
+
+    m_weights.fill(1);
+    m_weights[static_cast<size_t>(RestCall::None)] = 0;
+    m_weights[static_cast<size_t>(RestCall::NewOrder)] = 0;  // orders only count against the order limits
+    m_weights[static_cast<size_t>(RestCall::NewBatchOrder)] = 5;
+    m_weights[static_cast<size_t>(RestCall::AllOrders)] = 5;
+    m_weights[static_cast<size_t>(RestCall::AccountInfo)] = 5;
+    m_weights[static_cast<size_t>(RestCall::AccountBalance)] = 5;
+    m_weights[static_cast<size_t>(RestCall::KlineCandles)] = 5;
+    m_weights[static_cast<size_t>(RestCall::OrderBook)] = 10;
+  }
+
+
+  void RateLimitGovernor::setLimits(const vector<RateLimit>& limits)
+  {
+    std::scoped_lock lock(m_mux);
+
+    m_windows.clear();
+
+    for (const auto& limit : limits)
+    {
+      if (limit.interval.count() > 0)
+      {
+        m_windows.push_back(Window{ limit, 0, 0 });
+      }
+    }
+  }
+
+
+  void RateLimitGovernor::setLimits(const ExchangeInfo& info)
+  {
+    if (auto limits = readLimits(info); !limits.empty())
+    {
+      setLimits(limits);
+    }
+  }
+
+
+  vector<RateLimit> RateLimitGovernor::readLimits(const ExchangeInfo& info)
+  {
+    vector<RateLimit> limits;
+
+    for (const auto& rate : info.rateLimits)
+    {
+      auto type = rate.find("rateLimitType"), interval = rate.find("interval"), intervalNum = rate.find("intervalNum"), limit = rate.find("limit");
+
+      if (type == rate.cend() || interval == rate.cend() || intervalNum == rate.cend() || limit == rate.cend() || interval->second.empty())
+        continue;
+
+      RateLimit rateLimit;
+      std::memset(static_cast<void*>(&rateLimit), 0, sizeof(rateLimit)); // ExchangeInfoCache writes these to disk
+
+      if (type->second == "REQUEST_WEIGHT")
+        rateLimit.type = RateLimit::Type::RequestWeight;
+      else if (type->second == "ORDERS")
+        rateLimit.type = RateLimit::Type::Orders;
+      else
+        continue;
+
+      // "MINUTE", "SECOND", etc
+      rateLimit.interval = toInterval(std::stoul(intervalNum->second), interval->second[0]);
+      rateLimit.limit = std::stoul(limit->second);
+
+      limits.push_back(rateLimit);
+    }
+
+    return limits;
+  }
+
+
+  vector<RateLimit> RateLimitGovernor::limits() const
+  {
+    std::scoped_lock lock(m_mux);
+
+    vector<RateLimit> limits;
+    for (const auto& window : m_windows)
+      limits.push_back(window.limit);
+
+    return limits;
+  }
+
+
+  void RateLimitGovernor::setMode(const Mode mode)
+  {
+    std::scoped_lock lock(m_mux);
+    m_mode = mode;
+  }
+
+
+  RateLimitGovernor::Mode RateLimitGovernor::mode() const
+  {
+    std::scoped_lock lock(m_mux);
+    return m_mode;
+  }
+
+
+  void RateLimitGovernor::setMaxWait(const std::chrono::milliseconds wait)
+  {
+    std::scoped_lock lock(m_mux);
+    m_maxWait = wait;
+  }
+
+
+  void RateLimitGovernor::setDataShare(const double share)
+  {
+    std::scoped_lock lock(m_mux);
+    m_dataShare = std::clamp(share, 0.0, 1.0);
+  }
+
+
+  void RateLimitGovernor::setWeight(const RestCall call, const uint32_t weight)
+  {
+    std::scoped_lock lock(m_mux);
+    m_weights[static_cast<size_t>(call)] = weight;
+  }
+
+
+  uint32_t RateLimitGovernor::weight(const RestCall call) const
+  {
+    std::scoped_lock lock(m_mux);
+    return m_weights[static_cast<size_t>(call)];
+  }
+
+
+  RateLimitGovernor::Priority RateLimitGovernor::priority(const RestCall call)
+  {
+    switch (call)
+    {
+    case RestCall::NewOrder:
+    case RestCall::NewBatchOrder:
+    case RestCall::CancelOrder:
+      return Priority::Order;
+
+    default:
+      return Priority::Data;
+    }
+  }
+
+
+  uint32_t RateLimitGovernor::orderCount(const RestCall call)
+  {
+    switch (call)
+    {
+    case RestCall::NewOrder:
+      return 1;
+
+    case RestCall::NewBatchOrder:
+      return 5; // the batch's size isn't known here, assume the max. Corrected by the response headers
+
+    default:
+      return 0;
+    }
+  }
+
+
+  void RateLimitGovernor::acquire(const RestCall call)
+  {
+    const auto callPriority = priority(call);
+
+    std::unique_lock lock(m_mux);
+
+    auto now = nowMs();
+    auto wait = tryReserve(call, callPriority, now);
+
+    if (wait.count() == 0)
+    {
+      return;
+    }
+
+    if (m_mode == Mode::FailFast)
+    {
+      throw BfcppRateLimitException{ "request would exceed the limit, retry in " + std::to_string(wait.count()) + "ms" };
+    }
+
+    const auto deadline = now + m_maxWait.count();
+
+    if (callPriority == Priority::Order)
+      ++m_ordersWaiting;
+
+    while (wait.count() > 0)
+    {
+      if (now + wait.count() > deadline)
+      {
+        if (callPriority == Priority::Order)
+          --m_ordersWaiting;
+
+        throw BfcppRateLimitException{ "waited longer than maxWait" };
+      }
+
+      m_cv.wait_for(lock, wait);
+
+      now = nowMs();
+      wait = tryReserve(call, callPriority, now);
+    }
+
+    if (callPriority == Priority::Order)
+    {
+      --m_ordersWaiting;
+      m_cv.notify_all();  // data requests held back for this order
+    }
+  }
+
+
+  std::chrono::milliseconds RateLimitGovernor::tryReserve(const RestCall call, const Priority priority, const int64_t now)
+  {
+    using namespace std::chrono_literals;
+
+    const auto weight = m_weights[static_cast<size_t>(call)];
+    const auto orders = orderCount(call);
+
+    if (m_mode == Mode::Off)
+    {
+      for (auto& window : m_windows)
+      {
+        roll(window, now);
+        window.used += window.limit.type == RateLimit::Type::RequestWeight ? weight : orders;
+      }
+
+      return 0ms;
+    }
+
+    if (now < m_retryAfter)
+    {
+      return std::chrono::milliseconds{ m_retryAfter - now };
+    }
+
+    if (priority == Priority::Data && m_ordersWaiting > 0)
+    {
+      return 1ms;
+    }
+
+    int64_t wait = 0;
+
+    for (auto& window : m_windows)
+    {
+      roll(window, now);
+
+      const auto cost = window.limit.type == RateLimit::Type::RequestWeight ? weight : orders;
+
+      if (cost == 0)
+        continue;
+
+      const auto available = priority == Priority::Data && window.limit.type == RateLimit::Type::RequestWeight ? static_cast<uint32_t>(window.limit.limit * m_dataShare) : window.limit.limit;
+
+      if (window.used + cost > available)
+      {
+        wait = std::max<int64_t>(wait, window.start + std::chrono::duration_cast<std::chrono::milliseconds>(window.limit.interval).count() - now);
+      }
+    }
+
+    if (wait > 0)
+    {
+      return std::chrono::milliseconds{ wait };
+    }
+
+    for (auto& window : m_windows)
+    {
+      window.used += window.limit.type == RateLimit::Type::RequestWeight ? weight : orders;
+    }
+
+    return 0ms;
+  }
+
+
+  void RateLimitGovernor::roll(Window& window, const int64_t now) const
+  {
+    const auto interval = std::chrono::duration_cast<std::chrono::milliseconds>(window.limit.interval).count();
+    const auto start = now - (now % interval);
+
+    if (start != window.start)
+    {
+      window.start = start;
+      window.used = 0;
+    }
+  }
+
+
+  void RateLimitGovernor::onResponse(const web::http::status_code status, const web::http::http_headers& headers)
+  {
+    static const std::string_view UsedWeightHeader = "x-mbx-used-weight-";
+    static const std::string_view OrderCountHeader = "x-mbx-order-count-";
+    static const std::string_view RetryAfterHeader = "retry-after";
+
+    std::scoped_lock lock(m_mux);
+
+    const auto now = nowMs();
+
+    for (const auto& header : headers)
+    {
+      const auto name = utility::conversions::to_utf8string(header.first);
+
+      RateLimit::Type type;
+      std::string_view interval;
+
+      if (startsWithNoCase(name, UsedWeightHeader))
+      {
+        type = RateLimit::Type::RequestWeight;
+        interval = std::string_view{ name }.substr(UsedWeightHeader.size());
+      }
+      else if (startsWithNoCase(name, OrderCountHeader))
+      {
+        type = RateLimit::Type::Orders;
+        interval = std::string_view{ name }.substr(OrderCountHeader.size());
+      }
+      else if ((status == 429 || status == 418) && name.size() == RetryAfterHeader.size() && startsWithNoCase(name, RetryAfterHeader))
+      {
+        try
+        {
+          m_retryAfter = std::max<int64_t>(m_retryAfter, now + std::stoll(utility::conversions::to_utf8string(header.second)) * 1000);
+        }
+        catch (const std::exception&)
+        {
+        }
+        continue;
+      }
+      else
+      {
+        continue;
+      }
+
+      if (interval.size() < 2)
+        continue;
+
+      try
+      {
+        const auto duration = toInterval(std::stoul(string{ interval.substr(0, interval.size() - 1) }), interval.back());
+        const auto used = static_cast<uint32_t>(std::stoul(utility::conversions::to_utf8string(header.second)));
+
+        for (auto& window : m_windows)
+        {
+          if (window.limit.type == type && window.limit.interval == duration)
+          {
+            roll(window, now);
+            window.used = used;
+          }
+        }
+      }
+      catch (const std::exception&)
+      {
+        // malformed header, keep the local count
+      }
+    }
+
+    m_cv.notify_all();
+  }
+
+
+  vector<RateLimitGovernor::Usage> RateLimitGovernor::usage() const
+  {
+    std::scoped_lock lock(m_mux);
+
+    const auto now = nowMs();
+
+    vector<Usage> usage;
+
+    for (auto window : m_windows)
+    {
+      roll(window, now);
+      usage.push_back(Usage{ window.limit, window.used });
+    }
+
+    return usage;
+  }
+}
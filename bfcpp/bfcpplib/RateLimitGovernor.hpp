@@ -0,0 +1,154 @@
+#ifndef __BINANCE_RATELIMITGOVERNOR_HPP
+#define __BINANCE_RATELIMITGOVERNOR_HPP
+
+#include <mutex>
+#include <condition_variable>
+#include <array>
+#include "bfcppCommon.hpp"
+
+
+namespace bfcpp
+{
+  /// <summary>
+  /// Thrown by RateLimitGovernor::acquire() when a request would breach a limit.
+  /// </summary>
+  class BfcppRateLimitException : public BfcppException
+  {
+  public:
+    BfcppRateLimitException(const string& msg) : BfcppException("rate limit: " + msg)
+    {
+
+    }
+  };
+
+
+  /// <summary>
+  /// See the rateLimits in https://binance-docs.github.io/apidocs/futures/en/#exchange-information
+  /// </summary>
+  struct RateLimit
+  {
+    enum class Type { RequestWeight, Orders };
+
+    Type type;
+    std::chrono::seconds interval;
+    uint32_t limit;
+  };
+
+
+  /// <summary>
+  /// Tracks REST request weight and order counts against the exchange's rate limits, so requests can be held back or
+  /// rejected before the exchange returns 429 (and then 418, an IP ban).
+  ///
+  /// Usage is counted locally for each request in each limit's window (windows are aligned to the interval, as Binance's are) and
+  /// corrected from the X-MBX-USED-WEIGHT-* and X-MBX-ORDER-COUNT-* response headers, which are authoritative.
+  /// A 429 or 418 holds all requests for the response's Retry-After.
+  ///
+  /// In Queue and FailFast, order calls (newOrder, cancelOrder, newOrderBatch) have priority: data queries may only use dataShare() of each
+  /// weight limit, and don't proceed while an order call is waiting. The default, Off, only tracks usage so requests behave as they did without the governor.
+  /// </summary>
+  class RateLimitGovernor
+  {
+  public:
+    enum class Mode
+    {
+      Off,      // the default, usage is tracked, requests are never held
+      Queue,    // wait for the window to roll, up to maxWait(), then fail
+      FailFast  // throw BfcppRateLimitException
+    };
+
+    enum class Priority { Order, Data };
+
+    struct Usage
+    {
+      RateLimit limit;
+      uint32_t used;
+    };
+
+
+    /// <summary>
+    /// Starts with Binance's USD-M defaults (2400 weight/min, 1200 orders/min, 300 orders/10s) until setLimits() is called,
+    /// which UsdFuturesMarket does when exchangeInfo() is called.
+    /// </summary>
+    RateLimitGovernor();
+
+
+    void setLimits(const vector<RateLimit>& limits);
+
+    /// <summary>
+    /// Sets the limits from ExchangeInfo::rateLimits. Does nothing if the exchange info has no limits.
+    /// </summary>
+    void setLimits(const ExchangeInfo& info);
+
+    /// <summary>
+    /// The REQUEST_WEIGHT and ORDERS limits in ExchangeInfo::rateLimits.
+    /// </summary>
+    static vector<RateLimit> readLimits(const ExchangeInfo& info);
+
+    vector<RateLimit> limits() const;
+
+
+    void setMode(const Mode mode);
+    Mode mode() const;
+
+    /// <summary>
+    /// The longest a request waits in Mode::Queue before BfcppRateLimitException is thrown.
+    /// </summary>
+    void setMaxWait(const std::chrono::milliseconds wait);
+
+    /// <summary>
+    /// The share of each weight limit data queries can use, the remainder is kept for order calls. Default 0.8.
+    /// </summary>
+    void setDataShare(const double share);
+
+    /// <summary>
+    /// Sets the request weight for a call. Defaults are from the Binance docs, calls whose weight depends on a 'limit' param
+    /// (klines, orderBook) default to a mid value, the response headers then correct the usage.
+    /// </summary>
+    void setWeight(const RestCall call, const uint32_t weight);
+    uint32_t weight(const RestCall call) const;
+
+    static Priority priority(const RestCall call);
+
+
+    /// <summary>
+    /// Reserves the call's weight and order count, applying the mode if it would breach a limit. Called before each request.
+    /// </summary>
+    void acquire(const RestCall call);
+
+    /// <summary>
+    /// Updates usage from the response's headers. Called for each response.
+    /// </summary>
+    void onResponse(const web::http::status_code status, const web::http::http_headers& headers);
+
+    /// <summary>
+    /// Usage in each limit's current window.
+    /// </summary>
+    vector<Usage> usage() const;
+
+
+  private:
+    struct Window
+    {
+      RateLimit limit;
+      int64_t start;    // ms since epoch, aligned to the interval
+      uint32_t used;
+    };
+
+    // reserves and returns zero, or returns how long until the request could proceed
+    std::chrono::milliseconds tryReserve(const RestCall call, const Priority priority, const int64_t now);
+    void roll(Window& window, const int64_t now) const;
+    static uint32_t orderCount(const RestCall call);
+
+    mutable std::mutex m_mux;
+    std::condition_variable m_cv;
+    vector<Window> m_windows;
+    std::array<uint32_t, static_cast<size_t>(RestCall::ServerTime) + 1> m_weights;
+    Mode m_mode;
+    std::chrono::milliseconds m_maxWait;
+    double m_dataShare;
+    int64_t m_retryAfter;     // ms since epoch, after a 429/418
+    size_t m_ordersWaiting;
+  };
+}
+
+#endif
@@ -0,0 +1,108 @@
+#ifndef __BINANCE_RESTCALLSTATISTICS_HPP
+#define __BINANCE_RESTCALLSTATISTICS_HPP
+
+#include <array>
+#include <chrono>
+#include "bfcppCommon.hpp"
+#include "LatencyHistogram.hpp"
+
+
+namespace bfcpp
+{
+  /// <summary>
+  /// A RestCall's timings, see RestCallStatistics::summary().
+  /// </summary>
+  struct RestCallSummary
+  {
+    RestCall call{ RestCall::None };
+    LatencySummary queryBuild;
+    LatencySummary apiCall;
+    LatencySummary responseHandler;
+    LatencySummary bfcppTotalProcess;
+    LatencySummary total;
+  };
+
+
+  /// <summary>
+  /// The RestCallTimings of every REST call, aggregated per RestCall into LatencyHistograms. See UsdFuturesMarket::setRestTiming().
+  /// record() is lock free.
+  /// </summary>
+  class RestCallStatistics
+  {
+  public:
+    typedef std::chrono::steady_clock Clock;
+
+
+    struct Histograms
+    {
+      LatencyHistogram queryBuild;
+      LatencyHistogram apiCall;
+      LatencyHistogram responseHandler;
+      LatencyHistogram bfcppTotalProcess;
+      LatencyHistogram total;   // start to result, including waiting for the rate limit
+    };
+
+
+    void record(const RestCall call, const RestCallTimings& timings, const std::chrono::nanoseconds total)
+    {
+      auto& histograms = m_calls[static_cast<size_t>(call)];
+
+      histograms.queryBuild.record(timings.restQueryBuild);
+      histograms.apiCall.record(timings.restApiCall);
+      histograms.responseHandler.record(timings.restResponseHandler);
+      histograms.bfcppTotalProcess.record(timings.bfcppTotalProcess);
+      histograms.total.record(total);
+    }
+
+
+    const Histograms& histograms(const RestCall call) const
+    {
+      return m_calls[static_cast<size_t>(call)];
+    }
+
+
+    /// <summary>
+    /// The calls which have been made since the last reset().
+    /// </summary>
+    vector<RestCallSummary> summary() const
+    {
+      vector<RestCallSummary> summaries;
+
+      for (size_t i = 0; i < m_calls.size(); ++i)
+      {
+        if (const auto& histograms = m_calls[i]; histograms.total.count())
+        {
+          RestCallSummary summary;
+          summary.call = static_cast<RestCall>(i);
+          summary.queryBuild = histograms.queryBuild.summary();
+          summary.apiCall = histograms.apiCall.summary();
+          summary.responseHandler = histograms.responseHandler.summary();
+          summary.bfcppTotalProcess = histograms.bfcppTotalProcess.summary();
+          summary.total = histograms.total.summary();
+          summaries.emplace_back(std::move(summary));
+        }
+      }
+
+      return summaries;
+    }
+
+
+    void reset()
+    {
+      for (auto& histograms : m_calls)
+      {
+        histograms.queryBuild.reset();
+        histograms.apiCall.reset();
+        histograms.responseHandler.reset();
+        histograms.bfcppTotalProcess.reset();
+        histograms.total.reset();
+      }
+    }
+
+
+  private:
+    std::array<Histograms, static_cast<size_t>(RestCall::ServerTime) + 1> m_calls;
+  };
+}
+
+#endif
@@ -0,0 +1,150 @@
+#ifndef __BINANCE_SIGNER_HPP
+#define __BINANCE_SIGNER_HPP
+
+#include <array>
+#include <string_view>
+#include <openssl/sha.h>
+#include "bfcppCommon.hpp"
+
+
+// SHA256_CTX is deprecated in OpenSSL 3 in favour of EVP, but EVP contexts are heap allocated and can't be copied without allocating
+#if defined(_MSC_VER)
+  #pragma warning(push)
+  #pragma warning(disable: 4996)
+#elif defined(__GNUC__)
+  #pragma GCC diagnostic push
+  #pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+#endif
+
+
+namespace bfcpp
+{
+  /// <summary>
+  /// Signs requests with HMAC-SHA256, as createSignature(), but derives the key pads once, on construction.
+  ///
+  /// HMAC is H((K ^ opad) || H((K ^ ipad) || data)). The SHA256 states after hashing each key pad are kept, so signing copies
+  /// the two states (on the stack) and only hashes the data and the inner digest. The hex is written with a lookup table into the caller's buffer.
+  ///
+  /// sign() is const and doesn't allocate, so a Signer can be shared between threads.
+  /// </summary>
+  class Signer
+  {
+  public:
+    static const size_t SignatureLength = 64;   // hex chars
+
+
+    Signer() : Signer(string{})
+    {
+    }
+
+
+    explicit Signer(const string& secretKey) : m_hasKey(!secretKey.empty())
+    {
+      unsigned char key[SHA256_CBLOCK] = {};
+
+      if (secretKey.size() > SHA256_CBLOCK)
+      {
+        SHA256(reinterpret_cast<const unsigned char*>(secretKey.data()), secretKey.size(), key);
+      }
+      else
+      {
+        std::copy(secretKey.cbegin(), secretKey.cend(), key);
+      }
+
+      unsigned char innerPad[SHA256_CBLOCK];
+      unsigned char outerPad[SHA256_CBLOCK];
+
+      for (size_t i = 0; i < SHA256_CBLOCK; ++i)
+      {
+        innerPad[i] = key[i] ^ 0x36;
+        outerPad[i] = key[i] ^ 0x5c;
+      }
+
+      SHA256_Init(&m_inner);
+      SHA256_Update(&m_inner, innerPad, SHA256_CBLOCK);
+
+      SHA256_Init(&m_outer);
+      SHA256_Update(&m_outer, outerPad, SHA256_CBLOCK);
+    }
+
+
+    /// <summary>
+    /// Writes the signature, SignatureLength lower case hex chars, to 'out'.
+    /// </summary>
+    void sign(std::string_view data, char* out) const
+    {
+      unsigned char digest[SHA256_DIGEST_LENGTH];
+
+      SHA256_CTX ctx = m_inner;
+      SHA256_Update(&ctx, data.data(), data.size());
+      SHA256_Final(digest, &ctx);
+
+      ctx = m_outer;
+      SHA256_Update(&ctx, digest, sizeof(digest));
+      SHA256_Final(digest, &ctx);
+
+      toHex(digest, out);
+    }
+
+
+    string sign(std::string_view data) const
+    {
+      string signature(SignatureLength, '\0');
+      sign(data, signature.data());
+      return signature;
+    }
+
+
+    /// <summary>
+    /// Appends the signature to 'str'. Does not allocate if the string has capacity for it.
+    /// </summary>
+    void appendTo(std::string_view data, string& str) const
+    {
+      char signature[SignatureLength];
+      sign(data, signature);
+      str.append(signature, SignatureLength);
+    }
+
+
+    bool hasKey() const { return m_hasKey; }
+
+
+  private:
+    static void toHex(const unsigned char (&digest)[SHA256_DIGEST_LENGTH], char* out)
+    {
+      static const auto HexPairs = []
+      {
+        const char HexCodes[] = "0123456789abcdef";
+        std::array<char, 512> pairs{};
+
+        for (size_t i = 0; i < 256; ++i)
+        {
+          pairs[i * 2] = HexCodes[i >> 4];
+          pairs[i * 2 + 1] = HexCodes[i & 0x0F];
+        }
+
+        return pairs;
+      }();
+
+      for (size_t i = 0; i < SHA256_DIGEST_LENGTH; ++i)
+      {
+        out[i * 2] = HexPairs[digest[i] * 2];
+        out[i * 2 + 1] = HexPairs[digest[i] * 2 + 1];
+      }
+    }
+
+
+    SHA256_CTX m_inner;
+    SHA256_CTX m_outer;
+    bool m_hasKey;
+  };
+}
+
+
+#if defined(_MSC_VER)
+  #pragma warning(pop)
+#elif defined(__GNUC__)
+  #pragma GCC diagnostic pop
+#endif
+
+#endif
@@ -0,0 +1,207 @@
+#ifndef __BINANCE_SPSCRING_HPP
+#define __BINANCE_SPSCRING_HPP
+
+#include <atomic>
+#include <thread>
+#include <limits>
+#include "bfcppCommon.hpp"
+
+
+namespace bfcpp
+{
+  /// <summary>
+  /// What SpscRing::publish() does when the ring is full.
+  /// </summary>
+  enum class RingOverflow
+  {
+    Drop,   // the new event is dropped and counted, the receive thread never waits
+    Block   // the receive thread waits for the consumer to make space, which stalls the stream's socket
+  };
+
+
+  struct RingStats
+  {
+    uint64_t published{ 0 };
+    uint64_t dropped{ 0 };  // RingOverflow::Drop
+    uint64_t blocked{ 0 };  // RingOverflow::Block, events which had to wait for space
+  };
+
+
+  /// <summary>
+  /// A fixed capacity, lock-free, single producer single consumer ring of T, used to pass stream events from the
+  /// receive thread to a consumer's own thread, see the typed monitor functions which take a ring.
+  ///
+  /// All slots are constructed up front and reused: the producer writes the next event into a slot in place and the consumer
+  /// reads it in place, so once the slots have warmed (i.e. a vector's capacity) nothing allocates.
+  ///
+  /// Only one thread may publish and only one thread may poll/drain. A monitor's frames are handled in sequence,
+  /// so each monitor is a single producer, but a ring must not be shared between monitors.
+  /// </summary>
+  template<class T>
+  class SpscRing
+  {
+    static const size_t CacheLine = 64;
+
+  public:
+    /// <summary>
+    ///
+    /// </summary>
+    /// <param name="capacity">Rounded up to a power of two</param>
+    /// <param name="overflow">What publish() does when the ring is full</param>
+    SpscRing(const size_t capacity, const RingOverflow overflow = RingOverflow::Drop) : m_overflow(overflow)
+    {
+      if (capacity == 0 || capacity > (std::numeric_limits<size_t>::max() >> 1))
+      {
+        throw BfcppException{ BFCPP_FUNCTION_MSG(" invalid capacity") };
+      }
+
+      size_t size = 1;
+      while (size < capacity)
+        size <<= 1;
+
+      m_slots.resize(size);
+      m_mask = size - 1;
+    }
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+
+    /// <summary>
+    /// Producer. Calls write(T& slot) to fill the next slot then makes it visible to the consumer. Returns false, without calling write(), if full.
+    /// If write() throws, nothing is published.
+    /// </summary>
+    template<class F>
+    bool tryPublish(F&& write)
+    {
+      const auto head = m_head.load(std::memory_order_relaxed);
+
+      if (head - m_tailCache == m_slots.size())
+      {
+        m_tailCache = m_tail.load(std::memory_order_acquire);
+
+        if (head - m_tailCache == m_slots.size())
+          return false;
+      }
+
+      write(m_slots[head & m_mask]);
+
+      m_head.store(head + 1, std::memory_order_release);
+      m_published.store(m_published.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+      return true;
+    }
+
+
+    /// <summary>
+    /// Producer. As tryPublish() but applies the overflow policy when full. With RingOverflow::Block this waits
+    /// until there is space or the token is cancelled. Returns true if the event was published.
+    /// </summary>
+    template<class F>
+    bool publish(F&& write, const pplx::cancellation_token& cancel = pplx::cancellation_token::none())
+    {
+      if (tryPublish(write))
+        return true;
+
+      if (m_overflow == RingOverflow::Drop)
+      {
+        m_dropped.store(m_dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return false;
+      }
+
+      m_blocked.store(m_blocked.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+      while (!cancel.is_canceled())
+      {
+        std::this_thread::yield();
+
+        if (tryPublish(write))
+          return true;
+      }
+
+      return false;
+    }
+
+
+    /// <summary>
+    /// Consumer. Calls read(T& event) with the oldest event then releases its slot. Returns false if empty.
+    /// The event is only valid during read(), the slot is reused.
+    /// </summary>
+    template<class F>
+    bool poll(F&& read)
+    {
+      const auto tail = m_tail.load(std::memory_order_relaxed);
+
+      if (tail == m_headCache)
+      {
+        m_headCache = m_head.load(std::memory_order_acquire);
+
+        if (tail == m_headCache)
+          return false;
+      }
+
+      read(m_slots[tail & m_mask]);
+
+      m_tail.store(tail + 1, std::memory_order_release);
+      return true;
+    }
+
+
+    /// <summary>
+    /// Consumer. Calls read(T& event) for each available event, up to max, returns the number read.
+    /// </summary>
+    template<class F>
+    size_t drain(F&& read, const size_t max = std::numeric_limits<size_t>::max())
+    {
+      size_t count = 0;
+
+      while (count < max && poll(read))
+        ++count;
+
+      return count;
+    }
+
+
+    /// <summary>
+    /// The number of events waiting. Only exact when called by the producer or consumer.
+    /// </summary>
+    size_t size() const
+    {
+      return static_cast<size_t>(m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire));
+    }
+
+    bool empty() const { return size() == 0; }
+    size_t capacity() const { return m_slots.size(); }
+    RingOverflow overflow() const { return m_overflow; }
+
+
+    /// <summary>
+    /// Counters since construction, can be called from any thread.
+    /// </summary>
+    RingStats stats() const
+    {
+      RingStats stats;
+      stats.published = m_published.load(std::memory_order_relaxed);
+      stats.dropped = m_dropped.load(std::memory_order_relaxed);
+      stats.blocked = m_blocked.load(std::memory_order_relaxed);
+      return stats;
+    }
+
+
+  private:
+    vector<T> m_slots;
+    size_t m_mask;
+    RingOverflow m_overflow;
+
+    // producer and consumer indices are on separate cache lines, each side caches the other's index to avoid reading it on every call
+    alignas(CacheLine) std::atomic<uint64_t> m_head{ 0 };
+    uint64_t m_tailCache{ 0 };
+    std::atomic<uint64_t> m_published{ 0 };
+    std::atomic<uint64_t> m_dropped{ 0 };
+    std::atomic<uint64_t> m_blocked{ 0 };
+
+    alignas(CacheLine) std::atomic<uint64_t> m_tail{ 0 };
+    uint64_t m_headCache{ 0 };
+  };
+}
+
+#endif
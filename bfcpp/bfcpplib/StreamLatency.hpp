@@ -0,0 +1,174 @@
+#ifndef __BINANCE_STREAMLATENCY_HPP
+#define __BINANCE_STREAMLATENCY_HPP
+
+#include <charconv>
+#include "bfcppCommon.hpp"
+#include "LatencyHistogram.hpp"
+
+
+namespace bfcpp
+{
+  /// <summary>
+  /// A monitor's latencies, see UsdFuturesMarket::streamLatencySnapshot().
+  /// </summary>
+  struct StreamLatencySummary
+  {
+    MonitorTokenId id{ 0 };
+    string stream;
+    LatencySummary exchangeToReceive;
+    LatencySummary transactionToReceive;
+    LatencySummary receiveToParsed;
+    LatencySummary parsedToReturn;
+  };
+
+
+  /// <summary>
+  /// The latencies of one monitor's frames, see UsdFuturesMarket::setStreamLatencyTracking():
+  ///   exchangeToReceive:    the frame's event time ("E") to the frame being received, in the exchange's time (see ClockSync), so includes
+  ///                         the exchange's publishing delay. "E" is in milliseconds so this is to within 1ms
+  ///   transactionToReceive: as exchangeToReceive from the transaction time ("T"), for the depth and bookTicker streams
+  ///   receiveToParsed:      the frame received to it being read into the monitor's struct
+  ///   parsedToReturn:       the monitor's callback (and, i.e. for a local order book, applying the update)
+  ///
+  /// The exchange latencies use the system clock, as the event times are. receiveToParsed and parsedToReturn use the steady clock,
+  /// so they aren't affected by the system clock being adjusted.
+  ///
+  /// The receive loop calls received() and the monitor's handler calls parsed(), both on the receive thread, so the times
+  /// are held in thread locals rather than passed through the handlers.
+  /// </summary>
+  class StreamLatency
+  {
+  public:
+    typedef std::chrono::steady_clock SteadyClock;
+
+
+    StreamLatency(const string& stream) : m_stream(stream),
+      m_transactionTime(stream.find("@depth") != string::npos || stream.find("@bookTicker") != string::npos)
+    {
+    }
+
+
+    LatencyHistogram exchangeToReceive;
+    LatencyHistogram transactionToReceive;
+    LatencyHistogram receiveToParsed;
+    LatencyHistogram parsedToReturn;
+
+
+    const string& stream() const { return m_stream; }
+
+
+    StreamLatencySummary summary(const MonitorTokenId id) const
+    {
+      StreamLatencySummary summary;
+      summary.id = id;
+      summary.stream = m_stream;
+      summary.exchangeToReceive = exchangeToReceive.summary();
+      summary.transactionToReceive = transactionToReceive.summary();
+      summary.receiveToParsed = receiveToParsed.summary();
+      summary.parsedToReturn = parsedToReturn.summary();
+      return summary;
+    }
+
+
+    void reset()
+    {
+      exchangeToReceive.reset();
+      transactionToReceive.reset();
+      receiveToParsed.reset();
+      parsedToReturn.reset();
+    }
+
+
+    /// <summary>
+    /// Called by the receive loop before the frame is passed to the monitor's handler, with the time the frame was received on each clock.
+    /// </summary>
+    static void received(const Clock::time_point time, const SteadyClock::time_point steadyTime)
+    {
+      t_received = time;
+      t_receivedSteady = steadyTime;
+    }
+
+    /// <summary>
+    /// Called by a monitor's handler when the frame has been read, before the callback. Does nothing if the monitor isn't tracked.
+    /// </summary>
+    static void parsed()
+    {
+      if (t_tracking)
+      {
+        t_parsed = SteadyClock::now();
+      }
+    }
+
+
+    /// <summary>
+    /// Calls the handler, recording the frame's latencies. 'offset' is the exchange's clock minus the local clock.
+    /// </summary>
+    template<class Handler>
+    void handle(Handler& handler, std::string_view frame, shared_ptr<WebSocketSession> session, const std::chrono::microseconds offset)
+    {
+      const auto received = t_received;
+      const auto receivedSteady = t_receivedSteady;
+
+      t_parsed = SteadyClock::time_point{};
+      t_tracking = true;
+
+      try
+      {
+        handler(frame, session);
+      }
+      catch (...)
+      {
+        t_tracking = false;
+        throw;
+      }
+
+      const auto returned = SteadyClock::now();
+      t_tracking = false;
+
+      if (t_parsed != SteadyClock::time_point{})
+      {
+        receiveToParsed.record(t_parsed - receivedSteady);
+        parsedToReturn.record(returned - t_parsed);
+      }
+
+      // the receive time on the exchange's clock, in nanoseconds since epoch
+      const auto exchangeReceived = std::chrono::duration_cast<std::chrono::nanoseconds>(received.time_since_epoch() + offset).count();
+
+      if (const auto eventTime = findTime(frame, "\"E\":"); eventTime)
+      {
+        exchangeToReceive.record(exchangeReceived - eventTime * 1000000);
+      }
+
+      if (const auto transactionTime = m_transactionTime ? findTime(frame, "\"T\":") : 0; transactionTime)
+      {
+        transactionToReceive.record(exchangeReceived - transactionTime * 1000000);
+      }
+    }
+
+
+  private:
+    // the first value of the key, in milliseconds. 0 if not found. For arrays this is the first entry's
+    static int64_t findTime(std::string_view frame, std::string_view key)
+    {
+      int64_t time = 0;
+
+      if (const auto pos = frame.find(key); pos != std::string_view::npos)
+      {
+        std::from_chars(frame.data() + pos + key.size(), frame.data() + frame.size(), time);
+      }
+
+      return time;
+    }
+
+
+    string m_stream;
+    bool m_transactionTime;
+
+    static inline thread_local Clock::time_point t_received;
+    static inline thread_local SteadyClock::time_point t_receivedSteady;
+    static inline thread_local SteadyClock::time_point t_parsed;
+    static inline thread_local bool t_tracking = false;
+  };
+}
+
+#endif
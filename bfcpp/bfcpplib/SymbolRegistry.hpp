@@ -0,0 +1,196 @@
+#ifndef __BINANCE_SYMBOLREGISTRY_HPP
+#define __BINANCE_SYMBOLREGISTRY_HPP
+
+#include <string_view>
+#include <limits>
+#include "bfcppCommon.hpp"
+#include "Decimal.hpp"
+
+
+namespace bfcpp
+{
+  typedef uint16_t SymbolId;
+
+  constexpr SymbolId NoSymbolId = std::numeric_limits<SymbolId>::max();
+
+
+  /// <summary>
+  /// Assigns each symbol a dense integer id, 0 to size()-1, so per symbol data can be held in a vector indexed by id rather than a map keyed by name.
+  /// Ids are assigned in the order symbols are added, so are stable for a registry but not between registries.
+  ///
+  /// A symbol can carry its DecimalScale, which the typed streams use for its prices and quantities.
+  ///
+  /// Lookups use an open addressing table of string_views, they don't allocate.
+  /// Once populated a registry is read only and can be shared between threads, see UsdFuturesMarket::setSymbolRegistry().
+  /// </summary>
+  class SymbolRegistry
+  {
+  public:
+    SymbolRegistry() : m_mask(0)
+    {
+    }
+
+
+    /// <summary>
+    /// Registers every symbol in the exchange info, in the order returned, with its pricePrecision and quantityPrecision.
+    /// </summary>
+    explicit SymbolRegistry(const ExchangeInfo& info) : m_mask(0)
+    {
+      for (const auto& symbol : info.symbols)
+      {
+        if (auto it = symbol.data.find("symbol"); it != symbol.data.cend())
+        {
+          add(it->second, getDecimalScale(symbol));
+        }
+      }
+    }
+
+
+    /// <summary>
+    /// Returns the symbol's id, adding it if not already registered. Not thread safe, populate before sharing.
+    /// </summary>
+    SymbolId add(std::string_view symbol)
+    {
+      if (auto existing = id(symbol); existing != NoSymbolId)
+      {
+        return existing;
+      }
+
+      if (m_names.size() == NoSymbolId)
+      {
+        throw BfcppException{ BFCPP_FUNCTION_MSG(" too many symbols") };
+      }
+
+      const auto newId = static_cast<SymbolId>(m_names.size());
+      m_names.emplace_back(symbol);
+      m_scales.emplace_back();
+      m_hasScale.push_back(false);
+
+      // keep the table at most half full
+      if (m_names.size() * 2 > m_table.size())
+      {
+        rebuild();
+      }
+      else
+      {
+        insert(newId);
+      }
+
+      return newId;
+    }
+
+
+    /// <summary>
+    /// As add(), also setting the symbol's scale, replacing any previous scale.
+    /// </summary>
+    SymbolId add(std::string_view symbol, const DecimalScale& scale)
+    {
+      const auto symbolId = add(symbol);
+      m_scales[symbolId] = scale;
+      m_hasScale[symbolId] = true;
+      return symbolId;
+    }
+
+
+    /// <summary>
+    /// The symbol's scale, or nullptr if the id is not registered or was added without a scale.
+    /// </summary>
+    const DecimalScale* scale(const SymbolId id) const
+    {
+      return id < m_names.size() && m_hasScale[id] ? &m_scales[id] : nullptr;
+    }
+
+
+    /// <summary>
+    /// The symbol's id or NoSymbolId if not registered. Case sensitive, symbols are upper case.
+    /// </summary>
+    SymbolId id(std::string_view symbol) const
+    {
+      if (m_table.empty())
+      {
+        return NoSymbolId;
+      }
+
+      for (auto slot = hash(symbol) & m_mask; m_table[slot] != NoSymbolId; slot = (slot + 1) & m_mask)
+      {
+        if (m_names[m_table[slot]] == symbol)
+        {
+          return m_table[slot];
+        }
+      }
+
+      return NoSymbolId;
+    }
+
+
+    /// <summary>
+    /// The symbol's name. Throws if the id is not registered.
+    /// </summary>
+    const string& name(const SymbolId id) const
+    {
+      if (id >= m_names.size())
+      {
+        throw BfcppException{ BFCPP_FUNCTION_MSG(" unknown symbol id") };
+      }
+
+      return m_names[id];
+    }
+
+
+    bool contains(std::string_view symbol) const { return id(symbol) != NoSymbolId; }
+    size_t size() const { return m_names.size(); }
+
+
+  private:
+    // FNV-1a, symbols are short
+    static size_t hash(std::string_view symbol)
+    {
+      uint32_t h = 2166136261u;
+
+      for (const char c : symbol)
+      {
+        h = (h ^ static_cast<uint8_t>(c)) * 16777619u;
+      }
+
+      return h;
+    }
+
+
+    void insert(const SymbolId id)
+    {
+      auto slot = hash(m_names[id]) & m_mask;
+
+      while (m_table[slot] != NoSymbolId)
+      {
+        slot = (slot + 1) & m_mask;
+      }
+
+      m_table[slot] = id;
+    }
+
+
+    void rebuild()
+    {
+      size_t size = 16;
+      while (size < m_names.size() * 2)
+        size <<= 1;
+
+      m_table.assign(size, NoSymbolId);
+      m_mask = size - 1;
+
+      for (size_t i = 0; i < m_names.size(); ++i)
+      {
+        insert(static_cast<SymbolId>(i));
+      }
+    }
+
+
+    vector<string> m_names;      // indexed by id
+    vector<DecimalScale> m_scales;  // indexed by id, valid where m_hasScale
+    vector<bool> m_hasScale;
+    vector<SymbolId> m_table;    // hash slot to id
+    size_t m_mask;
+  };
+}
+
+#endif
@@ -0,0 +1,462 @@
+#ifndef __BINANCE_TYPEDSTREAMS_HPP
+#define __BINANCE_TYPEDSTREAMS_HPP
+
+#include <cstring>
+#include "bfcppCommon.hpp"
+#include "FastJson.hpp"
+#include "Decimal.hpp"
+#include "SymbolRegistry.hpp"
+
+
+namespace bfcpp
+{
+  // Typed equivalents of the map based stream structs (SymbolBookTickerStream, MarkPriceStream, etc).
+  // Numbers are integers or Decimal and strings are held inline, and they're read directly from the frame with fastjson,
+  // so populating them does not allocate (other than growing the Document's index and a vector's capacity on the first frames).
+  // Used by the monitor functions with the 'Typed' suffix, i.e. monitorSymbolBookStreamTyped().
+
+
+  /// <summary>
+  /// Prices and quantities in the typed streams are parsed with this scale, Binance uses at most 8 decimal places.
+  /// If the symbol is in the registry with a scale, see SymbolRegistry::add(), prices and quantities are then rescaled to the symbol's
+  /// pricePrecision and quantityPrecision. Mark, index and settle prices, quote volumes and funding rates keep this scale,
+  /// they have more decimal places than pricePrecision.
+  /// </summary>
+  constexpr unsigned StreamDecimalScale = 8;
+
+
+  /// <summary>
+  /// A string held inline, truncated to N-1 chars.
+  /// </summary>
+  template<size_t N>
+  struct FixedString
+  {
+    char data[N] = {};
+    uint8_t size = 0;
+
+    void assign(std::string_view str)
+    {
+      size = static_cast<uint8_t>(std::min(str.size(), N - 1));
+      std::memcpy(data, str.data(), size);
+      data[size] = '\0';
+    }
+
+    std::string_view view() const { return std::string_view{ data, size }; }
+    string str() const { return string{ data, size }; }
+
+    bool operator==(std::string_view other) const { return view() == other; }
+    bool operator!=(std::string_view other) const { return view() != other; }
+  };
+
+  typedef FixedString<32> SymbolString;
+
+
+  /// <summary>
+  /// See https://binance-docs.github.io/apidocs/futures/en/#individual-symbol-book-ticker-streams
+  /// </summary>
+  struct BookTicker
+  {
+    int64_t updateId;        // u
+    int64_t eventTime;       // E
+    int64_t transactionTime; // T
+    SymbolString symbol;     // s
+    SymbolId symbolId{ NoSymbolId };  // s, see UsdFuturesMarket::setSymbolRegistry()
+    Decimal bidPrice;        // b
+    Decimal bidQty;          // B
+    Decimal askPrice;        // a
+    Decimal askQty;          // A
+  };
+
+
+  /// <summary>
+  /// See https://binance-docs.github.io/apidocs/futures/en/#individual-symbol-mini-ticker-stream
+  /// </summary>
+  struct MiniTicker
+  {
+    int64_t eventTime;       // E
+    SymbolString symbol;     // s
+    SymbolId symbolId{ NoSymbolId };  // s, see UsdFuturesMarket::setSymbolRegistry()
+    Decimal close;           // c
+    Decimal open;            // o
+    Decimal high;            // h
+    Decimal low;             // l
+    Decimal volume;          // v
+    Decimal quoteVolume;     // q
+  };
+
+
+  /// <summary>
+  /// See https://binance-docs.github.io/apidocs/futures/en/#mark-price-stream
+  /// </summary>
+  struct MarkPrice
+  {
+    int64_t eventTime;                // E
+    SymbolString symbol;              // s
+    SymbolId symbolId{ NoSymbolId };  // s, see UsdFuturesMarket::setSymbolRegistry()
+    Decimal markPrice;                // p
+    Decimal indexPrice;               // i
+    Decimal estimatedSettlePrice;     // P
+    Decimal fundingRate;              // r
+    int64_t nextFundingTime;          // T
+  };
+
+
+  /// <summary>
+  /// See https://binance-docs.github.io/apidocs/futures/en/#kline-candlestick-streams
+  /// </summary>
+  struct Kline
+  {
+    int64_t eventTime;            // E
+    SymbolString symbol;          // s
+    SymbolId symbolId{ NoSymbolId };  // s, see UsdFuturesMarket::setSymbolRegistry()
+    int64_t startTime;            // k.t
+    int64_t closeTime;            // k.T
+    FixedString<8> interval;      // k.i
+    int64_t firstTradeId;         // k.f
+    int64_t lastTradeId;          // k.L
+    Decimal open;                 // k.o
+    Decimal close;                // k.c
+    Decimal high;                 // k.h
+    Decimal low;                  // k.l
+    Decimal volume;               // k.v
+    int64_t numberOfTrades;       // k.n
+    bool closed;                  // k.x
+    Decimal quoteVolume;          // k.q
+    Decimal takerBuyVolume;       // k.V
+    Decimal takerBuyQuoteVolume;  // k.Q
+  };
+
+
+
+  namespace typedjson
+  {
+    // Read from a cpprest JSON value without creating intermediate strings (on platforms where utility::string_t is std::string).
+
+    inline const web::json::value& field(const web::json::value& obj, const utility::string_t& key)
+    {
+      return obj.at(key);
+    }
+
+    inline int64_t readInt(const web::json::value& obj, const utility::string_t& key)
+    {
+      return field(obj, key).as_number().to_int64();
+    }
+
+    inline Decimal readDecimal(const web::json::value& obj, const utility::string_t& key)
+    {
+      return Decimal::fromString(utility::conversions::to_utf8string(field(obj, key).as_string()), StreamDecimalScale);
+    }
+
+    template<size_t N>
+    inline void readString(const web::json::value& obj, const utility::string_t& key, FixedString<N>& str)
+    {
+      str.assign(utility::conversions::to_utf8string(field(obj, key).as_string()));
+    }
+
+
+    inline void read(const web::json::value& json, BookTicker& bt)
+    {
+      static const utility::string_t U = utility::conversions::to_string_t("u"), E = utility::conversions::to_string_t("E"), T = utility::conversions::to_string_t("T"),
+                                      S = utility::conversions::to_string_t("s"), B = utility::conversions::to_string_t("b"), BQ = utility::conversions::to_string_t("B"),
+                                      A = utility::conversions::to_string_t("a"), AQ = utility::conversions::to_string_t("A");
+
+      bt.updateId = readInt(json, U);
+      bt.eventTime = readInt(json, E);
+      bt.transactionTime = readInt(json, T);
+      readString(json, S, bt.symbol);
+      bt.bidPrice = readDecimal(json, B);
+      bt.bidQty = readDecimal(json, BQ);
+      bt.askPrice = readDecimal(json, A);
+      bt.askQty = readDecimal(json, AQ);
+    }
+
+
+    inline void read(const web::json::value& json, MiniTicker& mt)
+    {
+      static const utility::string_t E = utility::conversions::to_string_t("E"), S = utility::conversions::to_string_t("s"), C = utility::conversions::to_string_t("c"),
+                                      O = utility::conversions::to_string_t("o"), H = utility::conversions::to_string_t("h"), L = utility::conversions::to_string_t("l"),
+                                      V = utility::conversions::to_string_t("v"), Q = utility::conversions::to_string_t("q");
+
+      mt.eventTime = readInt(json, E);
+      readString(json, S, mt.symbol);
+      mt.close = readDecimal(json, C);
+      mt.open = readDecimal(json, O);
+      mt.high = readDecimal(json, H);
+      mt.low = readDecimal(json, L);
+      mt.volume = readDecimal(json, V);
+      mt.quoteVolume = readDecimal(json, Q);
+    }
+
+
+    inline void read(const web::json::value& json, MarkPrice& mp)
+    {
+      static const utility::string_t E = utility::conversions::to_string_t("E"), S = utility::conversions::to_string_t("s"), P = utility::conversions::to_string_t("p"),
+                                      I = utility::conversions::to_string_t("i"), SP = utility::conversions::to_string_t("P"), R = utility::conversions::to_string_t("r"),
+                                      T = utility::conversions::to_string_t("T");
+
+      mp.eventTime = readInt(json, E);
+      readString(json, S, mp.symbol);
+      mp.markPrice = readDecimal(json, P);
+      mp.indexPrice = readDecimal(json, I);
+      mp.estimatedSettlePrice = readDecimal(json, SP);
+      mp.fundingRate = readDecimal(json, R);
+      mp.nextFundingTime = readInt(json, T);
+    }
+
+
+    inline void read(const web::json::value& json, Kline& k)
+    {
+      static const utility::string_t E = utility::conversions::to_string_t("E"), S = utility::conversions::to_string_t("s"), K = utility::conversions::to_string_t("k"),
+                                      t = utility::conversions::to_string_t("t"), T = utility::conversions::to_string_t("T"), i = utility::conversions::to_string_t("i"),
+                                      f = utility::conversions::to_string_t("f"), L = utility::conversions::to_string_t("L"), o = utility::conversions::to_string_t("o"),
+                                      c = utility::conversions::to_string_t("c"), h = utility::conversions::to_string_t("h"), l = utility::conversions::to_string_t("l"),
+                                      v = utility::conversions::to_string_t("v"), n = utility::conversions::to_string_t("n"), x = utility::conversions::to_string_t("x"),
+                                      q = utility::conversions::to_string_t("q"), V = utility::conversions::to_string_t("V"), Q = utility::conversions::to_string_t("Q");
+
+      k.eventTime = readInt(json, E);
+      readString(json, S, k.symbol);
+
+      const auto& candle = field(json, K);
+      k.startTime = readInt(candle, t);
+      k.closeTime = readInt(candle, T);
+      readString(candle, i, k.interval);
+      k.firstTradeId = readInt(candle, f);
+      k.lastTradeId = readInt(candle, L);
+      k.open = readDecimal(candle, o);
+      k.close = readDecimal(candle, c);
+      k.high = readDecimal(candle, h);
+      k.low = readDecimal(candle, l);
+      k.volume = readDecimal(candle, v);
+      k.numberOfTrades = readInt(candle, n);
+      k.closed = field(candle, x).as_bool();
+      k.quoteVolume = readDecimal(candle, q);
+      k.takerBuyVolume = readDecimal(candle, V);
+      k.takerBuyQuoteVolume = readDecimal(candle, Q);
+    }
+
+
+
+    // Read from a fastjson value, a single pass over the object's fields.
+
+    inline void read(const fastjson::Value& json, BookTicker& bt)
+    {
+      json.forEachField([&bt](std::string_view key, const fastjson::Value& value)
+      {
+        if (key.size() != 1)
+          return;
+
+        switch (key[0])
+        {
+        case 'u': bt.updateId = value.getInt64(); break;
+        case 'E': bt.eventTime = value.getInt64(); break;
+        case 'T': bt.transactionTime = value.getInt64(); break;
+        case 's': bt.symbol.assign(value.getString()); break;
+        case 'b': bt.bidPrice = value.getDecimal(StreamDecimalScale); break;
+        case 'B': bt.bidQty = value.getDecimal(StreamDecimalScale); break;
+        case 'a': bt.askPrice = value.getDecimal(StreamDecimalScale); break;
+        case 'A': bt.askQty = value.getDecimal(StreamDecimalScale); break;
+        default: break;
+        }
+      });
+    }
+
+
+    inline void read(const fastjson::Value& json, MiniTicker& mt)
+    {
+      json.forEachField([&mt](std::string_view key, const fastjson::Value& value)
+      {
+        if (key.size() != 1)
+          return;
+
+        switch (key[0])
+        {
+        case 'E': mt.eventTime = value.getInt64(); break;
+        case 's': mt.symbol.assign(value.getString()); break;
+        case 'c': mt.close = value.getDecimal(StreamDecimalScale); break;
+        case 'o': mt.open = value.getDecimal(StreamDecimalScale); break;
+        case 'h': mt.high = value.getDecimal(StreamDecimalScale); break;
+        case 'l': mt.low = value.getDecimal(StreamDecimalScale); break;
+        case 'v': mt.volume = value.getDecimal(StreamDecimalScale); break;
+        case 'q': mt.quoteVolume = value.getDecimal(StreamDecimalScale); break;
+        default: break;
+        }
+      });
+    }
+
+
+    inline void read(const fastjson::Value& json, MarkPrice& mp)
+    {
+      json.forEachField([&mp](std::string_view key, const fastjson::Value& value)
+      {
+        if (key.size() != 1)
+          return;
+
+        switch (key[0])
+        {
+        case 'E': mp.eventTime = value.getInt64(); break;
+        case 's': mp.symbol.assign(value.getString()); break;
+        case 'p': mp.markPrice = value.getDecimal(StreamDecimalScale); break;
+        case 'i': mp.indexPrice = value.getDecimal(StreamDecimalScale); break;
+        case 'P': mp.estimatedSettlePrice = value.getDecimal(StreamDecimalScale); break;
+        case 'r': mp.fundingRate = value.getDecimal(StreamDecimalScale); break;
+        case 'T': mp.nextFundingTime = value.getInt64(); break;
+        default: break;
+        }
+      });
+    }
+
+
+    inline void read(const fastjson::Value& json, Kline& k)
+    {
+      json.forEachField([&k](std::string_view key, const fastjson::Value& value)
+      {
+        if (key == "E")
+        {
+          k.eventTime = value.getInt64();
+        }
+        else if (key == "s")
+        {
+          k.symbol.assign(value.getString());
+        }
+        else if (key == "k")
+        {
+          value.forEachField([&k](std::string_view candleKey, const fastjson::Value& candleValue)
+          {
+            if (candleKey.size() != 1)
+              return;
+
+            switch (candleKey[0])
+            {
+            case 't': k.startTime = candleValue.getInt64(); break;
+            case 'T': k.closeTime = candleValue.getInt64(); break;
+            case 'i': k.interval.assign(candleValue.getString()); break;
+            case 'f': k.firstTradeId = candleValue.getInt64(); break;
+            case 'L': k.lastTradeId = candleValue.getInt64(); break;
+            case 'o': k.open = candleValue.getDecimal(StreamDecimalScale); break;
+            case 'c': k.close = candleValue.getDecimal(StreamDecimalScale); break;
+            case 'h': k.high = candleValue.getDecimal(StreamDecimalScale); break;
+            case 'l': k.low = candleValue.getDecimal(StreamDecimalScale); break;
+            case 'v': k.volume = candleValue.getDecimal(StreamDecimalScale); break;
+            case 'n': k.numberOfTrades = candleValue.getInt64(); break;
+            case 'x': k.closed = candleValue.getBool(); break;
+            case 'q': k.quoteVolume = candleValue.getDecimal(StreamDecimalScale); break;
+            case 'V': k.takerBuyVolume = candleValue.getDecimal(StreamDecimalScale); break;
+            case 'Q': k.takerBuyQuoteVolume = candleValue.getDecimal(StreamDecimalScale); break;
+            default: break;
+            }
+          });
+        }
+      });
+    }
+
+
+    // rescale the prices and quantities to the symbol's precision, truncating as Decimal::fromString() does
+
+    inline void applyScale(BookTicker& bt, const DecimalScale& scale)
+    {
+      bt.bidPrice = bt.bidPrice.rescale(scale.price, Decimal::Rounding::Down);
+      bt.bidQty = bt.bidQty.rescale(scale.quantity, Decimal::Rounding::Down);
+      bt.askPrice = bt.askPrice.rescale(scale.price, Decimal::Rounding::Down);
+      bt.askQty = bt.askQty.rescale(scale.quantity, Decimal::Rounding::Down);
+    }
+
+    inline void applyScale(MiniTicker& mt, const DecimalScale& scale)
+    {
+      mt.close = mt.close.rescale(scale.price, Decimal::Rounding::Down);
+      mt.open = mt.open.rescale(scale.price, Decimal::Rounding::Down);
+      mt.high = mt.high.rescale(scale.price, Decimal::Rounding::Down);
+      mt.low = mt.low.rescale(scale.price, Decimal::Rounding::Down);
+      mt.volume = mt.volume.rescale(scale.quantity, Decimal::Rounding::Down);
+    }
+
+    inline void applyScale(MarkPrice&, const DecimalScale&)
+    {
+    }
+
+    inline void applyScale(Kline& k, const DecimalScale& scale)
+    {
+      k.open = k.open.rescale(scale.price, Decimal::Rounding::Down);
+      k.close = k.close.rescale(scale.price, Decimal::Rounding::Down);
+      k.high = k.high.rescale(scale.price, Decimal::Rounding::Down);
+      k.low = k.low.rescale(scale.price, Decimal::Rounding::Down);
+      k.volume = k.volume.rescale(scale.quantity, Decimal::Rounding::Down);
+      k.takerBuyVolume = k.takerBuyVolume.rescale(scale.quantity, Decimal::Rounding::Down);
+    }
+
+
+    template<class T>
+    void applyRegistry(T& out, const SymbolRegistry& registry)
+    {
+      out.symbolId = registry.id(out.symbol.view());
+
+      if (const auto scale = registry.scale(out.symbolId))
+      {
+        applyScale(out, *scale);
+      }
+    }
+
+
+    /// <summary>
+    /// Reads the frame into 'out' with fastjson, without building a DOM. If the frame can't be read that way, cpprest is used.
+    /// If a registry is given the symbolId is set, NoSymbolId if the symbol isn't registered, and the values are rescaled to the symbol's scale.
+    /// </summary>
+    template<class T>
+    void readFrame(fastjson::Document& doc, std::string_view frame, T& out, const SymbolRegistry* registry = nullptr)
+    {
+      if (!fastjson::tryRead(doc, frame, [&out](const fastjson::Value& root) { read(root, out); }))
+      {
+        read(parseJson(frame), out);
+      }
+
+      if (registry)
+      {
+        applyRegistry(out, *registry);
+      }
+    }
+
+
+    /// <summary>
+    /// As readFrame() for streams which send an array of T, or a single T when subscribed to one symbol.
+    /// </summary>
+    template<class T>
+    void readFrame(fastjson::Document& doc, std::string_view frame, vector<T>& out, const SymbolRegistry* registry = nullptr)
+    {
+      out.clear();
+
+      auto readAll = [&out](const auto& root)
+      {
+        if (root.is_array())
+        {
+          for (auto& entry : root.as_array())
+            read(entry, out.emplace_back());
+        }
+        else
+        {
+          read(root, out.emplace_back());
+        }
+      };
+
+      auto readAllFast = [&out](const fastjson::Value& root)
+      {
+        if (root.isArray())
+          root.forEachElement([&out](const fastjson::Value& entry) { read(entry, out.emplace_back()); });
+        else
+          read(root, out.emplace_back());
+      };
+
+      if (!fastjson::tryRead(doc, frame, readAllFast))
+      {
+        out.clear();
+        readAll(parseJson(frame));
+      }
+
+      if (registry)
+      {
+        for (auto& entry : out)
+          applyRegistry(entry, *registry);
+      }
+    }
+  }
+}
+
+#endif
@@ -13,6 +13,11 @@
 #include <sstream>
 #include <string>
 #include <any>
+#include <mutex>
+#include <atomic>
+#include <string_view>
+#include <cstdint>
+#include <limits>
 #include <cpprest/json.h>
 #include <cpprest/ws_client.h>
 #include <cpprest/http_client.h>
@@ -61,7 +66,8 @@ namespace bfcpp
     Ping,
     NewBatchOrder,
     ExchangeInfo,
-    OrderBook
+    OrderBook,
+    ServerTime
   };
 
 
@@ -73,7 +79,8 @@ namespace bfcpp
     SymbolMiniTicker,
     SymbolBookTicker,
     AllMarketMiniTicker,
-    BookDepth
+    BookDepth,
+    LocalOrderBook
   };
   
   enum class MarketType
@@ -131,7 +138,8 @@ namespace bfcpp
       {RestCall::Ping, "/fapi/v1/ping"},
       {RestCall::NewBatchOrder, "/fapi/v1/batchOrders"},
       {RestCall::ExchangeInfo, "/fapi/v1/exchangeInfo"},
-      {RestCall::OrderBook, "/fapi/v1/depth"}
+      {RestCall::OrderBook, "/fapi/v1/depth"},
+      {RestCall::ServerTime, "/fapi/v1/time"}
   };
 
 
@@ -285,23 +293,27 @@ namespace bfcpp
   };
 
 
-  struct NewOrderPerformanceResult : public NewOrderResult
+  /// <summary>
+  /// The time spent in each part of a REST call. Set in the results of UsdFuturesTestMarketPerfomance, and recorded
+  /// for every call when UsdFuturesMarket::setRestTiming() is enabled.
+  /// </summary>
+  struct RestCallTimings
+  {
+    std::chrono::high_resolution_clock::duration restApiCall{};           // request sent to response received
+    std::chrono::high_resolution_clock::duration restQueryBuild{};        // query string and request built, excluding waiting for the rate limit
+    std::chrono::high_resolution_clock::duration restResponseHandler{};   // response read into the result
+    std::chrono::high_resolution_clock::duration bfcppTotalProcess{};     // restQueryBuild + restResponseHandler
+    std::chrono::high_resolution_clock::duration total{};                 // not set, for the caller
+  };
+
+
+  struct NewOrderPerformanceResult : public NewOrderResult, public RestCallTimings
   {
-    std::chrono::high_resolution_clock::duration restApiCall;
-    std::chrono::high_resolution_clock::duration restQueryBuild;
-    std::chrono::high_resolution_clock::duration restResponseHandler;
-    std::chrono::high_resolution_clock::duration bfcppTotalProcess;
-    std::chrono::high_resolution_clock::duration total ;
   };
 
 
-  struct NewOrderBatchPerformanceResult : public NewOrderBatchResult
+  struct NewOrderBatchPerformanceResult : public NewOrderBatchResult, public RestCallTimings
   {
-    std::chrono::high_resolution_clock::duration restApiCall;
-    std::chrono::high_resolution_clock::duration restQueryBuild;
-    std::chrono::high_resolution_clock::duration restResponseHandler;
-    std::chrono::high_resolution_clock::duration bfcppTotalProcess;
-    std::chrono::high_resolution_clock::duration total;
   };
 
 
@@ -499,6 +511,20 @@ namespace bfcpp
   };
 
 
+  class LocalOrderBook;
+
+  struct LocalOrderBookStream : public StreamCallbackData
+  {
+    LocalOrderBookStream() : StreamCallbackData(StreamCall::LocalOrderBook)
+    {
+    }
+
+    shared_ptr<LocalOrderBook> book;
+    int64_t eventTime{ 0 };
+    int64_t transactionTime{ 0 };
+  };
+
+
   /// <summary>
   /// Returned by monitor functions, containing an ID for use with cancelMonitor() to close this stream.
   /// </summary>
@@ -564,6 +590,45 @@ namespace bfcpp
 
 
 
+  /// <summary>
+  /// Passed to the handler set with UsdFuturesMarket::setStreamGapHandler() when a monitor's connection is lost, and again when it is restored.
+  /// Data sent between the Disconnected and Reconnected notifications was missed, so anything built from the stream (i.e. a book) must be resynced.
+  /// </summary>
+  struct StreamGap
+  {
+    enum class State
+    {
+      Disconnected, // the connection was closed or stale, reconnecting
+      Reconnected,  // the stream has resumed on a new connection
+      Failed        // ReconnectPolicy::maxAttempts reached, the monitor has stopped
+    };
+
+    State state{ State::Disconnected };
+    MonitorToken token;
+    string uri;
+    Clock::time_point disconnected;
+    size_t attempts{ 0 };
+  };
+
+
+  /// <summary>
+  /// How monitors reconnect, see UsdFuturesMarket::setReconnectPolicy().
+  /// The delay before each attempt is initialDelay, multiplied by 'multiplier' after each failed attempt up to maxDelay,
+  /// and randomised by +/- jitter (as a fraction) so that many monitors don't reconnect in step.
+  /// </summary>
+  struct ReconnectPolicy
+  {
+    bool enabled{ true };
+    std::chrono::milliseconds initialDelay{ 500 };
+    std::chrono::milliseconds maxDelay{ 30000 };
+    double multiplier{ 2.0 };
+    double jitter{ 0.25 };
+    size_t maxAttempts{ 0 };                      // 0 is unlimited
+    std::chrono::milliseconds staleTimeout{ 60000 }; // a market stream with no data for this long is reconnected, 0 disables. Not applied to the user data stream.
+  };
+
+
+
   struct WebSocketSession
   {
   private:
@@ -572,7 +637,7 @@ namespace bfcpp
 
 
   public:
-    WebSocketSession() : connected(false), id(0), cancelToken(cancelTokenSource.get_token())
+    WebSocketSession() : connected(false), id(0), checkStale(true), lastReceive(0), cancelToken(cancelTokenSource.get_token())
     {
 
     }
@@ -588,13 +653,21 @@ namespace bfcpp
     // the task which receives the websocket messages
     pplx::task<void> receiveTask;
 
-    // callback functions for user functions
-    std::function<void(std::any)>  callback;
-
     // the monitor id. The MonitorToken is returned to the caller which can be used to cancel the monitor
     MonitorTokenId id;
     std::atomic_bool connected;
 
+    // held when replacing the client on reconnect, or using it from outside the receive task
+    std::mutex clientMux;
+    // resolves the uri to reconnect to, as a task because it may require a REST call. If not set 'uri' is used
+    std::function<pplx::task<string>()> reconnectUri;
+    // called from the receive task when the connection is lost and when it's restored
+    std::function<void(const StreamGap&)> onGap;
+    // if the supervisor reconnects when no data is received for ReconnectPolicy::staleTimeout
+    bool checkStale;
+    // Clock ticks of the last frame received
+    std::atomic<Clock::duration::rep> lastReceive;
+
     void cancel()
     { 
       cancelTokenSource.cancel();
@@ -615,6 +688,12 @@ namespace bfcpp
   };
 
 
+  /// <summary>
+  /// Called with each text frame received for a monitor. The frame is only valid for the duration of the call.
+  /// </summary>
+  typedef std::function<void(std::string_view, shared_ptr<WebSocketSession>)> StreamHandler;
+
+
 
   template <typename T>
   string toString(const T a_value, const int n = 6)
@@ -626,6 +705,12 @@ namespace bfcpp
   }
 
 
+  inline web::json::value parseJson(std::string_view json)
+  {
+    return web::json::value::parse(utility::conversions::to_string_t(string{ json }));
+  }
+
+
   inline string jsonValueToString(const web::json::value& jsonVal)
   {
     switch (auto t = jsonVal.type(); t)
@@ -806,22 +891,92 @@ namespace bfcpp
 
 
   /// <summary>
-  /// Ensure price is in a suitable format for the exchange, i.e. changing precision.
-  /// You can get the precision for a symbol from exchangeInfo.
+  /// Converts a decimal string to an integer scaled by 10^decimals, i.e. "1234.5600" with 2 decimals is 123456.
+  /// Digits beyond 'decimals' are truncated. This does not allocate or use floating point.
+  /// Throws BfcppException if the string isn't a decimal number, or the value doesn't fit in an int64_t.
   /// </summary>
-  /// <param name="price">The unformatted price</param>
-  /// <param name="precision">The precision</param>
-  /// <returns>The price in a suitable format</returns>
-  inline string priceTransform(const string& price, const std::streamsize precision = 2)
+  /// <param name="str">The decimal string, as received from the exchange</param>
+  /// <param name="decimals">The number of decimal places kept</param>
+  /// <returns>The scaled value</returns>
+  inline int64_t toFixedPoint(std::string_view str, const unsigned decimals)
   {
-    string p;
+    constexpr int64_t Max = std::numeric_limits<int64_t>::max();
+
+    int64_t value = 0;
+    bool negative = false;
+    size_t i = 0, digits = 0;
+
+    auto isDigit = [](const char c) { return c >= '0' && c <= '9'; };
+
+    auto append = [&value](const int64_t digit)
+    {
+      if (value > (Max - digit) / 10)
+      {
+        throw BfcppException("toFixedPoint: overflow");
+      }
+
+      value = value * 10 + digit;
+    };
 
-    stringstream ss;
-    ss.precision(precision);
-    ss << std::fixed << std::stod(price);
-    ss >> p;
+    if (!str.empty() && (str[0] == '-' || str[0] == '+'))
+    {
+      negative = str[0] == '-';
+      ++i;
+    }
+
+    for (; i < str.size() && str[i] != '.'; ++i, ++digits)
+    {
+      if (!isDigit(str[i]))
+        throw BfcppException("toFixedPoint: not a decimal: " + string{ str });
+
+      append(str[i] - '0');
+    }
+
+    unsigned places = 0;
+
+    if (i < str.size())
+    {
+      for (++i; i < str.size(); ++i, ++digits)
+      {
+        if (!isDigit(str[i]))
+          throw BfcppException("toFixedPoint: not a decimal: " + string{ str });
+
+        if (places < decimals)
+        {
+          append(str[i] - '0');
+          ++places;
+        }
+      }
+    }
+
+    if (digits == 0)
+    {
+      throw BfcppException("toFixedPoint: not a decimal: " + string{ str });
+    }
+
+    for (; places < decimals; ++places)
+    {
+      append(0);
+    }
+
+    return negative ? -value : value;
+  }
+
+
+  /// <summary>
+  /// The number of significant decimal places in a decimal string, i.e. "0.0100" is 2.
+  /// </summary>
+  inline unsigned decimalPlaces(std::string_view str)
+  {
+    if (auto point = str.find('.'); point != std::string_view::npos)
+    {
+      if (auto last = str.find_last_not_of('0'); last != std::string_view::npos && last > point)
+      {
+        return static_cast<unsigned>(last - point);
+      }
+    }
 
-    return p;
+    return 0;
   }
 
 
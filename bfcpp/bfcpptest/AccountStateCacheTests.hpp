@@ -0,0 +1,237 @@
+#ifndef BFCPP_ACCOUNT_STATE_CACHE_TESTS_H
+#define BFCPP_ACCOUNT_STATE_CACHE_TESTS_H
+
+#include <thread>
+#include <atomic>
+#include <AccountStateCache.hpp>
+#include "UnitTest.hpp"
+
+
+namespace accountstatecachetests
+{
+	using namespace bfcpp;
+
+	// an ACCOUNT_UPDATE event
+	inline UsdFutureUserData accountUpdate(const int64_t time, const vector<map<string, string>>& balances, const vector<map<string, string>>& positions)
+	{
+		UsdFutureUserData data{ UsdFutureUserData::EventType::AccountUpdate };
+		data.au.data = { {"e", "ACCOUNT_UPDATE"}, {"E", std::to_string(time + 1)}, {"T", std::to_string(time)} };
+		data.au.reason = "ORDER";
+		data.au.balances = balances;
+		data.au.positions = positions;
+		return data;
+	}
+
+
+	inline map<string, string> position(const string& symbol, const string& side, const string& amount, const string& entryPrice)
+	{
+		return { {"s", symbol}, {"ps", side}, {"pa", amount}, {"ep", entryPrice}, {"up", "0"}, {"mt", "cross"} };
+	}
+
+
+	inline map<string, string> balance(const string& asset, const string& wallet)
+	{
+		return { {"a", asset}, {"wb", wallet}, {"cw", wallet} };
+	}
+
+
+	inline AccountInformation accountInformation()
+	{
+		AccountInformation info;
+		info.data = { {"updateTime", "1000"}, {"totalWalletBalance", "1500.00"} };
+		info.assets = { { {"asset", "USDT"}, {"walletBalance", "1000.50"}, {"crossWalletBalance", "900.25"}, {"updateTime", "1000"} },
+						{ {"asset", "BNB"}, {"walletBalance", "2.00"}, {"crossWalletBalance", "2.00"}, {"updateTime", "0"} } };
+		info.positions = { { {"symbol", "BTCUSDT"}, {"positionSide", "BOTH"}, {"positionAmt", "0.010"}, {"entryPrice", "37500.0"}, {"unrealizedProfit", "1.5"}, {"updateTime", "1000"} },
+						   { {"symbol", "ETHUSDT"}, {"positionSide", "LONG"}, {"positionAmt", "1.000"}, {"entryPrice", "2500.0"}, {"unrealizedProfit", "0"}, {"updateTime", "1000"} },
+						   { {"symbol", "ETHUSDT"}, {"positionSide", "SHORT"}, {"positionAmt", "-2.000"}, {"entryPrice", "2600.0"}, {"unrealizedProfit", "0"}, {"updateTime", "1000"} } };
+		return info;
+	}
+}
+
+
+inline void accountStateCacheTests(UnitTest& test)
+{
+	using namespace bfcpp;
+	using namespace accountstatecachetests;
+
+
+	// seeded from the account information, then updated by ACCOUNT_UPDATE deltas
+	{
+		AccountStateCache cache;
+
+		BFCPP_CHECK(test, !cache.seeded());
+		BFCPP_CHECK(test, !cache.position("BTCUSDT"));
+		BFCPP_CHECK(test, !cache.balance("USDT"));
+
+		AccountInformation failed;
+		failed.valid(false);
+		cache.seed(failed);
+		BFCPP_CHECK(test, !cache.seeded());
+
+		cache.seed(accountInformation());
+		BFCPP_CHECK(test, cache.seeded());
+
+		auto btc = cache.position("BTCUSDT");
+		BFCPP_CHECK(test, btc && btc->amount == Decimal::fromString("0.01") && btc->entryPrice == Decimal::fromString("37500") && btc->unrealizedProfit == Decimal::fromString("1.5"));
+		BFCPP_CHECK(test, btc && btc->updateTime == 1000);
+
+		auto usdt = cache.balance("USDT");
+		BFCPP_CHECK(test, usdt && usdt->walletBalance == Decimal::fromString("1000.5") && usdt->crossWalletBalance == Decimal::fromString("900.25"));
+
+		// an asset without its own time has the account's
+		BFCPP_CHECK(test, cache.balance("BNB") && cache.balance("BNB")->updateTime == 1000);
+
+		// only the balances and positions in the event change
+		cache.onUserData(accountUpdate(2000, { balance("USDT", "1010.75") }, { position("BTCUSDT", "BOTH", "0.020", "37600.0") }));
+
+		btc = cache.position("BTCUSDT");
+		BFCPP_CHECK(test, btc && btc->amount == Decimal::fromString("0.02") && btc->entryPrice == Decimal::fromString("37600") && btc->updateTime == 2000);
+		BFCPP_CHECK(test, cache.balance("USDT")->walletBalance == Decimal::fromString("1010.75"));
+		BFCPP_CHECK(test, cache.balance("BNB")->walletBalance == Decimal::fromString("2"));
+		BFCPP_CHECK(test, cache.position("ETHUSDT", PositionSide::Long)->amount == Decimal::fromString("1"));
+
+		// a position or asset not in the seed is added
+		cache.onUserData(accountUpdate(2100, { balance("BUSD", "50") }, { position("XRPUSDT", "BOTH", "-100", "0.5") }));
+		BFCPP_CHECK(test, cache.position("XRPUSDT") && cache.position("XRPUSDT")->amount == Decimal::fromString("-100"));
+		BFCPP_CHECK(test, cache.balance("BUSD") && cache.balance("BUSD")->walletBalance == Decimal::fromString("50"));
+
+		// a closed position has a zero amount
+		cache.onUserData(accountUpdate(2200, {}, { position("BTCUSDT", "BOTH", "0", "0") }));
+		BFCPP_CHECK(test, cache.position("BTCUSDT") && cache.position("BTCUSDT")->amount == Decimal{});
+
+		// other events, and values which aren't numbers, are ignored
+		UsdFutureUserData orderUpdate{ UsdFutureUserData::EventType::OrderUpdate };
+		cache.onUserData(orderUpdate);
+		cache.onUserData(accountUpdate(2300, { balance("USDT", "lots") }, {}));
+		BFCPP_CHECK(test, cache.balance("USDT")->walletBalance == Decimal::fromString("1010.75"));
+	}
+
+
+	// updates older than the state held are ignored, so the seed can race the stream
+	{
+		AccountStateCache cache;
+
+		cache.onUserData(accountUpdate(5000, { balance("USDT", "1200") }, { position("BTCUSDT", "BOTH", "0.050", "38000.0") }));
+		cache.seed(accountInformation());
+
+		BFCPP_CHECK(test, cache.seeded());
+		BFCPP_CHECK(test, cache.position("BTCUSDT")->amount == Decimal::fromString("0.05"));
+		BFCPP_CHECK(test, cache.position("BTCUSDT")->updateTime == 5000);
+		BFCPP_CHECK(test, cache.balance("USDT")->walletBalance == Decimal::fromString("1200"));
+
+		// the seed still sets what the stream hasn't
+		BFCPP_CHECK(test, cache.position("ETHUSDT", PositionSide::Short).has_value());
+
+		cache.onUserData(accountUpdate(4000, {}, { position("BTCUSDT", "BOTH", "0.040", "38000.0") }));
+		BFCPP_CHECK(test, cache.position("BTCUSDT")->amount == Decimal::fromString("0.05"));
+
+		// the same time is applied
+		cache.onUserData(accountUpdate(5000, {}, { position("BTCUSDT", "BOTH", "0.060", "38000.0") }));
+		BFCPP_CHECK(test, cache.position("BTCUSDT")->amount == Decimal::fromString("0.06"));
+	}
+
+
+	// hedge mode's LONG and SHORT positions are separate from each other and from BOTH
+	{
+		AccountStateCache cache;
+		cache.seed(accountInformation());
+
+		BFCPP_CHECK(test, cache.position("ETHUSDT", PositionSide::Long)->amount == Decimal::fromString("1"));
+		BFCPP_CHECK(test, cache.position("ETHUSDT", PositionSide::Short)->amount == Decimal::fromString("-2"));
+		BFCPP_CHECK(test, !cache.position("ETHUSDT", PositionSide::Both));
+		BFCPP_CHECK(test, !cache.position("BTCUSDT", PositionSide::Long));
+
+		cache.onUserData(accountUpdate(2000, {}, { position("ETHUSDT", "SHORT", "-3.000", "2650.0"), position("ETHUSDT", "BOTH", "0.5", "2700.0") }));
+
+		BFCPP_CHECK(test, cache.position("ETHUSDT", PositionSide::Long)->amount == Decimal::fromString("1"));
+		BFCPP_CHECK(test, cache.position("ETHUSDT", PositionSide::Long)->updateTime == 1000);
+		BFCPP_CHECK(test, cache.position("ETHUSDT", PositionSide::Short)->amount == Decimal::fromString("-3"));
+		BFCPP_CHECK(test, cache.position("ETHUSDT", PositionSide::Both)->amount == Decimal::fromString("0.5"));
+	}
+
+
+	// slots are fixed on construction, positions and assets beyond the capacity aren't held
+	{
+		AccountStateCache cache{ 2, 1 };
+
+		cache.onUserData(accountUpdate(1000, { balance("USDT", "1"), balance("BNB", "2") },
+										{ position("BTCUSDT", "BOTH", "1", "1"), position("ETHUSDT", "BOTH", "2", "2"), position("XRPUSDT", "BOTH", "3", "3") }));
+
+		BFCPP_CHECK(test, cache.position("BTCUSDT").has_value());
+		BFCPP_CHECK(test, cache.position("ETHUSDT").has_value());
+		BFCPP_CHECK(test, !cache.position("XRPUSDT"));
+		BFCPP_CHECK(test, cache.balance("USDT").has_value());
+		BFCPP_CHECK(test, !cache.balance("BNB"));
+
+		// those held are still updated
+		cache.onUserData(accountUpdate(2000, {}, { position("XRPUSDT", "BOTH", "4", "4"), position("ETHUSDT", "BOTH", "5", "5") }));
+		BFCPP_CHECK(test, !cache.position("XRPUSDT"));
+		BFCPP_CHECK(test, cache.position("ETHUSDT")->amount == Decimal::fromString("5"));
+
+		// as are names which don't fit a slot
+		AccountStateCache names;
+		names.onUserData(accountUpdate(1000, {}, { position(string(40, 'X'), "BOTH", "1", "1"), position("", "BOTH", "1", "1") }));
+		BFCPP_CHECK(test, !names.position(string(40, 'X')));
+		BFCPP_CHECK(test, !names.position(""));
+	}
+
+
+	// many positions, each found
+	{
+		AccountStateCache cache{ 500 };
+
+		vector<map<string, string>> positions;
+		for (int i = 0; i < 500; ++i)
+			positions.push_back(position("SYM" + std::to_string(i) + "USDT", i % 3 == 0 ? "BOTH" : i % 3 == 1 ? "LONG" : "SHORT", std::to_string(i), "1"));
+
+		cache.onUserData(accountUpdate(1000, {}, positions));
+
+		bool found = true;
+		for (int i = 0; i < 500; ++i)
+		{
+			const auto side = i % 3 == 0 ? PositionSide::Both : i % 3 == 1 ? PositionSide::Long : PositionSide::Short;
+			const auto held = cache.position("SYM" + std::to_string(i) + "USDT", side);
+			found = found && held && held->amount == Decimal{ i, 0 };
+		}
+
+		BFCPP_CHECK(test, found);
+	}
+
+
+	// a read whilst the position is written is retried, so it's never torn
+	{
+		AccountStateCache cache;
+		cache.onUserData(accountUpdate(0, {}, { position("BTCUSDT", "BOTH", "0", "0") }));
+
+		std::atomic_bool done{ false };
+
+		std::thread writer{ [&cache, &done]
+		{
+			for (int64_t i = 1; i <= 20000; ++i)
+			{
+				const auto value = std::to_string(i);
+				cache.onUserData(accountUpdate(i, {}, { { {"s", "BTCUSDT"}, {"ps", "BOTH"}, {"pa", value}, {"ep", value}, {"up", value} } }));
+			}
+
+			done = true;
+		} };
+
+		bool consistent = true;
+		int64_t lastTime = 0;
+
+		while (!done)
+		{
+			const auto held = cache.position("BTCUSDT");
+			consistent = consistent && held && held->amount == held->entryPrice && held->amount == held->unrealizedProfit && held->amount == Decimal{ held->updateTime, 0 } && held->updateTime >= lastTime;
+			lastTime = held ? held->updateTime : lastTime;
+		}
+
+		writer.join();
+
+		BFCPP_CHECK(test, consistent);
+		BFCPP_CHECK(test, cache.position("BTCUSDT")->updateTime == 20000);
+	}
+}
+
+
+#endif
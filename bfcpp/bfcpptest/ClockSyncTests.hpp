@@ -0,0 +1,106 @@
+#ifndef BFCPP_CLOCK_SYNC_TESTS_H
+#define BFCPP_CLOCK_SYNC_TESTS_H
+
+#include <ClockSync.hpp>
+#include "UnitTest.hpp"
+
+
+inline void clockSyncTests(UnitTest& test)
+{
+	using namespace bfcpp;
+	using namespace std::chrono_literals;
+
+	// local times in microseconds, the server's in milliseconds
+	const int64_t local = 1'700'000'000'000'000;
+
+
+	// not synced, the timestamp is the local time
+	{
+		ClockSync sync;
+
+		BFCPP_CHECK(test, !sync.synced());
+		BFCPP_CHECK(test, sync.offset() == 0us);
+
+		const auto before = ClockSync::localTime() / 1000;
+		const auto timestamp = sync.timestamp();
+		BFCPP_CHECK(test, timestamp >= before && timestamp <= ClockSync::localTime() / 1000);
+	}
+
+
+	// the sample with the lowest round trip is used, the server time is taken as 500us after its millisecond
+	{
+		ClockSync sync;
+
+		// round trips of 4ms, 1ms and 9ms, the server's clock is 250ms ahead
+		const vector<ClockSync::Sample> samples
+		{
+			{ local, (local + 2'000 + 250'000) / 1000 + 7, local + 4'000 },
+			{ local + 10'000, (local + 10'500 + 250'000) / 1000, local + 11'000 },
+			{ local + 20'000, (local + 24'500 + 250'000) / 1000 - 3, local + 29'000 }
+		};
+
+		BFCPP_CHECK(test, sync.update(samples));
+		BFCPP_CHECK(test, sync.synced());
+
+		// (local + 260'500) / 1000 * 1000 + 500 - (local + 10'500)
+		BFCPP_CHECK(test, sync.offset() == 250'000us);
+		BFCPP_CHECK(test, sync.delay() == 500us);
+
+		const auto timestamp = sync.timestamp();
+		const auto expected = (ClockSync::localTime() + 250'000) / 1000;
+		BFCPP_CHECK(test, timestamp <= expected && timestamp >= expected - 5);
+
+		// the order of the samples doesn't matter
+		ClockSync reversed;
+		BFCPP_CHECK(test, reversed.update({ samples[2], samples[1], samples[0] }));
+		BFCPP_CHECK(test, reversed.offset() == sync.offset());
+	}
+
+
+	// the +500us correction: a server time of T ms was taken between T and T+1 ms
+	{
+		ClockSync sync;
+
+		// zero round trip at local 1'000'000'000us, the server reports 1'000'000ms, the same millisecond
+		BFCPP_CHECK(test, sync.update({ { 1'000'000'000, 1'000'000, 1'000'000'000 } }));
+		BFCPP_CHECK(test, sync.offset() == 500us);
+		BFCPP_CHECK(test, sync.delay() == 0us);
+
+		// the server's clock behind
+		BFCPP_CHECK(test, sync.update({ { 1'000'000'000, 999'000, 1'000'002'000 } }));
+		BFCPP_CHECK(test, sync.offset() == -1'000'000us + 500us - 1'000us);
+		BFCPP_CHECK(test, sync.delay() == 1'000us);
+	}
+
+
+	// samples with a negative round trip, i.e. the local clock stepped back, are ignored
+	{
+		ClockSync sync;
+
+		BFCPP_CHECK(test, sync.update({ { local + 5'000, local / 1000 + 900'000, local }, { local, local / 1000 + 100, local + 2'000 } }));
+		BFCPP_CHECK(test, sync.offset() == 100'000us + 500us - 1'000us);
+		BFCPP_CHECK(test, sync.delay() == 1'000us);
+
+		// none usable, the offset is kept
+		BFCPP_CHECK(test, !sync.update({ { local + 5'000, local / 1000 + 900'000, local } }));
+		BFCPP_CHECK(test, sync.offset() == 100'000us + 500us - 1'000us);
+		BFCPP_CHECK(test, sync.synced());
+	}
+
+
+	// update({}) returns false without changing the offset
+	{
+		ClockSync sync;
+
+		BFCPP_CHECK(test, !sync.update({}));
+		BFCPP_CHECK(test, !sync.synced());
+		BFCPP_CHECK(test, sync.offset() == 0us);
+
+		BFCPP_CHECK(test, sync.update({ { 1'000'000'000, 1'000'000, 1'000'000'000 } }));
+		BFCPP_CHECK(test, !sync.update({}));
+		BFCPP_CHECK(test, sync.offset() == 500us);
+	}
+}
+
+
+#endif
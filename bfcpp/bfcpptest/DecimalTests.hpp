@@ -0,0 +1,139 @@
+#ifndef BFCPP_DECIMAL_TESTS_H
+#define BFCPP_DECIMAL_TESTS_H
+
+#include <Decimal.hpp>
+#include "UnitTest.hpp"
+
+
+inline void decimalTests(UnitTest& test)
+{
+	using namespace bfcpp;
+
+	using Rounding = Decimal::Rounding;
+
+
+	// parsing is exact, digits beyond the scale are truncated
+	{
+		BFCPP_CHECK(test, toFixedPoint("1234.56", 2) == 123456);
+		BFCPP_CHECK(test, toFixedPoint("1234.5678", 2) == 123456);
+		BFCPP_CHECK(test, toFixedPoint("-0.01", 4) == -100);
+		BFCPP_CHECK(test, toFixedPoint("+7", 1) == 70);
+		BFCPP_CHECK(test, toFixedPoint(".5", 1) == 5);
+		BFCPP_CHECK(test, toFixedPoint("9223372036854775807", 0) == std::numeric_limits<int64_t>::max());
+		BFCPP_CHECK(test, decimalPlaces("0.0100") == 2);
+		BFCPP_CHECK(test, decimalPlaces("100") == 0);
+
+		BFCPP_CHECK_THROWS(test, BfcppException, toFixedPoint("", 2));
+		BFCPP_CHECK_THROWS(test, BfcppException, toFixedPoint("-", 2));
+		BFCPP_CHECK_THROWS(test, BfcppException, toFixedPoint("1.2.3", 2));
+		BFCPP_CHECK_THROWS(test, BfcppException, toFixedPoint("1e5", 2));
+		BFCPP_CHECK_THROWS(test, BfcppException, toFixedPoint("9223372036854775808", 0));
+		BFCPP_CHECK_THROWS(test, BfcppException, toFixedPoint("92233720368.54775807", 9));
+
+		const auto d = Decimal::fromString("37500.125");
+		BFCPP_CHECK(test, d.raw() == 37500125 && d.scale() == 3);
+		BFCPP_CHECK(test, Decimal::fromString("37500.125", 1).raw() == 375001);
+	}
+
+
+	// formatting keeps exactly scale() decimal places
+	{
+		BFCPP_CHECK(test, Decimal(100, 4).str() == "0.0100");
+		BFCPP_CHECK(test, Decimal(-5, 2).str() == "-0.05");
+		BFCPP_CHECK(test, Decimal(123456, 0).str() == "123456");
+		BFCPP_CHECK(test, Decimal(std::numeric_limits<int64_t>::min(), 18).str() == "-9.223372036854775808");
+		BFCPP_CHECK(test, Decimal().str() == "0");
+
+		string s = "p=";
+		Decimal(15, 1).appendTo(s);
+		BFCPP_CHECK(test, s == "p=1.5");
+
+		BFCPP_CHECK(test, priceTransform("37500.125", 2) == "37500.13");
+		BFCPP_CHECK(test, priceTransform("-37500.125", 2) == "-37500.13");
+		BFCPP_CHECK(test, priceTransform("1.5", 3) == "1.500");
+	}
+
+
+	// comparison and arithmetic work across scales
+	{
+		BFCPP_CHECK(test, Decimal::fromString("1.50") == Decimal::fromString("1.5"));
+		BFCPP_CHECK(test, Decimal::fromString("-1.5") > Decimal::fromString("-1.6"));
+		BFCPP_CHECK(test, Decimal::fromString("-1.05") < Decimal::fromString("-1"));
+		BFCPP_CHECK(test, Decimal::fromString("2") > Decimal::fromString("1.999999999999999999"));
+		BFCPP_CHECK(test, Decimal::fromString("900000000000") > Decimal::fromString("0.000000000000000001"));
+
+		const auto sum = Decimal::fromString("1.25") + Decimal::fromString("0.005");
+		BFCPP_CHECK(test, sum.raw() == 1255 && sum.scale() == 3);
+		BFCPP_CHECK(test, (Decimal::fromString("1") - Decimal::fromString("1.5")).str() == "-0.5");
+		BFCPP_CHECK(test, (-Decimal::fromString("2.5")).str() == "-2.5");
+		BFCPP_CHECK(test, (Decimal::fromString("0.1") * 3).str() == "0.3");
+
+		auto total = Decimal::fromString("0.1");
+		total += Decimal::fromString("0.2");
+		total -= Decimal::fromString("0.05");
+		BFCPP_CHECK(test, total.str() == "0.25");
+
+		const auto notional = Decimal::fromString("37500.10").multiply(Decimal::fromString("0.003"), 2);
+		BFCPP_CHECK(test, notional.str() == "112.50");
+		BFCPP_CHECK(test, Decimal::fromString("1.5").multiply(Decimal::fromString("2"), 3).str() == "3.000");
+		BFCPP_CHECK(test, Decimal::fromString("-0.15").multiply(Decimal::fromString("0.1"), 2, Rounding::HalfUp).str() == "-0.02");
+		BFCPP_CHECK(test, Decimal::fromString("-0.15").multiply(Decimal::fromString("0.1"), 2, Rounding::Down).str() == "-0.01");
+
+		// the intermediate product is wider than 64 bits
+		const auto big = Decimal::fromString("9000000000.123456789").multiply(Decimal::fromString("1.000000001"), 9);
+		BFCPP_CHECK(test, big.str() == "9000000009.123456789");
+	}
+
+
+	// rounding
+	{
+		BFCPP_CHECK(test, Decimal::fromString("1.25").rescale(1).str() == "1.3");
+		BFCPP_CHECK(test, Decimal::fromString("1.24").rescale(1).str() == "1.2");
+		BFCPP_CHECK(test, Decimal::fromString("-1.25").rescale(1).str() == "-1.3");
+		BFCPP_CHECK(test, Decimal::fromString("1.29").rescale(1, Rounding::Down).str() == "1.2");
+		BFCPP_CHECK(test, Decimal::fromString("-1.29").rescale(1, Rounding::Down).str() == "-1.2");
+		BFCPP_CHECK(test, Decimal::fromString("1.21").rescale(1, Rounding::Up).str() == "1.3");
+		BFCPP_CHECK(test, Decimal::fromString("1.2").rescale(3).str() == "1.200");
+
+		BFCPP_CHECK(test, Decimal::fromString("37500.17").roundToStep(Decimal::fromString("0.10")).str() == "37500.10");
+		BFCPP_CHECK(test, Decimal::fromString("37500.17").roundToStep(Decimal::fromString("0.10"), Rounding::HalfUp).str() == "37500.20");
+		BFCPP_CHECK(test, Decimal::fromString("0.0034").roundToStep(Decimal::fromString("0.001"), Rounding::Up).str() == "0.0040");
+		BFCPP_CHECK(test, Decimal::fromString("7").roundToStep(Decimal::fromString("5")).str() == "5");
+	}
+
+
+	// results which don't fit throw
+	{
+		const Decimal max{ std::numeric_limits<int64_t>::max(), 0 };
+		const Decimal min{ std::numeric_limits<int64_t>::min(), 0 };
+
+		BFCPP_CHECK_THROWS(test, BfcppException, max + Decimal(1, 0));
+		BFCPP_CHECK_THROWS(test, BfcppException, min - Decimal(1, 0));
+		BFCPP_CHECK_THROWS(test, BfcppException, -min);
+		BFCPP_CHECK_THROWS(test, BfcppException, max * 2);
+		BFCPP_CHECK_THROWS(test, BfcppException, max.rescale(1));
+		BFCPP_CHECK_THROWS(test, BfcppException, max.multiply(Decimal(2, 0), 0));
+		BFCPP_CHECK_THROWS(test, BfcppException, Decimal(1, 0).rescale(Decimal::MaxScale + 1));
+		BFCPP_CHECK_THROWS(test, BfcppException, Decimal(1, 0).roundToStep(Decimal()));
+		BFCPP_CHECK_THROWS(test, BfcppException, Decimal(1, 0).roundToStep(Decimal(-1, 0)));
+		BFCPP_CHECK(test, (max - Decimal(1, 0)).raw() == std::numeric_limits<int64_t>::max() - 1);
+	}
+
+
+	// scales from exchangeInfo
+	{
+		ExchangeInfo info;
+		ExchangeInfo::Symbol symbol;
+		symbol.data["symbol"] = "BTCUSDT";
+		symbol.data["pricePrecision"] = "2";
+		symbol.data["quantityPrecision"] = "3";
+		info.symbols.push_back(symbol);
+
+		const auto scale = getDecimalScale(info, "BTCUSDT");
+		BFCPP_CHECK(test, scale.price == 2 && scale.quantity == 3);
+		BFCPP_CHECK_THROWS(test, BfcppException, getDecimalScale(info, "ETHUSDT"));
+	}
+}
+
+
+#endif
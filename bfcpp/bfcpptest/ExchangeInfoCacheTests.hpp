@@ -0,0 +1,203 @@
+#ifndef BFCPP_EXCHANGE_INFO_CACHE_TESTS_H
+#define BFCPP_EXCHANGE_INFO_CACHE_TESTS_H
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <ExchangeInfoCache.hpp>
+#include "UnitTest.hpp"
+
+
+namespace exchangeinfocachetests
+{
+	using namespace bfcpp;
+
+	inline ExchangeInfo::Symbol symbol(const string& name, const string& status, const string& pricePrecision, const string& tickSize)
+	{
+		ExchangeInfo::Symbol symbol;
+		symbol.data = { {"symbol", name}, {"pair", name}, {"contractType", "PERPETUAL"}, {"status", status}, {"baseAsset", name.substr(0, 3)},
+						{"quoteAsset", "USDT"}, {"marginAsset", "USDT"}, {"pricePrecision", pricePrecision}, {"quantityPrecision", "3"} };
+		symbol.filters = { { {"filterType", "PRICE_FILTER"}, {"minPrice", "0.10"}, {"maxPrice", "100000"}, {"tickSize", tickSize} },
+						   { {"filterType", "LOT_SIZE"}, {"minQty", "0.001"}, {"maxQty", "1000"}, {"stepSize", "0.001"} },
+						   { {"filterType", "MIN_NOTIONAL"}, {"notional", "5"} },
+						   { {"filterType", "PERCENT_PRICE"}, {"multiplierUp", "1.05"}, {"multiplierDown", "0.95"}, {"multiplierDecimal", "4"} } };
+		symbol.orderTypes = { "LIMIT", "MARKET", "STOP" };
+		symbol.timeInForce = { "GTC", "IOC" };
+		return symbol;
+	}
+
+
+	inline ExchangeInfo exchangeInfo(const string& serverTime, vector<ExchangeInfo::Symbol>&& symbols)
+	{
+		ExchangeInfo info;
+		info.serverTime = serverTime;
+		info.rateLimits = { { {"rateLimitType", "REQUEST_WEIGHT"}, {"interval", "MINUTE"}, {"intervalNum", "1"}, {"limit", "2400"} },
+							{ {"rateLimitType", "ORDERS"}, {"interval", "SECOND"}, {"intervalNum", "10"}, {"limit", "300"} } };
+		info.symbols = std::move(symbols);
+		return info;
+	}
+
+
+	inline string readFile(const std::filesystem::path& path)
+	{
+		std::ifstream in{ path, std::ios::binary };
+		return string{ std::istreambuf_iterator<char>{ in }, std::istreambuf_iterator<char>{} };
+	}
+
+
+	inline void writeFile(const std::filesystem::path& path, const string& contents)
+	{
+		std::ofstream out{ path, std::ios::binary | std::ios::trunc };
+		out.write(contents.data(), contents.size());
+	}
+
+
+	// the file with the bytes at offset replaced by value
+	inline void patchFile(const std::filesystem::path& from, const std::filesystem::path& to, const size_t offset, const uint32_t value)
+	{
+		auto contents = readFile(from);
+		std::memcpy(contents.data() + offset, &value, sizeof(value));
+		writeFile(to, contents);
+	}
+
+
+	inline bool sameRecords(const ExchangeInfoSnapshot& a, const ExchangeInfoSnapshot& b)
+	{
+		return a.symbols().size() == b.symbols().size() && std::memcmp(a.symbols().data(), b.symbols().data(), a.symbols().size() * sizeof(SymbolInfo)) == 0 &&
+			   a.rateLimits().size() == b.rateLimits().size() && std::memcmp(a.rateLimits().data(), b.rateLimits().data(), a.rateLimits().size() * sizeof(RateLimit)) == 0 &&
+			   a.updateTime() == b.updateTime();
+	}
+}
+
+
+inline void exchangeInfoCacheTests(UnitTest& test)
+{
+	using namespace bfcpp;
+	using namespace exchangeinfocachetests;
+
+	const auto root = std::filesystem::temp_directory_path() / ("bfcpp-unit-" + std::to_string(std::chrono::system_clock::now().time_since_epoch().count()));
+	std::filesystem::create_directories(root);
+
+	const auto path = (root / "exchangeinfo.bin").string();
+
+
+	// update() then a fresh cache loads the same records
+	{
+		ExchangeInfoCache cache{ path };
+
+		BFCPP_CHECK(test, cache.snapshot() == nullptr);
+		BFCPP_CHECK(test, !cache.load());
+		BFCPP_CHECK(test, cache.snapshot() == nullptr);
+
+		BFCPP_CHECK(test, cache.update(exchangeInfo("1700000000000", { symbol("BTCUSDT", "TRADING", "2", "0.10"), symbol("ETHUSDT", "TRADING", "2", "0.01"),
+																		symbol("XRPUSDT", "TRADING", "4", "0.0001") })));
+
+		const auto snapshot = cache.snapshot();
+		BFCPP_CHECK(test, snapshot && snapshot->symbols().size() == 3);
+		BFCPP_CHECK(test, snapshot->updateTime() == 1700000000000);
+		BFCPP_CHECK(test, snapshot->rateLimits().size() == 2);
+		BFCPP_CHECK(test, snapshot->registry()->id("ETHUSDT") == 1);
+		BFCPP_CHECK(test, snapshot->symbol("ETHUSDT") == snapshot->symbol(SymbolId{ 1 }));
+		BFCPP_CHECK(test, snapshot->symbol("DOGEUSDT") == nullptr);
+
+		const auto xrp = snapshot->symbol("XRPUSDT");
+		BFCPP_CHECK(test, xrp && xrp->symbol() == "XRPUSDT" && xrp->baseAsset() == "XRP" && xrp->contractType() == "PERPETUAL" && xrp->trading());
+		BFCPP_CHECK(test, xrp && xrp->pricePrecision == 4 && xrp->quantityPrecision == 3);
+		BFCPP_CHECK(test, xrp && xrp->tickSize == Decimal::fromString("0.0001") && xrp->minQty == Decimal::fromString("0.001") && xrp->minNotional == Decimal::fromString("5"));
+		BFCPP_CHECK(test, xrp && xrp->multiplierUp == Decimal::fromString("1.05") && xrp->multiplierDown == Decimal::fromString("0.95"));
+		BFCPP_CHECK(test, xrp && xrp->allowsOrderType("STOP") && !xrp->allowsOrderType("TAKE_PROFIT") && xrp->allowsTimeInForce("IOC") && !xrp->allowsTimeInForce("GTX"));
+
+		ExchangeInfoCache loaded{ path };
+		BFCPP_CHECK(test, loaded.load());
+		BFCPP_CHECK(test, loaded.snapshot() && sameRecords(*loaded.snapshot(), *snapshot));
+		BFCPP_CHECK(test, loaded.snapshot()->registry()->id("XRPUSDT") == 2);
+		BFCPP_CHECK(test, loaded.snapshot()->registry()->scale(2) && loaded.snapshot()->registry()->scale(2)->price == 4);
+	}
+
+
+	// ids are kept across refreshes, a delisted symbol keeps its record without a status
+	{
+		ExchangeInfoCache cache{ path };
+		BFCPP_CHECK(test, cache.load());
+
+		BFCPP_CHECK(test, cache.update(exchangeInfo("1700000060000", { symbol("SOLUSDT", "TRADING", "3", "0.001"), symbol("XRPUSDT", "SETTLING", "4", "0.0001"),
+																		symbol("BTCUSDT", "TRADING", "1", "0.1") })));
+
+		const auto snapshot = cache.snapshot();
+		BFCPP_CHECK(test, snapshot->symbols().size() == 4);
+		BFCPP_CHECK(test, snapshot->registry()->id("BTCUSDT") == 0);
+		BFCPP_CHECK(test, snapshot->registry()->id("ETHUSDT") == 1);
+		BFCPP_CHECK(test, snapshot->registry()->id("XRPUSDT") == 2);
+		BFCPP_CHECK(test, snapshot->registry()->id("SOLUSDT") == 3);
+
+		const auto eth = snapshot->symbol("ETHUSDT");
+		BFCPP_CHECK(test, eth && eth->status().empty() && !eth->trading());
+		BFCPP_CHECK(test, eth && eth->tickSize == Decimal::fromString("0.01") && eth->baseAsset() == "ETH");
+
+		BFCPP_CHECK(test, snapshot->symbol("XRPUSDT")->status() == "SETTLING");
+		BFCPP_CHECK(test, snapshot->symbol("BTCUSDT")->pricePrecision == 1);
+		BFCPP_CHECK(test, snapshot->updateTime() == 1700000060000);
+
+		ExchangeInfoCache loaded{ path };
+		BFCPP_CHECK(test, loaded.load());
+		BFCPP_CHECK(test, sameRecords(*loaded.snapshot(), *snapshot));
+		BFCPP_CHECK(test, loaded.snapshot()->registry()->id("SOLUSDT") == 3);
+	}
+
+
+	// load() rejects a file from another build or a partial file, keeping the snapshot it has
+	{
+		const auto bad = (root / "bad.bin").string();
+
+		ExchangeInfoCache cache{ bad };
+
+		// magic, version then SymbolInfo size, see FileHeader
+		patchFile(path, bad, 0, 0x58585858);
+		BFCPP_CHECK(test, !cache.load());
+
+		patchFile(path, bad, 4, 2);
+		BFCPP_CHECK(test, !cache.load());
+
+		patchFile(path, bad, 8, sizeof(SymbolInfo) + 8);
+		BFCPP_CHECK(test, !cache.load());
+
+		const auto contents = readFile(path);
+
+		writeFile(bad, contents.substr(0, contents.size() - 1));
+		BFCPP_CHECK(test, !cache.load());
+
+		writeFile(bad, contents + '\0');
+		BFCPP_CHECK(test, !cache.load());
+
+		writeFile(bad, contents.substr(0, 10));
+		BFCPP_CHECK(test, !cache.load());
+
+		BFCPP_CHECK(test, cache.snapshot() == nullptr);
+
+		writeFile(bad, contents);
+		BFCPP_CHECK(test, cache.load());
+
+		const auto snapshot = cache.snapshot();
+		writeFile(bad, contents.substr(0, contents.size() / 2));
+		BFCPP_CHECK(test, !cache.load());
+		BFCPP_CHECK(test, cache.snapshot() == snapshot);
+	}
+
+
+	// the snapshot is replaced even if the file can't be written
+	{
+		ExchangeInfoCache cache{ (root / "missing" / "exchangeinfo.bin").string() };
+
+		BFCPP_CHECK(test, !cache.update(exchangeInfo("1700000000000", { symbol("BTCUSDT", "TRADING", "2", "0.10") })));
+		BFCPP_CHECK(test, cache.snapshot() && cache.snapshot()->symbol("BTCUSDT") != nullptr);
+		BFCPP_CHECK(test, !cache.load());
+		BFCPP_CHECK(test, cache.snapshot() && cache.snapshot()->symbol("BTCUSDT") != nullptr);
+	}
+
+
+	std::error_code ec;
+	std::filesystem::remove_all(root, ec);
+}
+
+
+#endif
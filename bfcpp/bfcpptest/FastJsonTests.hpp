@@ -0,0 +1,138 @@
+#ifndef BFCPP_FAST_JSON_TESTS_H
+#define BFCPP_FAST_JSON_TESTS_H
+
+#include <FastJson.hpp>
+#include "UnitTest.hpp"
+
+
+inline void fastJsonTests(UnitTest& test)
+{
+	using namespace bfcpp;
+	using namespace bfcpp::fastjson;
+
+
+	// a depth stream frame, fields are read in order
+	{
+		const string frame = R"({"e":"depthUpdate", "E":1621845621365, "s":"BTCUSDT", "U":100, "u":105, "pu":-1, "b":[["37500.10","0.250"],["37500.00","1.5"]], "a":[] })";
+
+		Document doc;
+		BFCPP_CHECK(test, doc.parse(frame));
+
+		vector<string> keys;
+		int64_t eventTime = 0, pu = 0;
+		string symbol;
+		vector<std::pair<string, string>> bids;
+		size_t asks = 99;
+
+		doc.root().forEachField([&](std::string_view key, Value value)
+		{
+			keys.emplace_back(key);
+
+			if (key == "E")
+				eventTime = value.getInt64();
+			else if (key == "s")
+				symbol = value.getString();
+			else if (key == "pu")
+				pu = value.getInt64();
+			else if (key == "b")
+			{
+				value.forEachElement([&](Value level)
+				{
+					vector<string> pair;
+					level.forEachElement([&](Value v) { pair.emplace_back(v.getString()); });
+					bids.emplace_back(pair.at(0), pair.at(1));
+				});
+			}
+			else if (key == "a")
+			{
+				asks = 0;
+				value.forEachElement([&](Value) { ++asks; });
+			}
+		});
+
+		BFCPP_CHECK(test, (keys == vector<string>{ "e", "E", "s", "U", "u", "pu", "b", "a" }));
+		BFCPP_CHECK(test, eventTime == 1621845621365);
+		BFCPP_CHECK(test, symbol == "BTCUSDT");
+		BFCPP_CHECK(test, pu == -1);
+		BFCPP_CHECK(test, (bids == vector<std::pair<string, string>>{ {"37500.10", "0.250"}, {"37500.00", "1.5"} }));
+		BFCPP_CHECK(test, asks == 0);
+
+
+		Value value{ doc, 0, 0 };
+		BFCPP_CHECK(test, doc.root().find("u", value) && value.getInt64() == 105);
+		BFCPP_CHECK(test, !doc.root().find("x", value));
+		BFCPP_CHECK(test, doc.root().find("b", value) && value.isArray());
+		BFCPP_CHECK(test, value.raw() == R"([["37500.10","0.250"],["37500.00","1.5"]])");
+	}
+
+
+	// value types, quoted and unquoted numbers and nested objects
+	{
+		const string frame = "{ \"stream\" : \"btcusdt@markPrice\",\n\t\"data\" : { \"p\" : \"11794.15000000\", \"r\" : 0.00038167, \"ok\" : true, \"no\" : false, \"x\" : null } }";
+
+		Document doc;
+		BFCPP_CHECK(test, doc.parse(frame));
+
+		Value data{ doc, 0, 0 };
+		BFCPP_CHECK(test, doc.root().find("data", data) && data.isObject());
+
+		Value value{ doc, 0, 0 };
+		BFCPP_CHECK(test, data.find("p", value) && value.type() == Value::Type::String);
+		BFCPP_CHECK(test, value.getDecimal(8) == Decimal::fromString("11794.15", 8));
+		BFCPP_CHECK(test, value.raw() == "\"11794.15000000\"");
+		BFCPP_CHECK(test, data.find("r", value) && value.type() == Value::Type::Number);
+		BFCPP_CHECK(test, value.getString() == "0.00038167");
+		BFCPP_CHECK(test, value.getDecimal(8) == Decimal::fromString("0.00038167", 8));
+		BFCPP_CHECK(test, data.find("ok", value) && value.type() == Value::Type::True && value.getBool());
+		BFCPP_CHECK(test, data.find("no", value) && value.type() == Value::Type::False && !value.getBool());
+		BFCPP_CHECK(test, data.find("x", value) && value.type() == Value::Type::Null);
+	}
+
+
+	// structural chars and escaped quotes within strings, across the 64 byte blocks
+	{
+		const string text = R"(a,b:{c}[d] \"quoted\" and a long enough string to cross into the next block \\)";
+		const string frame = R"({"msg":")" + text + R"(", "n":[1, 2 ,3], "end":"}"})";
+
+		Document doc;
+		BFCPP_CHECK(test, frame.size() > 64);
+		BFCPP_CHECK(test, doc.parse(frame));
+
+		Value value{ doc, 0, 0 };
+		BFCPP_CHECK(test, doc.root().find("msg", value) && value.getString() == text);
+
+		vector<int64_t> numbers;
+		BFCPP_CHECK(test, doc.root().find("n", value));
+		value.forEachElement([&](Value v) { numbers.push_back(v.getInt64()); });
+		BFCPP_CHECK(test, (numbers == vector<int64_t>{ 1, 2, 3 }));
+
+		BFCPP_CHECK(test, doc.root().find("end", value) && value.getString() == "}");
+	}
+
+
+	// a document is reused between frames, malformed frames aren't read
+	{
+		Document doc;
+
+		BFCPP_CHECK(test, doc.parse(R"({"a":1})"));
+		BFCPP_CHECK(test, !doc.parse(R"({"a":"1})"));
+		BFCPP_CHECK(test, !doc.parse(R"({"a":[1})"));
+		BFCPP_CHECK(test, !doc.parse(R"({"a":1}})"));
+		BFCPP_CHECK(test, !doc.parse(""));
+
+		BFCPP_CHECK(test, doc.parse(R"({"b":2})"));
+		Value value{ doc, 0, 0 };
+		BFCPP_CHECK(test, doc.root().find("b", value) && value.getInt64() == 2);
+		BFCPP_CHECK_THROWS(test, BfcppException, doc.root().forEachElement([](Value) {}));
+
+		// tryRead() reports frames which can't be read, so the caller can fall back to cpprest
+		int64_t read = 0;
+		BFCPP_CHECK(test, tryRead(doc, R"({"c":3})", [&](Value root) { Value v{ doc, 0, 0 }; if (root.find("c", v)) read = v.getInt64(); }));
+		BFCPP_CHECK(test, read == 3);
+		BFCPP_CHECK(test, !tryRead(doc, R"({"c":3)", [](Value) {}));
+		BFCPP_CHECK(test, !tryRead(doc, R"(["c"])", [](Value root) { root.forEachField([](std::string_view, Value) {}); }));
+	}
+}
+
+
+#endif
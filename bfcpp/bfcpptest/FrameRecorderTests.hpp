@@ -0,0 +1,243 @@
+#ifndef BFCPP_FRAME_RECORDER_TESTS_H
+#define BFCPP_FRAME_RECORDER_TESTS_H
+
+#include <filesystem>
+#include <thread>
+#include <FrameRecorder.hpp>
+#include "UnitTest.hpp"
+
+
+namespace framerecordertests
+{
+	using namespace bfcpp;
+
+	struct Frame
+	{
+		string uri;
+		string frame;
+		std::chrono::nanoseconds received;
+		std::chrono::nanoseconds systemTime;
+	};
+
+
+	inline bool readAll(const string& path, vector<Frame>& frames)
+	{
+		return FrameRecorder::read(path, [&frames](const RecordedFrame& f)
+		{
+			frames.push_back(Frame{ string{ f.uri }, string{ f.frame }, f.received, f.systemTime });
+		});
+	}
+
+
+	// the recording files in the directory, in the order they were written
+	inline vector<string> recordings(const std::filesystem::path& directory)
+	{
+		vector<std::pair<uint64_t, string>> files;
+
+		for (const auto& entry : std::filesystem::directory_iterator{ directory })
+		{
+			const auto name = entry.path().stem().string();
+			files.emplace_back(std::stoull(name.substr(name.rfind('-') + 1)), entry.path().string());
+		}
+
+		std::sort(files.begin(), files.end());
+
+		vector<string> paths;
+		for (auto& file : files)
+			paths.push_back(std::move(file.second));
+
+		return paths;
+	}
+}
+
+
+inline void frameRecorderTests(UnitTest& test)
+{
+	using namespace bfcpp;
+	using namespace framerecordertests;
+	using namespace std::chrono_literals;
+
+	using Clock = FrameRecorder::Clock;
+
+	const auto root = std::filesystem::temp_directory_path() / ("bfcpp-unit-" + std::to_string(std::chrono::system_clock::now().time_since_epoch().count()));
+
+
+	// frames are read back as recorded
+	{
+		FrameRecorder::Options options;
+		options.directory = (root / "roundtrip").string();
+		options.prefix = "unit";
+		options.flushInterval = 5ms;
+
+		FrameRecorder recorder{ options };
+
+		const auto now = Clock::now();
+		const string depth = R"({"e":"depthUpdate","E":1621845621365,"s":"BTCUSDT","U":100,"u":105,"pu":99,"b":[["37500.10","0.250"]],"a":[]})";
+
+		recorder.record("wss://fstream.binance.com/ws/btcusdt@depth@0ms", depth, now);
+		recorder.record("wss://fstream.binance.com/stream", R"({"stream":"btcusdt@markPrice","data":{}})", now + 1ms);
+		std::this_thread::sleep_for(20ms);  // the writer switches buffers in between
+		recorder.record("", "", now + 2ms);
+		recorder.record("wss://fstream.binance.com/ws/listenKey", string(5000, 'x'), now + 3ms);
+		recorder.stop();
+
+		// stopped, so this is dropped
+		recorder.record("wss://fstream.binance.com/stream", "{}", now + 4ms);
+
+		BFCPP_CHECK(test, recorder.recorded() == 4);
+		BFCPP_CHECK(test, recorder.dropped() == 1);
+		BFCPP_CHECK(test, !recorder.failed());
+
+		const auto file = recorder.currentFile();
+		BFCPP_CHECK(test, std::filesystem::path{ file }.filename().string().rfind("unit-", 0) == 0);
+		BFCPP_CHECK(test, std::filesystem::path{ file }.extension() == ".bfr");
+
+		vector<Frame> frames;
+		BFCPP_CHECK(test, readAll(file, frames));
+		BFCPP_CHECK(test, frames.size() == 4);
+
+		if (frames.size() == 4)
+		{
+			const auto since = [now](const Frame& f) { return f.received - now.time_since_epoch(); };
+
+			BFCPP_CHECK(test, frames[0].uri == "wss://fstream.binance.com/ws/btcusdt@depth@0ms" && frames[0].frame == depth);
+			BFCPP_CHECK(test, since(frames[0]) == 0ns);
+			BFCPP_CHECK(test, frames[1].uri == "wss://fstream.binance.com/stream" && frames[1].frame == R"({"stream":"btcusdt@markPrice","data":{}})");
+			BFCPP_CHECK(test, since(frames[1]) == 1ms);
+			BFCPP_CHECK(test, frames[2].uri.empty() && frames[2].frame.empty());
+			BFCPP_CHECK(test, frames[3].frame == string(5000, 'x'));
+			BFCPP_CHECK(test, since(frames[3]) == 3ms);
+
+			// the system time is from the clocks when the file was opened, which was just before 'now'
+			const auto systemNow = std::chrono::system_clock::now().time_since_epoch();
+			BFCPP_CHECK(test, frames[1].systemTime - frames[0].systemTime == 1ms);
+			BFCPP_CHECK(test, frames[0].systemTime <= systemNow && systemNow - frames[0].systemTime < 60s);
+		}
+
+
+		// a truncated file passes the complete records then fails
+		const auto truncated = (root / "truncated.bfr").string();
+		std::filesystem::copy_file(file, truncated);
+		std::filesystem::resize_file(truncated, std::filesystem::file_size(file) - 10);
+
+		frames.clear();
+		BFCPP_CHECK(test, !readAll(truncated, frames));
+		BFCPP_CHECK(test, frames.size() == 3);
+
+		// within the last record's header
+		const auto lastRecord = FrameRecorder::RecordHeaderSize + string{ "wss://fstream.binance.com/ws/listenKey" }.size() + 5000;
+		std::filesystem::resize_file(truncated, std::filesystem::file_size(file) - lastRecord + 6);
+		frames.clear();
+		BFCPP_CHECK(test, !readAll(truncated, frames));
+		BFCPP_CHECK(test, frames.size() == 3);
+
+		// not a recording
+		const auto other = (root / "other.bfr").string();
+		std::ofstream{ other } << "not a recording, but long enough for a header";
+		BFCPP_CHECK(test, !readAll(other, frames));
+		BFCPP_CHECK(test, !readAll((root / "missing.bfr").string(), frames));
+	}
+
+
+	// frames larger than a buffer are dropped, a file which reaches maxFileSize is rotated
+	{
+		FrameRecorder::Options options;
+		options.directory = (root / "rotate").string();
+		options.prefix = "rotate";
+		options.maxFileSize = 300;
+		options.maxBufferedBytes = 4096;
+		options.flushInterval = 1ms;
+
+		FrameRecorder recorder{ options };
+
+		const auto now = Clock::now();
+		recorder.record("uri", string(3000, 'x'), now);
+
+		for (int i = 0; i < 10; ++i)
+			recorder.record("uri", string(50, static_cast<char>('a' + i)), now + std::chrono::milliseconds{ i });
+
+		recorder.stop();
+
+		BFCPP_CHECK(test, recorder.recorded() == 10);
+		BFCPP_CHECK(test, recorder.dropped() == 1);
+
+		const auto files = recordings(options.directory);
+		BFCPP_CHECK(test, files.size() > 1);
+
+		vector<Frame> frames;
+		bool complete = true, fits = true;
+
+		for (const auto& file : files)
+		{
+			complete = readAll(file, frames) && complete;
+			fits = std::filesystem::file_size(file) <= options.maxFileSize && fits;
+		}
+
+		BFCPP_CHECK(test, complete);
+		BFCPP_CHECK(test, fits);
+		BFCPP_CHECK(test, frames.size() == 10);
+
+		bool ordered = frames.size() == 10;
+		for (size_t i = 0; ordered && i < frames.size(); ++i)
+			ordered = frames[i].frame == string(50, static_cast<char>('a' + i));
+
+		BFCPP_CHECK(test, ordered);
+	}
+
+
+	// recorded from several receive threads, each thread's frames are kept in order
+	{
+		FrameRecorder::Options options;
+		options.directory = (root / "threads").string();
+		options.flushInterval = 1ms;
+
+		const int threadCount = 4, count = 5000;
+
+		{
+			FrameRecorder recorder{ options };
+			vector<std::thread> threads;
+
+			for (int t = 0; t < threadCount; ++t)
+			{
+				threads.emplace_back([&recorder, t]
+				{
+					for (int i = 0; i < count; ++i)
+						recorder.record(std::to_string(t), std::to_string(i), Clock::now());
+				});
+			}
+
+			for (auto& thread : threads)
+				thread.join();
+
+			recorder.stop();
+
+			BFCPP_CHECK(test, recorder.recorded() + recorder.dropped() == threadCount * count);
+			BFCPP_CHECK(test, recorder.dropped() == 0);
+		}
+
+		vector<Frame> frames;
+		for (const auto& file : recordings(options.directory))
+			readAll(file, frames);
+
+		BFCPP_CHECK(test, frames.size() == threadCount * count);
+
+		vector<int> next(threadCount, 0);
+		bool ordered = true;
+
+		for (const auto& frame : frames)
+		{
+			auto& expected = next.at(std::stoi(frame.uri));
+			ordered = ordered && std::stoi(frame.frame) == expected;
+			++expected;
+		}
+
+		BFCPP_CHECK(test, ordered);
+	}
+
+
+	std::error_code ec;
+	std::filesystem::remove_all(root, ec);
+}
+
+
+#endif
@@ -0,0 +1,207 @@
+#ifndef BFCPP_LATENCY_HISTOGRAM_TESTS_H
+#define BFCPP_LATENCY_HISTOGRAM_TESTS_H
+
+#include <thread>
+#include <OrderLatencyTracer.hpp>
+#include "UnitTest.hpp"
+
+
+inline void latencyHistogramTests(UnitTest& test)
+{
+	using namespace bfcpp;
+	using namespace std::chrono_literals;
+
+
+	// values below 2^SubBucketBits are exact
+	{
+		LatencyHistogram histogram;
+
+		BFCPP_CHECK(test, histogram.count() == 0);
+		BFCPP_CHECK(test, histogram.min() == 0ns && histogram.max() == 0ns && histogram.mean() == 0ns);
+		BFCPP_CHECK(test, histogram.percentile(50.0) == 0ns);
+
+		for (int64_t v = 100; v >= 1; --v)
+			histogram.record(v);
+
+		const auto summary = histogram.summary();
+		BFCPP_CHECK(test, summary.count == 100);
+		BFCPP_CHECK(test, summary.min == 1ns);
+		BFCPP_CHECK(test, summary.max == 100ns);
+		BFCPP_CHECK(test, summary.mean == 50ns);
+		BFCPP_CHECK(test, summary.p50 == 50ns);
+		BFCPP_CHECK(test, summary.p90 == 90ns);
+		BFCPP_CHECK(test, summary.p99 == 99ns);
+		BFCPP_CHECK(test, summary.p999 == 100ns);
+		BFCPP_CHECK(test, histogram.percentile(0.0) == 1ns);
+		BFCPP_CHECK(test, histogram.percentile(100.0) == 100ns);
+		BFCPP_CHECK(test, histogram.percentile(150.0) == 100ns);
+
+		histogram.reset();
+		BFCPP_CHECK(test, histogram.count() == 0);
+		BFCPP_CHECK(test, histogram.max() == 0ns && histogram.min() == 0ns);
+	}
+
+
+	// larger values are within 1/2^(SubBucketBits - 1) above the value
+	{
+		LatencyHistogram histogram;
+		bool withinBound = true;
+
+		for (int64_t v = 128; v < LatencyHistogram::MaxValue / 3; v = v * 3 + 1)
+		{
+			histogram.reset();
+			histogram.record(v);
+			histogram.record(v * 2);
+
+			const auto p50 = histogram.percentile(50.0).count();
+			withinBound = withinBound && p50 >= v && p50 <= v + v / 64;
+		}
+
+		BFCPP_CHECK(test, withinBound);
+
+		histogram.reset();
+		histogram.record(1ms);
+		histogram.record(2ms);
+		BFCPP_CHECK(test, histogram.percentile(100.0) == 2ms);
+		BFCPP_CHECK(test, histogram.mean() == 1500us);
+	}
+
+
+	// out of range values are clamped
+	{
+		LatencyHistogram histogram;
+
+		histogram.record(-5);
+		histogram.record(LatencyHistogram::MaxValue + 1000);
+
+		BFCPP_CHECK(test, histogram.min() == 0ns);
+		BFCPP_CHECK(test, histogram.max().count() == LatencyHistogram::MaxValue);
+		BFCPP_CHECK(test, histogram.percentile(100.0).count() == LatencyHistogram::MaxValue);
+	}
+
+
+	// recorded from several threads
+	{
+		LatencyHistogram histogram;
+		vector<std::thread> threads;
+
+		for (int t = 1; t <= 4; ++t)
+		{
+			threads.emplace_back([&histogram, t]
+			{
+				for (int i = 0; i < 50000; ++i)
+					histogram.record(t * 1000);
+			});
+		}
+
+		for (auto& thread : threads)
+			thread.join();
+
+		BFCPP_CHECK(test, histogram.count() == 200000);
+		BFCPP_CHECK(test, histogram.min() == 1us);
+		BFCPP_CHECK(test, histogram.max() == 4us);
+		BFCPP_CHECK(test, histogram.mean() == 2500ns);
+	}
+
+
+	// OrderLatencyTracer records each stage, traces end when the order closes or is abandoned
+	{
+		using Clock = OrderLatencyTracer::Clock;
+		using Stage = OrderLatencyStage;
+
+		OrderLatencyTracer tracer{ 2 };
+
+		const auto a = tracer.nextClientOrderId(), b = tracer.nextClientOrderId();
+		BFCPP_CHECK(test, a != b);
+		BFCPP_CHECK(test, a.size() <= 36 && a.rfind("bft", 0) == 0);
+
+		const Clock::time_point start{ 1s };
+		tracer.begin(a, start, start + 10us, start + 15us);
+		tracer.onSent(a, start + 20us);
+		tracer.onRestAck(a, true, start + 1ms);
+
+		BFCPP_CHECK(test, tracer.inFlight() == 1);
+		BFCPP_CHECK(test, tracer.summary(Stage::Build).max == 10us);
+		BFCPP_CHECK(test, tracer.summary(Stage::Sign).max == 5us);
+		BFCPP_CHECK(test, tracer.summary(Stage::Send).max == 5us);
+		BFCPP_CHECK(test, tracer.summary(Stage::RestAck).max == 980us);
+
+		auto update = [](const string& clientOrderId, const string& status)
+		{
+			UsdFutureUserData data{ UsdFutureUserData::EventType::OrderUpdate };
+			data.ou.orders["BTCUSDT"] = { {"c", clientOrderId}, {"X", status} };
+			return data;
+		};
+
+		tracer.onUserData(update(a, "NEW"), start + 2ms);
+		tracer.onUserData(update(a, "PARTIALLY_FILLED"), start + 3ms);
+		BFCPP_CHECK(test, tracer.inFlight() == 1);
+
+		tracer.onUserData(update(a, "FILLED"), start + 4ms);
+		BFCPP_CHECK(test, tracer.inFlight() == 0);
+		BFCPP_CHECK(test, tracer.summary(Stage::StreamAck).max == 1980us);
+		BFCPP_CHECK(test, tracer.summary(Stage::TickToAck).max == 2ms);
+		BFCPP_CHECK(test, tracer.summary(Stage::FirstFill).max == 2980us);
+		BFCPP_CHECK(test, tracer.summary(Stage::FinalFill).max == 3980us);
+		BFCPP_CHECK(test, tracer.summary(Stage::StreamAck).count == 1);
+
+		// a failed order ends its trace
+		tracer.begin(b, start, start, start);
+		tracer.onRestAck(b, false, start + 1ms);
+		BFCPP_CHECK(test, tracer.inFlight() == 0);
+
+		// a MARKET order's fill usually arrives before its REST response, the trace is kept for it
+		const auto market = tracer.nextClientOrderId();
+		tracer.begin(market, start, start, start);
+		tracer.onUserData(update(market, "FILLED"), start + 2ms);
+		BFCPP_CHECK(test, tracer.inFlight() == 1);
+		BFCPP_CHECK(test, tracer.summary(Stage::FinalFill).count == 2);
+
+		tracer.onUserData(update(market, "FILLED"), start + 3ms);
+		BFCPP_CHECK(test, tracer.summary(Stage::FinalFill).count == 2);
+
+		tracer.onRestAck(market, true, start + 4ms);
+		BFCPP_CHECK(test, tracer.inFlight() == 0);
+		BFCPP_CHECK(test, tracer.summary(Stage::RestAck).count == 3);
+		BFCPP_CHECK(test, tracer.summary(Stage::RestAck).max == 4ms);
+
+		// as is an IOC order's which expires
+		tracer.begin(market, start, start, start);
+		tracer.onUserData(update(market, "EXPIRED"), start + 1ms);
+		BFCPP_CHECK(test, tracer.inFlight() == 1);
+		tracer.onRestAck(market, true, start + 2ms);
+		BFCPP_CHECK(test, tracer.inFlight() == 0);
+
+		// the guard abandons traces unless released
+		const vector<string> ids = { tracer.nextClientOrderId(), tracer.nextClientOrderId() };
+		{
+			tracer.begin(ids[0], start, start, start);
+			tracer.begin(ids[1], start, start, start);
+			OrderLatencyTracer::TraceGuard guard{ tracer, ids };
+		}
+		BFCPP_CHECK(test, tracer.inFlight() == 0);
+
+		{
+			tracer.begin(ids[0], start, start, start);
+			OrderLatencyTracer::TraceGuard guard{ tracer, ids };
+			guard.release();
+		}
+		BFCPP_CHECK(test, tracer.inFlight() == 1);
+
+		tracer.abandon(ids[0]);
+		BFCPP_CHECK(test, tracer.inFlight() == 0);
+
+		// beyond capacity the oldest trace ends
+		for (int i = 0; i < 3; ++i)
+			tracer.begin(tracer.nextClientOrderId(), start + std::chrono::seconds{ i }, start, start);
+
+		BFCPP_CHECK(test, tracer.inFlight() == 2);
+
+		tracer.reset();
+		BFCPP_CHECK(test, tracer.summary(Stage::Build).count == 0);
+		BFCPP_CHECK(test, tracer.inFlight() == 2);
+	}
+}
+
+
+#endif
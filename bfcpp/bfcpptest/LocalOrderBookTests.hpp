@@ -0,0 +1,146 @@
+#ifndef BFCPP_LOCAL_ORDER_BOOK_TESTS_H
+#define BFCPP_LOCAL_ORDER_BOOK_TESTS_H
+
+#include <LocalOrderBook.hpp>
+#include "UnitTest.hpp"
+
+
+namespace localorderbooktests
+{
+	using namespace bfcpp;
+
+	inline BookDepthDiff diff(const LocalOrderBook& book, const uint64_t first, const uint64_t last, const uint64_t previous,
+							  vector<std::pair<string, string>> bids, vector<std::pair<string, string>> asks)
+	{
+		BookDepthDiff d;
+		d.firstUpdateId = first;
+		d.finalUpdateId = last;
+		d.previousFinalUpdateId = previous;
+
+		for (const auto& bid : bids)
+			d.bids.emplace_back(book.toTick(bid.first), book.toQuantity(bid.second));
+
+		for (const auto& ask : asks)
+			d.asks.emplace_back(book.toTick(ask.first), book.toQuantity(ask.second));
+
+		return d;
+	}
+
+
+	inline OrderBook snapshot(const string& lastUpdateId, vector<std::pair<string, string>> bids, vector<std::pair<string, string>> asks)
+	{
+		OrderBook ob;
+		ob.lastUpdateId = lastUpdateId;
+		ob.bids = std::move(bids);
+		ob.asks = std::move(asks);
+		return ob;
+	}
+}
+
+
+inline void localOrderBookTests(UnitTest& test)
+{
+	using namespace bfcpp;
+	using namespace localorderbooktests;
+
+	using Result = LocalOrderBook::UpdateResult;
+
+
+	// diffs are buffered until the snapshot, those older than it are dropped and the first which spans it is applied
+	{
+		LocalOrderBook book{ "BTCUSDT", "0.10" };
+
+		BFCPP_CHECK(test, book.needsSnapshot());
+		BFCPP_CHECK(test, book.update(diff(book, 90, 95, 89, { {"100.0", "1"} }, {})) == Result::Buffered);
+		BFCPP_CHECK(test, book.update(diff(book, 96, 105, 95, { {"100.1", "2"} }, {})) == Result::Buffered);
+		BFCPP_CHECK(test, !book.isSynced());
+		BFCPP_CHECK(test, !book.bestBid());
+
+		BFCPP_CHECK(test, book.applySnapshot(snapshot("100", { {"100.0", "5"}, {"99.9", "3"} }, { {"100.2", "4"} })) == Result::Applied);
+		BFCPP_CHECK(test, book.isSynced());
+		BFCPP_CHECK(test, !book.needsSnapshot());
+		BFCPP_CHECK(test, book.lastUpdateId() == 105);
+
+		// the dropped diff's quantity (1) wasn't applied over the snapshot's
+		BFCPP_CHECK(test, book.bestBid()->price == Decimal::fromString("100.1", 1));
+		BFCPP_CHECK(test, book.bestBid()->quantity == Decimal::fromString("2", 0));
+		BFCPP_CHECK(test, book.bestAsk()->price == Decimal::fromString("100.2", 1));
+
+		auto bids = book.bids(10);
+		BFCPP_CHECK(test, bids.size() == 3);
+		BFCPP_CHECK(test, bids.size() == 3 && bids[1].price == Decimal::fromString("100.0", 1) && bids[1].quantity == Decimal::fromString("5", 0));
+		BFCPP_CHECK(test, bids.size() == 3 && bids[2].price == Decimal::fromString("99.9", 1));
+
+
+		// 'pu' continues from the last 'u', a zero quantity removes the level
+		BFCPP_CHECK(test, book.update(diff(book, 106, 110, 105, { {"100.1", "0"} }, { {"100.2", "0"}, {"100.3", "7"} })) == Result::Applied);
+		BFCPP_CHECK(test, book.lastUpdateId() == 110);
+		BFCPP_CHECK(test, book.bestBid()->price == Decimal::fromString("100.0", 1));
+		BFCPP_CHECK(test, book.bestAsk()->price == Decimal::fromString("100.3", 1));
+		BFCPP_CHECK(test, book.asks(10).size() == 1);
+
+
+		// a diff which doesn't follow on is a gap, the book is reset and waits for a new snapshot
+		BFCPP_CHECK(test, book.update(diff(book, 120, 125, 119, { {"100.0", "9"} }, {})) == Result::Gap);
+		BFCPP_CHECK(test, !book.isSynced());
+		BFCPP_CHECK(test, book.needsSnapshot());
+		BFCPP_CHECK(test, !book.bestBid());
+		BFCPP_CHECK(test, book.bids(10).empty());
+
+		// the diff causing the gap was buffered, so a new snapshot resyncs
+		BFCPP_CHECK(test, book.applySnapshot(snapshot("122", { {"99.5", "1"} }, { {"101.0", "1"} })) == Result::Applied);
+		BFCPP_CHECK(test, book.isSynced());
+		BFCPP_CHECK(test, book.lastUpdateId() == 125);
+		BFCPP_CHECK(test, book.bestBid()->price == Decimal::fromString("100.0", 1));
+	}
+
+
+	// a snapshot older than the first buffered diff can't be used
+	{
+		LocalOrderBook book{ "BTCUSDT", "0.10" };
+
+		BFCPP_CHECK(test, book.update(diff(book, 200, 210, 199, { {"100.0", "1"} }, {})) == Result::Buffered);
+		BFCPP_CHECK(test, book.applySnapshot(snapshot("150", { {"99.0", "1"} }, { {"101.0", "1"} })) == Result::Gap);
+		BFCPP_CHECK(test, !book.isSynced());
+		BFCPP_CHECK(test, book.needsSnapshot());
+
+		// the diff is kept for the next snapshot
+		BFCPP_CHECK(test, book.applySnapshot(snapshot("205", { {"99.0", "1"} }, { {"101.0", "1"} })) == Result::Applied);
+		BFCPP_CHECK(test, book.lastUpdateId() == 210);
+	}
+
+
+	// once synced with a snapshot and no buffered diffs, an old diff is dropped and the next one must span the snapshot
+	{
+		LocalOrderBook book{ "BTCUSDT", "0.10" };
+
+		BFCPP_CHECK(test, book.applySnapshot(snapshot("300", { {"99.0", "1"} }, { {"101.0", "1"} })) == Result::Buffered);
+		BFCPP_CHECK(test, !book.isSynced());
+		BFCPP_CHECK(test, book.update(diff(book, 280, 299, 279, {}, {})) == Result::Dropped);
+		BFCPP_CHECK(test, book.update(diff(book, 295, 305, 294, {}, { {"100.5", "2"} })) == Result::Applied);
+		BFCPP_CHECK(test, book.bestAsk()->price == Decimal::fromString("100.5", 1));
+
+		// reset() clears the book and its buffer
+		book.reset();
+		BFCPP_CHECK(test, book.needsSnapshot());
+		BFCPP_CHECK(test, !book.bestAsk());
+	}
+
+
+	// levels outside the ladder's window are counted, and the count is cleared by the next snapshot
+	{
+		LocalOrderBook book{ "BTCUSDT", "0.10", 1000, 1000, 64 };
+
+		BFCPP_CHECK(test, book.applySnapshot(snapshot("10", { {"100.0", "1"}, {"1.0", "1"} }, { {"100.1", "1"} })) == Result::Buffered);
+		BFCPP_CHECK(test, book.update(diff(book, 9, 11, 8, {}, {})) == Result::Applied);
+		BFCPP_CHECK(test, book.isTruncated());
+		BFCPP_CHECK(test, book.truncatedLevels() == 1);
+
+		BFCPP_CHECK(test, book.applySnapshot(snapshot("20", { {"100.0", "1"} }, { {"100.1", "1"} })) == Result::Buffered);
+		BFCPP_CHECK(test, !book.isTruncated());
+		BFCPP_CHECK(test, book.truncatedLevels() == 1);
+	}
+}
+
+
+#endif
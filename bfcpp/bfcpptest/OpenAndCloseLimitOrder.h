@@ -155,7 +155,7 @@ private:
 		m_priceSet.wait(lock);	// notified by handleMarkPrice()
 
 		// set price then send order
-		order["price"] = priceTransform(std::to_string(std::stod(m_markPriceString)));
+		order["price"] = priceTransform(m_markPriceString);
 
 		auto result = m_market.newOrder(std::move(order));
 
@@ -0,0 +1,223 @@
+#ifndef BFCPP_ORDER_BATCH_TESTS_H
+#define BFCPP_ORDER_BATCH_TESTS_H
+
+#include <mutex>
+#include <OrderBatcher.hpp>
+#include "UnitTest.hpp"
+
+
+namespace orderbatchtests
+{
+	using namespace bfcpp;
+
+	inline map<string, string> order(const string& clientOrderId)
+	{
+		return { {"symbol", "BTCUSDT"}, {"side", "BUY"}, {"type", "LIMIT"}, {"price", "37500"}, {"quantity", "0.001"}, {"newClientOrderId", clientOrderId} };
+	}
+
+
+	// records the requests the batcher makes. Orders with a clientOrderId starting with "reject" get an error entry in the batch response
+	struct FakeExchange
+	{
+		std::mutex mux;
+		vector<string> orders;			// sent as normal orders
+		vector<vector<string>> batches;	// sent in batches
+		bool failBatches{ false };
+
+
+		OrderBatcher::SendOrder sendOrder()
+		{
+			return [this](map<string, string>&& order)
+			{
+				std::scoped_lock lock(mux);
+				orders.push_back(order["newClientOrderId"]);
+				return pplx::task_from_result(NewOrderResult{ { {"orderId", "1"}, {"clientOrderId", order["newClientOrderId"]} } });
+			};
+		}
+
+
+		OrderBatcher::SendBatch sendBatch()
+		{
+			return [this](vector<map<string, string>>&& orders)
+			{
+				std::scoped_lock lock(mux);
+
+				if (failBatches)
+					throw BfcppException{ "batch failed" };
+
+				vector<string> ids;
+				vector<map<string, string>> response;
+
+				for (auto& order : orders)
+				{
+					ids.push_back(order["newClientOrderId"]);
+
+					if (order["newClientOrderId"].rfind("reject", 0) == 0)
+						response.push_back({ {"code", "-2019"}, {"msg", "Margin is insufficient."} });
+					else
+						response.push_back({ {"orderId", std::to_string(ids.size())}, {"clientOrderId", order["newClientOrderId"]} });
+				}
+
+				batches.push_back(std::move(ids));
+				return pplx::task_from_result(NewOrderBatchResult{ std::move(response) });
+			};
+		}
+	};
+}
+
+
+inline void orderBatchTests(UnitTest& test)
+{
+	using namespace bfcpp;
+	using namespace orderbatchtests;
+	using namespace std::chrono_literals;
+
+
+	// each order's result is its entry of the batch response
+	{
+		NewOrderBatchResult batch{ { { {"orderId", "11"}, {"clientOrderId", "a"} }, { {"code", "-4164"}, {"msg", "Order's notional must be no smaller than 5"} },
+									 { {"orderId", "13"}, {"clientOrderId", "c"} } } };
+
+		auto results = OrderBatcher::splitBatchResult(std::move(batch), 3);
+
+		BFCPP_CHECK(test, results.size() == 3);
+		BFCPP_CHECK(test, results[0].valid() && results[0].response["orderId"] == "11");
+		BFCPP_CHECK(test, !results[1].valid() && results[1].msg() == "-4164: Order's notional must be no smaller than 5");
+		BFCPP_CHECK(test, results[2].valid() && results[2].response["clientOrderId"] == "c");
+	}
+
+
+	// a failed batch fails each order with its message
+	{
+		auto failed = createInvalidRestResult<NewOrderBatchResult>("-1021: Timestamp for this request is outside of the recvWindow.");
+
+		const auto results = OrderBatcher::splitBatchResult(std::move(failed), 4);
+
+		bool allFailed = results.size() == 4;
+		for (const auto& result : results)
+			allFailed = allFailed && !result.valid() && result.msg() == "-1021: Timestamp for this request is outside of the recvWindow.";
+
+		BFCPP_CHECK(test, allFailed);
+	}
+
+
+	// orders missing from a short response fail
+	{
+		NewOrderBatchResult batch{ { { {"orderId", "11"} } } };
+
+		const auto results = OrderBatcher::splitBatchResult(std::move(batch), 3);
+
+		BFCPP_CHECK(test, results.size() == 3);
+		BFCPP_CHECK(test, results[0].valid());
+		BFCPP_CHECK(test, !results[1].valid() && !results[2].valid());
+		BFCPP_CHECK(test, results[1].msg() == "order missing from batch response");
+	}
+
+
+	// MaxBatchOrders are sent together, each caller gets their own entry
+	{
+		FakeExchange exchange;
+		OrderBatcher batcher{ exchange.sendOrder(), exchange.sendBatch() };
+		batcher.start(10s);
+
+		vector<pplx::task<NewOrderResult>> tasks;
+		for (const auto id : { "a", "reject-b", "c", "d", "e" })
+			tasks.push_back(batcher.add(order(id)));
+
+		pplx::when_all(tasks.begin(), tasks.end()).wait();
+
+		BFCPP_CHECK(test, exchange.orders.empty());
+		BFCPP_CHECK(test, (exchange.batches == vector<vector<string>>{ { "a", "reject-b", "c", "d", "e" } }));
+
+		BFCPP_CHECK(test, tasks[0].get().valid() && tasks[0].get().response.at("clientOrderId") == "a");
+		BFCPP_CHECK(test, !tasks[1].get().valid() && tasks[1].get().msg() == "-2019: Margin is insufficient.");
+		BFCPP_CHECK(test, tasks[4].get().valid() && tasks[4].get().response.at("clientOrderId") == "e");
+	}
+
+
+	// orders held at the end of the window are sent, a lone order as a normal order
+	{
+		FakeExchange exchange;
+		OrderBatcher batcher{ exchange.sendOrder(), exchange.sendBatch() };
+		batcher.start(100ms);
+
+		auto a = batcher.add(order("a"));
+		auto b = batcher.add(order("b"));
+		BFCPP_CHECK(test, a.get().valid() && b.get().valid());
+		BFCPP_CHECK(test, (exchange.batches == vector<vector<string>>{ { "a", "b" } }));
+
+		auto lone = batcher.add(order("lone"));
+		BFCPP_CHECK(test, lone.get().valid() && lone.get().response.at("clientOrderId") == "lone");
+		BFCPP_CHECK(test, (exchange.orders == vector<string>{ "lone" }));
+		BFCPP_CHECK(test, exchange.batches.size() == 1);
+	}
+
+
+	// stop() sends the held orders before returning, then orders are sent directly
+	{
+		FakeExchange exchange;
+		OrderBatcher batcher{ exchange.sendOrder(), exchange.sendBatch() };
+		batcher.start(10s);
+
+		vector<pplx::task<NewOrderResult>> tasks;
+		for (const auto id : { "a", "b", "c", "d", "e", "f", "g" })
+			tasks.push_back(batcher.add(order(id)));
+
+		batcher.stop();
+
+		{
+			std::scoped_lock lock(exchange.mux);
+			BFCPP_CHECK(test, (exchange.batches == vector<vector<string>>{ { "a", "b", "c", "d", "e" }, { "f", "g" } }));
+		}
+
+		bool allValid = true;
+		for (auto& task : tasks)
+			allValid = allValid && task.get().valid();
+
+		BFCPP_CHECK(test, allValid);
+
+		auto direct = batcher.add(order("h"));
+		BFCPP_CHECK(test, direct.get().valid());
+		BFCPP_CHECK(test, (exchange.orders == vector<string>{ "h" }));
+
+		// a single held order is sent as a normal order
+		batcher.start(10s);
+		auto held = batcher.add(order("i"));
+		batcher.stop();
+		BFCPP_CHECK(test, held.get().valid());
+		BFCPP_CHECK(test, (exchange.orders == vector<string>{ "h", "i" }));
+	}
+
+
+	// not started, orders are sent directly
+	{
+		FakeExchange exchange;
+		OrderBatcher batcher{ exchange.sendOrder(), exchange.sendBatch() };
+
+		BFCPP_CHECK(test, batcher.add(order("a")).get().valid());
+		BFCPP_CHECK(test, (exchange.orders == vector<string>{ "a" }));
+		BFCPP_CHECK(test, exchange.batches.empty());
+	}
+
+
+	// a batch request which throws fails each order's task
+	{
+		FakeExchange exchange;
+		exchange.failBatches = true;
+
+		OrderBatcher batcher{ exchange.sendOrder(), exchange.sendBatch() };
+		batcher.start(10s);
+
+		vector<pplx::task<NewOrderResult>> tasks;
+		for (const auto id : { "a", "b" })
+			tasks.push_back(batcher.add(order(id)));
+
+		batcher.stop();
+
+		for (auto& task : tasks)
+			BFCPP_CHECK_THROWS(test, BfcppException, task.get());
+	}
+}
+
+
+#endif
@@ -0,0 +1,226 @@
+#ifndef BFCPP_ORDER_STATE_CACHE_TESTS_H
+#define BFCPP_ORDER_STATE_CACHE_TESTS_H
+
+#include <set>
+#include <OrderStateCache.hpp>
+#include "UnitTest.hpp"
+
+
+namespace orderstatecachetests
+{
+	using namespace bfcpp;
+
+	// an ORDER_TRADE_UPDATE event
+	inline UsdFutureUserData orderUpdate(const int64_t orderId, const string& clientOrderId, const string& symbol, const string& status, const string& filled, const int64_t time)
+	{
+		UsdFutureUserData data{ UsdFutureUserData::EventType::OrderUpdate };
+		data.ou.orders[symbol] = { {"i", std::to_string(orderId)}, {"c", clientOrderId}, {"s", symbol}, {"X", status}, {"S", "BUY"},
+								   {"p", "37500.10"}, {"q", "1.000"}, {"z", filled}, {"ap", "0"}, {"T", std::to_string(time)} };
+		return data;
+	}
+
+
+	// a newOrder()/cancelOrder() response
+	inline map<string, string> orderResponse(const int64_t orderId, const string& clientOrderId, const string& symbol, const string& status, const string& filled, const int64_t time)
+	{
+		return { {"orderId", std::to_string(orderId)}, {"clientOrderId", clientOrderId}, {"symbol", symbol}, {"status", status}, {"side", "SELL"},
+				 {"price", "37500.20"}, {"origQty", "1.000"}, {"executedQty", filled}, {"avgPrice", "0.00"}, {"updateTime", std::to_string(time)} };
+	}
+
+
+	inline string clientId(const int64_t orderId)
+	{
+		return "client-" + std::to_string(orderId);
+	}
+}
+
+
+inline void orderStateCacheTests(UnitTest& test)
+{
+	using namespace bfcpp;
+	using namespace orderstatecachetests;
+
+
+	// orders are found by orderId and clientOrderId as the tables grow
+	{
+		OrderStateCache cache;
+
+		for (int64_t id = 1; id <= 200; ++id)
+			cache.onUserData(orderUpdate(1000 + id, clientId(id), id % 2 ? "BTCUSDT" : "ETHUSDT", "NEW", "0", id));
+
+		BFCPP_CHECK(test, cache.size() == 200);
+
+		bool found = true;
+		for (int64_t id = 1; id <= 200; ++id)
+		{
+			const auto byId = cache.find(1000 + id);
+			const auto byClientId = cache.find(clientId(id));
+			found = found && byId && byClientId && byId->clientOrderId == clientId(id) && byClientId->orderId == 1000 + id;
+		}
+
+		BFCPP_CHECK(test, found);
+		BFCPP_CHECK(test, !cache.find(int64_t{ 999 }));
+		BFCPP_CHECK(test, !cache.find("client-0"));
+
+		const auto order = cache.find(int64_t{ 1001 });
+		BFCPP_CHECK(test, order && order->symbol == "BTCUSDT" && order->status == OrderStatus::New && order->buy);
+		BFCPP_CHECK(test, order && order->price == Decimal::fromString("37500.10") && order->quantity == Decimal::fromString("1"));
+
+		// other events and failed requests are ignored
+		cache.onUserData(UsdFutureUserData{ UsdFutureUserData::EventType::AccountUpdate });
+		cache.onOrderResponse({ {"code", "-2019"}, {"msg", "Margin is insufficient."} });
+		BFCPP_CHECK(test, cache.size() == 200);
+
+		cache.clear();
+		BFCPP_CHECK(test, cache.size() == 0);
+		BFCPP_CHECK(test, !cache.find(int64_t{ 1001 }));
+		BFCPP_CHECK(test, !cache.find(clientId(1)));
+
+		cache.onOrderResponse(orderResponse(1, clientId(1), "BTCUSDT", "NEW", "0", 1));
+		BFCPP_CHECK(test, cache.find(clientId(1)).has_value());
+	}
+
+
+	// the oldest closed orders are removed beyond capacity, open orders are kept, the others are still found
+	{
+		const size_t capacity = 40;
+		OrderStateCache cache{ capacity };
+
+		std::set<int64_t> open, closed;
+		std::deque<int64_t> closedOrder;
+		uint64_t random = 12345;
+		bool found = true, evicted = true;
+
+		for (int64_t id = 1; id <= 2000; ++id)
+		{
+			cache.onUserData(orderUpdate(id, clientId(id), "BTCUSDT", "NEW", "0", id));
+			open.insert(id);
+
+			// close a random open order
+			random = random * 6364136223846793005ULL + 1442695040888963407ULL;
+
+			if (open.size() > 10 || (random >> 60) < 8)
+			{
+				auto it = open.begin();
+				std::advance(it, (random >> 33) % open.size());
+
+				const auto closing = *it;
+				cache.onOrderResponse(orderResponse(closing, "", "BTCUSDT", (random >> 40) % 2 ? "FILLED" : "CANCELED", "0", id));
+				open.erase(it);
+				closed.insert(closing);
+				closedOrder.push_back(closing);
+			}
+
+			while (open.size() + closed.size() > capacity && !closedOrder.empty())
+			{
+				closed.erase(closedOrder.front());
+				closedOrder.pop_front();
+			}
+
+			if (id % 50 == 0 || id > 1950)
+			{
+				for (const auto held : { &open, &closed })
+				{
+					for (const auto orderId : *held)
+						found = found && cache.find(orderId) && cache.find(clientId(orderId)) && cache.find(clientId(orderId))->orderId == orderId;
+				}
+
+				for (int64_t removed = std::max<int64_t>(1, id - 200); removed <= id; ++removed)
+				{
+					if (!open.count(removed) && !closed.count(removed))
+						evicted = evicted && !cache.find(removed) && !cache.find(clientId(removed));
+				}
+			}
+		}
+
+		BFCPP_CHECK(test, found);
+		BFCPP_CHECK(test, evicted);
+		BFCPP_CHECK(test, cache.size() == open.size() + closed.size());
+		BFCPP_CHECK(test, cache.size() <= capacity);
+
+		// open orders are never removed, even beyond capacity
+		OrderStateCache small{ 2 };
+		for (int64_t id = 1; id <= 5; ++id)
+			small.onUserData(orderUpdate(id, clientId(id), "BTCUSDT", "NEW", "0", id));
+
+		BFCPP_CHECK(test, small.size() == 5);
+
+		small.onUserData(orderUpdate(1, clientId(1), "BTCUSDT", "FILLED", "1", 10));
+		BFCPP_CHECK(test, small.size() == 4);
+		BFCPP_CHECK(test, !small.find(int64_t{ 1 }));
+		BFCPP_CHECK(test, small.find(int64_t{ 5 }).has_value());
+	}
+
+
+	// the REST response and stream event for a change race, stale updates are ignored
+	{
+		OrderStateCache cache;
+
+		cache.onUserData(orderUpdate(7, "abc", "BTCUSDT", "NEW", "0", 100));
+
+		// older
+		cache.onOrderResponse(orderResponse(7, "abc", "BTCUSDT", "NEW", "0", 90));
+		BFCPP_CHECK(test, cache.find(int64_t{ 7 })->buy);
+		BFCPP_CHECK(test, cache.find(int64_t{ 7 })->updateTime == 100);
+
+		cache.onUserData(orderUpdate(7, "abc", "BTCUSDT", "PARTIALLY_FILLED", "0.500", 200));
+		BFCPP_CHECK(test, cache.find(int64_t{ 7 })->status == OrderStatus::PartiallyFilled);
+
+		// less filled at the same time
+		cache.onOrderResponse(orderResponse(7, "abc", "BTCUSDT", "PARTIALLY_FILLED", "0.300", 200));
+		BFCPP_CHECK(test, cache.find(int64_t{ 7 })->filledQuantity == Decimal::fromString("0.5"));
+
+		// more filled at the same time
+		cache.onOrderResponse(orderResponse(7, "", "BTCUSDT", "PARTIALLY_FILLED", "0.700", 200));
+		BFCPP_CHECK(test, cache.find(int64_t{ 7 })->filledQuantity == Decimal::fromString("0.7"));
+		BFCPP_CHECK(test, !cache.find(int64_t{ 7 })->buy);
+
+		// the clientOrderId is kept when the update doesn't have it
+		BFCPP_CHECK(test, cache.find("abc").has_value());
+		BFCPP_CHECK(test, cache.find(int64_t{ 7 })->clientOrderId == "abc");
+
+		cache.onUserData(orderUpdate(7, "abc", "BTCUSDT", "FILLED", "1.000", 300));
+		BFCPP_CHECK(test, cache.find("abc")->status == OrderStatus::Filled);
+
+		// reopening a closed order, even if later
+		cache.onOrderResponse(orderResponse(7, "abc", "BTCUSDT", "PARTIALLY_FILLED", "1.000", 400));
+		BFCPP_CHECK(test, cache.find("abc")->status == OrderStatus::Filled);
+		BFCPP_CHECK(test, cache.find("abc")->updateTime == 300);
+
+		// a REST response which arrives first is updated by the stream
+		cache.onOrderResponse(orderResponse(8, "def", "BTCUSDT", "NEW", "0", 500));
+		cache.onUserData(orderUpdate(8, "def", "BTCUSDT", "CANCELED", "0", 510));
+		BFCPP_CHECK(test, cache.find("def")->status == OrderStatus::Cancelled);
+	}
+
+
+	// open orders, for a symbol or all
+	{
+		OrderStateCache cache;
+
+		cache.onUserData(orderUpdate(1, "a", "BTCUSDT", "NEW", "0", 1));
+		cache.onUserData(orderUpdate(2, "b", "BTCUSDT", "PARTIALLY_FILLED", "0.1", 1));
+		cache.onUserData(orderUpdate(3, "c", "BTCUSDT", "FILLED", "1", 1));
+		cache.onUserData(orderUpdate(4, "d", "ETHUSDT", "NEW", "0", 1));
+		cache.onUserData(orderUpdate(5, "e", "ETHUSDT", "EXPIRED", "0", 1));
+
+		auto ids = [](const vector<OrderState>& orders)
+		{
+			std::set<int64_t> result;
+			for (const auto& order : orders)
+				result.insert(order.orderId);
+			return result;
+		};
+
+		BFCPP_CHECK(test, (ids(cache.openOrders("BTCUSDT")) == std::set<int64_t>{ 1, 2 }));
+		BFCPP_CHECK(test, (ids(cache.openOrders("ETHUSDT")) == std::set<int64_t>{ 4 }));
+		BFCPP_CHECK(test, (ids(cache.openOrders()) == std::set<int64_t>{ 1, 2, 4 }));
+		BFCPP_CHECK(test, cache.openOrders("XRPUSDT").empty());
+
+		cache.onUserData(orderUpdate(1, "a", "BTCUSDT", "CANCELED", "0", 2));
+		BFCPP_CHECK(test, (ids(cache.openOrders("BTCUSDT")) == std::set<int64_t>{ 2 }));
+	}
+}
+
+
+#endif
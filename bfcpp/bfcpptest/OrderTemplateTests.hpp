@@ -0,0 +1,143 @@
+#ifndef BFCPP_ORDER_TEMPLATE_TESTS_H
+#define BFCPP_ORDER_TEMPLATE_TESTS_H
+
+#include <Futures.hpp>
+#include "UnitTest.hpp"
+
+
+namespace ordertemplatetests
+{
+	using namespace bfcpp;
+
+	const string SecretKey = "NhqPtmdSJYdKjVHjA7PZj4Mge3R5YNiP1e3UZjInClVN65XAbvqqM6A7H5fATj0j";
+
+
+	// exposes the query string newOrder(map) sends
+	class QueryStringMarket : public UsdFuturesTestMarket
+	{
+	public:
+		QueryStringMarket() : UsdFuturesTestMarket(ApiAccess{ "apikey", SecretKey })
+		{
+		}
+
+		using UsdFuturesMarket::createQueryString;
+	};
+
+
+	inline int64_t timestampOf(const string& query)
+	{
+		const auto start = query.find("&timestamp=") + 11;
+		return std::stoll(query.substr(start, query.find('&', start) - start));
+	}
+}
+
+
+inline void orderTemplateTests(UnitTest& test)
+{
+	using namespace bfcpp;
+	using namespace ordertemplatetests;
+
+	QueryStringMarket market;
+	const Signer signer{ SecretKey };
+
+
+	// the signed query is byte for byte the one createQueryString() writes for the same order,
+	// with price, quantity and newClientOrderId among the fixed params in key order
+	{
+		OrderTemplate order{ { {"symbol", "BTCUSDT"}, {"side", "BUY"}, {"type", "LIMIT"}, {"timeInForce", "GTC"}, {"positionSide", "LONG"}, {"reduceOnly", "false"} } };
+
+		const auto expected = market.createQueryString({ {"symbol", "BTCUSDT"}, {"side", "BUY"}, {"type", "LIMIT"}, {"timeInForce", "GTC"}, {"positionSide", "LONG"},
+														 {"reduceOnly", "false"}, {"price", "37500.10"}, {"quantity", "0.001"}, {"newClientOrderId", "order-1"} },
+													   RestCall::NewOrder, true, "5000");
+
+		const auto query = order.build(Decimal::fromString("37500.10", 2), Decimal::fromString("0.001", 3), "order-1", "5000", timestampOf(expected), signer);
+
+		BFCPP_CHECK(test, query == expected);
+	}
+
+
+	// without a price or client order id, i.e. a MARKET order
+	{
+		OrderTemplate order{ { {"symbol", "ETHUSDT"}, {"side", "SELL"}, {"type", "MARKET"} } };
+
+		const auto expected = market.createQueryString({ {"symbol", "ETHUSDT"}, {"side", "SELL"}, {"type", "MARKET"}, {"quantity", "1.250"} }, RestCall::NewOrder, true, "3000");
+		const auto query = order.build(Decimal{}, Decimal::fromString("1.250", 3), {}, "3000", timestampOf(expected), signer);
+
+		BFCPP_CHECK(test, query == expected);
+	}
+
+
+	// without a quantity, with fixed params sorting before newClientOrderId and after quantity
+	{
+		OrderTemplate order{ { {"symbol", "BTCUSDT"}, {"side", "SELL"}, {"type", "STOP_MARKET"}, {"closePosition", "true"}, {"stopPrice", "36000"}, {"workingType", "MARK_PRICE"} } };
+
+		const auto expected = market.createQueryString({ {"symbol", "BTCUSDT"}, {"side", "SELL"}, {"type", "STOP_MARKET"}, {"closePosition", "true"}, {"stopPrice", "36000"},
+														 {"workingType", "MARK_PRICE"}, {"newClientOrderId", "stop-7"} },
+													   RestCall::NewOrder, true, "5000");
+
+		const auto query = order.build(Decimal{}, Decimal{}, "stop-7", "5000", timestampOf(expected), signer);
+
+		BFCPP_CHECK(test, query == expected);
+	}
+
+
+	// the template is reused: a second build() doesn't keep anything from the first
+	{
+		OrderTemplate order{ { {"symbol", "BTCUSDT"}, {"side", "BUY"}, {"type", "LIMIT"}, {"timeInForce", "GTC"} } };
+
+		order.build(Decimal::fromString("37500.10", 2), Decimal::fromString("0.001", 3), "a-much-longer-client-order-id", "5000", 1'700'000'000'000, signer);
+
+		const auto expected = market.createQueryString({ {"symbol", "BTCUSDT"}, {"side", "BUY"}, {"type", "LIMIT"}, {"timeInForce", "GTC"}, {"price", "9.5"}, {"quantity", "2"} },
+													   RestCall::NewOrder, true, "5000");
+
+		const auto query = order.build(Decimal::fromString("9.5", 1), Decimal::fromString("2", 0), {}, "5000", timestampOf(expected), signer);
+
+		BFCPP_CHECK(test, query == expected);
+		BFCPP_CHECK(test, order.fixedParams() == "side=BUY&symbol=BTCUSDT&timeInForce=GTC&type=LIMIT&");
+	}
+
+
+	// build() then sign() is build() with the signer
+	{
+		OrderTemplate order{ { {"symbol", "BTCUSDT"}, {"side", "BUY"}, {"type", "LIMIT"} } };
+
+		const string signedQuery{ order.build(Decimal::fromString("1.5", 1), Decimal::fromString("3", 0), "x", "5000", 1'700'000'000'123, signer) };
+
+		const string unsignedQuery{ order.build(Decimal::fromString("1.5", 1), Decimal::fromString("3", 0), "x", "5000", 1'700'000'000'123) };
+		BFCPP_CHECK(test, unsignedQuery == "newClientOrderId=x&price=1.5&quantity=3&side=BUY&symbol=BTCUSDT&type=LIMIT&recvWindow=5000&timestamp=1700000000123");
+		BFCPP_CHECK(test, order.sign(signer) == signedQuery);
+	}
+
+
+	// the params set per order can't be fixed, and the symbol is required
+	{
+		for (const auto key : { "price", "quantity", "newClientOrderId", "recvWindow", "timestamp", "signature" })
+		{
+			BFCPP_CHECK_THROWS(test, BfcppException, OrderTemplate({ {"symbol", "BTCUSDT"}, {"side", "BUY"}, {key, "1"} }));
+		}
+
+		BFCPP_CHECK_THROWS(test, BfcppException, OrderTemplate({ {"side", "BUY"}, {"type", "MARKET"} }));
+	}
+
+
+	// the client order id is limited to Binance's 36 chars
+	{
+		OrderTemplate order{ { {"symbol", "BTCUSDT"}, {"side", "BUY"}, {"type", "MARKET"} } };
+
+		BFCPP_CHECK_THROWS(test, BfcppException, order.build(Decimal{}, Decimal::fromString("1", 0), string(37, 'x'), "5000", 1'700'000'000'000, signer));
+		BFCPP_CHECK(test, order.build(Decimal{}, Decimal::fromString("1", 0), string(36, 'x'), "5000", 1'700'000'000'000, signer).size() > 0);
+	}
+
+
+	// market(), buy() and reduceOnly() for OrderValidator
+	{
+		OrderTemplate stop{ { {"symbol", "BTCUSDT"}, {"side", "SELL"}, {"type", "STOP_MARKET"}, {"reduceOnly", "true"} } };
+		BFCPP_CHECK(test, stop.market() && !stop.buy() && stop.reduceOnly() && stop.symbol() == "BTCUSDT");
+
+		OrderTemplate limit{ { {"symbol", "BTCUSDT"}, {"side", "BUY"}, {"type", "LIMIT"} } };
+		BFCPP_CHECK(test, !limit.market() && limit.buy() && !limit.reduceOnly());
+	}
+}
+
+
+#endif
@@ -0,0 +1,155 @@
+#ifndef BFCPP_ORDER_VALIDATOR_TESTS_H
+#define BFCPP_ORDER_VALIDATOR_TESTS_H
+
+#include <OrderValidator.hpp>
+#include "UnitTest.hpp"
+
+
+namespace ordervalidatortests
+{
+	using namespace bfcpp;
+
+	// BTCUSDT's filters
+	inline ExchangeInfo exchangeInfo()
+	{
+		ExchangeInfo::Symbol symbol;
+		symbol.data["symbol"] = "BTCUSDT";
+		symbol.data["pricePrecision"] = "2";
+		symbol.data["quantityPrecision"] = "3";
+		symbol.filters.push_back({ {"filterType", "PRICE_FILTER"}, {"minPrice", "556.80"}, {"maxPrice", "4529764"}, {"tickSize", "0.10"} });
+		symbol.filters.push_back({ {"filterType", "LOT_SIZE"}, {"minQty", "0.001"}, {"maxQty", "1000"}, {"stepSize", "0.001"} });
+		symbol.filters.push_back({ {"filterType", "MARKET_LOT_SIZE"}, {"minQty", "0.001"}, {"maxQty", "120"}, {"stepSize", "0.001"} });
+		symbol.filters.push_back({ {"filterType", "MIN_NOTIONAL"}, {"notional", "5"} });
+		symbol.filters.push_back({ {"filterType", "PERCENT_PRICE"}, {"multiplierUp", "1.0500"}, {"multiplierDown", "0.9500"}, {"multiplierDecimal", "4"} });
+
+		ExchangeInfo info;
+		info.symbols.push_back(symbol);
+		return info;
+	}
+
+
+	inline OrderCheck limit(const OrderValidator& validator, const bool buy, const string& price, const string& quantity, const bool reduceOnly = false)
+	{
+		auto p = Decimal::fromString(price);
+		auto q = Decimal::fromString(quantity);
+		return validator.check("BTCUSDT", buy, false, reduceOnly, p, q);
+	}
+
+
+	inline OrderCheck market(const OrderValidator& validator, const bool buy, const string& quantity)
+	{
+		Decimal p;
+		auto q = Decimal::fromString(quantity);
+		return validator.check("BTCUSDT", buy, true, false, p, q);
+	}
+}
+
+
+inline void orderValidatorTests(UnitTest& test)
+{
+	using namespace bfcpp;
+	using namespace ordervalidatortests;
+
+	const OrderValidator validator{ exchangeInfo() };
+
+
+	// PRICE_FILTER and LOT_SIZE
+	{
+		BFCPP_CHECK(test, limit(validator, true, "37500.10", "0.010") == OrderCheck::Valid);
+		BFCPP_CHECK(test, limit(validator, true, "37500.1", "0.01") == OrderCheck::Valid);
+		BFCPP_CHECK(test, limit(validator, true, "37500.15", "0.010") == OrderCheck::PriceTick);
+		BFCPP_CHECK(test, limit(validator, true, "37500.105", "0.010") == OrderCheck::PriceTick);
+		BFCPP_CHECK(test, limit(validator, true, "500", "0.010") == OrderCheck::PriceTooLow);
+		BFCPP_CHECK(test, limit(validator, false, "5000000", "0.010") == OrderCheck::PriceTooHigh);
+		BFCPP_CHECK(test, limit(validator, true, "37500.10", "0.0105") == OrderCheck::QuantityStep);
+		BFCPP_CHECK(test, limit(validator, true, "37500.10", "1001") == OrderCheck::QuantityTooHigh);
+		BFCPP_CHECK(test, limit(validator, true, "37500.10", "-1") == OrderCheck::InvalidValue);
+		BFCPP_CHECK(test, limit(validator, true, "0", "1") == OrderCheck::InvalidValue);
+
+		// MARKET_LOT_SIZE applies to market orders only
+		BFCPP_CHECK(test, limit(validator, true, "37500.10", "200") == OrderCheck::Valid);
+		BFCPP_CHECK(test, market(validator, true, "200") == OrderCheck::QuantityTooHigh);
+
+		Decimal price = Decimal::fromString("1"), quantity = Decimal::fromString("1");
+		BFCPP_CHECK(test, validator.check("ETHUSDT", true, false, false, price, quantity) == OrderCheck::UnknownSymbol);
+		BFCPP_CHECK(test, string{ toString(OrderCheck::MinNotional) } == "MinNotional");
+	}
+
+
+	// rounding never gives a worse price, quantities are rounded down
+	{
+		auto price = Decimal::fromString("37500.15");
+		auto quantity = Decimal::fromString("0.0125");
+		BFCPP_CHECK(test, validator.check("BTCUSDT", true, false, false, price, quantity, true) == OrderCheck::Valid);
+		BFCPP_CHECK(test, price.str() == "37500.10");
+		BFCPP_CHECK(test, quantity.str() == "0.012");
+
+		price = Decimal::fromString("37500.15");
+		BFCPP_CHECK(test, validator.check("BTCUSDT", false, false, false, price, quantity, true) == OrderCheck::Valid);
+		BFCPP_CHECK(test, price.str() == "37500.20");
+
+		// rounded below the minimum
+		price = Decimal::fromString("37500.10");
+		quantity = Decimal::fromString("0.0005");
+		BFCPP_CHECK(test, validator.check("BTCUSDT", true, false, false, price, quantity, true) == OrderCheck::QuantityTooLow);
+		BFCPP_CHECK(test, quantity.str() == "0.0005");
+	}
+
+
+	// MIN_NOTIONAL, which reduceOnly orders are exempt from
+	{
+		BFCPP_CHECK(test, limit(validator, true, "600", "0.008") == OrderCheck::MinNotional);
+		BFCPP_CHECK(test, limit(validator, true, "625", "0.008") == OrderCheck::Valid);
+		BFCPP_CHECK(test, limit(validator, true, "600", "0.008", true) == OrderCheck::Valid);
+	}
+
+
+	// the mark price, for PERCENT_PRICE and market orders' MIN_NOTIONAL
+	{
+		OrderValidator marked{ exchangeInfo() };
+
+		BFCPP_CHECK(test, market(marked, true, "0.001") == OrderCheck::Valid);
+		BFCPP_CHECK(test, limit(marked, true, "50000", "0.010") == OrderCheck::Valid);
+
+		marked.setReferencePrice("BTCUSDT", Decimal::fromString("40000.00"));
+		marked.setReferencePrice("ETHUSDT", Decimal::fromString("3000.00"));
+
+		BFCPP_CHECK(test, limit(marked, true, "42000.00", "0.010") == OrderCheck::Valid);
+		BFCPP_CHECK(test, limit(marked, true, "42000.10", "0.010") == OrderCheck::PercentPrice);
+		BFCPP_CHECK(test, limit(marked, false, "38000.00", "0.010") == OrderCheck::Valid);
+		BFCPP_CHECK(test, limit(marked, false, "37999.90", "0.010") == OrderCheck::PercentPrice);
+		BFCPP_CHECK(test, limit(marked, true, "37999.90", "0.010") == OrderCheck::Valid);
+		BFCPP_CHECK(test, limit(marked, false, "42000.10", "0.010") == OrderCheck::Valid);
+
+		BFCPP_CHECK(test, market(marked, true, "0.001") == OrderCheck::Valid);
+		marked.setReferencePrice("BTCUSDT", Decimal::fromString("1000"));
+		BFCPP_CHECK(test, market(marked, true, "0.001") == OrderCheck::MinNotional);
+		BFCPP_CHECK(test, market(marked, true, "0.005") == OrderCheck::Valid);
+	}
+
+
+	// orders as passed to newOrder()
+	{
+		map<string, string> order = { {"symbol", "BTCUSDT"}, {"side", "SELL"}, {"type", "LIMIT"}, {"price", "37500.15"}, {"quantity", "0.0125"} };
+
+		BFCPP_CHECK(test, validator.check(order) == OrderCheck::PriceTick);
+		BFCPP_CHECK(test, order["price"] == "37500.15");
+
+		BFCPP_CHECK(test, validator.check(order, true) == OrderCheck::Valid);
+		BFCPP_CHECK(test, order["price"] == "37500.20");
+		BFCPP_CHECK(test, order["quantity"] == "0.012");
+
+		// a market order's price is ignored
+		map<string, string> marketOrder = { {"symbol", "BTCUSDT"}, {"side", "BUY"}, {"type", "STOP_MARKET"}, {"price", "x"}, {"quantity", "0.010"} };
+		BFCPP_CHECK(test, validator.check(marketOrder) == OrderCheck::Valid);
+
+		map<string, string> invalid = { {"symbol", "BTCUSDT"}, {"side", "BUY"}, {"type", "LIMIT"}, {"price", "abc"}, {"quantity", "0.010"} };
+		BFCPP_CHECK(test, validator.check(invalid) == OrderCheck::InvalidValue);
+
+		map<string, string> noSymbol = { {"side", "BUY"}, {"type", "LIMIT"}, {"price", "37500.10"}, {"quantity", "0.010"} };
+		BFCPP_CHECK(test, validator.check(noSymbol) == OrderCheck::UnknownSymbol);
+	}
+}
+
+
+#endif
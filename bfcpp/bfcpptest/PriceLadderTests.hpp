@@ -0,0 +1,130 @@
+#ifndef BFCPP_PRICE_LADDER_TESTS_H
+#define BFCPP_PRICE_LADDER_TESTS_H
+
+#include <PriceLadder.hpp>
+#include "UnitTest.hpp"
+
+
+inline void priceLadderTests(UnitTest& test)
+{
+	using namespace bfcpp;
+
+	using Side = PriceLadder::Side;
+
+
+	// prices round to the nearest tick, halves away from zero
+	{
+		PriceLadder ladder{ "0.10" };
+
+		BFCPP_CHECK(test, ladder.toTick("100.0") == 1000);
+		BFCPP_CHECK(test, ladder.toTick("100") == 1000);
+		BFCPP_CHECK(test, ladder.toTick("100.04") == 1000);
+		BFCPP_CHECK(test, ladder.toTick("100.05") == 1001);
+		BFCPP_CHECK(test, ladder.toTick("100.149") == 1001);
+		BFCPP_CHECK(test, ladder.toTick("-0.05") == -1);
+		BFCPP_CHECK(test, ladder.tickToPrice(1001) == Decimal::fromString("100.1", 1));
+		BFCPP_CHECK(test, ladder.toQuantity("1.5") == 150000000);
+		BFCPP_CHECK(test, ladder.toDecimalQuantity(150000000) == Decimal::fromString("1.5", 1));
+
+		PriceLadder halves{ "0.5" };
+		BFCPP_CHECK(test, halves.toTick("1.25") == 3);
+		BFCPP_CHECK(test, halves.toTick("1.2") == 2);
+
+		BFCPP_CHECK(test, PriceLadder("0.1", 1000).capacity() == 1024);
+		BFCPP_CHECK_THROWS(test, BfcppException, PriceLadder("0"));
+	}
+
+
+	// best prices follow sets and removals, levels are walked best first
+	{
+		PriceLadder ladder{ "1", 64 };
+
+		ladder.set(Side::Bid, 100, 1);
+		ladder.set(Side::Bid, 98, 2);
+		ladder.set(Side::Bid, 99, 3);
+		ladder.set(Side::Ask, 102, 4);
+		ladder.set(Side::Ask, 101, 5);
+
+		BFCPP_CHECK(test, ladder.bestBid() == 100);
+		BFCPP_CHECK(test, ladder.bestAsk() == 101);
+		BFCPP_CHECK(test, ladder.quantity(Side::Bid, 99) == 3);
+		BFCPP_CHECK(test, ladder.quantity(Side::Bid, 97) == 0);
+		BFCPP_CHECK(test, ladder.quantity(Side::Bid, 1000000) == 0);
+
+		vector<std::pair<int64_t, int64_t>> bids;
+		ladder.forEachLevel(Side::Bid, 2, [&bids](const int64_t tick, const int64_t quantity) { bids.emplace_back(tick, quantity); });
+		BFCPP_CHECK(test, (bids == vector<std::pair<int64_t, int64_t>>{ {100, 1}, {99, 3} }));
+
+		// removing the best level finds the next
+		ladder.set(Side::Bid, 100, 0);
+		ladder.set(Side::Ask, 101, 0);
+		BFCPP_CHECK(test, ladder.bestBid() == 99);
+		BFCPP_CHECK(test, ladder.bestAsk() == 102);
+
+		ladder.set(Side::Ask, 102, 0);
+		BFCPP_CHECK(test, ladder.bestAsk() == PriceLadder::NoTick);
+		BFCPP_CHECK(test, !ladder.truncated());
+
+		ladder.clear();
+		BFCPP_CHECK(test, ladder.bestBid() == PriceLadder::NoTick);
+		BFCPP_CHECK(test, ladder.quantity(Side::Bid, 99) == 0);
+	}
+
+
+	// levels beyond the window are dropped and counted
+	{
+		PriceLadder ladder{ "1", 16 };
+
+		ladder.set(Side::Bid, 100, 1);
+		ladder.set(Side::Ask, 101, 1);
+
+		// removing a level which isn't held loses nothing
+		ladder.set(Side::Bid, 50, 0);
+		BFCPP_CHECK(test, !ladder.truncated());
+
+		ladder.set(Side::Bid, 50, 1);
+		BFCPP_CHECK(test, ladder.truncated());
+		BFCPP_CHECK(test, ladder.truncatedLevels() == 1);
+		BFCPP_CHECK(test, ladder.quantity(Side::Bid, 50) == 0);
+		BFCPP_CHECK(test, ladder.bestBid() == 100);
+
+		// clear() resets the flag, the count is kept
+		ladder.clear();
+		BFCPP_CHECK(test, !ladder.truncated());
+		BFCPP_CHECK(test, ladder.truncatedLevels() == 1);
+	}
+
+
+	// the window moves towards a new price, dropping the levels it leaves
+	{
+		PriceLadder ladder{ "1", 16 };
+
+		ladder.set(Side::Bid, 100, 1);
+		ladder.set(Side::Bid, 93, 2);
+		ladder.set(Side::Ask, 112, 3);
+
+		BFCPP_CHECK(test, ladder.quantity(Side::Ask, 112) == 3);
+		BFCPP_CHECK(test, ladder.bestAsk() == 112);
+		BFCPP_CHECK(test, ladder.bestBid() == 100);
+		BFCPP_CHECK(test, ladder.quantity(Side::Bid, 93) == 0);
+		BFCPP_CHECK(test, ladder.truncated());
+		BFCPP_CHECK(test, ladder.truncatedLevels() == 1);
+	}
+
+
+	// the tick size comes from the symbol's PRICE_FILTER
+	{
+		ExchangeInfo info;
+		ExchangeInfo::Symbol symbol;
+		symbol.data["symbol"] = "BTCUSDT";
+		symbol.filters.push_back({ {"filterType", "LOT_SIZE"}, {"stepSize", "0.001"} });
+		symbol.filters.push_back({ {"filterType", "PRICE_FILTER"}, {"tickSize", "0.10"} });
+		info.symbols.push_back(symbol);
+
+		BFCPP_CHECK(test, getTickSize(info, "BTCUSDT") == "0.10");
+		BFCPP_CHECK(test, getTickSize(info, "ETHUSDT").empty());
+	}
+}
+
+
+#endif
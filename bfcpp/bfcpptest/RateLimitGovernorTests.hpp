@@ -0,0 +1,272 @@
+#ifndef BFCPP_RATE_LIMIT_GOVERNOR_TESTS_H
+#define BFCPP_RATE_LIMIT_GOVERNOR_TESTS_H
+
+#include <thread>
+#include <RateLimitGovernor.hpp>
+#include "UnitTest.hpp"
+
+
+namespace ratelimitgovernortests
+{
+	using namespace bfcpp;
+
+
+	inline web::http::http_headers headers(const vector<std::pair<string, string>>& values)
+	{
+		web::http::http_headers result;
+		for (const auto& [name, value] : values)
+			result.add(utility::conversions::to_string_t(name), utility::conversions::to_string_t(value));
+		return result;
+	}
+
+
+	// the usage of the limit with the type and interval, or -1
+	inline int64_t used(const RateLimitGovernor& governor, const RateLimit::Type type, const std::chrono::seconds interval)
+	{
+		for (const auto& usage : governor.usage())
+		{
+			if (usage.limit.type == type && usage.limit.interval == interval)
+				return usage.used;
+		}
+		return -1;
+	}
+
+
+	// how many calls are made before acquire() throws, up to max
+	inline size_t acquired(RateLimitGovernor& governor, const RestCall call, const size_t max = 1000)
+	{
+		size_t count = 0;
+
+		try
+		{
+			for (; count < max; ++count)
+				governor.acquire(call);
+		}
+		catch (const BfcppRateLimitException&)
+		{
+		}
+
+		return count;
+	}
+}
+
+
+inline void rateLimitGovernorTests(UnitTest& test)
+{
+	using namespace bfcpp;
+	using namespace ratelimitgovernortests;
+	using namespace std::chrono_literals;
+
+	// day long windows so they don't roll during a test
+	const auto Day = std::chrono::seconds{ 86400 };
+
+
+	// Off only tracks usage
+	{
+		RateLimitGovernor governor;
+		governor.setLimits({ {RateLimit::Type::RequestWeight, Day, 10}, {RateLimit::Type::Orders, Day, 2} });
+
+		BFCPP_CHECK(test, governor.mode() == RateLimitGovernor::Mode::Off);
+		BFCPP_CHECK(test, acquired(governor, RestCall::ServerTime, 20) == 20);
+		BFCPP_CHECK(test, acquired(governor, RestCall::NewOrder, 5) == 5);
+		BFCPP_CHECK(test, used(governor, RateLimit::Type::RequestWeight, Day) == 20);
+		BFCPP_CHECK(test, used(governor, RateLimit::Type::Orders, Day) == 5);
+	}
+
+
+	// FailFast, data queries only use dataShare() of the weight limit, the remainder is kept for order calls
+	{
+		RateLimitGovernor governor;
+		governor.setLimits({ {RateLimit::Type::RequestWeight, Day, 10}, {RateLimit::Type::Orders, Day, 2} });
+		governor.setMode(RateLimitGovernor::Mode::FailFast);
+
+		BFCPP_CHECK(test, RateLimitGovernor::priority(RestCall::ServerTime) == RateLimitGovernor::Priority::Data);
+		BFCPP_CHECK(test, RateLimitGovernor::priority(RestCall::CancelOrder) == RateLimitGovernor::Priority::Order);
+
+		BFCPP_CHECK(test, acquired(governor, RestCall::ServerTime) == 8);
+		BFCPP_CHECK(test, acquired(governor, RestCall::CancelOrder) == 2);
+		BFCPP_CHECK(test, used(governor, RateLimit::Type::RequestWeight, Day) == 10);
+
+		// new orders have no weight, only the order count
+		BFCPP_CHECK(test, acquired(governor, RestCall::NewOrder) == 2);
+		BFCPP_CHECK(test, used(governor, RateLimit::Type::Orders, Day) == 2);
+		BFCPP_CHECK_THROWS(test, BfcppRateLimitException, governor.acquire(RestCall::NewOrder));
+
+		// a call's weight can be changed
+		governor.setLimits({ {RateLimit::Type::RequestWeight, Day, 10} });
+		governor.setWeight(RestCall::ServerTime, 3);
+		BFCPP_CHECK(test, governor.weight(RestCall::ServerTime) == 3);
+		BFCPP_CHECK(test, acquired(governor, RestCall::ServerTime) == 2);
+	}
+
+
+	// setDataShare()
+	{
+		const vector<RateLimit> limits{ {RateLimit::Type::RequestWeight, Day, 10} };
+
+		RateLimitGovernor governor;
+		governor.setMode(RateLimitGovernor::Mode::FailFast);
+
+		governor.setLimits(limits);
+		governor.setDataShare(0.5);
+		BFCPP_CHECK(test, acquired(governor, RestCall::ServerTime) == 5);
+		BFCPP_CHECK(test, acquired(governor, RestCall::CancelOrder) == 5);
+
+		governor.setLimits(limits);
+		governor.setDataShare(2.0);  // limited to 1.0
+		BFCPP_CHECK(test, acquired(governor, RestCall::ServerTime) == 10);
+
+		governor.setLimits(limits);
+		governor.setDataShare(0.0);
+		BFCPP_CHECK(test, acquired(governor, RestCall::ServerTime) == 0);
+		BFCPP_CHECK(test, acquired(governor, RestCall::CancelOrder) == 10);
+	}
+
+
+	// Queue fails immediately if the window rolls after maxWait()
+	{
+		RateLimitGovernor governor;
+		governor.setLimits({ {RateLimit::Type::RequestWeight, Day, 1} });
+		governor.setMode(RateLimitGovernor::Mode::Queue);
+		governor.setMaxWait(50ms);
+		governor.setDataShare(1.0);
+
+		governor.acquire(RestCall::ServerTime);
+
+		const auto start = Clock::now();
+		BFCPP_CHECK_THROWS(test, BfcppRateLimitException, governor.acquire(RestCall::ServerTime));
+		BFCPP_CHECK(test, Clock::now() - start < 1s);
+	}
+
+
+	// Queue waits for the window to roll, data queries wait for order calls which are queued
+	{
+		RateLimitGovernor governor;
+		governor.setLimits({ {RateLimit::Type::RequestWeight, Day, 1000}, {RateLimit::Type::Orders, 1s, 1} });
+		governor.setMode(RateLimitGovernor::Mode::Queue);
+		governor.setMaxWait(5s);
+
+		// start early in the 1s window, so the second order waits for the next
+		while (std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now().time_since_epoch()).count() % 1000 > 200)
+			std::this_thread::sleep_for(1ms);
+
+		governor.acquire(RestCall::NewOrder);
+
+		bool orderFailed = false;
+		std::thread order{ [&governor, &orderFailed]
+		{
+			try
+			{
+				governor.acquire(RestCall::NewOrder);
+			}
+			catch (const BfcppRateLimitException&)
+			{
+				orderFailed = true;
+			}
+		} };
+
+		std::this_thread::sleep_for(50ms);
+
+		// there is weight for this, but the order is waiting
+		const auto start = Clock::now();
+		governor.acquire(RestCall::ServerTime);
+		const auto waited = Clock::now() - start;
+
+		order.join();
+
+		BFCPP_CHECK(test, !orderFailed);
+		BFCPP_CHECK(test, waited > 500ms);
+		BFCPP_CHECK(test, used(governor, RateLimit::Type::Orders, 1s) == 1);
+	}
+
+
+	// a 429 or 418 holds all requests for the Retry-After
+	{
+		RateLimitGovernor governor;
+		governor.setMode(RateLimitGovernor::Mode::FailFast);
+
+		governor.onResponse(200, headers({ {"Retry-After", "1"} }));
+		BFCPP_CHECK(test, acquired(governor, RestCall::ServerTime, 1) == 1);
+
+		governor.onResponse(429, headers({ {"Retry-After", "1"} }));
+		BFCPP_CHECK_THROWS(test, BfcppRateLimitException, governor.acquire(RestCall::ServerTime));
+		BFCPP_CHECK_THROWS(test, BfcppRateLimitException, governor.acquire(RestCall::NewOrder));
+
+		governor.setMode(RateLimitGovernor::Mode::Queue);
+		governor.setMaxWait(100ms);
+		BFCPP_CHECK_THROWS(test, BfcppRateLimitException, governor.acquire(RestCall::ServerTime));
+
+		governor.setMaxWait(5s);
+		governor.acquire(RestCall::ServerTime);
+
+		// it has passed
+		governor.setMode(RateLimitGovernor::Mode::FailFast);
+		BFCPP_CHECK(test, acquired(governor, RestCall::ServerTime, 1) == 1);
+
+		RateLimitGovernor banned;
+		banned.setMode(RateLimitGovernor::Mode::FailFast);
+		banned.onResponse(418, headers({ {"retry-after", "60"} }));
+		BFCPP_CHECK_THROWS(test, BfcppRateLimitException, banned.acquire(RestCall::CancelOrder));
+
+		// Off is never held
+		banned.setMode(RateLimitGovernor::Mode::Off);
+		BFCPP_CHECK(test, acquired(banned, RestCall::ServerTime, 1) == 1);
+	}
+
+
+	// the response headers set the usage of the limit with the same interval
+	{
+		RateLimitGovernor governor;  // 2400 weight/min, 1200 orders/min, 300 orders/10s
+
+		governor.onResponse(200, headers({ {"X-MBX-USED-WEIGHT-1M", "1234"}, {"X-MBX-ORDER-COUNT-10S", "7"}, {"x-mbx-order-count-1m", "20"},
+										   {"X-MBX-USED-WEIGHT-1S", "99"}, {"Content-Type", "application/json"} }));
+
+		BFCPP_CHECK(test, used(governor, RateLimit::Type::RequestWeight, 60s) == 1234);
+		BFCPP_CHECK(test, used(governor, RateLimit::Type::Orders, 10s) == 7);
+		BFCPP_CHECK(test, used(governor, RateLimit::Type::Orders, 60s) == 20);
+		BFCPP_CHECK(test, governor.usage().size() == 3);
+
+		// malformed headers are ignored
+		RateLimitGovernor malformed;
+		malformed.setLimits({ {RateLimit::Type::RequestWeight, Day, 100} });
+		malformed.acquire(RestCall::ServerTime);
+		malformed.onResponse(200, headers({ {"X-MBX-USED-WEIGHT-1D", "lots"}, {"X-MBX-USED-WEIGHT-", "50"}, {"X-MBX-USED-WEIGHT-D", "50"} }));
+		BFCPP_CHECK(test, used(malformed, RateLimit::Type::RequestWeight, Day) == 1);
+
+		// and they're authoritative
+		malformed.setMode(RateLimitGovernor::Mode::FailFast);
+		malformed.setDataShare(1.0);
+		malformed.onResponse(200, headers({ {"X-MBX-USED-WEIGHT-1D", "99"} }));
+		BFCPP_CHECK(test, acquired(malformed, RestCall::ServerTime) == 1);
+
+		malformed.onResponse(200, headers({ {"X-MBX-USED-WEIGHT-1D", "10"} }));
+		BFCPP_CHECK(test, acquired(malformed, RestCall::ServerTime) == 90);
+	}
+
+
+	// limits from the exchange info
+	{
+		ExchangeInfo info;
+		info.rateLimits = { { {"rateLimitType", "REQUEST_WEIGHT"}, {"interval", "MINUTE"}, {"intervalNum", "1"}, {"limit", "2400"} },
+							{ {"rateLimitType", "ORDERS"}, {"interval", "SECOND"}, {"intervalNum", "10"}, {"limit", "300"} },
+							{ {"rateLimitType", "RAW_REQUESTS"}, {"interval", "MINUTE"}, {"intervalNum", "5"}, {"limit", "6100"} },
+							{ {"rateLimitType", "ORDERS"}, {"interval", "MINUTE"}, {"limit", "1200"} } };
+
+		const auto limits = RateLimitGovernor::readLimits(info);
+
+		BFCPP_CHECK(test, limits.size() == 2);
+		BFCPP_CHECK(test, limits[0].type == RateLimit::Type::RequestWeight && limits[0].interval == 60s && limits[0].limit == 2400);
+		BFCPP_CHECK(test, limits[1].type == RateLimit::Type::Orders && limits[1].interval == 10s && limits[1].limit == 300);
+
+		RateLimitGovernor governor;
+		governor.setLimits(info);
+		BFCPP_CHECK(test, governor.limits().size() == 2);
+
+		// no limits keeps the current ones
+		governor.setLimits(ExchangeInfo{});
+		BFCPP_CHECK(test, governor.limits().size() == 2);
+	}
+}
+
+
+#endif
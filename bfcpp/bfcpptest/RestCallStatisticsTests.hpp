@@ -0,0 +1,101 @@
+#ifndef BFCPP_REST_CALL_STATISTICS_TESTS_H
+#define BFCPP_REST_CALL_STATISTICS_TESTS_H
+
+#include <RestCallStatistics.hpp>
+#include "UnitTest.hpp"
+
+
+namespace restcallstatisticstests
+{
+	using namespace bfcpp;
+	using namespace std::chrono_literals;
+
+	inline RestCallTimings timings(const std::chrono::microseconds build, const std::chrono::microseconds apiCall, const std::chrono::microseconds handler)
+	{
+		RestCallTimings timings;
+		timings.restQueryBuild = build;
+		timings.restApiCall = apiCall;
+		timings.restResponseHandler = handler;
+		timings.bfcppTotalProcess = build + handler;
+		return timings;
+	}
+}
+
+
+inline void restCallStatisticsTests(UnitTest& test)
+{
+	using namespace bfcpp;
+	using namespace restcallstatisticstests;
+
+
+	// no calls, no summaries
+	{
+		RestCallStatistics statistics;
+
+		BFCPP_CHECK(test, statistics.summary().empty());
+		BFCPP_CHECK(test, statistics.histograms(RestCall::NewOrder).total.count() == 0);
+	}
+
+
+	// only the calls made are summarised, in RestCall order, each with its own timings
+	{
+		RestCallStatistics statistics;
+
+		statistics.record(RestCall::OrderBook, timings(20us, 3'000us, 200us), 3'300us);
+		statistics.record(RestCall::NewOrder, timings(5us, 1'000us, 10us), 1'100us);
+		statistics.record(RestCall::NewOrder, timings(7us, 2'000us, 12us), 2'100us);
+
+		const auto summaries = statistics.summary();
+
+		BFCPP_CHECK(test, summaries.size() == 2);
+		BFCPP_CHECK(test, summaries[0].call == RestCall::NewOrder && summaries[1].call == RestCall::OrderBook);
+
+		BFCPP_CHECK(test, summaries[0].total.count == 2 && summaries[0].apiCall.count == 2);
+		BFCPP_CHECK(test, summaries[0].queryBuild.min == 5us && summaries[0].queryBuild.max == 7us);
+		BFCPP_CHECK(test, summaries[0].apiCall.min == 1'000us && summaries[0].apiCall.max == 2'000us);
+		BFCPP_CHECK(test, summaries[0].responseHandler.max == 12us);
+		BFCPP_CHECK(test, summaries[0].bfcppTotalProcess.min == 15us && summaries[0].bfcppTotalProcess.max == 19us);
+		BFCPP_CHECK(test, summaries[0].total.min == 1'100us && summaries[0].total.max == 2'100us);
+
+		BFCPP_CHECK(test, summaries[1].total.count == 1 && summaries[1].apiCall.min == 3'000us && summaries[1].total.max == 3'300us);
+
+		// the others are still empty
+		BFCPP_CHECK(test, statistics.histograms(RestCall::CancelOrder).total.count() == 0);
+		BFCPP_CHECK(test, statistics.histograms(RestCall::ServerTime).apiCall.count() == 0);
+	}
+
+
+	// the first and last RestCalls have their own histograms
+	{
+		RestCallStatistics statistics;
+
+		statistics.record(RestCall::None, timings(1us, 2us, 3us), 6us);
+		statistics.record(RestCall::ServerTime, timings(1us, 500us, 3us), 504us);
+
+		const auto summaries = statistics.summary();
+
+		BFCPP_CHECK(test, summaries.size() == 2);
+		BFCPP_CHECK(test, summaries[0].call == RestCall::None && summaries[0].total.max == 6us);
+		BFCPP_CHECK(test, summaries[1].call == RestCall::ServerTime && summaries[1].apiCall.max == 500us);
+	}
+
+
+	// reset() clears every call
+	{
+		RestCallStatistics statistics;
+
+		statistics.record(RestCall::NewOrder, timings(5us, 1'000us, 10us), 1'100us);
+		statistics.record(RestCall::ExchangeInfo, timings(5us, 1'000us, 10us), 1'100us);
+		statistics.reset();
+
+		BFCPP_CHECK(test, statistics.summary().empty());
+
+		statistics.record(RestCall::AccountInfo, timings(5us, 1'000us, 10us), 1'100us);
+
+		const auto summaries = statistics.summary();
+		BFCPP_CHECK(test, summaries.size() == 1 && summaries[0].call == RestCall::AccountInfo && summaries[0].total.count == 1);
+	}
+}
+
+
+#endif
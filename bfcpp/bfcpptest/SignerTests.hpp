@@ -0,0 +1,70 @@
+#ifndef BFCPP_SIGNER_TESTS_H
+#define BFCPP_SIGNER_TESTS_H
+
+#include <Signer.hpp>
+#include "UnitTest.hpp"
+
+
+inline void signerTests(UnitTest& test)
+{
+	using namespace bfcpp;
+
+
+	// the example from the Binance API docs
+	{
+		const string secret = "NhqPtmdSJYdKjVHjA7PZj4Mge3R5YNiP1e3UZjInClVN65XAbvqqM6A7H5fATj0j";
+		const string query = "symbol=LTCBTC&side=BUY&type=LIMIT&timeInForce=GTC&quantity=1&price=0.1&recvWindow=5000&timestamp=1499827319559";
+		const string expected = "c8db56825ae71d6d79447849e617115f4a920fa2acdcab2b053c4b2838bd6b71";
+
+		const Signer signer{ secret };
+
+		BFCPP_CHECK(test, signer.hasKey());
+		BFCPP_CHECK(test, signer.sign(query) == expected);
+		BFCPP_CHECK(test, createSignature(secret, query) == expected);
+
+		// signing again gives the same result, the key's states aren't changed
+		BFCPP_CHECK(test, signer.sign(query) == expected);
+
+		string str = "signature=";
+		signer.appendTo(query, str);
+		BFCPP_CHECK(test, str == "signature=" + expected);
+
+		char out[Signer::SignatureLength];
+		signer.sign(query, out);
+		BFCPP_CHECK(test, string(out, Signer::SignatureLength) == expected);
+	}
+
+
+	// matches createSignature() for keys shorter than, equal to and longer than the SHA256 block (which is hashed first) and for varied data lengths
+	{
+		for (const size_t keySize : { 0, 1, 32, 63, 64, 65, 131 })
+		{
+			string key;
+			for (size_t i = 0; i < keySize; ++i)
+				key += static_cast<char>('A' + (i * 7) % 26);
+
+			const Signer signer{ key };
+			BFCPP_CHECK(test, signer.hasKey() == (keySize != 0));
+
+			for (const size_t dataSize : { 0, 1, 55, 56, 64, 119, 1000 })
+			{
+				string data;
+				for (size_t i = 0; i < dataSize; ++i)
+					data += static_cast<char>('a' + (i * 3 + keySize) % 26);
+
+				const auto matches = signer.sign(data) == createSignature(key, data);
+				test.check(matches, ("Signer(key of " + std::to_string(keySize) + ").sign(data of " + std::to_string(dataSize) + ") == createSignature()").c_str(), __FILE__, __LINE__);
+			}
+		}
+	}
+
+
+	// RFC 4231, test case 6, a key longer than the block
+	{
+		const Signer signer{ string(131, '\xaa') };
+		BFCPP_CHECK(test, signer.sign("Test Using Larger Than Block-Size Key - Hash Key First") == "60e431591ee0b67f0d8a26aacbf5b77f8e0bc6213728c5140546040f0ee37f54");
+	}
+}
+
+
+#endif
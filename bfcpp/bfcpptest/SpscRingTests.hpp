@@ -0,0 +1,103 @@
+#ifndef BFCPP_SPSC_RING_TESTS_H
+#define BFCPP_SPSC_RING_TESTS_H
+
+#include <thread>
+#include <SpscRing.hpp>
+#include "UnitTest.hpp"
+
+
+inline void spscRingTests(UnitTest& test)
+{
+	using namespace bfcpp;
+
+
+	// events are read in order, a full ring drops with RingOverflow::Drop
+	{
+		SpscRing<int> ring{ 3 };
+
+		BFCPP_CHECK(test, ring.capacity() == 4);
+		BFCPP_CHECK(test, ring.empty());
+		BFCPP_CHECK(test, !ring.poll([](int&) {}));
+
+		for (int i = 1; i <= 4; ++i)
+			BFCPP_CHECK(test, ring.publish([i](int& slot) { slot = i; }));
+
+		BFCPP_CHECK(test, ring.size() == 4);
+		BFCPP_CHECK(test, !ring.tryPublish([](int& slot) { slot = 99; }));
+		BFCPP_CHECK(test, !ring.publish([](int& slot) { slot = 99; }));
+
+		int value = 0;
+		BFCPP_CHECK(test, ring.poll([&value](int& event) { value = event; }));
+		BFCPP_CHECK(test, value == 1);
+
+		// space was made so the next publish succeeds
+		BFCPP_CHECK(test, ring.publish([](int& slot) { slot = 5; }));
+
+		vector<int> values;
+		BFCPP_CHECK(test, ring.drain([&values](int& event) { values.push_back(event); }, 2) == 2);
+		BFCPP_CHECK(test, ring.drain([&values](int& event) { values.push_back(event); }) == 2);
+		BFCPP_CHECK(test, (values == vector<int>{ 2, 3, 4, 5 }));
+		BFCPP_CHECK(test, ring.empty());
+
+		const auto stats = ring.stats();
+		BFCPP_CHECK(test, stats.published == 5);
+		BFCPP_CHECK(test, stats.dropped == 1);
+		BFCPP_CHECK(test, stats.blocked == 0);
+
+		BFCPP_CHECK_THROWS(test, BfcppException, SpscRing<int>(0));
+	}
+
+
+	// nothing is published if the write throws
+	{
+		SpscRing<int> ring{ 2 };
+
+		BFCPP_CHECK_THROWS(test, BfcppException, ring.tryPublish([](int&) { throw BfcppException("write failed"); }));
+		BFCPP_CHECK(test, ring.empty());
+		BFCPP_CHECK(test, ring.stats().published == 0);
+	}
+
+
+	// slots are reused in place, so their memory is kept
+	{
+		SpscRing<vector<int>> ring{ 1 };
+
+		ring.publish([](vector<int>& slot) { slot.assign(100, 1); });
+		ring.poll([](vector<int>& event) { event.clear(); });
+
+		size_t capacity = 0;
+		ring.publish([&capacity](vector<int>& slot) { capacity = slot.capacity(); slot.push_back(2); });
+		BFCPP_CHECK(test, capacity >= 100);
+	}
+
+
+	// a producer and consumer on separate threads, RingOverflow::Block loses nothing and keeps the order
+	{
+		const int count = 200000;
+		SpscRing<int> ring{ 64, RingOverflow::Block };
+
+		std::thread producer{ [&ring]
+		{
+			for (int i = 0; i < count; ++i)
+				ring.publish([i](int& slot) { slot = i; });
+		} };
+
+		int expected = 0;
+		bool ordered = true;
+
+		while (expected < count)
+		{
+			ring.drain([&](int& event) { ordered = ordered && event == expected; ++expected; });
+		}
+
+		producer.join();
+
+		BFCPP_CHECK(test, ordered);
+		BFCPP_CHECK(test, ring.empty());
+		BFCPP_CHECK(test, ring.stats().published == count);
+		BFCPP_CHECK(test, ring.stats().dropped == 0);
+	}
+}
+
+
+#endif
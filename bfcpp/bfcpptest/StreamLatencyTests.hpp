@@ -0,0 +1,222 @@
+#ifndef BFCPP_STREAM_LATENCY_TESTS_H
+#define BFCPP_STREAM_LATENCY_TESTS_H
+
+#include <thread>
+#include <StreamLatency.hpp>
+#include "UnitTest.hpp"
+
+
+namespace streamlatencytests
+{
+	using namespace bfcpp;
+	using namespace std::chrono_literals;
+
+	// the frames' event times are 1'700'000'000'000ms, they're received 100ms later
+	const Clock::time_point Received{ std::chrono::milliseconds{ 1'700'000'000'100 } };
+
+	const string MarkPriceFrame = R"({"e":"markPriceUpdate","E":1700000000000,"s":"BTCUSDT","p":"37500.10000000","i":"37490.0","r":"0.00010000","T":1700003600000})";
+	const string DepthFrame = R"({"e":"depthUpdate","E":1700000000000,"T":1699999999950,"s":"BTCUSDT","U":1,"u":2,"pu":0,"b":[["37500.10","1.000"]],"a":[]})";
+	const string BookTickerFrame = R"({"e":"bookTicker","u":400900217,"E":1700000000000,"T":1699999999980,"s":"BTCUSDT","b":"37500.10","B":"31.21","a":"37500.20","A":"40.66"})";
+	const string AggTradeFrame = R"({"e":"aggTrade","E":1700000000000,"a":5933014,"s":"BTCUSDT","p":"37500.10","q":"0.010","f":100,"l":105,"T":1699999999900,"m":true})";
+	const string ArrayFrame = R"([{"e":"markPriceUpdate","E":1700000000000,"s":"BTCUSDT"},{"e":"markPriceUpdate","E":1700000000090,"s":"ETHUSDT"}])";
+
+
+	// a monitor's handler, which reads the frame then calls the callback
+	struct FakeHandler
+	{
+		bool parse{ true };
+		std::chrono::microseconds callback{ 0 };
+		size_t calls{ 0 };
+
+		void operator()(std::string_view, shared_ptr<WebSocketSession>)
+		{
+			++calls;
+
+			if (parse)
+			{
+				StreamLatency::parsed();
+			}
+
+			if (callback != 0us)
+			{
+				std::this_thread::sleep_for(callback);
+			}
+		}
+	};
+
+
+	inline void handle(StreamLatency& latency, FakeHandler& handler, const string& frame, const std::chrono::microseconds offset = 0us,
+					   const StreamLatency::SteadyClock::time_point receivedSteady = StreamLatency::SteadyClock::now())
+	{
+		StreamLatency::received(Received, receivedSteady);
+		latency.handle(handler, frame, nullptr, offset);
+	}
+}
+
+
+inline void streamLatencyTests(UnitTest& test)
+{
+	using namespace bfcpp;
+	using namespace streamlatencytests;
+
+
+	// "E" to the frame being received
+	{
+		StreamLatency latency{ "btcusdt@markPrice@1s" };
+		FakeHandler handler;
+
+		handle(latency, handler, MarkPriceFrame);
+
+		BFCPP_CHECK(test, handler.calls == 1);
+		BFCPP_CHECK(test, latency.exchangeToReceive.count() == 1);
+		BFCPP_CHECK(test, latency.exchangeToReceive.min() == 100ms);
+
+		// markPrice's "T" is the next funding time, only depth and bookTicker have a transaction time
+		BFCPP_CHECK(test, latency.transactionToReceive.count() == 0);
+	}
+
+
+	// the receive time is moved onto the exchange's clock by the offset
+	{
+		StreamLatency latency{ "btcusdt@markPrice@1s" };
+		FakeHandler handler;
+
+		handle(latency, handler, MarkPriceFrame, 30'000us);
+		BFCPP_CHECK(test, latency.exchangeToReceive.max() == 130ms);
+
+		handle(latency, handler, MarkPriceFrame, -40'000us);
+		BFCPP_CHECK(test, latency.exchangeToReceive.min() == 60ms);
+
+		// received before the event time, on the exchange's clock, is recorded as 0
+		handle(latency, handler, MarkPriceFrame, -150'000us);
+		BFCPP_CHECK(test, latency.exchangeToReceive.count() == 3);
+		BFCPP_CHECK(test, latency.exchangeToReceive.min() == 0ns);
+	}
+
+
+	// "T" to the frame being received, for the depth and bookTicker streams
+	{
+		FakeHandler handler;
+
+		StreamLatency depth{ "btcusdt@depth@100ms" };
+		handle(depth, handler, DepthFrame);
+		BFCPP_CHECK(test, depth.transactionToReceive.count() == 1 && depth.transactionToReceive.min() == 150ms);
+		BFCPP_CHECK(test, depth.exchangeToReceive.min() == 100ms);
+
+		StreamLatency bookTicker{ "btcusdt@bookTicker" };
+		handle(bookTicker, handler, BookTickerFrame, 5'000us);
+		BFCPP_CHECK(test, bookTicker.transactionToReceive.count() == 1 && bookTicker.transactionToReceive.min() == 125ms);
+
+		// aggTrade's "T" is the trade time, not recorded
+		StreamLatency aggTrade{ "btcusdt@aggTrade" };
+		handle(aggTrade, handler, AggTradeFrame);
+		BFCPP_CHECK(test, aggTrade.transactionToReceive.count() == 0);
+		BFCPP_CHECK(test, aggTrade.exchangeToReceive.count() == 1);
+	}
+
+
+	// for an array the first entry's time is used, and a frame without "E" isn't recorded
+	{
+		StreamLatency latency{ "!markPrice@arr@1s" };
+		FakeHandler handler;
+
+		handle(latency, handler, ArrayFrame);
+		BFCPP_CHECK(test, latency.exchangeToReceive.count() == 1 && latency.exchangeToReceive.min() == 100ms);
+
+		handle(latency, handler, R"({"result":null,"id":1})");
+		BFCPP_CHECK(test, handler.calls == 2);
+		BFCPP_CHECK(test, latency.exchangeToReceive.count() == 1);
+	}
+
+
+	// the handler's parsed() splits the time in the handler into receiveToParsed and parsedToReturn
+	{
+		StreamLatency latency{ "btcusdt@markPrice@1s" };
+		FakeHandler handler;
+		handler.callback = 2'000us;
+
+		handle(latency, handler, MarkPriceFrame, 0us, StreamLatency::SteadyClock::now() - 5ms);
+
+		BFCPP_CHECK(test, latency.receiveToParsed.count() == 1 && latency.parsedToReturn.count() == 1);
+		BFCPP_CHECK(test, latency.receiveToParsed.min() >= 5ms && latency.receiveToParsed.min() < 2s);
+		BFCPP_CHECK(test, latency.parsedToReturn.min() >= 2ms && latency.parsedToReturn.min() < 2s);
+	}
+
+
+	// without parsed(), i.e. a handler which doesn't read the frame, only the exchange latencies are recorded
+	{
+		StreamLatency latency{ "btcusdt@markPrice@1s" };
+		FakeHandler handler;
+		handler.parse = false;
+
+		handle(latency, handler, MarkPriceFrame);
+
+		BFCPP_CHECK(test, latency.receiveToParsed.count() == 0 && latency.parsedToReturn.count() == 0);
+		BFCPP_CHECK(test, latency.exchangeToReceive.count() == 1);
+	}
+
+
+	// the times are thread local: parsed() on another thread, or outside handle(), isn't the frame's
+	{
+		StreamLatency latency{ "btcusdt@markPrice@1s" };
+
+		auto otherThread = [](std::string_view, shared_ptr<WebSocketSession>)
+		{
+			std::thread{ [] { StreamLatency::parsed(); } }.join();
+		};
+
+		StreamLatency::received(Received, StreamLatency::SteadyClock::now());
+		latency.handle(otherThread, MarkPriceFrame, nullptr, 0us);
+
+		BFCPP_CHECK(test, latency.receiveToParsed.count() == 0);
+
+		// after handle() returns parsed() does nothing, so a frame for a monitor which isn't tracked can't be attributed to the next
+		StreamLatency::parsed();
+
+		FakeHandler handler;
+		handler.parse = false;
+		handle(latency, handler, MarkPriceFrame);
+
+		BFCPP_CHECK(test, latency.receiveToParsed.count() == 0);
+	}
+
+
+	// a handler which throws: the exception is passed on and nothing is recorded
+	{
+		StreamLatency latency{ "btcusdt@markPrice@1s" };
+
+		auto throws = [](std::string_view, shared_ptr<WebSocketSession>)
+		{
+			StreamLatency::parsed();
+			throw BfcppException{ "handler failed" };
+		};
+
+		StreamLatency::received(Received, StreamLatency::SteadyClock::now());
+		BFCPP_CHECK_THROWS(test, BfcppException, latency.handle(throws, MarkPriceFrame, nullptr, 0us));
+		BFCPP_CHECK(test, latency.exchangeToReceive.count() == 0 && latency.receiveToParsed.count() == 0);
+	}
+
+
+	// summary() and reset()
+	{
+		StreamLatency latency{ "btcusdt@depth@100ms" };
+		FakeHandler handler;
+
+		handle(latency, handler, DepthFrame);
+		handle(latency, handler, DepthFrame);
+
+		const auto summary = latency.summary(7);
+		BFCPP_CHECK(test, summary.id == 7 && summary.stream == "btcusdt@depth@100ms");
+		BFCPP_CHECK(test, summary.exchangeToReceive.count == 2 && summary.transactionToReceive.count == 2);
+		BFCPP_CHECK(test, summary.receiveToParsed.count == 2 && summary.parsedToReturn.count == 2);
+		BFCPP_CHECK(test, summary.exchangeToReceive.min == 100ms && summary.transactionToReceive.max == 150ms);
+
+		latency.reset();
+		const auto cleared = latency.summary(7);
+		BFCPP_CHECK(test, cleared.exchangeToReceive.count == 0 && cleared.transactionToReceive.count == 0);
+		BFCPP_CHECK(test, cleared.receiveToParsed.count == 0 && cleared.parsedToReturn.count == 0);
+	}
+}
+
+
+#endif
@@ -0,0 +1,157 @@
+#ifndef BFCPP_SYMBOL_REGISTRY_TESTS_H
+#define BFCPP_SYMBOL_REGISTRY_TESTS_H
+
+#include <SymbolRegistry.hpp>
+#include "UnitTest.hpp"
+
+
+namespace symbolregistrytests
+{
+	using namespace bfcpp;
+
+	inline string symbolName(const size_t i)
+	{
+		return "SYM" + std::to_string(i) + "USDT";
+	}
+}
+
+
+inline void symbolRegistryTests(UnitTest& test)
+{
+	using namespace bfcpp;
+	using namespace symbolregistrytests;
+
+
+	// empty
+	{
+		SymbolRegistry registry;
+
+		BFCPP_CHECK(test, registry.size() == 0);
+		BFCPP_CHECK(test, registry.id("BTCUSDT") == NoSymbolId);
+		BFCPP_CHECK(test, !registry.contains("BTCUSDT"));
+		BFCPP_CHECK(test, registry.scale(0) == nullptr);
+		BFCPP_CHECK_THROWS(test, BfcppException, registry.name(0));
+	}
+
+
+	// ids are dense, in the order added, and adding again returns the same id
+	{
+		SymbolRegistry registry;
+
+		BFCPP_CHECK(test, registry.add("BTCUSDT") == 0);
+		BFCPP_CHECK(test, registry.add("ETHUSDT") == 1);
+		BFCPP_CHECK(test, registry.add("BNBUSDT") == 2);
+
+		BFCPP_CHECK(test, registry.add("ETHUSDT") == 1);
+		BFCPP_CHECK(test, registry.add(string{ "BTCUSDT" }) == 0);
+		BFCPP_CHECK(test, registry.size() == 3);
+
+		BFCPP_CHECK(test, registry.id("BNBUSDT") == 2);
+		BFCPP_CHECK(test, registry.name(1) == "ETHUSDT");
+		BFCPP_CHECK(test, registry.contains("BTCUSDT"));
+
+		// case sensitive
+		BFCPP_CHECK(test, registry.id("btcusdt") == NoSymbolId);
+		BFCPP_CHECK(test, registry.id("BTCUSD") == NoSymbolId);
+	}
+
+
+	// name() throws for an id not registered
+	{
+		SymbolRegistry registry;
+		registry.add("BTCUSDT");
+
+		BFCPP_CHECK_THROWS(test, BfcppException, registry.name(1));
+		BFCPP_CHECK_THROWS(test, BfcppException, registry.name(NoSymbolId));
+	}
+
+
+	// scales: none when added without one, replaced when added again with one, and an existing scale is kept by add(symbol)
+	{
+		SymbolRegistry registry;
+
+		const auto btc = registry.add("BTCUSDT");
+		BFCPP_CHECK(test, registry.scale(btc) == nullptr);
+
+		BFCPP_CHECK(test, registry.add("BTCUSDT", DecimalScale{ 2, 3 }) == btc);
+		BFCPP_CHECK(test, registry.scale(btc) && registry.scale(btc)->price == 2 && registry.scale(btc)->quantity == 3);
+
+		BFCPP_CHECK(test, registry.add("BTCUSDT", DecimalScale{ 1, 0 }) == btc);
+		BFCPP_CHECK(test, registry.scale(btc)->price == 1 && registry.scale(btc)->quantity == 0);
+
+		BFCPP_CHECK(test, registry.add("BTCUSDT") == btc);
+		BFCPP_CHECK(test, registry.scale(btc) && registry.scale(btc)->price == 1);
+
+		const auto eth = registry.add("ETHUSDT");
+		BFCPP_CHECK(test, registry.scale(eth) == nullptr);
+		BFCPP_CHECK(test, registry.scale(eth + 1) == nullptr);
+	}
+
+
+	// lookups stay correct as the table is rebuilt, at 16, 32, 64 ... slots
+	{
+		SymbolRegistry registry;
+
+		bool added = true, found = true;
+
+		for (size_t i = 0; i < 300; ++i)
+		{
+			added = added && registry.add(symbolName(i)) == i;
+
+			// every symbol added so far, after each growth
+			if (i == 8 || i == 16 || i == 32 || i == 64 || i == 128 || i == 256)
+			{
+				for (size_t j = 0; j <= i; ++j)
+				{
+					found = found && registry.id(symbolName(j)) == j && registry.name(static_cast<SymbolId>(j)) == symbolName(j);
+				}
+
+				found = found && registry.id(symbolName(i + 1)) == NoSymbolId;
+			}
+		}
+
+		BFCPP_CHECK(test, added);
+		BFCPP_CHECK(test, found);
+		BFCPP_CHECK(test, registry.size() == 300);
+
+		// adding again after growth doesn't add
+		bool same = true;
+		for (size_t i = 0; i < 300; ++i)
+		{
+			same = same && registry.add(symbolName(i)) == i;
+		}
+
+		BFCPP_CHECK(test, same);
+		BFCPP_CHECK(test, registry.size() == 300);
+	}
+
+
+	// from exchange info, in the order returned, with each symbol's precision. A symbol without a name is skipped
+	{
+		ExchangeInfo info;
+
+		ExchangeInfo::Symbol btc;
+		btc.data = { {"symbol", "BTCUSDT"}, {"pricePrecision", "2"}, {"quantityPrecision", "3"} };
+
+		ExchangeInfo::Symbol unnamed;
+		unnamed.data = { {"pricePrecision", "5"} };
+
+		ExchangeInfo::Symbol eth;
+		eth.data = { {"symbol", "ETHUSDT"}, {"pricePrecision", "2"}, {"quantityPrecision", "3"} };
+
+		ExchangeInfo::Symbol doge;
+		doge.data = { {"symbol", "DOGEUSDT"}, {"pricePrecision", "6"}, {"quantityPrecision", "0"} };
+
+		info.symbols = { btc, unnamed, eth, doge };
+
+		SymbolRegistry registry{ info };
+
+		BFCPP_CHECK(test, registry.size() == 3);
+		BFCPP_CHECK(test, registry.id("BTCUSDT") == 0 && registry.id("ETHUSDT") == 1 && registry.id("DOGEUSDT") == 2);
+		BFCPP_CHECK(test, registry.scale(2) && registry.scale(2)->price == 6 && registry.scale(2)->quantity == 0);
+		BFCPP_CHECK(test, registry.scale(0) && registry.scale(0)->quantity == 3);
+	}
+}
+
+
+#endif
@@ -0,0 +1,79 @@
+#ifndef BFCPP_UNIT_TEST_H
+#define BFCPP_UNIT_TEST_H
+
+#include <iostream>
+#include <string>
+#include <exception>
+
+
+// A minimal harness for the library's unit tests, which don't connect to the exchange. See UnitTests.hpp, run with: bfcpptest --unit
+
+class UnitTest
+{
+public:
+	void check(const bool passed, const char* expression, const char* file, const int line)
+	{
+		++m_checks;
+
+		if (!passed)
+		{
+			++m_failures;
+			std::cout << "\n  FAILED: " << expression << " (" << file << ":" << line << ")";
+		}
+	}
+
+
+	template<class ExceptionT, class F>
+	void checkThrows(F f, const char* expression, const char* file, const int line)
+	{
+		bool thrown = false;
+
+		try
+		{
+			f();
+		}
+		catch (const ExceptionT&)
+		{
+			thrown = true;
+		}
+		catch (const std::exception&)
+		{
+		}
+
+		check(thrown, expression, file, line);
+	}
+
+
+	// runs a suite, an exception it doesn't catch is a failure
+	template<class F>
+	void run(const char* name, F suite)
+	{
+		std::cout << "\n" << name;
+
+		try
+		{
+			suite(*this);
+		}
+		catch (const std::exception& ex)
+		{
+			++m_failures;
+			std::cout << "\n  FAILED: exception: " << ex.what();
+		}
+	}
+
+
+	size_t checks() const { return m_checks; }
+	size_t failures() const { return m_failures; }
+
+
+private:
+	size_t m_checks{ 0 };
+	size_t m_failures{ 0 };
+};
+
+
+#define BFCPP_CHECK(test, expression) (test).check((expression), #expression, __FILE__, __LINE__)
+#define BFCPP_CHECK_THROWS(test, ExceptionT, expression) (test).checkThrows<ExceptionT>([&] { (void)(expression); }, #expression, __FILE__, __LINE__)
+
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef BFCPP_UNIT_TESTS_H
+#define BFCPP_UNIT_TESTS_H
+
+#include "UnitTest.hpp"
+#include "LocalOrderBookTests.hpp"
+#include "PriceLadderTests.hpp"
+#include "FastJsonTests.hpp"
+#include "DecimalTests.hpp"
+#include "SpscRingTests.hpp"
+#include "SymbolRegistryTests.hpp"
+#include "OrderTemplateTests.hpp"
+#include "SignerTests.hpp"
+#include "RateLimitGovernorTests.hpp"
+#include "OrderBatchTests.hpp"
+#include "ClockSyncTests.hpp"
+#include "ExchangeInfoCacheTests.hpp"
+#include "OrderValidatorTests.hpp"
+#include "OrderStateCacheTests.hpp"
+#include "AccountStateCacheTests.hpp"
+#include "LatencyHistogramTests.hpp"
+#include "StreamLatencyTests.hpp"
+#include "RestCallStatisticsTests.hpp"
+#include "FrameRecorderTests.hpp"
+
+
+// Runs the unit tests, returns true if all passed
+inline bool runUnitTests()
+{
+	UnitTest test;
+
+	test.run("LocalOrderBook", localOrderBookTests);
+	test.run("PriceLadder", priceLadderTests);
+	test.run("FastJson", fastJsonTests);
+	test.run("Decimal", decimalTests);
+	test.run("SpscRing", spscRingTests);
+	test.run("SymbolRegistry", symbolRegistryTests);
+	test.run("OrderTemplate", orderTemplateTests);
+	test.run("Signer", signerTests);
+	test.run("RateLimitGovernor", rateLimitGovernorTests);
+	test.run("OrderBatch", orderBatchTests);
+	test.run("ClockSync", clockSyncTests);
+	test.run("ExchangeInfoCache", exchangeInfoCacheTests);
+	test.run("OrderValidator", orderValidatorTests);
+	test.run("OrderStateCache", orderStateCacheTests);
+	test.run("AccountStateCache", accountStateCacheTests);
+	test.run("LatencyHistogram", latencyHistogramTests);
+	test.run("StreamLatency", streamLatencyTests);
+	test.run("RestCallStatistics", restCallStatisticsTests);
+	test.run("FrameRecorder", frameRecorderTests);
+
+	std::cout << "\n\n" << test.checks() << " checks, " << test.failures() << " failed\n";
+
+	return test.failures() == 0;
+}
+
+
+#endif
@@ -9,6 +9,7 @@
 
 #include "OpenAndCloseLimitOrder.h"
 #include "ScopedTimer.hpp"
+#include "UnitTests.hpp"
 
 
 using namespace std::chrono_literals;
@@ -320,6 +321,27 @@ void monitorSymbolBook()
 
 
 
+/// <summary>
+/// As monitorSymbolBook() but with a statically typed callback: the stream struct is passed by const reference rather than in a std::any.
+/// </summary>
+void monitorSymbolBookTyped()
+{
+	std::cout << "\n\n--- USD-M Futures Monitor Symbol Book Ticker (typed callback) ---\n";
+
+	UsdFuturesMarket futures;
+	futures.monitorSymbolBookStream("BTCUSDT", [](const SymbolBookTickerStream& tick)
+	{
+		stringstream ss;
+		std::for_each(std::begin(tick.data), std::end(tick.data), [&ss](auto pair) { ss << "\n" << pair.first << "=" << pair.second; });
+
+		logg(ss.str());
+	});
+
+	std::this_thread::sleep_for(10s);
+}
+
+
+
 void monitorAllMarketMiniTicker()
 {
 	std::cout << "\n\n--- USD-M Futures Monitor All Market Symbol Ticker ---\n";
@@ -615,6 +637,7 @@ void performanceNewOrderCheckSync(const ApiAccess& access)
 	};
 
 	UsdFuturesTestMarketPerfomance market{ access };
+	market.warmRestClients();
 
 	vector<NewOrderPerformanceResult> results;
 	results.reserve(NumNewOrders);
@@ -676,6 +699,7 @@ void performanceNewOrderCheckAsync(const ApiAccess& access)
 	std::cout << "\n\n--- USD-M Futures New Order Async Performance ---\n";
 	
 	UsdFuturesTestMarketPerfomance market{ access };
+	market.warmRestClients();
 
 	vector<pplx::task<NewOrderPerformanceResult>> results;
 	results.reserve(NumNewOrders);
@@ -752,6 +776,7 @@ void performanceNewOrderBatchCheckAsync(const ApiAccess& access)
 	static size_t MaxOrdersPerBatchCall = 5;
 
 	UsdFuturesTestMarketPerfomance market{ access };
+	market.warmRestClients();
 
 	vector<pplx::task<NewOrderBatchPerformanceResult>> results;
 	results.reserve(NumBatchOrders/MaxOrdersPerBatchCall);
@@ -1008,6 +1033,12 @@ void orderBook()
 
 int main(int argc, char** argv)
 {
+	// run the unit tests, these don't connect to the exchange
+	if (argc == 2 && string{ argv[1] } == "--unit")
+	{
+		return runUnitTests() ? 0 : 1;
+	}
+
 	try
 	{
 		std::string apiFutTest, secretFutTest;
@@ -1054,6 +1085,7 @@ int main(int argc, char** argv)
 		//monitorCandleSticks();
 		//monitorSymbol();
 		//monitorSymbolBook();
+		//monitorSymbolBookTyped();
 		//monitorAllMarketMiniTicker();
 		//monitorMultipleStreams();
 		//monitorPartialBookDepth();